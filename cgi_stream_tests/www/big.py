@@ -0,0 +1,7 @@
+import os, sys
+size = int(os.environ.get("QUERY_STRING") or 1048576)
+out = sys.stdout.buffer
+out.write(b"Content-Type: application/octet-stream\r\n\r\n")
+line = b"x" * 1023 + b"\n"
+for _ in range(size // 1024):
+    out.write(line)
@@ -0,0 +1,3 @@
+import hashlib, sys
+body = sys.stdin.buffer.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\n%d %s\n" % (len(body), hashlib.md5(body).hexdigest()))
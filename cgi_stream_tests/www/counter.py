@@ -0,0 +1,13 @@
+import os, sys, time
+path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "counter.txt")
+count = int(open(path).read()) + 1 if os.path.exists(path) else 1
+open(path, "w").write(str(count))
+query = os.environ.get("QUERY_STRING", "")
+if query == "slow":
+    time.sleep(1)
+sys.stdout.write("Content-Type: text/plain\r\n")
+if query == "nostore":
+    sys.stdout.write("Cache-Control: no-store\r\n")
+if query == "cookie":
+    sys.stdout.write("Set-Cookie: id=%d\r\n" % count)
+sys.stdout.write("\r\ncount=%d lang=%s\n" % (count, os.environ.get("HTTP_ACCEPT_LANGUAGE", "")))
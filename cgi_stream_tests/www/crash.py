@@ -0,0 +1,5 @@
+import os, signal, sys, time
+sys.stdout.write("Content-Type: text/plain\r\n\r\npartial\n")
+sys.stdout.flush()
+time.sleep(0.5)
+os.kill(os.getpid(), signal.SIGKILL)
@@ -0,0 +1,3 @@
+import sys
+sys.stdout.write("Content-Type: text/plain\r\nContent-Length: 6\r\n\r\nerror\n")
+sys.exit(1)
@@ -0,0 +1,3 @@
+import sys, time
+time.sleep(2)
+sys.stdout.write("Content-Type: text/plain\r\n\r\nheld\n")
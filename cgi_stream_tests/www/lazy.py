@@ -0,0 +1,4 @@
+import sys, time
+time.sleep(3)
+body = sys.stdin.buffer.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\n%d\n" % len(body))
@@ -0,0 +1,5 @@
+import sys, time
+sys.stdout.write("Content-Type: text/plain\r\nContent-Length: 12\r\n\r\nfirst\n")
+sys.stdout.flush()
+time.sleep(0.5)
+sys.stdout.write("second")
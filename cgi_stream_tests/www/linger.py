@@ -0,0 +1,6 @@
+import os, sys, time
+sys.stdout.write("Content-Type: text/plain\r\n\r\ndone\n")
+sys.stdout.flush()
+os.close(1)
+time.sleep(4)
+open(os.path.join(os.path.dirname(os.path.abspath(__file__)), "linger.mark"), "w").close()
@@ -0,0 +1,5 @@
+import sys, time
+sys.stdout.write("Content-Type: text/plain\r\n\r\nfirst\n")
+sys.stdout.flush()
+time.sleep(2)
+sys.stdout.write("second\n")
@@ -0,0 +1,6 @@
+import os, sys
+body = sys.stdin.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\n")
+print("pid=%d" % os.getpid())
+print("query=%s" % os.environ.get("QUERY_STRING", ""))
+print("body=%d" % len(body))
@@ -0,0 +1,3 @@
+import os, sys, time
+time.sleep(1)
+sys.stdout.write("Content-Type: text/plain\r\n\r\npid=%d\n" % os.getpid())
@@ -0,0 +1,3 @@
+import sys
+body = sys.stdin.buffer.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\nbody=%d\n" % len(body))
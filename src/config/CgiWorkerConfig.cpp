@@ -0,0 +1,63 @@
+#include "CgiWorkerConfig.hpp"
+
+CgiWorkerConfig::CgiWorkerConfig()
+    : _script(""), _min(CGI_WORKER_MIN), _max(CGI_WORKER_MAX), _idleTimeout(CGI_WORKER_IDLE), _maxRequests(CGI_WORKER_REQUESTS) {}
+CgiWorkerConfig::CgiWorkerConfig(const CgiWorkerConfig& other)
+    : _script(other._script), _min(other._min), _max(other._max), _idleTimeout(other._idleTimeout), _maxRequests(other._maxRequests) {}
+CgiWorkerConfig& CgiWorkerConfig::operator=(const CgiWorkerConfig& other) {
+    if (this != &other) {
+        _script      = other._script;
+        _min         = other._min;
+        _max         = other._max;
+        _idleTimeout = other._idleTimeout;
+        _maxRequests = other._maxRequests;
+    }
+    return *this;
+}
+CgiWorkerConfig::CgiWorkerConfig(const String& script)
+    : _script(script), _min(CGI_WORKER_MIN), _max(CGI_WORKER_MAX), _idleTimeout(CGI_WORKER_IDLE), _maxRequests(CGI_WORKER_REQUESTS) {}
+CgiWorkerConfig::~CgiWorkerConfig() {}
+
+const String& CgiWorkerConfig::getScript() const {
+    return _script;
+}
+size_t CgiWorkerConfig::getMin() const {
+    return _min;
+}
+size_t CgiWorkerConfig::getMax() const {
+    return _max;
+}
+int CgiWorkerConfig::getIdleTimeout() const {
+    return _idleTimeout;
+}
+size_t CgiWorkerConfig::getMaxRequests() const {
+    return _maxRequests;
+}
+
+bool CgiWorkerConfig::setOption(const String& option) {
+    String name, value;
+    if (!splitByChar(option, name, value, EQUALS))
+        return Logger::error("cgi_worker takes extension and script plus options, got '" + option + "'");
+    if (name == "min") {
+        if (!stringToType<size_t>(value, _min) || value[0] == '-')
+            return Logger::error("invalid cgi_worker min: " + value);
+    } else if (name == "max") {
+        if (!stringToType<size_t>(value, _max) || value[0] == '-' || _max < 1)
+            return Logger::error("invalid cgi_worker max: " + value);
+    } else if (name == "idle") {
+        if (!stringToType<int>(value, _idleTimeout) || _idleTimeout < 1)
+            return Logger::error("invalid cgi_worker idle: " + value);
+    } else if (name == "requests") {
+        if (!stringToType<size_t>(value, _maxRequests) || value[0] == '-' || _maxRequests < 1)
+            return Logger::error("invalid cgi_worker requests: " + value);
+    } else {
+        return Logger::error("unknown cgi_worker option: " + name);
+    }
+    return true;
+}
+
+bool CgiWorkerConfig::validate() const {
+    if (_min > _max)
+        return Logger::error("cgi_worker min exceeds max");
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef CGI_WORKER_CONFIG_HPP
+#define CGI_WORKER_CONFIG_HPP
+#include <iostream>
+#include "../utils/Logger.hpp"
+#include "../utils/Types.hpp"
+#include "../utils/Utils.hpp"
+
+// cgi_worker <extension> <worker script> [min=N] [max=N] [idle=S] [requests=N]
+// The cgi_pass interpreter for the extension runs the worker script once; the
+// script then serves requests over framed stdin/stdout instead of exiting.
+class CgiWorkerConfig {
+   public:
+    CgiWorkerConfig();
+    CgiWorkerConfig(const CgiWorkerConfig& other);
+    CgiWorkerConfig& operator=(const CgiWorkerConfig& other);
+    CgiWorkerConfig(const String& script);
+    ~CgiWorkerConfig();
+
+    const String& getScript() const;
+    size_t        getMin() const;
+    size_t        getMax() const;
+    int           getIdleTimeout() const;
+    size_t        getMaxRequests() const;
+
+    bool setOption(const String& option);
+    bool validate() const;
+
+   private:
+    String _script;      // passed to the interpreter as its only argument
+    size_t _min;         // min=N: workers started up front and kept alive
+    size_t _max;         // max=N: beyond this, requests fall back to fork
+    int    _idleTimeout; // idle=S: seconds before an idle worker above min exits
+    size_t _maxRequests; // requests=N: worker is recycled after N requests
+};
+
+#endif
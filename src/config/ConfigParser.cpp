@@ -1,8 +1,16 @@
 #include "ConfigParser.hpp"
+#include <set>
 
-ConfigParser::ConfigParser(const String& filename) : _lexer(filename), _haveHttp(false), _httpClientMaxBody(-1) {
+ConfigParser::ConfigParser(const String& filename) : _lexer(filename), _haveHttp(false), _httpClientMaxBody(-1), _httpConfig() {
     nextToken();
 
+    // ---- Http directives ----
+    _httpDirectives["accept_batch"]      = &HttpConfig::setAcceptBatch;
+    _httpDirectives["max_connections"]   = &HttpConfig::setMaxConnections;
+    _httpDirectives["overload_response"] = &HttpConfig::setOverloadResponse;
+    _httpDirectives["aio"]               = &HttpConfig::setAio;
+    _httpDirectives["proxy_cache_path"]  = &HttpConfig::setProxyCachePath;
+
     // ---- Server directives ----
     _serverDirectives["listen"]               = &ServerConfig::setListen;
     _serverDirectives["server_name"]          = &ServerConfig::setServerName;
@@ -19,19 +27,38 @@ ConfigParser::ConfigParser(const String& filename) : _lexer(filename), _haveHttp
     _locationDirectives["methods"]              = &LocationConfig::setAllowedMethods;
     _locationDirectives["return"]               = &LocationConfig::setRedirect;
     _locationDirectives["cgi_pass"]             = &LocationConfig::setCgiPass;
+    _locationDirectives["cgi_worker"]           = &LocationConfig::setCgiWorker;
+    _locationDirectives["fastcgi_pass"]         = &LocationConfig::setFastcgiPass;
+    _locationDirectives["proxy_pass"]           = &LocationConfig::setProxyPass;
+    _locationDirectives["proxy_cache"]          = &LocationConfig::setProxyCache;
+    _locationDirectives["proxy_cache_valid"]    = &LocationConfig::setProxyCacheValid;
+    _locationDirectives["proxy_cache_lock"]     = &LocationConfig::setProxyCacheLock;
+    _locationDirectives["cgi_max_concurrency"]  = &LocationConfig::setCgiMaxConcurrency;
+    _locationDirectives["cgi_queue_size"]       = &LocationConfig::setCgiQueueSize;
+    _locationDirectives["cgi_queue_timeout"]    = &LocationConfig::setCgiQueueTimeout;
+    _locationDirectives["cgi_cache_valid"]      = &LocationConfig::setCgiCacheValid;
+    _locationDirectives["cgi_cache_vary"]       = &LocationConfig::setCgiCacheVary;
     _locationDirectives["upload_dir"]           = &LocationConfig::setUploadDir;
+    _locationDirectives["upload_io"]            = &LocationConfig::setUploadIo;
     _locationDirectives["error_page"]           = &LocationConfig::setErrorPage;
+
+    // ---- Upstream directives ----
+    _upstreamDirectives["server"]       = &UpstreamConfig::setServer;
+    _upstreamDirectives["least_conn"]   = &UpstreamConfig::setLeastConn;
+    _upstreamDirectives["hash"]         = &UpstreamConfig::setHash;
+    _upstreamDirectives["health_check"] = &UpstreamConfig::setHealthCheck;
 }
 
 
-ConfigParser::ConfigParser() : _lexer(), _current(), _haveHttp(false), _servers(), _httpClientMaxBody(-1) {}
+ConfigParser::ConfigParser() : _lexer(), _current(), _haveHttp(false), _servers(), _httpClientMaxBody(-1), _httpConfig() {}
 
 ConfigParser::ConfigParser(const ConfigParser& other)
     : _lexer(other._lexer),
     _current(other._current),
     _haveHttp(other._haveHttp),
     _servers(other._servers),
-    _httpClientMaxBody(other._httpClientMaxBody)
+    _httpClientMaxBody(other._httpClientMaxBody),
+    _httpConfig(other._httpConfig)
 {}
 
 ConfigParser& ConfigParser::operator=(const ConfigParser& other) {
@@ -41,6 +68,7 @@ ConfigParser& ConfigParser::operator=(const ConfigParser& other) {
         _haveHttp = other._haveHttp;
         _servers = other._servers;
         _httpClientMaxBody = other._httpClientMaxBody;
+        _httpConfig = other._httpConfig;
     }
     return *this;
 }
@@ -77,6 +105,9 @@ bool ConfigParser::parse() {
             } else if (_current.getType() == TOKEN_WORD && _current.getValue() == "server") {
                 if (!parseServer())
                     return false;
+            } else if (_current.getType() == TOKEN_WORD && _current.getValue() == "upstream") {
+                if (!parseUpstream())
+                    return false;
             } else {
                 return error("Unexpected top-level token '" + _current.getValue() + "'");
             }
@@ -97,6 +128,9 @@ bool ConfigParser::parseHttp() {
         if (_current.getType() == TOKEN_WORD && _current.getValue() == "server") {
             if (!parseServer())
                 return false;
+        } else if (_current.getType() == TOKEN_WORD && _current.getValue() == "upstream") {
+            if (!parseUpstream())
+                return false;
         } else if (_current.getType() == TOKEN_WORD && _current.getValue() == "client_max_body_size") {
             nextToken();
             if (_current.getType() != TOKEN_WORD && _current.getType() != TOKEN_STRING)
@@ -107,6 +141,22 @@ bool ConfigParser::parseHttp() {
             nextToken();
             if (!expect(TOKEN_SEMICOLON, "';' after client_max_body_size"))
                 return false;
+        } else if (_current.getType() == TOKEN_WORD && keyExists(_httpDirectives, _current.getValue())) {
+            String key = _current.getValue();
+            nextToken();
+
+            VectorString values;
+            while (_current.getType() != TOKEN_SEMICOLON) {
+                if (_current.getType() != TOKEN_WORD && _current.getType() != TOKEN_STRING)
+                    return error("Expected value or ';'");
+                values.push_back(_current.getValue());
+                nextToken();
+            }
+            nextToken();
+
+            const HttpSetter setter = getValue<HttpDirectiveMap, String, HttpSetter>(_httpDirectives, key);
+            if (!(_httpConfig.*(setter))(values))
+                return false;
         } else {
             return error("Invalid directive in http block: '" + _current.getValue() + "'");
         }
@@ -201,6 +251,43 @@ bool ConfigParser::parseLocation(ServerConfig& srv) {
     srv.addLocation(loc);
     return true;
 }
+bool ConfigParser::parseUpstream() {
+    nextToken(); // consume "upstream"
+    if (_current.getType() != TOKEN_WORD && _current.getType() != TOKEN_STRING)
+        return error("Expected upstream name");
+    String name = _current.getValue();
+    if (name.empty() || name.find_first_of(":/[]") != String::npos)
+        return error("Invalid upstream name: '" + name + "'");
+    nextToken();
+    if (!expect(TOKEN_LBRACE, "'{' after upstream name"))
+        return false;
+
+    UpstreamConfig upstream(name);
+    while (_current.getType() != TOKEN_RBRACE) {
+        if (_current.getType() != TOKEN_WORD)
+            return error("Expected directive name");
+        String key = _current.getValue();
+        nextToken();
+
+        VectorString values;
+        while (_current.getType() != TOKEN_SEMICOLON) {
+            if (_current.getType() != TOKEN_WORD && _current.getType() != TOKEN_STRING)
+                return error("Expected value or ';'");
+            values.push_back(_current.getValue());
+            nextToken();
+        }
+        nextToken();
+
+        if (!keyExists(_upstreamDirectives, key))
+            return error("Unknown upstream directive '" + key + "'");
+        const UpstreamSetter setter = getValue<UpstreamDirectiveMap, String, UpstreamSetter>(_upstreamDirectives, key);
+        if (!(upstream.*(setter))(values))
+            return false;
+    }
+    nextToken();
+    return upstream.validate() && _httpConfig.addUpstream(upstream);
+}
+
 bool ConfigParser::validate() {
     if (_servers.empty())
         return Logger::error("No server defined");
@@ -225,6 +312,30 @@ bool ConfigParser::validate() {
                     return Logger::error("Location has no root and server has no root");
                 loc.setRoot(srv.getRoot());
             }
+            const MapCgiWorkerConfig& workers = loc.getCgiWorkers();
+            for (MapCgiWorkerConfig::const_iterator it = workers.begin(); it != workers.end(); ++it) {
+                if (loc.getCgiInterpreter(it->first).empty())
+                    return Logger::error("cgi_worker without cgi_pass for extension: " + it->first);
+            }
+            if (loc.hasCgiLimit() && !loc.hasCgi())
+                return Logger::error("cgi_max_concurrency without cgi_pass in location: " + loc.getPath());
+            if (loc.hasCgiQueueSettings() && !loc.hasCgiLimit())
+                return Logger::error("cgi_queue_size/cgi_queue_timeout without cgi_max_concurrency in location: " + loc.getPath());
+            if (loc.hasCgiCache() && !loc.hasCgi())
+                return Logger::error("cgi_cache_valid without cgi_pass in location: " + loc.getPath());
+            if (!loc.getCgiCacheVary().empty() && !loc.hasCgiCache())
+                return Logger::error("cgi_cache_vary without cgi_cache_valid in location: " + loc.getPath());
+            // proxy_pass http://name goes to the upstream block of that name, if any
+            if (!loc.getProxyUpstream().empty() && !_httpConfig.findUpstream(loc.getProxyUpstream()))
+                loc.setProxyUpstream("");
+            if (loc.hasProxyCache() && !loc.hasProxy())
+                return Logger::error("proxy_cache without proxy_pass in location: " + loc.getPath());
+            if (loc.hasProxyCache() && _httpConfig.getProxyCachePath().empty())
+                return Logger::error("proxy_cache without proxy_cache_path in location: " + loc.getPath());
+            if (loc.hasProxyCacheSettings() && !loc.hasProxyCache())
+                return Logger::error("proxy_cache_valid or proxy_cache_lock without proxy_cache in location: " + loc.getPath());
+            if (loc.hasUploadIo() && loc.getUploadDir().empty())
+                return Logger::error("upload_io without upload_dir in location: " + loc.getPath());
             if (loc.getAllowedMethods().empty())
                 loc.setAllowedMethods(VectorString(1, "GET"));
             if (loc.getClientMaxBody() == -1)
@@ -237,6 +348,16 @@ bool ConfigParser::validate() {
             }
         }
     }
+    // As in nginx, one socket takes its options from one listen directive:
+    // other server blocks on that address name it without options
+    std::set<String> withOptions;
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        const VectorListenAddress& addresses = _servers[i].getListenAddresses();
+        for (size_t j = 0; j < addresses.size(); ++j) {
+            if (addresses[j].hasOptions() && !withOptions.insert(addresses[j].getListenAddress()).second)
+                return Logger::error("duplicate listen options for " + addresses[j].getListenAddress());
+        }
+    }
     return true;
 }
 
@@ -246,4 +367,8 @@ const VectorServerConfig& ConfigParser::getServers() const {
 
 const ssize_t& ConfigParser::getHttpClientMaxBody() const {
     return _httpClientMaxBody;
+}
+
+const HttpConfig& ConfigParser::getHttpConfig() const {
+    return _httpConfig;
 }
\ No newline at end of file
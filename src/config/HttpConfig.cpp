@@ -0,0 +1,152 @@
+#include "HttpConfig.hpp"
+
+HttpConfig::HttpConfig() : acceptBatch(-1), maxConnections(-1), overloadSet(false), overloadRetryAfter(-1), aioThreads(-1), proxyCachePath(), proxyCacheMaxSize(PROXY_CACHE_MAX_SIZE), upstreams() {}
+
+HttpConfig::HttpConfig(const HttpConfig& other)
+    : acceptBatch(other.acceptBatch),
+      maxConnections(other.maxConnections),
+      overloadSet(other.overloadSet),
+      overloadRetryAfter(other.overloadRetryAfter),
+      aioThreads(other.aioThreads),
+      proxyCachePath(other.proxyCachePath),
+      proxyCacheMaxSize(other.proxyCacheMaxSize),
+      upstreams(other.upstreams) {}
+
+HttpConfig& HttpConfig::operator=(const HttpConfig& other) {
+    if (this != &other) {
+        acceptBatch        = other.acceptBatch;
+        maxConnections     = other.maxConnections;
+        overloadSet        = other.overloadSet;
+        overloadRetryAfter = other.overloadRetryAfter;
+        aioThreads         = other.aioThreads;
+        proxyCachePath     = other.proxyCachePath;
+        proxyCacheMaxSize  = other.proxyCacheMaxSize;
+        upstreams          = other.upstreams;
+    }
+    return *this;
+}
+
+HttpConfig::~HttpConfig() {}
+
+bool HttpConfig::setAcceptBatch(const VectorString& values) {
+    if (acceptBatch != -1)
+        return Logger::error("duplicate accept_batch");
+    if (!requireSingleValue(values, "accept_batch"))
+        return false;
+    int batch;
+    if (!stringToType<int>(values[0], batch) || batch < 1 || batch > ACCEPT_BATCH_MAX)
+        return Logger::error("invalid accept_batch: " + values[0]);
+    acceptBatch = batch;
+    return true;
+}
+
+bool HttpConfig::setMaxConnections(const VectorString& values) {
+    if (maxConnections != -1)
+        return Logger::error("duplicate max_connections");
+    if (!requireSingleValue(values, "max_connections"))
+        return false;
+    long limit;
+    if (!stringToType<long>(values[0], limit) || limit < 1 || limit > MAX_CONNECTIONS_LIMIT)
+        return Logger::error("invalid max_connections: " + values[0]);
+    maxConnections = limit;
+    return true;
+}
+
+// overload_response pause;            stop polling listeners while full (default)
+// overload_response 503 [seconds];    answer new connections with a prebuilt 503
+bool HttpConfig::setOverloadResponse(const VectorString& values) {
+    if (overloadSet)
+        return Logger::error("duplicate overload_response");
+    if (values.empty() || values.size() > 2)
+        return Logger::error("overload_response takes 'pause' or '503 [retry_after]'");
+    if (values[0] == "pause" && values.size() == 1) {
+        overloadRetryAfter = -1;
+    } else if (values[0] == "503") {
+        int retryAfter = OVERLOAD_RETRY_AFTER;
+        if (values.size() == 2 && (!stringToType<int>(values[1], retryAfter) || retryAfter < 0))
+            return Logger::error("invalid overload_response retry_after: " + values[1]);
+        overloadRetryAfter = retryAfter;
+    } else {
+        return Logger::error("invalid overload_response: " + values[0]);
+    }
+    overloadSet = true;
+    return true;
+}
+
+// aio off;              file handlers run on the event loop (default)
+// aio threads=N;        static files, listings, DELETE and error pages are built on N threads
+bool HttpConfig::setAio(const VectorString& values) {
+    if (aioThreads != -1)
+        return Logger::error("duplicate aio");
+    if (!requireSingleValue(values, "aio"))
+        return false;
+    int threads = 0;
+    if (values[0] != "off") {
+        bool valid = values[0].compare(0, 8, "threads=") == 0 && stringToType<int>(values[0].substr(8), threads);
+        if (!valid || threads < 1 || threads > AIO_THREADS_MAX)
+            return Logger::error("invalid aio: " + values[0]);
+    }
+    aioThreads = threads;
+    return true;
+}
+
+// proxy_cache_path <dir> [max_size=SIZE];   bodies of proxy_cache locations, LRU beyond SIZE
+bool HttpConfig::setProxyCachePath(const VectorString& values) {
+    if (!proxyCachePath.empty())
+        return Logger::error("duplicate proxy_cache_path");
+    if (values.empty() || values.size() > 2)
+        return Logger::error("proxy_cache_path takes a directory and an optional max_size");
+    if (values[0].empty() || values[0][0] != SLASH)
+        return Logger::error("proxy_cache_path must be absolute: " + values[0]);
+    if (values.size() == 2) {
+        String name, size;
+        if (!splitByChar(values[1], name, size, EQUALS) || name != "max_size" || convertMaxBodySize(size) == 0)
+            return Logger::error("invalid proxy_cache_path max_size: " + values[1]);
+        proxyCacheMaxSize = convertMaxBodySize(size);
+    }
+    proxyCachePath = values[0];
+    return true;
+}
+
+bool HttpConfig::addUpstream(const UpstreamConfig& upstream) {
+    if (findUpstream(upstream.getName()))
+        return Logger::error("duplicate upstream: " + upstream.getName());
+    upstreams.push_back(upstream);
+    return true;
+}
+
+int HttpConfig::getAcceptBatch() const {
+    return acceptBatch == -1 ? ACCEPT_BATCH_DEFAULT : acceptBatch;
+}
+
+size_t HttpConfig::getMaxConnections() const {
+    return maxConnections == -1 ? MAX_CONNECTIONS : static_cast<size_t>(maxConnections);
+}
+
+int HttpConfig::getOverloadRetryAfter() const {
+    return overloadRetryAfter;
+}
+
+int HttpConfig::getAioThreads() const {
+    return aioThreads == -1 ? 0 : aioThreads;
+}
+
+const String& HttpConfig::getProxyCachePath() const {
+    return proxyCachePath;
+}
+
+size_t HttpConfig::getProxyCacheMaxSize() const {
+    return proxyCacheMaxSize;
+}
+
+const VectorUpstreamConfig& HttpConfig::getUpstreams() const {
+    return upstreams;
+}
+
+const UpstreamConfig* HttpConfig::findUpstream(const String& name) const {
+    for (size_t i = 0; i < upstreams.size(); ++i) {
+        if (upstreams[i].getName() == name)
+            return &upstreams[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,45 @@
+#ifndef HTTP_CONFIG_HPP
+#define HTTP_CONFIG_HPP
+#include "../utils/Logger.hpp"
+#include "../utils/Utils.hpp"
+#include "UpstreamConfig.hpp"
+
+// Directives of the http block that apply to the whole process (event loop,
+// connection handling) rather than to a single server.
+class HttpConfig {
+   public:
+    HttpConfig();
+    HttpConfig(const HttpConfig& other);
+    HttpConfig& operator=(const HttpConfig& other);
+    ~HttpConfig();
+
+    // setters
+    bool setAcceptBatch(const VectorString& values);
+    bool setMaxConnections(const VectorString& values);
+    bool setOverloadResponse(const VectorString& values);
+    bool setAio(const VectorString& values);
+    bool setProxyCachePath(const VectorString& values);
+    bool addUpstream(const UpstreamConfig& upstream);
+
+    // getters
+    int    getAcceptBatch() const;
+    size_t getMaxConnections() const;
+    int    getOverloadRetryAfter() const;
+    int    getAioThreads() const;
+    size_t getProxyCacheMaxSize() const;
+
+    const String&               getProxyCachePath() const;
+    const VectorUpstreamConfig& getUpstreams() const;
+    const UpstreamConfig*       findUpstream(const String& name) const;
+
+   private:
+    int                  acceptBatch;        // max connections accepted per listener wakeup (-1: default)
+    long                 maxConnections;     // open client connections before shedding (-1: default)
+    bool                 overloadSet;        // tracks if overload_response directive was used
+    int                  overloadRetryAfter; // -1: pause listeners, else reply 503 with this Retry-After
+    int                  aioThreads;         // file handler threads, 0: off (-1: default)
+    String               proxyCachePath;     // directory of the proxy_cache bodies, empty: no cache
+    size_t               proxyCacheMaxSize;  // bodies kept before the least recently used go
+    VectorUpstreamConfig upstreams;          // upstream blocks, named by proxy_pass
+};
+#endif
@@ -1,17 +1,44 @@
 #include "ListenAddressConfig.hpp"
 
-ListenAddress::ListenAddress() : _interface(""), _port(-1), _serverFd(-1) {}
-ListenAddress::ListenAddress(const ListenAddress& other) : _interface(other._interface), _port(other._port), _serverFd(other._serverFd) {}
+ListenAddress::ListenAddress()
+    : _interface(""), _port(-1), _serverFd(-1), _backlog(-1), _deferred(false), _fastOpen(-1), _rcvBuf(-1), _sndBuf(-1), _soKeepalive(false), _ipv6Only(false), _unix(false), _mode(-1), _hasOptions(false) {}
+ListenAddress::ListenAddress(const ListenAddress& other)
+    : _interface(other._interface),
+      _port(other._port),
+      _serverFd(other._serverFd),
+      _backlog(other._backlog),
+      _deferred(other._deferred),
+      _fastOpen(other._fastOpen),
+      _rcvBuf(other._rcvBuf),
+      _sndBuf(other._sndBuf),
+      _soKeepalive(other._soKeepalive),
+      _ipv6Only(other._ipv6Only),
+      _unix(other._unix),
+      _mode(other._mode),
+      _hasOptions(other._hasOptions) {}
 ListenAddress& ListenAddress::operator=(const ListenAddress& other) {
     if (this != &other) {
-        _interface = other._interface;
-        _port      = other._port;
-        _serverFd  = other._serverFd;
+        _interface   = other._interface;
+        _port        = other._port;
+        _serverFd    = other._serverFd;
+        _backlog     = other._backlog;
+        _deferred    = other._deferred;
+        _fastOpen    = other._fastOpen;
+        _rcvBuf      = other._rcvBuf;
+        _sndBuf      = other._sndBuf;
+        _soKeepalive = other._soKeepalive;
+        _ipv6Only    = other._ipv6Only;
+        _unix        = other._unix;
+        _mode        = other._mode;
+        _hasOptions  = other._hasOptions;
     }
     return *this;
 }
 ListenAddress::~ListenAddress() {}
-ListenAddress::ListenAddress(const String& iface, int p) : _interface(iface), _port(p), _serverFd(-1) {}
+ListenAddress::ListenAddress(const String& iface, int p)
+    : _interface(iface), _port(p), _serverFd(-1), _backlog(-1), _deferred(false), _fastOpen(-1), _rcvBuf(-1), _sndBuf(-1), _soKeepalive(false), _ipv6Only(false), _unix(false), _mode(-1), _hasOptions(false) {}
+ListenAddress::ListenAddress(const String& unixPath)
+    : _interface(unixPath), _port(0), _serverFd(-1), _backlog(-1), _deferred(false), _fastOpen(-1), _rcvBuf(-1), _sndBuf(-1), _soKeepalive(false), _ipv6Only(false), _unix(true), _mode(-1), _hasOptions(false) {}
 const String& ListenAddress::getInterface() const {
     return _interface;
 }
@@ -25,5 +52,85 @@ void ListenAddress::setServerFd(int fd) {
     _serverFd = fd;
 }
 String ListenAddress::getListenAddress() const {
+    if (_unix)
+        return "unix:" + _interface;
+    if (isIpv6())
+        return "[" + _interface + "]:" + typeToString<int>(_port);
     return _interface + ":" + typeToString<int>(_port);
 }
+int ListenAddress::getBacklog() const {
+    return _backlog;
+}
+bool ListenAddress::isDeferred() const {
+    return _deferred;
+}
+int ListenAddress::getFastOpen() const {
+    return _fastOpen;
+}
+int ListenAddress::getRcvBuf() const {
+    return _rcvBuf;
+}
+int ListenAddress::getSndBuf() const {
+    return _sndBuf;
+}
+bool ListenAddress::isSoKeepalive() const {
+    return _soKeepalive;
+}
+bool ListenAddress::isIpv6() const {
+    return !_unix && _interface.find(COLON) != String::npos;
+}
+bool ListenAddress::isIpv6Only() const {
+    return _ipv6Only;
+}
+bool ListenAddress::isUnix() const {
+    return _unix;
+}
+int ListenAddress::getMode() const {
+    return _mode;
+}
+bool ListenAddress::hasOptions() const {
+    return _hasOptions;
+}
+
+// One option of a listen directive: listen 127.0.0.1:8080 backlog=511 deferred;
+bool ListenAddress::setOption(const String& option) {
+    _hasOptions = true;
+    if (_unix && (option == "deferred" || option == "so_keepalive" || option.compare(0, 9, "fastopen=") == 0))
+        return Logger::error("listen option not supported on unix sockets: " + option);
+    if (option == "deferred") {
+        _deferred = true;
+        return true;
+    }
+    if (option == "so_keepalive") {
+        _soKeepalive = true;
+        return true;
+    }
+    String name, value;
+    if (!splitByChar(option, name, value, EQUALS))
+        return Logger::error("listen takes exactly one value plus options, got '" + option + "'");
+    if (name == "backlog") {
+        if (!stringToType<int>(value, _backlog) || _backlog < 1)
+            return Logger::error("invalid listen backlog: " + value);
+    } else if (name == "fastopen") {
+        if (!stringToType<int>(value, _fastOpen) || _fastOpen < 0)
+            return Logger::error("invalid listen fastopen: " + value);
+    } else if (name == "ipv6only") {
+        if (!isIpv6() || (value != "on" && value != "off"))
+            return Logger::error("invalid listen ipv6only: " + value);
+        _ipv6Only = (value == "on");
+    } else if (name == "mode") {
+        char* end  = NULL;
+        long  mode = std::strtol(value.c_str(), &end, 8);
+        if (!_unix || value.empty() || *end != '\0' || mode < 0 || mode > 0777)
+            return Logger::error("invalid listen mode: " + value);
+        _mode = static_cast<int>(mode);
+    } else if (name == "rcvbuf" || name == "sndbuf") {
+        ssize_t size = convertMaxBodySize(value);
+        if (size <= 0 || size > INT_MAX)
+            return Logger::error("invalid listen " + name + ": " + value);
+        (name == "rcvbuf" ? _rcvBuf : _sndBuf) = static_cast<int>(size);
+    } else {
+        return Logger::error("unknown listen option: " + name);
+    }
+    return true;
+}
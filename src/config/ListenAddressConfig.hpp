@@ -1,5 +1,8 @@
 #ifndef LISTEN_ADDRESS_CONFIG_HPP
 #define LISTEN_ADDRESS_CONFIG_HPP
+#include <arpa/inet.h>
+#include <sys/un.h>
+#include <climits>
 #include <iostream>
 #include "../utils/Types.hpp"
 #include "../utils/Utils.hpp"
@@ -10,20 +13,44 @@ class ListenAddress {
     ListenAddress(const ListenAddress& other);
     ListenAddress& operator=(const ListenAddress& other);
     ListenAddress(const String& iface, int p);
+    ListenAddress(const String& unixPath);
     ~ListenAddress();
     // Getters
     const String& getInterface() const;
     int           getPort() const;
     int           getServerFd() const;
     String        getListenAddress() const;
+    int           getBacklog() const;
+    bool          isDeferred() const;
+    int           getFastOpen() const;
+    int           getRcvBuf() const;
+    int           getSndBuf() const;
+    bool          isSoKeepalive() const;
+    bool          isIpv6() const;
+    bool          isIpv6Only() const;
+    bool          isUnix() const;
+    int           getMode() const;
+    bool          hasOptions() const;
 
     // Setters
     void setServerFd(int fd);
+    bool setOption(const String& option);
 
    private:
     String _interface;
     int    _port;
     int    _serverFd;
+    // listen options (-1: kernel default)
+    int  _backlog;     // backlog=N
+    bool _deferred;    // deferred: TCP_DEFER_ACCEPT
+    int  _fastOpen;    // fastopen=N: TCP_FASTOPEN queue length
+    int  _rcvBuf;      // rcvbuf=size
+    int  _sndBuf;      // sndbuf=size
+    bool _soKeepalive; // so_keepalive: SO_KEEPALIVE
+    bool _ipv6Only;    // ipv6only=on: no IPv4-mapped peers on [::]
+    bool _unix;        // unix:/path: _interface holds the socket path, _port is 0
+    int  _mode;        // mode=0660: socket file permissions (unix only)
+    bool _hasOptions;  // any of the above was given
 };
 
 #endif
\ No newline at end of file
@@ -5,12 +5,30 @@
 // -----------------------------------------------------------------------------
 LocationConfig::LocationConfig()
     : path(),
+      normalizedPath(),
       root(),
       autoIndex(false),
       autoIndexSet(false),
       indexes(),
       uploadDir(),
+      uploadIo(UPLOAD_IO_WRITE),
+      uploadIoSet(false),
       cgiPass(),
+      cgiWorkers(),
+      fastcgiPass(),
+      proxyPass(),
+      proxyUri(),
+      proxyUpstream(),
+      proxyCache(false),
+      proxyCacheSet(false),
+      proxyCacheValid(-1),
+      proxyCacheLock(false),
+      proxyCacheLockSet(false),
+      cgiMaxConcurrency(-1),
+      cgiQueueSize(-1),
+      cgiQueueTimeout(-1),
+      cgiCacheValid(-1),
+      cgiCacheVary(),
       clientMaxBody(-1),
       allowedMethods(),
       errorPage(),
@@ -20,12 +38,30 @@ LocationConfig::LocationConfig()
 
 LocationConfig::LocationConfig(const LocationConfig& other)
     : path(other.path),
+      normalizedPath(other.normalizedPath),
       root(other.root),
       autoIndex(other.autoIndex),
       autoIndexSet(other.autoIndexSet),
       indexes(other.indexes),
       uploadDir(other.uploadDir),
+      uploadIo(other.uploadIo),
+      uploadIoSet(other.uploadIoSet),
       cgiPass(other.cgiPass),
+      cgiWorkers(other.cgiWorkers),
+      fastcgiPass(other.fastcgiPass),
+      proxyPass(other.proxyPass),
+      proxyUri(other.proxyUri),
+      proxyUpstream(other.proxyUpstream),
+      proxyCache(other.proxyCache),
+      proxyCacheSet(other.proxyCacheSet),
+      proxyCacheValid(other.proxyCacheValid),
+      proxyCacheLock(other.proxyCacheLock),
+      proxyCacheLockSet(other.proxyCacheLockSet),
+      cgiMaxConcurrency(other.cgiMaxConcurrency),
+      cgiQueueSize(other.cgiQueueSize),
+      cgiQueueTimeout(other.cgiQueueTimeout),
+      cgiCacheValid(other.cgiCacheValid),
+      cgiCacheVary(other.cgiCacheVary),
       clientMaxBody(other.clientMaxBody),
       allowedMethods(other.allowedMethods),
       errorPage(other.errorPage),
@@ -35,12 +71,30 @@ LocationConfig::LocationConfig(const LocationConfig& other)
 
 LocationConfig::LocationConfig(const String& p)
     : path(p),
+      normalizedPath(normalizePath(p)),
       root(),
       autoIndex(false),
       autoIndexSet(false),
       indexes(),
       uploadDir(),
+      uploadIo(UPLOAD_IO_WRITE),
+      uploadIoSet(false),
       cgiPass(),
+      cgiWorkers(),
+      fastcgiPass(),
+      proxyPass(),
+      proxyUri(),
+      proxyUpstream(),
+      proxyCache(false),
+      proxyCacheSet(false),
+      proxyCacheValid(-1),
+      proxyCacheLock(false),
+      proxyCacheLockSet(false),
+      cgiMaxConcurrency(-1),
+      cgiQueueSize(-1),
+      cgiQueueTimeout(-1),
+      cgiCacheValid(-1),
+      cgiCacheVary(),
       clientMaxBody(-1),
       allowedMethods(),
       errorPage(),
@@ -50,19 +104,37 @@ LocationConfig::LocationConfig(const String& p)
 
 LocationConfig& LocationConfig::operator=(const LocationConfig& other) {
     if (this != &other) {
-        path           = other.path;
-        root           = other.root;
-        autoIndex      = other.autoIndex;
-        autoIndexSet   = other.autoIndexSet;
-        indexes        = other.indexes;
-        uploadDir      = other.uploadDir;
-        cgiPass        = other.cgiPass;
-        clientMaxBody  = other.clientMaxBody;
-        allowedMethods = other.allowedMethods;
-        errorPage      = other.errorPage;
-        hasRedirect    = other.hasRedirect;
-        redirectCode   = other.redirectCode;
-        redirectValue  = other.redirectValue;
+        path              = other.path;
+        normalizedPath    = other.normalizedPath;
+        root              = other.root;
+        autoIndex         = other.autoIndex;
+        autoIndexSet      = other.autoIndexSet;
+        indexes           = other.indexes;
+        uploadDir         = other.uploadDir;
+        uploadIo          = other.uploadIo;
+        uploadIoSet       = other.uploadIoSet;
+        cgiPass           = other.cgiPass;
+        cgiWorkers        = other.cgiWorkers;
+        fastcgiPass       = other.fastcgiPass;
+        proxyPass         = other.proxyPass;
+        proxyUri          = other.proxyUri;
+        proxyUpstream     = other.proxyUpstream;
+        proxyCache        = other.proxyCache;
+        proxyCacheSet     = other.proxyCacheSet;
+        proxyCacheValid   = other.proxyCacheValid;
+        proxyCacheLock    = other.proxyCacheLock;
+        proxyCacheLockSet = other.proxyCacheLockSet;
+        cgiMaxConcurrency = other.cgiMaxConcurrency;
+        cgiQueueSize      = other.cgiQueueSize;
+        cgiQueueTimeout   = other.cgiQueueTimeout;
+        cgiCacheValid     = other.cgiCacheValid;
+        cgiCacheVary      = other.cgiCacheVary;
+        clientMaxBody     = other.clientMaxBody;
+        allowedMethods    = other.allowedMethods;
+        errorPage         = other.errorPage;
+        hasRedirect       = other.hasRedirect;
+        redirectCode      = other.redirectCode;
+        redirectValue     = other.redirectValue;
     }
     return *this;
 }
@@ -126,6 +198,23 @@ void LocationConfig::setUploadDir(const String& p) {
     uploadDir = p;
 }
 
+bool LocationConfig::setUploadIo(const VectorString& v) {
+    if (uploadIoSet)
+        return Logger::error("duplicate upload_io directive");
+    if (!requireSingleValue(v, "upload_io"))
+        return false;
+    if (v[0] == "write")
+        uploadIo = UPLOAD_IO_WRITE;
+    else if (v[0] == "direct")
+        uploadIo = UPLOAD_IO_DIRECT;
+    else if (v[0] == "splice")
+        uploadIo = UPLOAD_IO_SPLICE;
+    else
+        return Logger::error("invalid upload_io value (must be 'write', 'direct' or 'splice')");
+    uploadIoSet = true;
+    return true;
+}
+
 bool LocationConfig::setCgiPass(const VectorString& c) {
     if (c.size() != 2)
         return Logger::error("cgi_pass requires extension and interpreter");
@@ -144,6 +233,153 @@ bool LocationConfig::setCgiPass(const VectorString& c) {
     return true;
 }
 
+bool LocationConfig::setCgiWorker(const VectorString& w) {
+    if (w.size() < 2)
+        return Logger::error("cgi_worker requires extension and worker script");
+
+    const String& extension = w[0];
+    if (extension.empty() || extension[0] != DOT)
+        return Logger::error("cgi_worker extension must start with '.'");
+    if (cgiWorkers.find(extension) != cgiWorkers.end())
+        return Logger::error("duplicate cgi_worker for extension: " + extension);
+
+    CgiWorkerConfig worker(w[1]);
+    for (size_t i = 2; i < w.size(); ++i) {
+        if (!worker.setOption(w[i]))
+            return false;
+    }
+    if (!worker.validate())
+        return false;
+    cgiWorkers[extension] = worker;
+    return true;
+}
+
+bool LocationConfig::setFastcgiPass(const VectorString& f) {
+    if (!fastcgiPass.empty())
+        return Logger::error("duplicate fastcgi_pass directive");
+    if (!requireSingleValue(f, "fastcgi_pass"))
+        return false;
+    if (!proxyPass.empty())
+        return Logger::error("fastcgi_pass and proxy_pass cannot share a location");
+    String host, port;
+    if (f[0].compare(0, 5, "unix:") == 0) {
+        if (f[0].size() == 5)
+            return Logger::error("invalid fastcgi_pass address: " + f[0]);
+    } else if (!splitHostPort(f[0], host, port))
+        return Logger::error("invalid fastcgi_pass address: " + f[0]);
+    fastcgiPass = f[0];
+    return true;
+}
+
+// proxy_pass http://host[:port][/uri]. The port defaults to 80; a URI part
+// replaces the location prefix of the request, like nginx.
+bool LocationConfig::setProxyPass(const VectorString& p) {
+    if (!proxyPass.empty())
+        return Logger::error("duplicate proxy_pass directive");
+    if (!requireSingleValue(p, "proxy_pass"))
+        return false;
+    if (!fastcgiPass.empty())
+        return Logger::error("fastcgi_pass and proxy_pass cannot share a location");
+    if (p[0].compare(0, 7, "http://") != 0)
+        return Logger::error("invalid proxy_pass address (must start with http://): " + p[0]);
+    size_t slash     = p[0].find(SLASH, 7);
+    String authority = p[0].substr(7, slash == String::npos ? String::npos : slash - 7);
+    size_t v6End     = authority.find(']');
+    if (authority.find(COLON, v6End == String::npos ? 0 : v6End) == String::npos) {
+        // may name an upstream block; ConfigParser::validate() drops it if none matches
+        proxyUpstream = authority;
+        authority += ":80";
+    }
+    String host, port;
+    if (!splitHostPort(authority, host, port))
+        return Logger::error("invalid proxy_pass address: " + p[0]);
+    proxyPass = authority;
+    if (slash != String::npos)
+        proxyUri = p[0].substr(slash);
+    return true;
+}
+
+void LocationConfig::setProxyUpstream(const String& name) {
+    proxyUpstream = name;
+}
+
+bool LocationConfig::setProxyCache(const VectorString& v) {
+    if (proxyCacheSet)
+        return Logger::error("duplicate proxy_cache directive");
+    if (!requireSingleValue(v, "proxy_cache"))
+        return false;
+    if (v[0] != "on" && v[0] != "off")
+        return Logger::error("invalid proxy_cache value (must be 'on' or 'off')");
+    proxyCache    = (v[0] == "on");
+    proxyCacheSet = true;
+    return true;
+}
+
+bool LocationConfig::setProxyCacheLock(const VectorString& v) {
+    if (proxyCacheLockSet)
+        return Logger::error("duplicate proxy_cache_lock directive");
+    if (!requireSingleValue(v, "proxy_cache_lock"))
+        return false;
+    if (v[0] != "on" && v[0] != "off")
+        return Logger::error("invalid proxy_cache_lock value (must be 'on' or 'off')");
+    proxyCacheLock    = (v[0] == "on");
+    proxyCacheLockSet = true;
+    return true;
+}
+
+// proxy_cache_valid <seconds>;  freshness of a 200 the upstream gave none
+bool LocationConfig::setProxyCacheValid(const VectorString& v) {
+    if (proxyCacheValid != -1)
+        return Logger::error("duplicate proxy_cache_valid directive");
+    if (!requireSingleValue(v, "proxy_cache_valid"))
+        return false;
+    if (!stringToType<int>(v[0], proxyCacheValid) || proxyCacheValid < 1) {
+        proxyCacheValid = -1;
+        return Logger::error("invalid proxy_cache_valid: " + v[0]);
+    }
+    return true;
+}
+
+// Shared by cgi_max_concurrency, cgi_queue_size and cgi_queue_timeout
+static bool setCgiLimit(const VectorString& values, const String& directive, int min, int& target) {
+    if (target != -1)
+        return Logger::error("duplicate " + directive + " directive");
+    if (!requireSingleValue(values, directive))
+        return false;
+    int value;
+    if (!stringToType<int>(values[0], value) || value < min)
+        return Logger::error("invalid " + directive + ": " + values[0]);
+    target = value;
+    return true;
+}
+
+bool LocationConfig::setCgiMaxConcurrency(const VectorString& v) {
+    return setCgiLimit(v, "cgi_max_concurrency", 1, cgiMaxConcurrency);
+}
+
+bool LocationConfig::setCgiQueueSize(const VectorString& v) {
+    return setCgiLimit(v, "cgi_queue_size", 0, cgiQueueSize);
+}
+
+bool LocationConfig::setCgiQueueTimeout(const VectorString& v) {
+    return setCgiLimit(v, "cgi_queue_timeout", 1, cgiQueueTimeout);
+}
+
+bool LocationConfig::setCgiCacheValid(const VectorString& v) {
+    return setCgiLimit(v, "cgi_cache_valid", 1, cgiCacheValid);
+}
+
+// cgi_cache_vary <header>...;  requests differing in these get their own entry
+bool LocationConfig::setCgiCacheVary(const VectorString& v) {
+    if (!cgiCacheVary.empty())
+        return Logger::error("duplicate cgi_cache_vary directive");
+    if (v.empty())
+        return Logger::error("cgi_cache_vary requires at least one header name");
+    for (size_t i = 0; i < v.size(); ++i)
+        cgiCacheVary.push_back(toLowerWords(v[i]));
+    return true;
+}
+
 bool LocationConfig::setRedirect(const VectorString& r) {
     if (hasRedirect)
         return Logger::error("duplicate return directive");
@@ -210,11 +446,15 @@ bool LocationConfig::setErrorPage(const VectorString& values) {
     return true;
 }
 
-String LocationConfig::getPath() const {
+const String& LocationConfig::getPath() const {
     return path;
 }
 
-String LocationConfig::getRoot() const {
+const String& LocationConfig::getNormalizedPath() const {
+    return normalizedPath;
+}
+
+const String& LocationConfig::getRoot() const {
     return root;
 }
 
@@ -222,10 +462,18 @@ bool LocationConfig::getAutoIndex() const {
     return autoIndex;
 }
 
-String LocationConfig::getUploadDir() const {
+const String& LocationConfig::getUploadDir() const {
     return uploadDir;
 }
 
+UploadIo LocationConfig::getUploadIo() const {
+    return uploadIo;
+}
+
+bool LocationConfig::hasUploadIo() const {
+    return uploadIoSet;
+}
+
 const std::map<String, String>& LocationConfig::getCgiPass() const {
     return cgiPass;
 }
@@ -239,7 +487,90 @@ bool LocationConfig::hasCgi() const {
     return !cgiPass.empty();
 }
 
-VectorString LocationConfig::getAllowedMethods() const {
+const MapCgiWorkerConfig& LocationConfig::getCgiWorkers() const {
+    return cgiWorkers;
+}
+
+const CgiWorkerConfig* LocationConfig::getCgiWorker(const String& extension) const {
+    MapCgiWorkerConfig::const_iterator it = cgiWorkers.find(extension);
+    return (it != cgiWorkers.end()) ? &it->second : NULL;
+}
+
+const String& LocationConfig::getFastcgiPass() const {
+    return fastcgiPass;
+}
+
+bool LocationConfig::hasFastcgi() const {
+    return !fastcgiPass.empty();
+}
+
+const String& LocationConfig::getProxyPass() const {
+    return proxyPass;
+}
+
+const String& LocationConfig::getProxyUri() const {
+    return proxyUri;
+}
+
+const String& LocationConfig::getProxyUpstream() const {
+    return proxyUpstream;
+}
+
+bool LocationConfig::hasProxyCache() const {
+    return proxyCache;
+}
+
+bool LocationConfig::hasProxyCacheSettings() const {
+    return proxyCacheValid != -1 || proxyCacheLock;
+}
+
+// 0 when a response without freshness information is not stored
+int LocationConfig::getProxyCacheValid() const {
+    return proxyCacheValid == -1 ? 0 : proxyCacheValid;
+}
+
+bool LocationConfig::hasProxyCacheLock() const {
+    return proxyCacheLock;
+}
+
+bool LocationConfig::hasProxy() const {
+    return !proxyPass.empty();
+}
+
+bool LocationConfig::hasCgiLimit() const {
+    return cgiMaxConcurrency != -1;
+}
+
+// 0 when unlimited
+int LocationConfig::getCgiMaxConcurrency() const {
+    return cgiMaxConcurrency == -1 ? 0 : cgiMaxConcurrency;
+}
+
+int LocationConfig::getCgiQueueSize() const {
+    return cgiQueueSize == -1 ? CGI_QUEUE_SIZE : cgiQueueSize;
+}
+
+int LocationConfig::getCgiQueueTimeout() const {
+    return cgiQueueTimeout == -1 ? CGI_QUEUE_TIMEOUT : cgiQueueTimeout;
+}
+
+bool LocationConfig::hasCgiQueueSettings() const {
+    return cgiQueueSize != -1 || cgiQueueTimeout != -1;
+}
+
+bool LocationConfig::hasCgiCache() const {
+    return cgiCacheValid != -1;
+}
+
+int LocationConfig::getCgiCacheValid() const {
+    return cgiCacheValid;
+}
+
+const VectorString& LocationConfig::getCgiCacheVary() const {
+    return cgiCacheVary;
+}
+
+const VectorString& LocationConfig::getAllowedMethods() const {
     return allowedMethods;
 }
 
@@ -247,7 +578,7 @@ ssize_t LocationConfig::getClientMaxBody() const {
     return clientMaxBody;
 }
 
-VectorString LocationConfig::getIndexes() const {
+const VectorString& LocationConfig::getIndexes() const {
     return indexes;
 }
 
@@ -264,6 +595,6 @@ int LocationConfig::getRedirectCode() const {
     return redirectCode;
 }
 
-String LocationConfig::getRedirectValue() const {
+const String& LocationConfig::getRedirectValue() const {
     return redirectValue;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include "../utils/Logger.hpp"
 #include "../utils/Utils.hpp"
+#include "CgiWorkerConfig.hpp"
 class LocationConfig {
    public:
     LocationConfig();
@@ -22,45 +23,99 @@ class LocationConfig {
     bool setIndexes(const VectorString& i);
     void setUploadDir(const String& p);
     bool setUploadDir(const VectorString& p);
+    bool setUploadIo(const VectorString& v);
     bool setCgiPass(const VectorString& c);
+    bool setCgiWorker(const VectorString& w);
+    bool setFastcgiPass(const VectorString& f);
+    bool setProxyPass(const VectorString& p);
+    void setProxyUpstream(const String& name);
+    bool setProxyCache(const VectorString& v);
+    bool setProxyCacheValid(const VectorString& v);
+    bool setProxyCacheLock(const VectorString& v);
+    bool setCgiMaxConcurrency(const VectorString& v);
+    bool setCgiQueueSize(const VectorString& v);
+    bool setCgiQueueTimeout(const VectorString& v);
+    bool setCgiCacheValid(const VectorString& v);
+    bool setCgiCacheVary(const VectorString& v);
     bool setRedirect(const VectorString& r);
     bool setErrorPage(const VectorString& values);
 
     void setClientMaxBody(ssize_t c);
     bool setClientMaxBody(const VectorString& c);
 
-    bool             setAllowedMethods(const VectorString& m);
-    String           getPath() const;
-    String           getRoot() const;
-    bool             getAutoIndex() const;
-    VectorString     getIndexes() const;
-    String           getUploadDir() const;
-    const MapString& getCgiPass() const;
-    String           getCgiInterpreter(const String& extension) const;
-    bool             hasCgi() const;
-    ssize_t          getClientMaxBody() const;
-    VectorString     getAllowedMethods() const;
-    String           getErrorPage(int code) const;
-    bool             getIsRedirect() const;
-    int              getRedirectCode() const;
-    String           getRedirectValue() const;
+    bool                      setAllowedMethods(const VectorString& m);
+    const String&             getPath() const;
+    const String&             getNormalizedPath() const;
+    const String&             getRoot() const;
+    bool                      getAutoIndex() const;
+    const VectorString&       getIndexes() const;
+    const String&             getUploadDir() const;
+    UploadIo                  getUploadIo() const;
+    bool                      hasUploadIo() const;
+    const MapString&          getCgiPass() const;
+    String                    getCgiInterpreter(const String& extension) const;
+    bool                      hasCgi() const;
+    const MapCgiWorkerConfig& getCgiWorkers() const;
+    const CgiWorkerConfig*    getCgiWorker(const String& extension) const;
+    const String&             getFastcgiPass() const;
+    bool                      hasFastcgi() const;
+    const String&             getProxyPass() const;
+    const String&             getProxyUri() const;
+    const String&             getProxyUpstream() const;
+    bool                      hasProxyCache() const;
+    bool                      hasProxyCacheSettings() const;
+    int                       getProxyCacheValid() const;
+    bool                      hasProxyCacheLock() const;
+    bool                      hasProxy() const;
+    bool                      hasCgiLimit() const;
+    int                       getCgiMaxConcurrency() const;
+    int                       getCgiQueueSize() const;
+    int                       getCgiQueueTimeout() const;
+    bool                      hasCgiQueueSettings() const;
+    bool                      hasCgiCache() const;
+    int                       getCgiCacheValid() const;
+    const VectorString&       getCgiCacheVary() const;
+    ssize_t                   getClientMaxBody() const;
+    const VectorString&       getAllowedMethods() const;
+    String                    getErrorPage(int code) const;
+    bool                      getIsRedirect() const;
+    int                       getRedirectCode() const;
+    const String&             getRedirectValue() const;
 
    private:
     // required location parameters
     String path;
+    String normalizedPath; // path through normalizePath(), matched against request URIs
     // optional location parameters
-    String       root;           // default root of server if not set (be required)
-    bool         autoIndex;      // default: false
-    bool         autoIndexSet;   // tracks if autoindex directive was used
-    VectorString indexes;        // default: root if not set be default "index.html"
-    String       uploadDir;      // upload directory path
-    MapString    cgiPass;        // maps extension to interpreter path
-    ssize_t      clientMaxBody;  // default: ""
-    VectorString allowedMethods; // default: GET
-    MapIntString errorPage;      // maps error code to error page path
-    bool         hasRedirect;
-    int          redirectCode;
-    String       redirectValue;
+    String             root;              // default root of server if not set (be required)
+    bool               autoIndex;         // default: false
+    bool               autoIndexSet;      // tracks if autoindex directive was used
+    VectorString       indexes;           // default: root if not set be default "index.html"
+    String             uploadDir;         // upload directory path
+    UploadIo           uploadIo;          // how a raw body reaches the file, default: write
+    bool               uploadIoSet;       // tracks if upload_io directive was used
+    MapString          cgiPass;           // maps extension to interpreter path
+    MapCgiWorkerConfig cgiWorkers;        // maps extension to its persistent worker pool
+    String             fastcgiPass;       // upstream FastCGI server: host:port or unix:/path
+    String             proxyPass;         // upstream HTTP server of proxy_pass: host:port
+    String             proxyUri;          // replaces the location prefix, empty: URI passed as sent
+    String             proxyUpstream;     // upstream block proxy_pass names, empty: a single server
+    bool               proxyCache;        // responses stored in the proxy_cache_path cache, default: off
+    bool               proxyCacheSet;     // tracks if proxy_cache directive was used
+    int                proxyCacheValid;   // seconds a 200 without Cache-Control/Expires stays fresh, -1: not stored
+    bool               proxyCacheLock;    // one request per key fetches a miss, the others wait for it
+    bool               proxyCacheLockSet; // tracks if proxy_cache_lock directive was used
+    int                cgiMaxConcurrency; // CGI requests running at once, -1: unlimited
+    int                cgiQueueSize;      // requests waiting for a slot before 503
+    int                cgiQueueTimeout;   // seconds a request may wait for a slot
+    int                cgiCacheValid;     // seconds a GET's CGI output is reused, -1: not cached
+    VectorString       cgiCacheVary;      // lowercase request headers that are part of the cache key
+    ssize_t            clientMaxBody;     // default: ""
+    VectorString       allowedMethods;    // default: GET
+    MapIntString       errorPage;         // maps error code to error page path
+    bool               hasRedirect;
+    int                redirectCode;
+    String             redirectValue;
 };
 
 #endif
\ No newline at end of file
@@ -82,16 +82,28 @@ void ServerConfig::setRoot(const String& r) {
 
 bool ServerConfig::listenExists(const ListenAddress& addr) const {
     for (size_t i = 0; i < listenAddresses.size(); ++i)
-        if (listenAddresses[i].getInterface() == addr.getInterface() && listenAddresses[i].getPort() == addr.getPort())
+        if (listenAddresses[i].getListenAddress() == addr.getListenAddress())
             return true;
     return false;
 }
 
 bool ServerConfig::setListen(const VectorString& l) {
-    if (!requireSingleValue(l, "listen"))
-        return false;
+    if (l.empty())
+        return Logger::error("listen takes exactly one value");
+    if (l[0].compare(0, 5, "unix:") == 0)
+        return setUnixListen(l);
     String interface, portStr;
-    if (!splitByChar(l[0], interface, portStr, COLON))
+    if (!l[0].empty() && l[0][0] == '[') {
+        // [addr]:port; [::] listens dual-stack unless ipv6only=on
+        size_t          close = l[0].find(']');
+        struct in6_addr dummy;
+        if (close == String::npos || close + 1 >= l[0].size() || l[0][close + 1] != COLON)
+            return Logger::error("invalid listen format");
+        interface = l[0].substr(1, close - 1);
+        portStr   = l[0].substr(close + 2);
+        if (inet_pton(AF_INET6, interface.c_str(), &dummy) != 1)
+            return Logger::error("invalid IPv6 address: " + interface);
+    } else if (!splitByChar(l[0], interface, portStr, COLON))
         return Logger::error("invalid listen format");
     int port;
     if (!stringToType<int>(portStr, port) || port < 1 || port > 65535)
@@ -99,12 +111,37 @@ bool ServerConfig::setListen(const VectorString& l) {
     if (interface == "localhost")
         interface = "127.0.0.1";
     ListenAddress addr(interface, port);
+    for (size_t i = 1; i < l.size(); ++i)
+        if (!addr.setOption(l[i]))
+            return false;
+    if (listenExists(addr))
+        return Logger::error("duplicate listen address: " + l[0]);
+    listenAddresses.push_back(addr);
+    return true;
+}
+
+// listen unix:/run/webserv.sock [mode=0660] [backlog=N] ...;
+bool ServerConfig::setUnixListen(const VectorString& l) {
+    String path = l[0].substr(5);
+    if (path.empty() || path.size() >= sizeof(((struct sockaddr_un*)0)->sun_path))
+        return Logger::error("invalid unix socket path: " + l[0]);
+    ListenAddress addr(path);
+    for (size_t i = 1; i < l.size(); ++i)
+        if (!addr.setOption(l[i]))
+            return false;
     if (listenExists(addr))
         return Logger::error("duplicate listen address: " + l[0]);
     listenAddresses.push_back(addr);
     return true;
 }
 
+bool ServerConfig::hasUnixListen() const {
+    for (size_t i = 0; i < listenAddresses.size(); ++i)
+        if (listenAddresses[i].isUnix())
+            return true;
+    return false;
+}
+
 bool ServerConfig::setErrorPage(const VectorString& values) {
     if (values.size() < 2)
         return Logger::error("error_page requires at least one code and a path");
@@ -155,7 +192,7 @@ const VectorLocationConfig& ServerConfig::getLocations() const {
     return locations;
 }
 
-VectorString ServerConfig::getIndexes() const {
+const VectorString& ServerConfig::getIndexes() const {
     return indexes;
 }
 
@@ -171,7 +208,7 @@ bool ServerConfig::hasServerName(const String& name) const {
     return isKeyInVector(name, serverNames);
 }
 
-String ServerConfig::getRoot() const {
+const String& ServerConfig::getRoot() const {
     return root;
 }
 
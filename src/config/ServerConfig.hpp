@@ -24,6 +24,7 @@ class ServerConfig {
     bool setRoot(const VectorString& root);
     void setRoot(const String& root);
     bool setListen(const VectorString& l);
+    bool setUnixListen(const VectorString& l);
     bool setErrorPage(const VectorString& values);
     void addLocation(const LocationConfig& loc);
 
@@ -32,13 +33,14 @@ class ServerConfig {
     String                      getInterface(size_t index = 0) const;
     const VectorListenAddress&  getListenAddresses() const;
     bool                        hasPort(int port) const;
+    bool                        hasUnixListen() const;
     VectorLocationConfig&       getLocations();
     const VectorLocationConfig& getLocations() const;
     String                      getServerName(size_t index = 0) const;
     const VectorString&         getServerNames() const;
     bool                        hasServerName(const String& name) const;
-    String                      getRoot() const;
-    VectorString                getIndexes() const;
+    const String&               getRoot() const;
+    const VectorString&         getIndexes() const;
     ssize_t                     getClientMaxBody() const;
     const MapIntString&         getErrorPages() const;
     String                      getErrorPage(int code) const;
@@ -0,0 +1,200 @@
+#include "UpstreamConfig.hpp"
+
+UpstreamConfig::Server::Server() : address(), maxFails(UPSTREAM_MAX_FAILS), failTimeout(UPSTREAM_FAIL_TIMEOUT) {}
+
+UpstreamConfig::UpstreamConfig()
+    : _name(),
+      _servers(),
+      _policySet(false),
+      _policy(UPSTREAM_ROUND_ROBIN),
+      _hashCookie(),
+      _healthCheck(false),
+      _healthInterval(UPSTREAM_HEALTH_INTERVAL),
+      _healthUri("/"),
+      _healthFails(1),
+      _healthPasses(1) {}
+
+UpstreamConfig::UpstreamConfig(const UpstreamConfig& other)
+    : _name(other._name),
+      _servers(other._servers),
+      _policySet(other._policySet),
+      _policy(other._policy),
+      _hashCookie(other._hashCookie),
+      _healthCheck(other._healthCheck),
+      _healthInterval(other._healthInterval),
+      _healthUri(other._healthUri),
+      _healthFails(other._healthFails),
+      _healthPasses(other._healthPasses) {}
+
+UpstreamConfig& UpstreamConfig::operator=(const UpstreamConfig& other) {
+    if (this != &other) {
+        _name           = other._name;
+        _servers        = other._servers;
+        _policySet      = other._policySet;
+        _policy         = other._policy;
+        _hashCookie     = other._hashCookie;
+        _healthCheck    = other._healthCheck;
+        _healthInterval = other._healthInterval;
+        _healthUri      = other._healthUri;
+        _healthFails    = other._healthFails;
+        _healthPasses   = other._healthPasses;
+    }
+    return *this;
+}
+
+UpstreamConfig::UpstreamConfig(const String& name)
+    : _name(name),
+      _servers(),
+      _policySet(false),
+      _policy(UPSTREAM_ROUND_ROBIN),
+      _hashCookie(),
+      _healthCheck(false),
+      _healthInterval(UPSTREAM_HEALTH_INTERVAL),
+      _healthUri("/"),
+      _healthFails(1),
+      _healthPasses(1) {}
+
+UpstreamConfig::~UpstreamConfig() {}
+
+// -----------------------------------------------------------------------------
+// Setters
+// -----------------------------------------------------------------------------
+bool UpstreamConfig::setServer(const VectorString& values) {
+    if (values.empty())
+        return Logger::error("server in upstream " + _name + " takes an address");
+    Server server;
+    String authority = values[0];
+    size_t v6End     = authority.find(']');
+    if (authority.find(COLON, v6End == String::npos ? 0 : v6End) == String::npos)
+        authority += ":80";
+    String host, port;
+    if (!splitHostPort(authority, host, port))
+        return Logger::error("invalid upstream server address: " + values[0]);
+    server.address = authority;
+    for (size_t i = 1; i < values.size(); ++i) {
+        if (!setServerOption(server, values[i]))
+            return false;
+    }
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        if (_servers[i].address == server.address)
+            return Logger::error("duplicate server " + server.address + " in upstream " + _name);
+    }
+    _servers.push_back(server);
+    return true;
+}
+
+bool UpstreamConfig::setServerOption(Server& server, const String& option) {
+    String name, value;
+    if (!splitByChar(option, name, value, EQUALS))
+        return Logger::error("invalid upstream server option: " + option);
+    if (name == "max_fails") {
+        if (!stringToType<int>(value, server.maxFails) || server.maxFails < 0)
+            return Logger::error("invalid upstream server max_fails: " + value);
+    } else if (name == "fail_timeout") {
+        if (!stringToType<int>(value, server.failTimeout) || server.failTimeout < 1)
+            return Logger::error("invalid upstream server fail_timeout: " + value);
+    } else {
+        return Logger::error("unknown upstream server option: " + name);
+    }
+    return true;
+}
+
+bool UpstreamConfig::setLeastConn(const VectorString& values) {
+    if (!values.empty())
+        return Logger::error("least_conn takes no value");
+    if (_policySet)
+        return Logger::error("duplicate balancing method in upstream " + _name);
+    _policy    = UPSTREAM_LEAST_CONN;
+    _policySet = true;
+    return true;
+}
+
+// hash $request_uri;       requests for one URI go to the same server
+// hash $cookie_<name>;     requests carrying the same cookie value do
+bool UpstreamConfig::setHash(const VectorString& values) {
+    if (_policySet)
+        return Logger::error("duplicate balancing method in upstream " + _name);
+    if (!requireSingleValue(values, "hash"))
+        return false;
+    if (values[0] == "$request_uri") {
+        _policy = UPSTREAM_HASH_URI;
+    } else if (values[0].compare(0, 8, "$cookie_") == 0 && values[0].size() > 8) {
+        _policy     = UPSTREAM_HASH_COOKIE;
+        _hashCookie = values[0].substr(8);
+    } else {
+        return Logger::error("invalid hash key (expected $request_uri or $cookie_<name>): " + values[0]);
+    }
+    _policySet = true;
+    return true;
+}
+
+bool UpstreamConfig::setHealthCheck(const VectorString& values) {
+    if (_healthCheck)
+        return Logger::error("duplicate health_check in upstream " + _name);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!setHealthOption(values[i]))
+            return false;
+    }
+    _healthCheck = true;
+    return true;
+}
+
+bool UpstreamConfig::setHealthOption(const String& option) {
+    String name, value;
+    if (!splitByChar(option, name, value, EQUALS))
+        return Logger::error("invalid health_check option: " + option);
+    if (name == "interval") {
+        if (!stringToType<int>(value, _healthInterval) || _healthInterval < 1)
+            return Logger::error("invalid health_check interval: " + value);
+    } else if (name == "uri") {
+        if (value.empty() || value[0] != SLASH)
+            return Logger::error("invalid health_check uri: " + value);
+        _healthUri = value;
+    } else if (name == "fails") {
+        if (!stringToType<int>(value, _healthFails) || _healthFails < 1)
+            return Logger::error("invalid health_check fails: " + value);
+    } else if (name == "passes") {
+        if (!stringToType<int>(value, _healthPasses) || _healthPasses < 1)
+            return Logger::error("invalid health_check passes: " + value);
+    } else {
+        return Logger::error("unknown health_check option: " + name);
+    }
+    return true;
+}
+
+bool UpstreamConfig::validate() const {
+    if (_servers.empty())
+        return Logger::error("upstream " + _name + " has no servers");
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Getters
+// -----------------------------------------------------------------------------
+const String& UpstreamConfig::getName() const {
+    return _name;
+}
+const UpstreamConfig::VectorServer& UpstreamConfig::getServers() const {
+    return _servers;
+}
+UpstreamPolicy UpstreamConfig::getPolicy() const {
+    return _policy;
+}
+const String& UpstreamConfig::getHashCookie() const {
+    return _hashCookie;
+}
+bool UpstreamConfig::hasHealthCheck() const {
+    return _healthCheck;
+}
+int UpstreamConfig::getHealthInterval() const {
+    return _healthInterval;
+}
+const String& UpstreamConfig::getHealthUri() const {
+    return _healthUri;
+}
+int UpstreamConfig::getHealthFails() const {
+    return _healthFails;
+}
+int UpstreamConfig::getHealthPasses() const {
+    return _healthPasses;
+}
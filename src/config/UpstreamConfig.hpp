@@ -0,0 +1,63 @@
+#ifndef UPSTREAM_CONFIG_HPP
+#define UPSTREAM_CONFIG_HPP
+#include <vector>
+#include "../utils/Logger.hpp"
+#include "../utils/Types.hpp"
+#include "../utils/Utils.hpp"
+
+// upstream <name> {
+//     server <host[:port]> [max_fails=N] [fail_timeout=S];
+//     least_conn;                                (default: round-robin)
+//     hash $request_uri;  or  hash $cookie_<name>;
+//     health_check [interval=S] [uri=/path] [fails=N] [passes=N];
+// }
+// A location with proxy_pass http://<name> spreads its requests over the servers.
+class UpstreamConfig {
+   public:
+    struct Server {
+        String address;     // host:port, port 80 when left out
+        int    maxFails;    // max_fails=N: failures that take the server out, 0: never
+        int    failTimeout; // fail_timeout=S: window failures are counted in, and time out
+        Server();
+    };
+    typedef std::vector<Server> VectorServer;
+
+    UpstreamConfig();
+    UpstreamConfig(const UpstreamConfig& other);
+    UpstreamConfig& operator=(const UpstreamConfig& other);
+    UpstreamConfig(const String& name);
+    ~UpstreamConfig();
+
+    bool setServer(const VectorString& values);
+    bool setLeastConn(const VectorString& values);
+    bool setHash(const VectorString& values);
+    bool setHealthCheck(const VectorString& values);
+    bool validate() const;
+
+    const String&       getName() const;
+    const VectorServer& getServers() const;
+    UpstreamPolicy      getPolicy() const;
+    const String&       getHashCookie() const;
+    bool                hasHealthCheck() const;
+    int                 getHealthInterval() const;
+    const String&       getHealthUri() const;
+    int                 getHealthFails() const;
+    int                 getHealthPasses() const;
+
+   private:
+    String         _name;
+    VectorServer   _servers;
+    bool           _policySet;      // tracks if least_conn or hash was used
+    UpstreamPolicy _policy;
+    String         _hashCookie;     // UPSTREAM_HASH_COOKIE: cookie the key is read from
+    bool           _healthCheck;    // tracks if health_check was used
+    int            _healthInterval; // interval=S: seconds between probes
+    String         _healthUri;      // uri=/path: requested with GET, 2xx/3xx is healthy
+    int            _healthFails;    // fails=N: failed probes in a row before a server is taken out
+    int            _healthPasses;   // passes=N: passed probes in a row before it is put back
+
+    bool setServerOption(Server& server, const String& option);
+    bool setHealthOption(const String& option);
+};
+
+#endif
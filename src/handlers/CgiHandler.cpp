@@ -1,4 +1,6 @@
 #include "CgiHandler.hpp"
+#include <fcntl.h>
+#include <spawn.h>
 #include <unistd.h>
 #include <cstdlib>
 #include <sstream>
@@ -35,96 +37,86 @@ bool CgiHandler::handle(const RouteResult& resultRouter, HttpResponse& response,
     if (extension.empty())
         return Logger::error("Failed to parse CGI extension");
 
-    String interpreter = loc->getCgiInterpreter(extension);
-    int    parentToChild[2];
-    int    childToParent[2];
-    if (pipe(parentToChild) == -1)
+    // argv and env are built here: the spawned child only applies the file
+    // actions and calls execve
+    String       interpreter = loc->getCgiInterpreter(extension);
+    String       scriptDir   = extractDirectoryFromPath(scriptPath);
+    String       fileName    = scriptPath.substr(scriptDir.size());
+    VectorString argv;
+    argv.push_back(interpreter);
+    argv.push_back(fileName.substr(1));
+    VectorString env = buildEnv(resultRouter);
+
+    // close-on-exec: the dup2 file actions give the child its own copies on
+    // stdin/stdout, and no other CGI inherits these pipes
+    int parentToChild[2];
+    int childToParent[2];
+    if (pipe2(parentToChild, O_CLOEXEC) == -1)
         return Logger::error("CGI pipe parent->child failed");
-    if (pipe(childToParent) == -1) {
+    if (pipe2(childToParent, O_CLOEXEC) == -1) {
         close(parentToChild[0]);
         close(parentToChild[1]);
         return Logger::error("CGI pipe child->parent failed");
     }
 
-    pid_t pid = fork();
+    pid_t pid = spawn(argv, env, parentToChild[0], childToParent[1], scriptDir, openFds);
+    close(parentToChild[0]);
+    close(childToParent[1]);
     if (pid < 0) {
-        close(parentToChild[0]);
         close(parentToChild[1]);
         close(childToParent[0]);
-        close(childToParent[1]);
-        return Logger::error("CGI fork failed");
+        return Logger::error("CGI spawn failed: " + interpreter);
     }
-
-    String scriptDir = extractDirectoryFromPath(scriptPath);
-
-    if (pid == 0) {
-        if (close(parentToChild[1]) == -1) {
-            perror("CGI close parentToChild[1] failed");
-            _exit(1);
-        }
-        if (close(childToParent[0]) == -1) {
-            perror("CGI close childToParent[0] failed");
-            _exit(1);
-        }
-        if (dup2(parentToChild[0], STDIN_FILENO) == -1) {
-            perror("CGI dup2 parentToChild[0] failed");
-            _exit(1);
-        }
-        if (dup2(childToParent[1], STDOUT_FILENO) == -1) {
-            perror("CGI dup2 childToParent[1] failed");
-            _exit(1);
-        }
-        if (close(parentToChild[0]) == -1) {
-            perror("CGI close parentToChild[0] failed");
-            _exit(1);
-        }
-        if (close(childToParent[1]) == -1) {
-            perror("CGI close childToParent[1] failed");
-            _exit(1);
-        }
-        for (size_t i = 0; i < openFds.size(); i++) {
-            if (close(openFds[i]) == -1) {
-                perror("CGI close openFds failed");
-                _exit(1);
-            }
-        }
-
-        String fileName = scriptPath.substr(scriptDir.size());
-        if (!scriptDir.empty()) {
-            if (chdir(scriptDir.c_str()) != 0) {
-                perror("CGI chdir failed");
-                _exit(1);
-            }
-        }
-
-        VectorString       envStrings = buildEnv(resultRouter);
-        VectorString       envStorage(envStrings.begin(), envStrings.end());
-        std::vector<char*> envp;
-        for (size_t i = 0; i < envStorage.size(); i++)
-            envp.push_back(const_cast<char*>(envStorage[i].c_str()));
-        envp.push_back(NULL);
-        VectorString argvStorage;
-        argvStorage.push_back(interpreter);
-        argvStorage.push_back(fileName.substr(1));
-        std::vector<char*> argv;
-        for (size_t i = 0; i < argvStorage.size(); i++)
-            argv.push_back(const_cast<char*>(argvStorage[i].c_str()));
-        argv.push_back(NULL);
-
-        execve(argv[0], &argv[0], &envp[0]);
-        _exit(1);
-    }
-
-    close(parentToChild[0]);
-    close(childToParent[1]);
     setNonBlocking(parentToChild[1]);
     setNonBlocking(childToParent[0]);
     _cgi->init(pid, parentToChild[1], childToParent[0]);
     return true;
 }
+
+// glibc implements posix_spawn with clone(CLONE_VM | CLONE_VFORK): the child
+// runs on the parent's memory until execve instead of copying its page tables
+// as fork() does, so launching a CGI costs the same whatever the server's RSS.
+// Returns -1 when the child could not be set up or execve failed.
+pid_t CgiHandler::spawn(const VectorString& argv, const VectorString& env, int stdinFd, int stdoutFd, const String& workDir,
+                        const VectorInt& closeFds) {
+    std::vector<char*> argvPtrs;
+    for (size_t i = 0; i < argv.size(); i++)
+        argvPtrs.push_back(const_cast<char*>(argv[i].c_str()));
+    argvPtrs.push_back(NULL);
+    std::vector<char*> envPtrs;
+    for (size_t i = 0; i < env.size(); i++)
+        envPtrs.push_back(const_cast<char*>(env[i].c_str()));
+    envPtrs.push_back(NULL);
+
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0)
+        return -1;
+    bool ok = posix_spawn_file_actions_adddup2(&actions, stdinFd, STDIN_FILENO) == 0 &&
+              posix_spawn_file_actions_adddup2(&actions, stdoutFd, STDOUT_FILENO) == 0;
+    for (size_t i = 0; ok && i < closeFds.size(); i++)
+        ok = posix_spawn_file_actions_addclose(&actions, closeFds[i]) == 0;
+    if (ok && !workDir.empty())
+        ok = posix_spawn_file_actions_addchdir_np(&actions, workDir.c_str()) == 0;
+
+    pid_t pid = -1;
+    if (ok && posix_spawn(&pid, argvPtrs[0], &actions, NULL, &argvPtrs[0], &envPtrs[0]) != 0)
+        pid = -1;
+    posix_spawn_file_actions_destroy(&actions);
+    return pid;
+}
 // ─── Static helpers ──────────────────────────────────────────────────────────
 
 bool CgiHandler::parseOutput(const String& raw, HttpResponse& response) {
+    size_t bodyStart;
+    if (!parseHeaders(raw, response, bodyStart))
+        return false;
+    response.setBody(raw.substr(bodyStart));
+    return true;
+}
+
+// Parses the header block at the start of raw into response; bodyStart is set
+// past the blank line. Returns false while the block is still incomplete.
+bool CgiHandler::parseHeaders(const String& raw, HttpResponse& response, size_t& bodyStart) {
     size_t headerEnd    = raw.find("\r\n\r\n");
     size_t headerEndLen = 4;
     if (headerEnd == String::npos) {
@@ -135,7 +127,6 @@ bool CgiHandler::parseOutput(const String& raw, HttpResponse& response) {
         return false;
 
     String            headerPart = raw.substr(0, headerEnd);
-    String            bodyPart   = raw.substr(headerEnd + headerEndLen);
     std::stringstream ss(headerPart);
     String            line;
     bool              statusSet = false;
@@ -165,10 +156,10 @@ bool CgiHandler::parseOutput(const String& raw, HttpResponse& response) {
     if (!statusSet)
         response.setStatus(HTTP_OK, "OK");
     response.addHeader(HEADER_SERVER, "Webserv/1.0");
-    response.setBody(bodyPart);
+    bodyStart = headerEnd + headerEndLen;
     return true;
 }
-VectorString CgiHandler::buildEnv(const RouteResult& resultRouter) const {
+VectorString CgiHandler::buildEnv(const RouteResult& resultRouter) {
     VectorString env;
 
     const HttpRequest&    req = resultRouter.getRequest();
@@ -211,10 +202,10 @@ VectorString CgiHandler::buildEnv(const RouteResult& resultRouter) const {
     env.push_back("REMOTE_HOST=" + req.getHost());
 
     // --- HTTP headers ---
-    const MapString& headers = req.getHeaders();
-    for (MapString::const_iterator it = headers.begin(); it != headers.end(); ++it) {
-        String key = it->first;
-        String val = it->second;
+    const ArenaMapString& headers = req.getHeaders();
+    for (ArenaMapString::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+        String key(it->first.begin(), it->first.end());
+        String val(it->second.begin(), it->second.end());
 
         // sanitize header name
         for (size_t i = 0; i < key.size(); i++) {
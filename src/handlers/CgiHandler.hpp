@@ -18,12 +18,14 @@ class CgiHandler : public IHandler {
     bool handle(const RouteResult& resultRouter, HttpResponse& response) const;
     bool handle(const RouteResult& resultRouter, HttpResponse& response, const VectorInt& openFds) const;
 
-    static bool parseOutput(const String& raw, HttpResponse& response);
+    static bool         parseOutput(const String& raw, HttpResponse& response);
+    static bool         parseHeaders(const String& raw, HttpResponse& response, size_t& bodyStart);
+    static VectorString buildEnv(const RouteResult& resultRouter);
+    static pid_t        spawn(const VectorString& argv, const VectorString& env, int stdinFd, int stdoutFd, const String& workDir,
+                              const VectorInt& closeFds = VectorInt());
 
    private:
     CgiProcess* _cgi;
-
-    VectorString       buildEnv(const RouteResult& resultRouter) const;
 };
 
 #endif
@@ -1,7 +1,26 @@
 #include "CgiProcess.hpp"
 #include "../utils/Utils.hpp"
 
-CgiProcess::CgiProcess() : _pid(-1), _writeFd(-1), _readFd(-1), _writeOffset(0), _writeDone(true), _startTime(0), _active(false) {}
+CgiProcess::CgiProcess()
+    : _pid(-1),
+      _writeFd(-1),
+      _readFd(-1),
+      _writeOffset(0),
+      _writeDone(true),
+      _startTime(0),
+      _active(false),
+      _worker(false),
+      _responseDone(false),
+      _headersSent(false),
+      _chunked(false),
+      _readPaused(false),
+      _pipeFull(false),
+      _spliceRetry(false),
+      _spliceOff(false),
+      _outputDone(false),
+      _exited(false),
+      _exitStatus(0),
+      _cacheValid(0) {}
 
 CgiProcess::CgiProcess(const CgiProcess& other)
     : _pid(other._pid),
@@ -12,19 +31,49 @@ CgiProcess::CgiProcess(const CgiProcess& other)
       _writeDone(other._writeDone),
       _output(other._output),
       _startTime(other._startTime),
-      _active(other._active) {}
+      _active(other._active),
+      _worker(other._worker),
+      _frameInput(other._frameInput),
+      _responseDone(other._responseDone),
+      _headersSent(other._headersSent),
+      _chunked(other._chunked),
+      _readPaused(other._readPaused),
+      _pipeFull(other._pipeFull),
+      _spliceRetry(other._spliceRetry),
+      _spliceOff(other._spliceOff),
+      _outputDone(other._outputDone),
+      _exited(other._exited),
+      _exitStatus(other._exitStatus),
+      _cacheKey(other._cacheKey),
+      _cacheValid(other._cacheValid),
+      _cacheOutput(other._cacheOutput) {}
 
 CgiProcess& CgiProcess::operator=(const CgiProcess& other) {
     if (this != &other) {
-        _pid         = other._pid;
-        _writeFd     = other._writeFd;
-        _readFd      = other._readFd;
-        _writeBuffer = other._writeBuffer;
-        _writeOffset = other._writeOffset;
-        _writeDone   = other._writeDone;
-        _output      = other._output;
-        _startTime   = other._startTime;
-        _active      = other._active;
+        _pid          = other._pid;
+        _writeFd      = other._writeFd;
+        _readFd       = other._readFd;
+        _writeBuffer  = other._writeBuffer;
+        _writeOffset  = other._writeOffset;
+        _writeDone    = other._writeDone;
+        _output       = other._output;
+        _startTime    = other._startTime;
+        _active       = other._active;
+        _worker       = other._worker;
+        _frameInput   = other._frameInput;
+        _responseDone = other._responseDone;
+        _headersSent  = other._headersSent;
+        _chunked      = other._chunked;
+        _readPaused   = other._readPaused;
+        _pipeFull     = other._pipeFull;
+        _spliceRetry  = other._spliceRetry;
+        _spliceOff    = other._spliceOff;
+        _outputDone   = other._outputDone;
+        _exited       = other._exited;
+        _exitStatus   = other._exitStatus;
+        _cacheKey     = other._cacheKey;
+        _cacheValid   = other._cacheValid;
+        _cacheOutput  = other._cacheOutput;
     }
     return *this;
 }
@@ -41,10 +90,47 @@ void CgiProcess::init(pid_t pid, int writeFd, int readFd) {
     _output.clear();
     _startTime = getCurrentTime();
     _active    = true;
+    _worker    = false;
+    _frameInput.clear();
+    _responseDone = false;
+    _headersSent  = false;
+    _chunked      = false;
+    _readPaused   = false;
+    _pipeFull     = false;
+    _spliceRetry  = false;
+    _spliceOff    = false;
+    _outputDone   = false;
+    _exited       = false;
+    _exitStatus   = 0;
+    _cacheKey.clear();
+    _cacheValid = 0;
+    _cacheOutput.clear();
+}
+
+// Worker protocol: every message is a "<length>\n<bytes>" frame. A request is
+// one frame of NUL-separated NAME=value pairs, the body frames and an empty
+// frame; the response is the CGI output as frames ending with an empty frame.
+void CgiProcess::initWorker(pid_t pid, int writeFd, int readFd, const VectorString& env) {
+    init(pid, writeFd, readFd);
+    _worker = true;
+    String block;
+    for (size_t i = 0; i < env.size(); ++i) {
+        block += env[i];
+        block += '\0';
+    }
+    appendFrame(block.data(), block.size());
+}
+
+void CgiProcess::appendFrame(const char* data, size_t len) {
+    _writeBuffer += typeToString<size_t>(len) + "\n";
+    _writeBuffer.append(data, len);
 }
 
 void CgiProcess::appendBuffer(const String& data) {
-    _writeBuffer.append(data);
+    if (!_worker)
+        _writeBuffer.append(data);
+    else if (!data.empty())
+        appendFrame(data.data(), data.size());
 }
 
 void CgiProcess::reset() {
@@ -57,11 +143,32 @@ void CgiProcess::reset() {
     _output.clear();
     _startTime = 0;
     _active    = false;
+    _worker    = false;
+    _frameInput.clear();
+    _responseDone = false;
+    _headersSent  = false;
+    _chunked      = false;
+    _readPaused   = false;
+    _pipeFull     = false;
+    _spliceRetry  = false;
+    _spliceOff    = false;
+    _outputDone   = false;
+    _exited       = false;
+    _exitStatus   = 0;
+    _cacheKey.clear();
+    _cacheValid = 0;
+    _cacheOutput.clear();
 }
 
 bool CgiProcess::isActive() const {
     return _active;
 }
+bool CgiProcess::isWorker() const {
+    return _worker;
+}
+bool CgiProcess::isResponseDone() const {
+    return _responseDone;
+}
 pid_t CgiProcess::getPid() const {
     return _pid;
 }
@@ -78,6 +185,40 @@ const String& CgiProcess::getOutput() const {
     return _output;
 }
 
+// Output past CGI_CACHE_ENTRY_MAX is only streamed, and not kept
+String CgiProcess::takeOutput() {
+    String data;
+    data.swap(_output);
+    if (isCaching() && _cacheOutput.size() + data.size() > CGI_CACHE_ENTRY_MAX) {
+        _cacheKey.clear();
+        _cacheOutput.clear();
+    }
+    if (isCaching())
+        _cacheOutput += data;
+    return data;
+}
+
+bool CgiProcess::isHeadersSent() const {
+    return _headersSent;
+}
+bool CgiProcess::isChunked() const {
+    return _chunked;
+}
+
+// The header block went to the client: from here on _output only holds body
+// bytes waiting to be forwarded.
+void CgiProcess::startStream(bool chunked) {
+    _headersSent = true;
+    _chunked     = chunked;
+}
+
+bool CgiProcess::isReadPaused() const {
+    return _readPaused;
+}
+void CgiProcess::setReadPaused(bool paused) {
+    _readPaused = paused;
+}
+
 void CgiProcess::setWriteFd(int fd) {
     _writeFd = fd;
 }
@@ -89,7 +230,68 @@ bool CgiProcess::isWriteDone() const {
     return _writeDone && (_writeBuffer.empty() || _writeOffset >= _writeBuffer.size());
 }
 
+// No more body will be appended, though some may still wait in the buffer
+bool CgiProcess::isBodyComplete() const {
+    return _writeDone;
+}
+
+size_t CgiProcess::getPendingWrite() const {
+    return _writeBuffer.size() - _writeOffset;
+}
+
+// Body bytes stop being taken from the client while this many wait for the pipe
+bool CgiProcess::isWriteBufferFull() const {
+    return !_writeDone && (_pipeFull || getPendingWrite() >= CGI_STREAM_BUFFER);
+}
+
+void CgiProcess::setPipeFull(bool full) {
+    _pipeFull = full;
+}
+
+// A worker's stdin and stdout are framed, so only a forked CGI's body can
+// bypass userspace
+bool CgiProcess::canSplice() const {
+    return !_worker && !_spliceOff;
+}
+
+// Moves up to len request body bytes from the socket into stdin. A wakeup
+// whose data an earlier splice in the same poll round already took finds
+// the socket empty, which says nothing about the pipe.
+ssize_t CgiProcess::spliceBody(int socketFd, size_t len) {
+    char probe;
+    if (recv(socketFd, &probe, 1, MSG_PEEK | MSG_DONTWAIT) < 0) {
+        _pipeFull = false;
+        return -1;
+    }
+    ssize_t n = spliceData(socketFd, _writeFd, std::min(len, (size_t)CGI_STREAM_BUFFER));
+    _pipeFull = (n < 0 && !_spliceOff);
+    return n;
+}
+
+// Moves identity-coded output from stdout to the socket; 0 is EOF
+ssize_t CgiProcess::spliceOutput(int socketFd) {
+    return spliceData(_readFd, socketFd, CGI_STREAM_BUFFER);
+}
+
+// Each side is only spliced once poll reported it ready, so a failure means the
+// other side is full. Failing again after that side became ready means splice
+// is not supported for these fds, and the copy falls back to read/write.
+ssize_t CgiProcess::spliceData(int in, int out, size_t len) {
+    ssize_t n = splice(in, NULL, out, NULL, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n > 0) {
+        _startTime   = getCurrentTime();
+        _spliceRetry = false;
+    } else if (n < 0) {
+        _spliceOff   = _spliceRetry;
+        _spliceRetry = true;
+    }
+    return n;
+}
+
 void CgiProcess::setWriteDone(bool done) {
+    // the empty frame tells a worker the body is complete, as EOF does for a forked CGI
+    if (_worker && done && !_writeDone)
+        appendFrame("", 0);
     _writeDone = done;
 }
 
@@ -111,8 +313,10 @@ bool CgiProcess::writeBody(int fd) {
     if (madeProgress)
         _startTime = getCurrentTime();
 
-    if (_writeOffset >= _writeBuffer.size() && !_writeBuffer.empty()) {
-        _writeBuffer.clear();
+    // The body keeps arriving while it is written, so the written part is
+    // dropped rather than letting the buffer grow with the whole upload
+    if (_writeOffset > 0) {
+        _writeBuffer.erase(0, _writeOffset);
         _writeOffset = 0;
     }
 
@@ -126,14 +330,20 @@ void CgiProcess::appendOutput(const char* data, size_t len) {
 bool CgiProcess::handleRead() {
     char    buf[BUFFER_SIZE];
     bool    gotData = false;
-    ssize_t n;
-    while ((n = read(_readFd, buf, sizeof(buf))) > 0) {
-        _output.append(buf, n);
+    ssize_t n       = -1;
+    // At most CGI_STREAM_BUFFER pending bytes: the rest waits in the pipe
+    // until the output has been forwarded to the client
+    while (_output.size() + _frameInput.size() < CGI_STREAM_BUFFER && (n = read(_readFd, buf, sizeof(buf))) > 0) {
+        (_worker ? _frameInput : _output).append(buf, n);
         gotData = true;
     }
     if (gotData)
         _startTime = getCurrentTime();
 
+    // A worker stays alive after its response: the empty frame marks the end
+    if (_worker && parseFrames())
+        return false;
+
     // Subject rule: never check errno.
     // If read returns 0, it means EOF. Return false to indicate we are done.
     if (n == 0)
@@ -141,38 +351,53 @@ bool CgiProcess::handleRead() {
     return true; // Keep monitoring if we got data or if read returned -1 (non-blocking)
 }
 
-bool CgiProcess::finish() {
-    if (_pid <= 0) 
-        return false;
-    if (_writeFd != INVALID_FD) {
-        close(_writeFd);
-        _writeFd = INVALID_FD;
-    }
-    if (_readFd != INVALID_FD) {
-        close(_readFd);
-        _readFd = INVALID_FD;
-    }
-    int   status = 0;
-    pid_t ret    = waitpid(_pid, &status, WNOHANG);
-    if (ret == 0) {
-        kill(_pid, SIGTERM);
-        ret = waitpid(_pid, &status, WNOHANG);
-        if (ret == 0) {
-            kill(_pid, SIGKILL);
-            waitpid(_pid, &status, WNOHANG);
-        }
+bool CgiProcess::parseFrames() {
+    size_t pos = 0;
+    while (!_responseDone) {
+        size_t eol = _frameInput.find('\n', pos);
+        if (eol == String::npos)
+            break;
+        size_t len = std::strtoul(_frameInput.c_str() + pos, NULL, 10);
+        if (_frameInput.size() - eol - 1 < len)
+            break;
+        _output.append(_frameInput, eol + 1, len);
+        _responseDone = (len == 0);
+        pos           = eol + 1 + len;
     }
-    _active = false;
-    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    _frameInput.erase(0, pos);
+    return _responseDone;
+}
+
+bool CgiProcess::isOutputDone() const {
+    return _outputDone;
+}
+
+// Output reached EOF: the response now waits for the exit status, for at
+// most CGI_EXIT_WAIT seconds from here.
+void CgiProcess::setOutputDone() {
+    _outputDone = true;
+    _startTime  = getCurrentTime();
+}
+
+bool CgiProcess::hasExited() const {
+    return _exited;
+}
+
+void CgiProcess::setExitStatus(int status) {
+    _exited     = true;
+    _exitStatus = status;
+}
+
+// Killed by a signal: whatever output it left may be cut short
+bool CgiProcess::isCrashed() const {
+    return _exited && WIFSIGNALED(_exitStatus);
 }
 
 void CgiProcess::cleanup() {
     if (!_active)
         return;
-    if (_pid > 0) {
-        kill(_pid, SIGKILL);
-        waitpid(_pid, NULL, WNOHANG);
-    }
+    // No signal here: closing the pipes lets a script that is done exit on its
+    // own, and the ChildReaper kills one that does not (see release())
     if (_writeFd != INVALID_FD) {
         close(_writeFd);
         _writeFd = INVALID_FD;
@@ -187,3 +412,26 @@ void CgiProcess::cleanup() {
 void CgiProcess::resetStartTime() {
     _startTime = getCurrentTime();
 }
+
+void CgiProcess::startCaching(const String& key, int valid) {
+    _cacheKey   = key;
+    _cacheValid = valid;
+}
+
+bool CgiProcess::isCaching() const {
+    return !_cacheKey.empty();
+}
+
+const String& CgiProcess::getCacheKey() const {
+    return _cacheKey;
+}
+
+int CgiProcess::getCacheValid() const {
+    return _cacheValid;
+}
+
+String CgiProcess::takeCacheOutput() {
+    String data;
+    data.swap(_cacheOutput);
+    return data;
+}
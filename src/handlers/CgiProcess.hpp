@@ -1,10 +1,13 @@
 #ifndef CGI_PROCESS_HPP
 #define CGI_PROCESS_HPP
 
+#include <fcntl.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <algorithm>
 #include <ctime>
 #include "../utils/Types.hpp"
 
@@ -19,6 +22,25 @@ class CgiProcess {
     String _output;
     time_t _startTime;
     bool   _active;
+    bool   _worker;       // pipes belong to a pooled cgi_worker process
+    String _frameInput;   // worker: unparsed response frames
+    bool   _responseDone; // worker: terminating frame received
+    bool   _headersSent;  // response head queued, output is now streamed
+    bool   _chunked;      // streamed body uses chunked transfer coding
+    bool   _readPaused;   // read pipe out of the poll set until the client drains
+    bool   _pipeFull;     // a splice into stdin found no room
+    bool   _spliceRetry;  // last splice failed: the next failure means unsupported
+    bool   _spliceOff;    // splice refused these fds, copy through userspace
+    bool   _outputDone;   // EOF on the read pipe, waiting for the exit status
+    bool   _exited;       // reaped, _exitStatus is valid
+    int    _exitStatus;
+    String _cacheKey;     // cgi_cache_valid key, empty: the output is not kept
+    int    _cacheValid;
+    String _cacheOutput;  // output taken so far, header block included
+
+    void    appendFrame(const char* data, size_t len);
+    bool    parseFrames();
+    ssize_t spliceData(int in, int out, size_t len);
 
    public:
     CgiProcess();
@@ -27,25 +49,51 @@ class CgiProcess {
     ~CgiProcess();
 
     void          init(pid_t pid, int writeFd, int readFd);
+    void          initWorker(pid_t pid, int writeFd, int readFd, const VectorString& env);
     void          appendBuffer(const String& data);
     void          reset();
     bool          isActive() const;
+    bool          isWorker() const;
+    bool          isResponseDone() const;
     pid_t         getPid() const;
     int           getWriteFd() const;
     int           getReadFd() const;
     time_t        getStartTime() const;
     const String& getOutput() const;
+    String        takeOutput();
+    bool          isHeadersSent() const;
+    bool          isChunked() const;
+    void          startStream(bool chunked);
+    bool          isReadPaused() const;
+    void          setReadPaused(bool paused);
+
+    void    setWriteFd(int fd);
+    void    setReadFd(int fd);
+    bool    isWriteDone() const;
+    void    setWriteDone(bool done);
+    bool    isBodyComplete() const;
+    size_t  getPendingWrite() const;
+    bool    isWriteBufferFull() const;
+    void    setPipeFull(bool full);
+    bool    canSplice() const;
+    ssize_t spliceBody(int socketFd, size_t len);
+    ssize_t spliceOutput(int socketFd);
+    bool    writeBody(int fd);
+    void    appendOutput(const char* data, size_t len);
+    bool    handleRead();
+    bool    isOutputDone() const;
+    void    setOutputDone();
+    bool    hasExited() const;
+    void    setExitStatus(int status);
+    bool    isCrashed() const;
+    void    cleanup();
+    void    resetStartTime();
 
-    void setWriteFd(int fd);
-    void setReadFd(int fd);
-    bool isWriteDone() const;
-    void setWriteDone(bool done);
-    bool writeBody(int fd);
-    void appendOutput(const char* data, size_t len);
-    bool handleRead();
-    bool finish();
-    void cleanup();
-    void resetStartTime();
+    void          startCaching(const String& key, int valid);
+    bool          isCaching() const;
+    const String& getCacheKey() const;
+    int           getCacheValid() const;
+    String        takeCacheOutput();
 };
 
 #endif
@@ -0,0 +1,24 @@
+#include "FastCgiHandler.hpp"
+
+FastCgiHandler::FastCgiHandler() : _fcgi(NULL) {}
+FastCgiHandler::FastCgiHandler(FastCgiRequest& fcgi) : _fcgi(&fcgi) {}
+FastCgiHandler::FastCgiHandler(const FastCgiHandler& other) : IHandler(), _fcgi(other._fcgi) {}
+FastCgiHandler& FastCgiHandler::operator=(const FastCgiHandler& other) {
+    if (this != &other)
+        _fcgi = other._fcgi;
+    return *this;
+}
+FastCgiHandler::~FastCgiHandler() {}
+
+bool FastCgiHandler::handle(const RouteResult& resultRouter, HttpResponse& response) const {
+    (void)response;
+
+    if (!_fcgi)
+        return false;
+    const LocationConfig* loc = resultRouter.getLocation();
+    if (!loc || !loc->hasFastcgi())
+        return false;
+    // The body is complete at this point: requests are buffered before the upstream sees them
+    _fcgi->encode(loc->getFastcgiPass(), CgiHandler::buildEnv(resultRouter), resultRouter.getRequest().getBody());
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef FASTCGI_HANDLER_HPP
+#define FASTCGI_HANDLER_HPP
+
+#include "CgiHandler.hpp"
+#include "FastCgiRequest.hpp"
+#include "IHandler.hpp"
+
+// Encodes the routed request for fastcgi_pass. The upstream connection is
+// attached afterwards by ServerManager, which owns the keep-alive pool.
+class FastCgiHandler : public IHandler {
+   public:
+    FastCgiHandler();
+    FastCgiHandler(FastCgiRequest& fcgi);
+    FastCgiHandler(const FastCgiHandler& other);
+    FastCgiHandler& operator=(const FastCgiHandler& other);
+    ~FastCgiHandler();
+
+    bool handle(const RouteResult& resultRouter, HttpResponse& response) const;
+
+   private:
+    FastCgiRequest* _fcgi;
+};
+
+#endif
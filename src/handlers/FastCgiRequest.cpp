@@ -0,0 +1,222 @@
+#include "FastCgiRequest.hpp"
+#include <sys/socket.h>
+#include "../utils/Utils.hpp"
+
+FastCgiRequest::FastCgiRequest()
+    : _fd(-1), _reused(false), _connecting(false), _sentOffset(0), _keepConn(false), _startTime(0), _active(false) {}
+
+FastCgiRequest::FastCgiRequest(const FastCgiRequest& other)
+    : _upstream(other._upstream),
+      _fd(other._fd),
+      _reused(other._reused),
+      _connecting(other._connecting),
+      _request(other._request),
+      _sentOffset(other._sentOffset),
+      _input(other._input),
+      _output(other._output),
+      _keepConn(other._keepConn),
+      _startTime(other._startTime),
+      _active(other._active) {}
+
+FastCgiRequest& FastCgiRequest::operator=(const FastCgiRequest& other) {
+    if (this != &other) {
+        _upstream   = other._upstream;
+        _fd         = other._fd;
+        _reused     = other._reused;
+        _connecting = other._connecting;
+        _request    = other._request;
+        _sentOffset = other._sentOffset;
+        _input      = other._input;
+        _output     = other._output;
+        _keepConn   = other._keepConn;
+        _startTime  = other._startTime;
+        _active     = other._active;
+    }
+    return *this;
+}
+
+FastCgiRequest::~FastCgiRequest() {}
+
+// ─── Encoding ────────────────────────────────────────────────────────────────
+
+void FastCgiRequest::appendRecord(FastCgiRecordType type, const char* data, size_t len) {
+    unsigned char padding = static_cast<unsigned char>((8 - (len % 8)) % 8);
+    char          header[FCGI_HEADER_LEN];
+    header[0] = FCGI_VERSION_1;
+    header[1] = static_cast<char>(type);
+    header[2] = static_cast<char>((FCGI_REQUEST_ID >> 8) & 0xFF);
+    header[3] = static_cast<char>(FCGI_REQUEST_ID & 0xFF);
+    header[4] = static_cast<char>((len >> 8) & 0xFF);
+    header[5] = static_cast<char>(len & 0xFF);
+    header[6] = static_cast<char>(padding);
+    header[7] = 0;
+    _request.append(header, FCGI_HEADER_LEN);
+    _request.append(data, len);
+    _request.append(padding, '\0');
+}
+
+// A stream is split into records of at most 64K and closed by an empty record
+void FastCgiRequest::appendStream(FastCgiRecordType type, const String& data) {
+    for (size_t pos = 0; pos < data.size(); pos += FCGI_MAX_CONTENT)
+        appendRecord(type, data.data() + pos, std::min(data.size() - pos, static_cast<size_t>(FCGI_MAX_CONTENT)));
+    appendRecord(type, "", 0);
+}
+
+// Name/value lengths: one byte below 128, otherwise four bytes with the high bit set
+void FastCgiRequest::appendLength(String& out, size_t len) {
+    if (len < 128) {
+        out += static_cast<char>(len);
+        return;
+    }
+    out += static_cast<char>(((len >> 24) & 0x7F) | 0x80);
+    out += static_cast<char>((len >> 16) & 0xFF);
+    out += static_cast<char>((len >> 8) & 0xFF);
+    out += static_cast<char>(len & 0xFF);
+}
+
+// env holds the same NAME=value strings a forked CGI would get
+void FastCgiRequest::encode(const String& upstream, const VectorString& env, const String& body) {
+    reset();
+    _upstream = upstream;
+
+    const char begin[8] = {0, FCGI_RESPONDER, FCGI_KEEP_CONN, 0, 0, 0, 0, 0};
+    appendRecord(FCGI_BEGIN_REQUEST, begin, sizeof(begin));
+
+    String params;
+    for (size_t i = 0; i < env.size(); ++i) {
+        size_t eq = env[i].find(EQUALS);
+        if (eq == String::npos)
+            continue;
+        appendLength(params, eq);
+        appendLength(params, env[i].size() - eq - 1);
+        params.append(env[i], 0, eq);
+        params.append(env[i], eq + 1, String::npos);
+    }
+    appendStream(FCGI_PARAMS, params);
+    appendStream(FCGI_STDIN, body);
+
+    _startTime = getCurrentTime();
+    _active    = true;
+}
+
+// ─── Connection ──────────────────────────────────────────────────────────────
+
+void FastCgiRequest::attach(int fd, bool reused, bool connecting) {
+    _fd         = fd;
+    _reused     = reused;
+    _connecting = connecting;
+    _sentOffset = 0;
+    _input.clear();
+    _output.clear();
+    _keepConn = false;
+}
+
+// The socket now belongs to the pool (or has been closed by the caller)
+void FastCgiRequest::detach() {
+    _fd         = -1;
+    _connecting = false;
+}
+
+void FastCgiRequest::reset() {
+    _upstream.clear();
+    _fd         = -1;
+    _reused     = false;
+    _connecting = false;
+    _request.clear();
+    _sentOffset = 0;
+    _input.clear();
+    _output.clear();
+    _keepConn  = false;
+    _startTime = 0;
+    _active    = false;
+}
+
+// ─── I/O ─────────────────────────────────────────────────────────────────────
+
+FastCgiStatus FastCgiRequest::handleWrite() {
+    if (_connecting) {
+        // POLLOUT on a connecting socket: SO_ERROR tells whether connect() succeeded
+        int       err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0)
+            return FCGI_FAILED;
+        _connecting = false;
+    }
+    bool madeProgress = false;
+    while (_sentOffset < _request.size()) {
+        ssize_t w = write(_fd, _request.data() + _sentOffset, _request.size() - _sentOffset);
+        if (w <= 0)
+            break;
+        _sentOffset += w;
+        madeProgress = true;
+    }
+    if (madeProgress)
+        _startTime = getCurrentTime();
+    return _sentOffset >= _request.size() ? FCGI_COMPLETE : FCGI_PENDING;
+}
+
+FastCgiStatus FastCgiRequest::handleRead() {
+    char    buf[BUFFER_SIZE];
+    ssize_t n;
+    while ((n = read(_fd, buf, sizeof(buf))) > 0)
+        _input.append(buf, n);
+    if (!_input.empty())
+        _startTime = getCurrentTime();
+
+    size_t pos = 0;
+    while (_input.size() - pos >= FCGI_HEADER_LEN) {
+        const unsigned char* h       = reinterpret_cast<const unsigned char*>(_input.data() + pos);
+        size_t               len     = (static_cast<size_t>(h[4]) << 8) | h[5];
+        size_t               total   = FCGI_HEADER_LEN + len + h[6];
+        const char*          content = _input.data() + pos + FCGI_HEADER_LEN;
+        if (_input.size() - pos < total)
+            break;
+        if (h[1] == FCGI_STDOUT) {
+            _output.append(content, len);
+        } else if (h[1] == FCGI_STDERR && len > 0) {
+            Logger::error("FastCGI stderr: " + trimSpaces(String(content, len)));
+        } else if (h[1] == FCGI_END_REQUEST && len >= 8) {
+            // protocolStatus 0 is FCGI_REQUEST_COMPLETE; anything else and the app may have dropped the connection
+            _keepConn = (content[4] == 0);
+            _input.clear();
+            return FCGI_COMPLETE;
+        }
+        pos += total;
+    }
+    _input.erase(0, pos);
+
+    // Subject rule: never check errno. EOF before END_REQUEST is a failed request.
+    if (n == 0)
+        return FCGI_FAILED;
+    return FCGI_PENDING;
+}
+
+// ─── Accessors ───────────────────────────────────────────────────────────────
+
+bool FastCgiRequest::isActive() const {
+    return _active;
+}
+bool FastCgiRequest::isReused() const {
+    return _reused;
+}
+bool FastCgiRequest::isConnecting() const {
+    return _connecting;
+}
+bool FastCgiRequest::hasResponseData() const {
+    return !_input.empty() || !_output.empty();
+}
+bool FastCgiRequest::canKeepConnection() const {
+    return _keepConn;
+}
+int FastCgiRequest::getFd() const {
+    return _fd;
+}
+const String& FastCgiRequest::getUpstream() const {
+    return _upstream;
+}
+const String& FastCgiRequest::getOutput() const {
+    return _output;
+}
+time_t FastCgiRequest::getStartTime() const {
+    return _startTime;
+}
@@ -0,0 +1,56 @@
+#ifndef FASTCGI_REQUEST_HPP
+#define FASTCGI_REQUEST_HPP
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <ctime>
+#include "../utils/Enums.hpp"
+#include "../utils/Types.hpp"
+
+// One request in flight on a pooled FastCGI upstream connection. The encoded
+// request is kept until the response is complete, so it can be replayed on a
+// fresh connection when a reused keep-alive one turns out to be closed.
+class FastCgiRequest {
+   private:
+    String _upstream;    // fastcgi_pass address, the pool key
+    int    _fd;          // upstream socket, -1 until attached
+    bool   _reused;      // connection came from the keep-alive pool
+    bool   _connecting;  // non-blocking connect still in progress
+    String _request;     // BEGIN_REQUEST + PARAMS + STDIN records
+    size_t _sentOffset;  // bytes of _request already written
+    String _input;       // unparsed bytes read from upstream
+    String _output;      // concatenated FCGI_STDOUT content
+    bool   _keepConn;    // END_REQUEST said REQUEST_COMPLETE
+    time_t _startTime;
+    bool   _active;
+
+    void appendRecord(FastCgiRecordType type, const char* data, size_t len);
+    void appendStream(FastCgiRecordType type, const String& data);
+    static void appendLength(String& out, size_t len);
+
+   public:
+    FastCgiRequest();
+    FastCgiRequest(const FastCgiRequest& other);
+    FastCgiRequest& operator=(const FastCgiRequest& other);
+    ~FastCgiRequest();
+
+    void encode(const String& upstream, const VectorString& env, const String& body);
+    void attach(int fd, bool reused, bool connecting);
+    void detach();
+    void reset();
+
+    FastCgiStatus handleWrite();
+    FastCgiStatus handleRead();
+
+    bool          isActive() const;
+    bool          isReused() const;
+    bool          isConnecting() const;
+    bool          hasResponseData() const;
+    bool          canKeepConnection() const;
+    int           getFd() const;
+    const String& getUpstream() const;
+    const String& getOutput() const;
+    time_t        getStartTime() const;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "MultipartUpload.hpp"
+#include <cstdio>
+#include <vector>
+#include "../utils/Utils.hpp"
+
+MultipartUpload::MultipartUpload()
+    : _state(PART_PREAMBLE), _uploadDir(), _delimiter(), _buffer(), _filename(), _tempPath(), _fd(INVALID_FD), _saved(), _active(false) {}
+
+MultipartUpload::MultipartUpload(const MultipartUpload& other)
+    : _state(other._state),
+      _uploadDir(other._uploadDir),
+      _delimiter(other._delimiter),
+      _buffer(other._buffer),
+      _filename(other._filename),
+      _tempPath(other._tempPath),
+      _fd(other._fd),
+      _saved(other._saved),
+      _active(other._active) {}
+
+MultipartUpload& MultipartUpload::operator=(const MultipartUpload& other) {
+    if (this != &other) {
+        _state     = other._state;
+        _uploadDir = other._uploadDir;
+        _delimiter = other._delimiter;
+        _buffer    = other._buffer;
+        _filename  = other._filename;
+        _tempPath  = other._tempPath;
+        _fd        = other._fd;
+        _saved     = other._saved;
+        _active    = other._active;
+    }
+    return *this;
+}
+
+MultipartUpload::~MultipartUpload() {}
+
+// The body is parsed as if it started with a CRLF, so the first boundary
+// matches the same delimiter as the ones between parts
+void MultipartUpload::begin(const String& uploadDir, const String& boundary) {
+    reset();
+    _uploadDir = uploadDir;
+    _delimiter = CRLF "--" + boundary;
+    _buffer    = CRLF;
+    _active    = true;
+}
+
+// Takes the next piece of the body. Everything is consumed: bytes that could
+// still turn out to be a boundary are kept in _buffer until the next call.
+MultipartStatus MultipartUpload::feed(const char* data, size_t len) {
+    _buffer.append(data, len);
+    while (true) {
+        if (_state == PART_DONE) {
+            _buffer.clear(); // epilogue
+            return MULTIPART_COMPLETE;
+        }
+        if (_state == PART_PREAMBLE || _state == PART_DATA) {
+            size_t pos  = _buffer.find(_delimiter);
+            size_t keep = _delimiter.size() - 1;
+            size_t end  = pos;
+            if (pos == String::npos)
+                end = (_buffer.size() > keep) ? _buffer.size() - keep : 0;
+            if (_state == PART_DATA && !writePart(_buffer.data(), end))
+                return MULTIPART_FAILED;
+            if (pos == String::npos) {
+                _buffer.erase(0, end);
+                return MULTIPART_INCOMPLETE;
+            }
+            _buffer.erase(0, pos + _delimiter.size());
+            if (_state == PART_DATA && !closePart())
+                return MULTIPART_FAILED;
+            _state = PART_BOUNDARY;
+        } else if (_state == PART_BOUNDARY) {
+            if (_buffer.size() < 2)
+                return MULTIPART_INCOMPLETE;
+            if (_buffer.compare(0, 2, "--") == 0) {
+                _state = PART_DONE;
+                continue;
+            }
+            size_t eol = _buffer.find(CRLF);
+            if (eol == String::npos)
+                return (_buffer.size() > MAX_HEADER_SIZE) ? MULTIPART_INVALID : MULTIPART_INCOMPLETE;
+            // only transport padding may follow a boundary
+            if (_buffer.find_first_not_of(" \t") < eol)
+                return MULTIPART_INVALID;
+            _buffer.erase(0, eol + 2);
+            _state = PART_HEADERS;
+        } else {
+            if (_buffer.size() < 2)
+                return MULTIPART_INCOMPLETE;
+            size_t end = (_buffer.compare(0, 2, CRLF) == 0) ? 0 : _buffer.find(DOUBLE_CRLF);
+            if (end == String::npos)
+                return (_buffer.size() > MAX_HEADER_SIZE) ? MULTIPART_INVALID : MULTIPART_INCOMPLETE;
+            if (!openPart(_buffer.substr(0, end)))
+                return MULTIPART_FAILED;
+            _buffer.erase(0, (end == 0) ? 2 : end + 4);
+            _state = PART_DATA;
+        }
+    }
+}
+
+// A part is a file when its Content-Disposition names one. The temp file is
+// hidden in upload_dir, so the rename on completion stays on one filesystem.
+bool MultipartUpload::openPart(const String& headers) {
+    String disposition;
+    _filename.clear();
+    if (getHeaderValue(headers, HEADER_CONTENT_DISPOSITION, disposition))
+        _filename = sanitizeFilename(extractFilenameFromHeader(disposition));
+    if (_filename.empty() || _filename == "." || _filename == "..")
+        return true;
+    if (!ensureDirectoryExists(_uploadDir))
+        return Logger::error("Failed to create upload directory: " + _uploadDir);
+
+    String            pattern = joinPaths(_uploadDir, ".upload_XXXXXX");
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    _fd = mkstemp(&path[0]);
+    if (_fd == INVALID_FD)
+        return Logger::error("Failed to create upload file in: " + _uploadDir);
+    fcntl(_fd, F_SETFD, FD_CLOEXEC);
+    _tempPath = &path[0];
+    return true;
+}
+
+bool MultipartUpload::writePart(const char* data, size_t len) {
+    if (_fd == INVALID_FD)
+        return true;
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = write(_fd, data + written, len - written);
+        if (n <= 0)
+            return Logger::error("Failed to write upload file: " + _tempPath);
+        written += n;
+    }
+    return true;
+}
+
+bool MultipartUpload::closePart() {
+    if (_fd == INVALID_FD)
+        return true;
+    close(_fd);
+    _fd           = INVALID_FD;
+    String target = joinPaths(_uploadDir, _filename);
+    if (std::rename(_tempPath.c_str(), target.c_str()) == -1) {
+        unlink(_tempPath.c_str());
+        _tempPath.clear();
+        return Logger::error("Failed to save upload file: " + target);
+    }
+    _tempPath.clear();
+    _saved.push_back(_filename);
+    return true;
+}
+
+// Drops the part being written; files already completed are kept
+void MultipartUpload::abort() {
+    if (_fd != INVALID_FD) {
+        close(_fd);
+        unlink(_tempPath.c_str());
+    }
+    reset();
+}
+
+void MultipartUpload::reset() {
+    _state = PART_PREAMBLE;
+    _uploadDir.clear();
+    _delimiter.clear();
+    _buffer.clear();
+    _filename.clear();
+    _tempPath.clear();
+    _fd = INVALID_FD;
+    _saved.clear();
+    _active = false;
+}
+
+bool MultipartUpload::isActive() const {
+    return _active;
+}
+
+const VectorString& MultipartUpload::getSavedFiles() const {
+    return _saved;
+}
@@ -0,0 +1,45 @@
+#ifndef MULTIPART_UPLOAD_HPP
+#define MULTIPART_UPLOAD_HPP
+
+#include <cstddef>
+#include "../utils/Enums.hpp"
+#include "../utils/Types.hpp"
+
+// Incremental multipart/form-data parser for upload locations. feed() takes
+// the body as it arrives and writes each file part straight to a temp file in
+// upload_dir, renamed to its sanitized filename once the part's closing
+// boundary is seen. Only a possible boundary prefix or an incomplete part
+// header block is held back, so memory does not grow with the upload. Parts
+// without a filename (plain form fields) are dropped. Only feed() touches the
+// disk, so it is what runs on an aio thread.
+class MultipartUpload {
+   private:
+    MultipartState _state;
+    String         _uploadDir;
+    String         _delimiter; // CRLF "--" boundary
+    String         _buffer;    // bytes not yet known to be part data
+    String         _filename;  // sanitized name of the current file part
+    String         _tempPath;
+    int            _fd;        // temp file of the current part, -1 for a form field
+    VectorString   _saved;     // files completed so far
+    bool           _active;
+
+    bool openPart(const String& headers);
+    bool writePart(const char* data, size_t len);
+    bool closePart();
+
+   public:
+    MultipartUpload();
+    MultipartUpload(const MultipartUpload& other);
+    MultipartUpload& operator=(const MultipartUpload& other);
+    ~MultipartUpload();
+
+    void                begin(const String& uploadDir, const String& boundary);
+    MultipartStatus     feed(const char* data, size_t len);
+    void                abort();
+    void                reset();
+    bool                isActive() const;
+    const VectorString& getSavedFiles() const;
+};
+
+#endif
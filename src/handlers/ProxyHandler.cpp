@@ -0,0 +1,31 @@
+#include "ProxyHandler.hpp"
+
+ProxyHandler::ProxyHandler() : _proxy(NULL) {}
+ProxyHandler::ProxyHandler(ProxyRequest& proxy) : _proxy(&proxy) {}
+ProxyHandler::ProxyHandler(const ProxyHandler& other) : IHandler(), _proxy(other._proxy) {}
+ProxyHandler& ProxyHandler::operator=(const ProxyHandler& other) {
+    if (this != &other)
+        _proxy = other._proxy;
+    return *this;
+}
+ProxyHandler::~ProxyHandler() {}
+
+bool ProxyHandler::handle(const RouteResult& resultRouter, HttpResponse& response) const {
+    (void)response;
+
+    if (!_proxy)
+        return false;
+    const LocationConfig* loc = resultRouter.getLocation();
+    if (!loc || !loc->hasProxy())
+        return false;
+    // The target goes out as the client sent it, unless proxy_pass has a URI
+    // to put in place of the location prefix
+    const HttpRequest& req    = resultRouter.getRequest();
+    String             target = req.getTarget();
+    if (!loc->getProxyUri().empty() && target.compare(0, loc->getPath().size(), loc->getPath()) == 0)
+        target = loc->getProxyUri() + target.substr(loc->getPath().size());
+    // An upstream block goes by its name, and the ServerManager picks the server
+    const String& upstream = loc->getProxyUpstream().empty() ? loc->getProxyPass() : loc->getProxyUpstream();
+    _proxy->encode(upstream, target, req, resultRouter.getRemoteAddress());
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef PROXY_HANDLER_HPP
+#define PROXY_HANDLER_HPP
+
+#include "IHandler.hpp"
+#include "ProxyRequest.hpp"
+
+// Encodes the routed request for proxy_pass. The upstream connection is
+// attached afterwards by ServerManager, which owns the keep-alive pool.
+class ProxyHandler : public IHandler {
+   public:
+    ProxyHandler();
+    ProxyHandler(ProxyRequest& proxy);
+    ProxyHandler(const ProxyHandler& other);
+    ProxyHandler& operator=(const ProxyHandler& other);
+    ~ProxyHandler();
+
+    bool handle(const RouteResult& resultRouter, HttpResponse& response) const;
+
+   private:
+    ProxyRequest* _proxy;
+};
+
+#endif
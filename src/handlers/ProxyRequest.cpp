@@ -0,0 +1,486 @@
+#include "ProxyRequest.hpp"
+#include <sys/socket.h>
+#include <algorithm>
+#include "../utils/Utils.hpp"
+
+ProxyRequest::ProxyRequest()
+    : _server(-1),
+      _tries(0),
+      _fd(-1),
+      _reused(false),
+      _connecting(false),
+      _sentOffset(0),
+      _headersDone(false),
+      _framing(PROXY_BODY_NONE),
+      _remaining(0),
+      _headRequest(false),
+      _keepConn(false),
+      _headersSent(false),
+      _chunked(false),
+      _readPaused(false),
+      _cacheStatus(CACHE_MISS),
+      _cacheValid(0),
+      _caching(false),
+      _cacheLock(CACHE_LOCK_NONE),
+      _startTime(0),
+      _active(false) {}
+
+ProxyRequest::ProxyRequest(const ProxyRequest& other)
+    : _upstream(other._upstream),
+      _address(other._address),
+      _server(other._server),
+      _tries(other._tries),
+      _fd(other._fd),
+      _reused(other._reused),
+      _connecting(other._connecting),
+      _request(other._request),
+      _sentOffset(other._sentOffset),
+      _input(other._input),
+      _output(other._output),
+      _response(other._response),
+      _headersDone(other._headersDone),
+      _framing(other._framing),
+      _remaining(other._remaining),
+      _decoder(other._decoder),
+      _headRequest(other._headRequest),
+      _keepConn(other._keepConn),
+      _headersSent(other._headersSent),
+      _chunked(other._chunked),
+      _readPaused(other._readPaused),
+      _cacheKey(other._cacheKey),
+      _cacheStatus(other._cacheStatus),
+      _cacheValid(other._cacheValid),
+      _caching(other._caching),
+      _cacheLock(other._cacheLock),
+      _cacheBody(other._cacheBody),
+      _startTime(other._startTime),
+      _active(other._active) {}
+
+ProxyRequest& ProxyRequest::operator=(const ProxyRequest& other) {
+    if (this != &other) {
+        _upstream    = other._upstream;
+        _address     = other._address;
+        _server      = other._server;
+        _tries       = other._tries;
+        _fd          = other._fd;
+        _reused      = other._reused;
+        _connecting  = other._connecting;
+        _request     = other._request;
+        _sentOffset  = other._sentOffset;
+        _input       = other._input;
+        _output      = other._output;
+        _response    = other._response;
+        _headersDone = other._headersDone;
+        _framing     = other._framing;
+        _remaining   = other._remaining;
+        _decoder     = other._decoder;
+        _headRequest = other._headRequest;
+        _keepConn    = other._keepConn;
+        _headersSent = other._headersSent;
+        _chunked     = other._chunked;
+        _readPaused  = other._readPaused;
+        _cacheKey    = other._cacheKey;
+        _cacheStatus = other._cacheStatus;
+        _cacheValid  = other._cacheValid;
+        _caching     = other._caching;
+        _cacheLock   = other._cacheLock;
+        _cacheBody   = other._cacheBody;
+        _startTime   = other._startTime;
+        _active      = other._active;
+    }
+    return *this;
+}
+
+ProxyRequest::~ProxyRequest() {}
+
+// ─── Encoding ────────────────────────────────────────────────────────────────
+
+// RFC 7230 6.1: these describe a single connection and are not forwarded
+bool ProxyRequest::isHopByHop(const String& lowerKey) {
+    return lowerKey == "connection" || lowerKey == "keep-alive" || lowerKey == "proxy-connection" || lowerKey == "te" ||
+           lowerKey == "trailer" || lowerKey == "transfer-encoding" || lowerKey == "upgrade";
+}
+
+// The body is complete and sent with a Content-Length whatever framing the
+// client used, so the upstream never sees a chunked request or Expect
+void ProxyRequest::encode(const String& upstream, const String& target, const HttpRequest& req, const String& remoteAddr) {
+    reset();
+    _upstream    = upstream;
+    _address     = upstream;
+    _headRequest = (req.getMethod() == METHOD_HEAD);
+
+    _request = req.getMethod() + " " + target + " " + HTTP_VERSION_1_1 + CRLF;
+    if (req.getHeader(HEADER_HOST).empty())
+        _request += String("host: ") + upstream + CRLF;
+    String                forwardedFor = remoteAddr;
+    const ArenaMapString& headers      = req.getHeaders();
+    for (ArenaMapString::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+        String key(it->first.begin(), it->first.end());
+        String value(it->second.begin(), it->second.end());
+        if (isHopByHop(key) || key == "content-length" || key == "expect")
+            continue;
+        if (key == "x-forwarded-for") {
+            forwardedFor = value + ", " + remoteAddr;
+            continue;
+        }
+        _request += key + ": " + value + CRLF;
+    }
+    _request += "x-forwarded-for: " + forwardedFor + CRLF;
+    const String& body = req.getBody();
+    if (!body.empty() || req.getMethod() == METHOD_POST || req.getMethod() == METHOD_PUT)
+        _request += "content-length: " + typeToString<size_t>(body.size()) + CRLF;
+    _request += CRLF;
+    _request += body;
+
+    _startTime = getCurrentTime();
+    _active    = true;
+}
+
+// ─── Connection ──────────────────────────────────────────────────────────────
+
+void ProxyRequest::attach(int fd, bool reused, bool connecting) {
+    _fd         = fd;
+    _reused     = reused;
+    _connecting = connecting;
+    _sentOffset = 0;
+    _input.clear();
+    _keepConn = false;
+}
+
+// The socket now belongs to the pool (or has been closed by the caller)
+void ProxyRequest::detach() {
+    _fd         = -1;
+    _connecting = false;
+}
+
+void ProxyRequest::reset() {
+    _upstream.clear();
+    _address.clear();
+    _server     = -1;
+    _tries      = 0;
+    _fd         = -1;
+    _reused     = false;
+    _connecting = false;
+    _request.clear();
+    _sentOffset = 0;
+    _input.clear();
+    _output.clear();
+    _response    = HttpResponse();
+    _headersDone = false;
+    _framing     = PROXY_BODY_NONE;
+    _remaining   = 0;
+    _decoder.reset();
+    _headRequest = false;
+    _keepConn    = false;
+    _headersSent = false;
+    _chunked     = false;
+    _readPaused  = false;
+    _cacheKey.clear();
+    _cacheStatus = CACHE_MISS;
+    _cacheValid  = 0;
+    _caching     = false;
+    _cacheLock   = CACHE_LOCK_NONE;
+    _cacheBody.clear();
+    _startTime   = 0;
+    _active      = false;
+}
+
+// An upstream block picked one of its servers for the next attempt
+void ProxyRequest::setServer(const String& address, int server) {
+    _address = address;
+    _server  = server;
+    ++_tries;
+}
+
+// The server was handed back to its block; _address stays for logging
+void ProxyRequest::clearServer() {
+    _server = -1;
+}
+
+// ─── I/O ─────────────────────────────────────────────────────────────────────
+
+ProxyStatus ProxyRequest::handleWrite() {
+    if (_connecting) {
+        // POLLOUT on a connecting socket: SO_ERROR tells whether connect() succeeded
+        int       err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0)
+            return PROXY_FAILED;
+        _connecting = false;
+    }
+    bool madeProgress = false;
+    while (_sentOffset < _request.size()) {
+        ssize_t w = write(_fd, _request.data() + _sentOffset, _request.size() - _sentOffset);
+        if (w <= 0)
+            break;
+        _sentOffset += w;
+        madeProgress = true;
+    }
+    if (madeProgress)
+        _startTime = getCurrentTime();
+    return _sentOffset >= _request.size() ? PROXY_COMPLETE : PROXY_PENDING;
+}
+
+// Reads at most PROXY_STREAM_BUFFER bytes per wakeup, so one fast upstream
+// cannot fill memory ahead of a slow client. PROXY_COMPLETE means the whole
+// response has been read, not that the client has it yet.
+ProxyStatus ProxyRequest::handleRead() {
+    char    buf[BUFFER_SIZE];
+    ssize_t n     = -1;
+    size_t  total = 0;
+    while (total < PROXY_STREAM_BUFFER && (n = read(_fd, buf, sizeof(buf))) > 0) {
+        _input.append(buf, n);
+        total += n;
+    }
+    if (total > 0)
+        _startTime = getCurrentTime();
+
+    while (!_headersDone) {
+        size_t headEnd = _input.find(DOUBLE_CRLF);
+        if (headEnd == String::npos) {
+            // Subject rule: never check errno. EOF before the head is a failed request.
+            if (_input.size() > PROXY_STREAM_BUFFER || n == 0)
+                return PROXY_FAILED;
+            return PROXY_PENDING;
+        }
+        if (!parseHead(headEnd))
+            return PROXY_FAILED;
+    }
+    ProxyStatus status = decodeBody();
+    if (status != PROXY_PENDING || n != 0)
+        return status;
+    // EOF only ends a body that has no other framing
+    return _framing == PROXY_BODY_CLOSE ? PROXY_COMPLETE : PROXY_FAILED;
+}
+
+// Takes the head ending at headEnd off _input. An interim 1xx head is
+// dropped, and the final one is parsed on the next call.
+bool ProxyRequest::parseHead(size_t headEnd) {
+    String head = _input.substr(0, headEnd);
+    _input.erase(0, headEnd + 4);
+    size_t lineEnd = head.find(CRLF);
+    String version;
+    if (!parseStatusLine(head.substr(0, lineEnd), version))
+        return false;
+    int status = _response.getStatusCode();
+    if (status < 200) {
+        _response = HttpResponse();
+        return true;
+    }
+
+    String connection, transferEncoding, contentLength;
+    size_t pos = (lineEnd == String::npos) ? head.size() : lineEnd + 2;
+    while (pos < head.size()) {
+        size_t eol = head.find(CRLF, pos);
+        if (eol == String::npos)
+            eol = head.size();
+        size_t colon = head.find(COLON, pos);
+        if (colon == String::npos || colon > eol)
+            return false;
+        String key   = trimSpaces(head.substr(pos, colon - pos));
+        String value = trimSpaces(head.substr(colon + 1, eol - colon - 1));
+        String lower = toLowerWords(key);
+        if (lower == "connection")
+            connection = toLowerWords(value);
+        else if (lower == "transfer-encoding")
+            transferEncoding = toLowerWords(value);
+        else if (lower == "content-length")
+            contentLength = value;
+        else if (!isHopByHop(lower))
+            addResponseHeader(key, value);
+        pos = eol + 2;
+    }
+
+    _keepConn = (version == HTTP_VERSION_1_1 && connection.find("close") == String::npos);
+    if (_headRequest || status == HTTP_NO_CONTENT || status == HTTP_NOT_MODIFIED) {
+        _framing = PROXY_BODY_NONE;
+    } else if (transferEncoding.find("chunked") != String::npos) {
+        _framing = PROXY_BODY_CHUNKED;
+    } else if (!contentLength.empty()) {
+        if (!stringToType<size_t>(contentLength, _remaining))
+            return false;
+        _framing = PROXY_BODY_LENGTH;
+    } else {
+        _framing  = PROXY_BODY_CLOSE;
+        _keepConn = false;
+    }
+    // a HEAD response keeps the length the GET would have had
+    if (!contentLength.empty() && _framing != PROXY_BODY_CHUNKED)
+        _response.addHeader(HEADER_CONTENT_LENGTH, contentLength);
+    _headersDone = true;
+    return true;
+}
+
+bool ProxyRequest::parseStatusLine(const String& line, String& version) {
+    size_t space = line.find(' ');
+    if (space == String::npos || line.compare(0, 5, "HTTP/") != 0)
+        return false;
+    version       = line.substr(0, space);
+    size_t reason = line.find(' ', space + 1);
+    String digits = line.substr(space + 1, reason == String::npos ? String::npos : reason - space - 1);
+    int    code;
+    if (digits.size() != 3 || !stringToType<int>(digits, code) || code < 100)
+        return false;
+    _response.setStatus(code, reason == String::npos ? getHttpStatusMessage(code) : line.substr(reason + 1));
+    return true;
+}
+
+// HttpResponse fills in Date and Server under its own spelling of the names,
+// so the upstream's are stored under the same keys to replace them
+void ProxyRequest::addResponseHeader(const String& key, const String& value) {
+    String lower = toLowerWords(key);
+    if (lower == HEADER_SET_COOKIE)
+        _response.addSetCookie(value);
+    else if (lower == HEADER_DATE)
+        _response.addHeader(HEADER_DATE, value);
+    else if (lower == "server")
+        _response.addHeader(HEADER_SERVER, value);
+    else
+        _response.addHeader(key, value);
+}
+
+// Moves body bytes from _input to _output. Bytes left past the end of the
+// body mean the upstream is out of step, so its connection is not reused.
+ProxyStatus ProxyRequest::decodeBody() {
+    if (_framing == PROXY_BODY_CHUNKED) {
+        size_t        consumed = 0;
+        ChunkedStatus status   = _decoder.decode(_input, _output, consumed, SIZE_MAX);
+        _input.erase(0, consumed);
+        if (status == CHUNKED_INVALID)
+            return PROXY_FAILED;
+        if (status == CHUNKED_INCOMPLETE)
+            return PROXY_PENDING;
+    } else if (_framing != PROXY_BODY_NONE) {
+        size_t take = _input.size();
+        if (_framing == PROXY_BODY_LENGTH)
+            take = std::min(take, _remaining);
+        if (take == _input.size() && _output.empty())
+            _output.swap(_input);
+        else
+            _output.append(_input, 0, take);
+        _input.erase(0, std::min(take, _input.size()));
+        if (_framing == PROXY_BODY_CLOSE)
+            return PROXY_PENDING;
+        _remaining -= take;
+        if (_remaining > 0)
+            return PROXY_PENDING;
+    }
+    if (!_input.empty())
+        _keepConn = false;
+    return PROXY_COMPLETE;
+}
+
+// ─── Streaming ───────────────────────────────────────────────────────────────
+
+// A body too big for the cache is passed through and not stored
+String ProxyRequest::takeOutput() {
+    String out;
+    out.swap(_output);
+    if (_caching && _cacheBody.size() + out.size() > PROXY_CACHE_ENTRY_MAX) {
+        _caching = false;
+        _cacheBody.clear();
+    }
+    if (_caching)
+        _cacheBody += out;
+    return out;
+}
+
+// storeBody is false for a HEAD, which has no body to store
+void ProxyRequest::startCaching(const String& key, CacheStatus status, int valid, bool storeBody) {
+    _cacheKey    = key;
+    _cacheStatus = status;
+    _cacheValid  = valid;
+    _caching     = storeBody;
+}
+
+void ProxyRequest::setCacheLock(CacheLock lock) {
+    _cacheLock = lock;
+}
+
+String ProxyRequest::takeCacheBody() {
+    String body;
+    body.swap(_cacheBody);
+    return body;
+}
+
+void ProxyRequest::startStream(bool chunked) {
+    _headersSent = true;
+    _chunked     = chunked;
+}
+
+void ProxyRequest::setReadPaused(bool paused) {
+    _readPaused = paused;
+}
+
+void ProxyRequest::resetStartTime() {
+    _startTime = getCurrentTime();
+}
+
+// ─── Accessors ───────────────────────────────────────────────────────────────
+
+bool ProxyRequest::isActive() const {
+    return _active;
+}
+bool ProxyRequest::isReused() const {
+    return _reused;
+}
+bool ProxyRequest::isConnecting() const {
+    return _connecting;
+}
+bool ProxyRequest::isHeadersDone() const {
+    return _headersDone;
+}
+bool ProxyRequest::isHeadersSent() const {
+    return _headersSent;
+}
+bool ProxyRequest::isChunked() const {
+    return _chunked;
+}
+bool ProxyRequest::isReadPaused() const {
+    return _readPaused;
+}
+bool ProxyRequest::isCaching() const {
+    return _caching;
+}
+bool ProxyRequest::hasResponseData() const {
+    return _headersDone || !_input.empty();
+}
+bool ProxyRequest::canKeepConnection() const {
+    return _keepConn;
+}
+int ProxyRequest::getFd() const {
+    return _fd;
+}
+ProxyFraming ProxyRequest::getFraming() const {
+    return _framing;
+}
+HttpResponse& ProxyRequest::getResponse() {
+    return _response;
+}
+const String& ProxyRequest::getUpstream() const {
+    return _upstream;
+}
+const String& ProxyRequest::getAddress() const {
+    return _address;
+}
+int ProxyRequest::getServer() const {
+    return _server;
+}
+size_t ProxyRequest::getTries() const {
+    return _tries;
+}
+const String& ProxyRequest::getCacheKey() const {
+    return _cacheKey;
+}
+CacheLock ProxyRequest::getCacheLock() const {
+    return _cacheLock;
+}
+CacheStatus ProxyRequest::getCacheStatus() const {
+    return _cacheStatus;
+}
+int ProxyRequest::getCacheValid() const {
+    return _cacheValid;
+}
+time_t ProxyRequest::getStartTime() const {
+    return _startTime;
+}
@@ -0,0 +1,105 @@
+#ifndef PROXY_REQUEST_HPP
+#define PROXY_REQUEST_HPP
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <ctime>
+#include "../http/ChunkedDecoder.hpp"
+#include "../http/HttpRequest.hpp"
+#include "../http/HttpResponse.hpp"
+#include "../utils/Enums.hpp"
+#include "../utils/Types.hpp"
+
+// One request in flight on a pooled proxy_pass upstream connection. The
+// request goes out whole; the response is parsed as it arrives, its head once
+// and then its body, which takeOutput() hands over piece by piece so it can be
+// streamed to the client. The encoded request is kept until the upstream
+// answers, so it can be replayed on a fresh connection when a reused
+// keep-alive one turns out to be closed. For proxy_cache, the body taken is
+// also kept, up to PROXY_CACHE_ENTRY_MAX, to be stored once it is complete.
+class ProxyRequest {
+   private:
+    String         _upstream;    // proxy_pass host:port or upstream block name
+    String         _address;     // server connected to, host:port, the pool key
+    int            _server;      // index in the upstream block, -1: none held
+    size_t         _tries;       // upstream block servers tried for this request
+    int            _fd;          // upstream socket, -1 until attached
+    bool           _reused;      // connection came from the keep-alive pool
+    bool           _connecting;  // non-blocking connect still in progress
+    String         _request;     // request line, headers and body
+    size_t         _sentOffset;  // bytes of _request already written
+    String         _input;       // bytes read from upstream, not parsed yet
+    String         _output;      // body bytes not yet taken for the client
+    HttpResponse   _response;    // upstream status line and end-to-end headers
+    bool           _headersDone; // _response holds the final (non-1xx) head
+    ProxyFraming   _framing;     // how the end of the upstream body is found
+    size_t         _remaining;   // PROXY_BODY_LENGTH: body bytes still to come
+    ChunkedDecoder _decoder;     // PROXY_BODY_CHUNKED
+    bool           _headRequest; // HEAD: the response has no body
+    bool           _keepConn;    // upstream connection can go back to the pool
+    bool           _headersSent; // head queued for the client
+    bool           _chunked;     // body re-chunked for the client
+    bool           _readPaused;  // upstream left out of poll() while the client catches up
+    String         _cacheKey;    // proxy_cache key, empty: not cached
+    CacheStatus    _cacheStatus; // MISS or EXPIRED, sent as X-Cache-Status
+    int            _cacheValid;  // proxy_cache_valid of the location
+    bool           _caching;     // body copied into _cacheBody for the cache
+    CacheLock      _cacheLock;   // proxy_cache_lock held, or waited for
+    String         _cacheBody;
+    time_t         _startTime;
+    bool           _active;
+
+    bool          parseHead(size_t headEnd);
+    bool          parseStatusLine(const String& line, String& version);
+    void          addResponseHeader(const String& key, const String& value);
+    ProxyStatus   decodeBody();
+    static bool   isHopByHop(const String& lowerKey);
+
+   public:
+    ProxyRequest();
+    ProxyRequest(const ProxyRequest& other);
+    ProxyRequest& operator=(const ProxyRequest& other);
+    ~ProxyRequest();
+
+    void encode(const String& upstream, const String& target, const HttpRequest& req, const String& remoteAddr);
+    void attach(int fd, bool reused, bool connecting);
+    void detach();
+    void reset();
+    void setServer(const String& address, int server);
+    void clearServer();
+
+    ProxyStatus handleWrite();
+    ProxyStatus handleRead();
+    String      takeOutput();
+    void        startStream(bool chunked);
+    void        setReadPaused(bool paused);
+    void        resetStartTime();
+    void        startCaching(const String& key, CacheStatus status, int valid, bool storeBody);
+    String      takeCacheBody();
+    void        setCacheLock(CacheLock lock);
+
+    bool          isActive() const;
+    bool          isReused() const;
+    bool          isConnecting() const;
+    bool          isHeadersDone() const;
+    bool          isHeadersSent() const;
+    bool          isChunked() const;
+    bool          isReadPaused() const;
+    bool          isCaching() const;
+    bool          hasResponseData() const;
+    bool          canKeepConnection() const;
+    int           getFd() const;
+    ProxyFraming  getFraming() const;
+    HttpResponse& getResponse();
+    const String& getUpstream() const;
+    const String& getAddress() const;
+    int           getServer() const;
+    size_t        getTries() const;
+    const String& getCacheKey() const;
+    CacheStatus   getCacheStatus() const;
+    int           getCacheValid() const;
+    CacheLock     getCacheLock() const;
+    time_t        getStartTime() const;
+};
+
+#endif
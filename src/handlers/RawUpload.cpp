@@ -0,0 +1,262 @@
+#include "RawUpload.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../utils/Utils.hpp"
+
+RawUpload::RawUpload()
+    : _uploadDir(), _filename(), _tempPath(), _length(0), _fd(INVALID_FD), _io(UPLOAD_IO_WRITE), _block(), _blockUsed(0), _outOfSpace(false), _active(false) {
+    _pipe[0] = INVALID_FD;
+    _pipe[1] = INVALID_FD;
+}
+
+RawUpload::RawUpload(const RawUpload& other)
+    : _uploadDir(other._uploadDir),
+      _filename(other._filename),
+      _tempPath(other._tempPath),
+      _length(other._length),
+      _fd(other._fd),
+      _io(other._io),
+      _block(other._block),
+      _blockUsed(other._blockUsed),
+      _outOfSpace(other._outOfSpace),
+      _active(other._active) {
+    _pipe[0] = other._pipe[0];
+    _pipe[1] = other._pipe[1];
+}
+
+RawUpload& RawUpload::operator=(const RawUpload& other) {
+    if (this != &other) {
+        _uploadDir = other._uploadDir;
+        _filename  = other._filename;
+        _tempPath  = other._tempPath;
+        _length    = other._length;
+        _fd        = other._fd;
+        _io        = other._io;
+        _pipe[0]   = other._pipe[0];
+        _pipe[1]   = other._pipe[1];
+        _block     = other._block;
+        _blockUsed = other._blockUsed;
+        _outOfSpace = other._outOfSpace;
+        _active     = other._active;
+    }
+    return *this;
+}
+
+RawUpload::~RawUpload() {}
+
+// length is the Content-Length, 0 when unknown (chunked)
+void RawUpload::begin(const String& uploadDir, const String& filename, size_t length, UploadIo io) {
+    reset();
+    _outOfSpace = false;
+    _uploadDir  = uploadDir;
+    _filename   = filename;
+    _length     = length;
+    _io         = io;
+    _active     = true;
+}
+
+// A failure leaves the upload inactive
+bool RawUpload::open() {
+    String uploadDir = _uploadDir;
+    if (!ensureDirectoryExists(uploadDir)) {
+        abort();
+        return fail("Failed to create upload directory: " + uploadDir);
+    }
+    String            pattern = joinPaths(uploadDir, ".upload_XXXXXX");
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    _fd = mkostemp(&path[0], O_CLOEXEC | (_io == UPLOAD_IO_DIRECT ? O_DIRECT : 0));
+    if (_fd == INVALID_FD && _io == UPLOAD_IO_DIRECT) {
+        // maybe only O_DIRECT was refused: try once more without it
+        std::copy(pattern.begin(), pattern.end(), path.begin());
+        _io = UPLOAD_IO_WRITE;
+        _fd = mkostemp(&path[0], O_CLOEXEC);
+    }
+    if (_fd == INVALID_FD) {
+        abort();
+        return fail("Failed to create upload file in: " + uploadDir);
+    }
+    _tempPath = &path[0];
+
+    // fallocate() failing with the room there means the filesystem does not
+    // support it, and the body is written without a reservation
+    if (_length > 0 && fallocate(_fd, 0, 0, _length) == -1 && !hasRoomFor(_length)) {
+        _outOfSpace = true;
+        fail("No room for " + typeToString<size_t>(_length) + " bytes for: " + _filename);
+        abort();
+        return false;
+    }
+    if (_io == UPLOAD_IO_DIRECT)
+        _block.resize(UPLOAD_DIRECT_BLOCK + UPLOAD_DIRECT_ALIGN);
+    if (_io == UPLOAD_IO_SPLICE && pipe2(_pipe, O_CLOEXEC) == -1)
+        _io = UPLOAD_IO_WRITE;
+    return true;
+}
+
+// Staged data is flushed before a fallback from O_DIRECT, so whatever is
+// left afterwards goes straight to writeAll()
+bool RawUpload::write(const char* data, size_t len) {
+    while (_io == UPLOAD_IO_DIRECT && len > 0) {
+        size_t n = std::min(len, (size_t)UPLOAD_DIRECT_BLOCK - _blockUsed);
+        std::memcpy(alignedBlock() + _blockUsed, data, n);
+        _blockUsed += n;
+        data += n;
+        len -= n;
+        if (_blockUsed == UPLOAD_DIRECT_BLOCK && !flushBlock(false))
+            return false;
+    }
+    return writeAll(data, len);
+}
+
+// Moves up to CLIENT_READ_BATCH bytes from the socket into the pipe, which
+// drainPipe() left empty. Returns like recv(): 0 at EOF, -1 when nothing was
+// read. The socket is peeked first, so a splice() that fails with data
+// waiting was refused: the upload switches to write() once, and the rest of
+// the body is read the usual way.
+ssize_t RawUpload::fillPipe(int socketFd, size_t len) {
+    char    probe;
+    ssize_t peeked = recv(socketFd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (peeked <= 0)
+        return (peeked == 0) ? 0 : -1;
+    ssize_t n = splice(socketFd, NULL, _pipe[1], NULL, std::min(len, (size_t)CLIENT_READ_BATCH), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0)
+        _io = UPLOAD_IO_WRITE;
+    return (n > 0) ? n : -1;
+}
+
+// Writes the len bytes fillPipe() moved on to the file. Returns false when
+// the file could not be written.
+bool RawUpload::drainPipe(size_t len) {
+    for (size_t left = len; left > 0;) {
+        ssize_t m = -1;
+        if (_io == UPLOAD_IO_SPLICE)
+            m = splice(_pipe[0], NULL, _fd, NULL, left, SPLICE_F_MOVE);
+        if (m < 0) {
+            // the file refused splice(): copy out what the pipe holds
+            char buffer[BUFFER_SIZE];
+            _io = UPLOAD_IO_WRITE;
+            m   = read(_pipe[0], buffer, std::min(left, sizeof(buffer)));
+            if (m > 0 && !writeAll(buffer, m))
+                return false;
+        }
+        if (m <= 0)
+            return fail("Failed to write upload file: " + _tempPath);
+        left -= m;
+    }
+    return true;
+}
+
+// The staged tail is rarely a multiple of the alignment, so it is written
+// with O_DIRECT turned off
+bool RawUpload::finish() {
+    if (_io == UPLOAD_IO_DIRECT && _blockUsed > 0 && !flushBlock(true))
+        return false;
+    close(_fd);
+    _fd           = INVALID_FD;
+    String target = joinPaths(_uploadDir, _filename);
+    if (std::rename(_tempPath.c_str(), target.c_str()) == -1) {
+        fail("Failed to save upload file: " + target);
+        unlink(_tempPath.c_str());
+        reset();
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void RawUpload::abort() {
+    if (_fd != INVALID_FD) {
+        close(_fd);
+        unlink(_tempPath.c_str());
+    }
+    reset();
+}
+
+// _outOfSpace is kept for the caller to pick the response status
+void RawUpload::reset() {
+    if (_pipe[0] != INVALID_FD) {
+        close(_pipe[0]);
+        close(_pipe[1]);
+    }
+    _uploadDir.clear();
+    _filename.clear();
+    _tempPath.clear();
+    _length  = 0;
+    _fd      = INVALID_FD;
+    _io      = UPLOAD_IO_WRITE;
+    _pipe[0] = INVALID_FD;
+    _pipe[1] = INVALID_FD;
+    std::vector<char>().swap(_block);
+    _blockUsed = 0;
+    _active    = false;
+}
+
+bool RawUpload::isActive() const {
+    return _active;
+}
+
+bool RawUpload::isOpen() const {
+    return _fd != INVALID_FD;
+}
+
+bool RawUpload::canSplice() const {
+    return _active && _io == UPLOAD_IO_SPLICE;
+}
+
+bool RawUpload::isOutOfSpace() const {
+    return _outOfSpace;
+}
+
+const String& RawUpload::getFilename() const {
+    return _filename;
+}
+
+char* RawUpload::alignedBlock() {
+    size_t address = reinterpret_cast<size_t>(&_block[0]);
+    return &_block[0] + (UPLOAD_DIRECT_ALIGN - address % UPLOAD_DIRECT_ALIGN) % UPLOAD_DIRECT_ALIGN;
+}
+
+// A filesystem that takes O_DIRECT at open() can still reject the write
+// itself; the upload then continues through the page cache, and a write
+// failing there too fails the upload
+bool RawUpload::writeAll(const char* data, size_t len) {
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = ::write(_fd, data + written, len - written);
+        if (n < 0 && _io == UPLOAD_IO_DIRECT) {
+            fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+            _io = UPLOAD_IO_WRITE;
+            continue;
+        }
+        if (n <= 0) {
+            _outOfSpace = !hasRoomFor(len - written);
+            return fail("Failed to write upload file: " + _tempPath);
+        }
+        written += n;
+    }
+    return true;
+}
+
+bool RawUpload::flushBlock(bool last) {
+    if (last && _io == UPLOAD_IO_DIRECT)
+        fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+    size_t used = _blockUsed;
+    _blockUsed  = 0;
+    return writeAll(alignedBlock(), used);
+}
+
+// Space an unprivileged writer could still take in upload_dir
+bool RawUpload::hasRoomFor(size_t bytes) const {
+    struct statvfs fs;
+    if (statvfs(_uploadDir.c_str(), &fs) == -1)
+        return true;
+    return (unsigned long long)fs.f_bavail * fs.f_frsize >= bytes;
+}
+
+bool RawUpload::fail(const String& message) {
+    return Logger::error(message);
+}
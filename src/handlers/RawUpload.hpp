@@ -0,0 +1,64 @@
+#ifndef RAW_UPLOAD_HPP
+#define RAW_UPLOAD_HPP
+
+#include <sys/socket.h>
+#include <sys/statvfs.h>
+#include <sys/types.h>
+#include <cstddef>
+#include <vector>
+#include "../utils/Enums.hpp"
+#include "../utils/Types.hpp"
+
+// A non-multipart upload body written to its file as it is read. begin()
+// only records where it goes; open() creates the file hidden in upload_dir,
+// fallocate()d to Content-Length so a full disk is reported before the body
+// is taken, and finish() renames it into place once the whole body is in.
+// upload_io selects the path to disk: write() from the receive buffer,
+// O_DIRECT through an aligned staging block that skips the page cache, or
+// splice() from the socket into a pipe and on to the file without a
+// userspace copy. Everything but fillPipe() may run on an aio thread.
+// Where the filesystem refuses O_DIRECT or splice, write() is used instead;
+// a write() that fails after that fails the upload. errno is never looked
+// at: a full disk is told apart from other failures by the free space left.
+class RawUpload {
+   private:
+    String            _uploadDir;
+    String            _filename;  // sanitized, final name in upload_dir
+    String            _tempPath;
+    size_t            _length;    // Content-Length, 0 when unknown
+    int               _fd;
+    UploadIo          _io;
+    int               _pipe[2];   // socket -> pipe -> file, for UPLOAD_IO_SPLICE
+    std::vector<char> _block;     // O_DIRECT staging, aligned inside
+    size_t            _blockUsed;
+    bool              _outOfSpace; // last failure left less room than it needed
+    bool              _active;
+
+    char* alignedBlock();
+    bool  writeAll(const char* data, size_t len);
+    bool  flushBlock(bool last);
+    bool  hasRoomFor(size_t bytes) const;
+    bool  fail(const String& message);
+
+   public:
+    RawUpload();
+    RawUpload(const RawUpload& other);
+    RawUpload& operator=(const RawUpload& other);
+    ~RawUpload();
+
+    void          begin(const String& uploadDir, const String& filename, size_t length, UploadIo io);
+    bool          open();
+    bool          write(const char* data, size_t len);
+    ssize_t       fillPipe(int socketFd, size_t len);
+    bool          drainPipe(size_t len);
+    bool          finish();
+    void          abort();
+    void          reset();
+    bool          isActive() const;
+    bool          isOpen() const;
+    bool          canSplice() const;
+    bool          isOutOfSpace() const;
+    const String& getFilename() const;
+};
+
+#endif
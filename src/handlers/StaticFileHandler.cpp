@@ -1,8 +1,8 @@
 #include "StaticFileHandler.hpp"
 
-StaticFileHandler::StaticFileHandler() : mimeTypes() {}
+StaticFileHandler::StaticFileHandler() : mimeTypes(NULL) {}
 
-StaticFileHandler::StaticFileHandler(const MimeTypes& _mimeTypes) : mimeTypes(_mimeTypes) {}
+StaticFileHandler::StaticFileHandler(const MimeTypes& _mimeTypes) : mimeTypes(&_mimeTypes) {}
 
 StaticFileHandler::StaticFileHandler(const StaticFileHandler& other) : mimeTypes(other.mimeTypes) {}
 
@@ -16,16 +16,16 @@ StaticFileHandler& StaticFileHandler::operator=(const StaticFileHandler& other)
 StaticFileHandler::~StaticFileHandler() {}
 
 bool StaticFileHandler::handle(const RouteResult& resultRouter, HttpResponse& response) const {
-    String path   = resultRouter.getPathRootUri();
-    String method = resultRouter.getRequest().getMethod();
-    String content;
+    const String& path   = resultRouter.getPathRootUri();
+    const String& method = resultRouter.getRequest().getMethod();
+    String        content;
     if (!readFileContent(path, content))
         return false;
     response.setStatus(HTTP_OK, "OK");
     response.addHeader(HEADER_SERVER, "Webserv/1.0");
-    response.setResponseHeaders(mimeTypes.get(path), content.size());
+    response.setResponseHeaders(mimeTypes ? mimeTypes->get(path) : String(DEFAULT_MIME_TYPE), content.size());
     if (method != "HEAD") {
-        response.setBody(content);
+        response.swapBody(content);
     }
     return true;
 }
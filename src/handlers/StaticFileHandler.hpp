@@ -17,7 +17,7 @@ class StaticFileHandler : public IHandler {
     bool handle(const RouteResult& resultRouter, HttpResponse& response) const;
 
    private:
-    MimeTypes mimeTypes;
+    const MimeTypes* mimeTypes; // owned by the ResponseBuilder
 };
 
 #endif
@@ -1,7 +1,4 @@
 #include "../handlers/UploaderHandler.hpp"
-#include <sys/stat.h>
-#include <cstdlib>
-#include <fstream>
 #include "../utils/Utils.hpp"
 
 UploaderHandler::UploaderHandler() {}
@@ -14,24 +11,13 @@ UploaderHandler& UploaderHandler::operator=(const UploaderHandler& other) {
 }
 UploaderHandler::~UploaderHandler() {}
 
-bool UploaderHandler::handle(const String& uploadDir, const String& filename, const String& content, HttpResponse& response) const {
-    if (uploadDir.empty() || filename.empty())
-        return Logger::error("uploader folder is empty");
-    String safeName     = sanitizeFilename(filename);
-    String fullPath     = joinPaths(uploadDir, safeName);
-
-    // Ensure upload directory exists
-    if (!ensureDirectoryExists(uploadDir))
-        return Logger::error("Failed to create upload directory: " + uploadDir);
-
-    std::ofstream out(fullPath.c_str(), std::ios::binary);
-    if (!out.is_open())
+// 201 listing the files an upload wrote (see MultipartUpload and RawUpload)
+bool UploaderHandler::respond(const VectorString& savedFiles, HttpResponse& response) const {
+    if (savedFiles.empty())
         return false;
-
-    out.write(content.c_str(), content.size());
-    out.close();
-
-    String successMsg = "File uploaded successfully: " + safeName;
+    String successMsg = "File uploaded successfully: " + savedFiles[0];
+    for (size_t i = 1; i < savedFiles.size(); ++i)
+        successMsg += ", " + savedFiles[i];
     response.setStatus(HTTP_CREATED, "Created");
     response.setResponseHeaders("text/plain", successMsg.size());
     response.setBody(successMsg);
@@ -11,8 +11,7 @@ class UploaderHandler {
     UploaderHandler& operator=(const UploaderHandler& other);
     ~UploaderHandler();
 
-    bool handle(const String& uploadDir, const String& filename, const String& content, HttpResponse& response) const;
-    
+    bool respond(const VectorString& savedFiles, HttpResponse& response) const;
 };
 
 #endif
@@ -0,0 +1,107 @@
+#include "ChunkedDecoder.hpp"
+#include <algorithm>
+#include "../utils/Utils.hpp"
+
+ChunkedDecoder::ChunkedDecoder() : _state(CHUNK_SIZE), _remaining(0), _decoded(0), _line() {}
+
+ChunkedDecoder::ChunkedDecoder(const ChunkedDecoder& other)
+    : _state(other._state), _remaining(other._remaining), _decoded(other._decoded), _line(other._line) {}
+
+ChunkedDecoder& ChunkedDecoder::operator=(const ChunkedDecoder& other) {
+    if (this != &other) {
+        _state     = other._state;
+        _remaining = other._remaining;
+        _decoded   = other._decoded;
+        _line      = other._line;
+    }
+    return *this;
+}
+
+ChunkedDecoder::~ChunkedDecoder() {}
+
+// Consumes input from the start and appends at most maxOutput body bytes to
+// output; consumed tells the caller how much input to drop. Bytes after the
+// final CRLF (a pipelined request) are left unconsumed.
+ChunkedStatus ChunkedDecoder::decode(const String& input, String& output, size_t& consumed, size_t maxOutput) {
+    size_t produced = 0;
+    consumed        = 0;
+    while (consumed < input.size() && _state != CHUNK_DONE) {
+        if (_state == CHUNK_DATA) {
+            size_t n = std::min(std::min(_remaining, input.size() - consumed), maxOutput - produced);
+            if (n == 0)
+                break;
+            output.append(input, consumed, n);
+            consumed += n;
+            produced += n;
+            _decoded += n;
+            _remaining -= n;
+            if (_remaining == 0)
+                _state = CHUNK_DATA_END;
+            continue;
+        }
+
+        size_t eol = input.find('\n', consumed);
+        size_t end = (eol == String::npos) ? input.size() : eol + 1;
+        _line.append(input, consumed, end - consumed);
+        consumed = end;
+        if (eol == String::npos) {
+            if (_line.size() > MAX_HEADER_SIZE)
+                return CHUNKED_INVALID;
+            break;
+        }
+        String line;
+        line.swap(_line);
+        line.erase(line.size() - 1);
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        if (_state == CHUNK_DATA_END) {
+            if (!line.empty())
+                return CHUNKED_INVALID;
+            _state = CHUNK_SIZE;
+        } else if (_state == CHUNK_SIZE) {
+            if (!parseSize(line, _remaining))
+                return CHUNKED_INVALID;
+            _state = (_remaining == 0) ? CHUNK_TRAILER : CHUNK_DATA;
+        } else if (line.empty()) {
+            _state = CHUNK_DONE; // trailer fields are read and dropped
+        }
+    }
+    return (_state == CHUNK_DONE) ? CHUNKED_COMPLETE : CHUNKED_INCOMPLETE;
+}
+
+void ChunkedDecoder::reset() {
+    _state     = CHUNK_SIZE;
+    _remaining = 0;
+    _decoded   = 0;
+    _line.clear();
+}
+
+bool ChunkedDecoder::isDone() const {
+    return _state == CHUNK_DONE;
+}
+
+size_t ChunkedDecoder::getDecodedSize() const {
+    return _decoded;
+}
+
+// Hex size, optionally followed by ";extension" which is ignored
+bool ChunkedDecoder::parseSize(const String& line, size_t& size) {
+    String digits = trimSpaces(line.substr(0, line.find(';')));
+    if (digits.empty() || digits.size() > sizeof(size_t) * 2 - 1)
+        return false;
+    size = 0;
+    for (size_t i = 0; i < digits.size(); i++) {
+        char c = digits[i];
+        size *= 16;
+        if (c >= '0' && c <= '9')
+            size += c - '0';
+        else if (c >= 'a' && c <= 'f')
+            size += c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            size += c - 'A' + 10;
+        else
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef CHUNKED_DECODER_HPP
+#define CHUNKED_DECODER_HPP
+
+#include <cstddef>
+#include "../utils/Enums.hpp"
+#include "../utils/Types.hpp"
+
+// Incremental decoder for a chunked request body. decode() is fed whatever
+// part of the body has arrived and appends the chunk data it can; a size or
+// trailer line split across reads is kept until its end arrives.
+class ChunkedDecoder {
+   private:
+    ChunkedState _state;
+    size_t       _remaining; // data bytes left in the current chunk
+    size_t       _decoded;   // body bytes produced so far
+    String       _line;      // partial size or trailer line
+
+    static bool parseSize(const String& line, size_t& size);
+
+   public:
+    ChunkedDecoder();
+    ChunkedDecoder(const ChunkedDecoder& other);
+    ChunkedDecoder& operator=(const ChunkedDecoder& other);
+    ~ChunkedDecoder();
+
+    ChunkedStatus decode(const String& input, String& output, size_t& consumed, size_t maxOutput);
+    void          reset();
+    bool          isDone() const;
+    size_t        getDecodedSize() const;
+};
+
+#endif
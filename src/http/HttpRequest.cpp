@@ -1,70 +1,187 @@
 #include "HttpRequest.hpp"
+#include <cctype>
+#include <cstring>
+#include <strings.h>
+#include <stdint.h>
+
+// Scan helpers working on [start, start + len) ranges of the raw header section,
+// so parsing does not need a temporary string per line, key and value.
+static bool isHeaderSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static void trimRange(const char* s, size_t& start, size_t& len) {
+    while (len > 0 && isHeaderSpace(s[start])) {
+        start++;
+        len--;
+    }
+    while (len > 0 && isHeaderSpace(s[start + len - 1]))
+        len--;
+}
+
+// Same rules as trimQuotes(cleanCharEnd(token, ';')) in parseKeyValue()
+static void trimTokenRange(const String& s, size_t& start, size_t& len, bool stripSemicolon) {
+    if (stripSemicolon && len > 0 && s[start + len - 1] == SEMICOLON)
+        len--;
+    if (len >= 2 && ((s[start] == '"' && s[start + len - 1] == '"') || (s[start] == '\'' && s[start + len - 1] == '\''))) {
+        start++;
+        len -= 2;
+    }
+}
+
+static bool nextToken(const String& s, size_t& pos, size_t end, size_t& tokStart, size_t& tokLen) {
+    while (pos < end && std::isspace(static_cast<unsigned char>(s[pos])))
+        pos++;
+    if (pos >= end)
+        return false;
+    tokStart = pos;
+    while (pos < end && !std::isspace(static_cast<unsigned char>(s[pos])))
+        pos++;
+    tokLen = pos - tokStart;
+    return true;
+}
+
+static int hexDigitValue(char c) {
+    if (std::isdigit(static_cast<unsigned char>(c)))
+        return c - '0';
+    return std::toupper(static_cast<unsigned char>(c)) - 'A' + 10;
+}
+
+// urlDecode() into an existing string so its capacity is reused between requests
+static void assignUrlDecoded(String& out, const String& s, size_t start, size_t len) {
+    out.clear();
+    for (size_t i = start; i < start + len; ++i) {
+        if (s[i] == '%' && i + 2 < start + len && std::isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(s[i + 2]))) {
+            out += static_cast<char>((hexDigitValue(s[i + 1]) << 4) | hexDigitValue(s[i + 2]));
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+}
 
 HttpRequest::HttpRequest()
-    : method(""),
+    : arena(),
+      method(""),
       uri(""),
+      target(""),
       httpVersion(""),
       queryString(""),
       fragment(""),
-      headers(),
+      headers(std::less<ArenaString>(), ArenaPairAllocator(&arena)),
       body(""),
       contentType(""),
       contentLength(0),
       host(""),
       port(80),
-      cookies(),
-      errorCode(0) {}
+      cookies(std::less<ArenaString>(), ArenaPairAllocator(&arena)),
+      errorCode(0),
+      bodyReceived(0),
+      bodyDecoder() {}
 
 HttpRequest::HttpRequest(const HttpRequest& other)
-    : method(other.method),
+    : arena(),
+      method(other.method),
       uri(other.uri),
+      target(other.target),
       httpVersion(other.httpVersion),
       queryString(other.queryString),
       fragment(other.fragment),
-      headers(other.headers),
+      headers(std::less<ArenaString>(), ArenaPairAllocator(&arena)),
       body(other.body),
       contentType(other.contentType),
       contentLength(other.contentLength),
       host(other.host),
       port(other.port),
-      cookies(other.cookies),
-      errorCode(other.errorCode) {}
+      cookies(std::less<ArenaString>(), ArenaPairAllocator(&arena)),
+      errorCode(other.errorCode),
+      bodyReceived(other.bodyReceived),
+      bodyDecoder(other.bodyDecoder) {
+    copyFrom(other);
+}
 
 HttpRequest& HttpRequest::operator=(const HttpRequest& other) {
     if (this != &other) {
         method        = other.method;
         uri           = other.uri;
+        target        = other.target;
         httpVersion   = other.httpVersion;
         queryString   = other.queryString;
         fragment      = other.fragment;
-        headers       = other.headers;
         body          = other.body;
         contentType   = other.contentType;
         contentLength = other.contentLength;
         host          = other.host;
         port          = other.port;
-        cookies       = other.cookies;
         errorCode     = other.errorCode;
+        bodyReceived  = other.bodyReceived;
+        bodyDecoder   = other.bodyDecoder;
+        headers.clear();
+        cookies.clear();
+        arena.reset();
+        copyFrom(other);
     }
     return *this;
 }
 
 HttpRequest::~HttpRequest() {}
 
+// Header and cookie maps live in the arena of their owner, so a copy
+// re-creates every entry in this request's own arena.
+void HttpRequest::copyFrom(const HttpRequest& other) {
+    for (ArenaMapString::const_iterator it = other.headers.begin(); it != other.headers.end(); ++it)
+        headers.insert(std::make_pair(arenaString(it->first.data(), it->first.size()), arenaString(it->second.data(), it->second.size())));
+    for (ArenaMapString::const_iterator it = other.cookies.begin(); it != other.cookies.end(); ++it)
+        cookies.insert(std::make_pair(arenaString(it->first.data(), it->first.size()), arenaString(it->second.data(), it->second.size())));
+}
+
+ArenaString HttpRequest::arenaString(const char* data, size_t len) const {
+    return ArenaString(data, len, ArenaAllocator<char>(&arena));
+}
+
+const ArenaString* HttpRequest::findHeader(const char* key) const {
+    return findHeader(key, std::strlen(key));
+}
+
+// Keys are stored lowercase and in order, so the key is compared as given,
+// lowered a byte at a time, and the walk stops once it has been passed
+const ArenaString* HttpRequest::findHeader(const char* key, size_t len) const {
+    for (ArenaMapString::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+        const ArenaString& name = it->first;
+        int                cmp  = 0;
+        for (size_t i = 0; cmp == 0 && i < name.size() && i < len; ++i)
+            cmp = static_cast<unsigned char>(name[i]) - std::tolower(static_cast<unsigned char>(key[i]));
+        if (cmp == 0)
+            cmp = (name.size() > len) - (name.size() < len);
+        if (cmp == 0)
+            return &it->second;
+        if (cmp > 0)
+            break;
+    }
+    return NULL;
+}
+
+// Strings keep their capacity and the arena keeps its block, so a keep-alive
+// connection parses its next request without going back to malloc.
 void HttpRequest::clear() {
-    method      = "";
-    uri         = "";
-    httpVersion = "";
-    queryString = "";
-    fragment    = "";
+    method.clear();
+    uri.clear();
+    target.clear();
+    httpVersion.clear();
+    queryString.clear();
+    fragment.clear();
     headers.clear();
-    body          = "";
-    contentType   = "";
+    body.clear();
+    contentType.clear();
     contentLength = 0;
-    host          = "";
-    port          = 80;
+    host.clear();
+    port = 80;
     cookies.clear();
-    errorCode = 0;
+    errorCode    = 0;
+    bodyReceived = 0;
+    bodyDecoder.reset();
+    arena.reset();
 }
 
 bool HttpRequest::parse(const String& raw) {
@@ -105,18 +222,23 @@ bool HttpRequest::parseHeaders(const String& headerSection) {
         return Logger::error("Empty request line");
     }
 
-    String       requestLine = headerSection.substr(0, lineEnd);
-    VectorString values;
-    if (!parseKeyValue(requestLine, method, values) && (errorCode = HTTP_BAD_REQUEST)) {
+    size_t pos = 0;
+    size_t methodStart, methodLen, uriStart, uriLen, versionStart, versionLen, extraStart, extraLen;
+    if (!nextToken(headerSection, pos, lineEnd, methodStart, methodLen) || !nextToken(headerSection, pos, lineEnd, uriStart, uriLen)) {
+        errorCode = HTTP_BAD_REQUEST;
         return Logger::error("Failed to parse request line");
     }
-    if (values.size() != 2 && (errorCode = HTTP_BAD_REQUEST)) {
+    if (!nextToken(headerSection, pos, lineEnd, versionStart, versionLen) || nextToken(headerSection, pos, lineEnd, extraStart, extraLen)) {
+        errorCode = HTTP_BAD_REQUEST;
         return Logger::error("Invalid request line format");
     }
+    trimTokenRange(headerSection, methodStart, methodLen, false);
+    trimTokenRange(headerSection, uriStart, uriLen, true);
+    trimTokenRange(headerSection, versionStart, versionLen, true);
 
-    uri         = values[0];
-    httpVersion = values[1];
-    if (method.empty() || uri.empty() || httpVersion.empty()) {
+    method.assign(headerSection, methodStart, methodLen);
+    httpVersion.assign(headerSection, versionStart, versionLen);
+    if (method.empty() || uriLen == 0 || httpVersion.empty()) {
         errorCode = HTTP_BAD_REQUEST;
         return Logger::error("Empty method, URI, or HTTP version");
     }
@@ -126,25 +248,33 @@ bool HttpRequest::parseHeaders(const String& headerSection) {
         return Logger::error("Unsupported HTTP version");
     }
     // ! Validate URI length (414 URI Too Long)
-    if (uri.length() > MAX_URI_LENGTH && (errorCode = HTTP_URI_TOO_LONG))
+    if (uriLen > MAX_URI_LENGTH && (errorCode = HTTP_URI_TOO_LONG))
         return Logger::error("URI too long");
 
-    method = toUpperWords(method);
+    for (size_t i = 0; i < method.size(); ++i)
+        method[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(method[i])));
     // ! Check if method is recognized (501 Not Implemented for unknown methods)
     if (!checkAllowedMethods(method)) {
         errorCode = HTTP_NOT_IMPLEMENTED;
         return Logger::error("Method not implemented");
     }
 
-    if (!splitByChar(uri, uri, fragment, HASH))
-        fragment = "";
-    if (!splitByChar(uri, uri, queryString, QUESTION))
-        queryString = "";
-    else
-        queryString = urlDecode(queryString);
-    uri = urlDecode(uri);
+    // Split /path?query#fragment in place, then decode path and query
+    size_t uriEnd  = uriStart + uriLen;
+    size_t hashPos = headerSection.find(HASH, uriStart);
+    if (hashPos != String::npos && hashPos < uriEnd) {
+        fragment.assign(headerSection, hashPos + 1, uriEnd - hashPos - 1);
+        uriEnd = hashPos;
+    }
+    target.assign(headerSection, uriStart, uriEnd - uriStart);
+    size_t queryPos = headerSection.find(QUESTION, uriStart);
+    if (queryPos != String::npos && queryPos < uriEnd) {
+        assignUrlDecoded(queryString, headerSection, queryPos + 1, uriEnd - queryPos - 1);
+        uriEnd = queryPos;
+    }
+    assignUrlDecoded(uri, headerSection, uriStart, uriEnd - uriStart);
 
-    size_t pos = lineEnd + lineEndLen;
+    pos = lineEnd + lineEndLen;
     while (pos < headerSection.size()) {
         lineEnd    = headerSection.find(CRLF, pos);
         lineEndLen = 2;
@@ -158,30 +288,34 @@ bool HttpRequest::parseHeaders(const String& headerSection) {
             lineEnd    = headerSection.size();
             lineEndLen = 0;
         }
-
-        String line = headerSection.substr(pos, lineEnd - pos);
-        if (line.empty())
+        if (lineEnd == pos)
             break;
 
-        String key, value;
-        if (!splitByChar(line, key, value, COLON) && (errorCode = HTTP_BAD_REQUEST))
+        size_t colon = headerSection.find(COLON, pos);
+        if ((colon == String::npos || colon >= lineEnd) && (errorCode = HTTP_BAD_REQUEST))
             return Logger::error("Failed to parse header line");
 
-        String headerKey = toLowerWords(trimSpaces(key));
-        String headerVal = trimSpaces(value);
+        size_t keyStart = pos, keyLen = colon - pos;
+        size_t valStart = colon + 1, valLen = lineEnd - colon - 1;
+        trimRange(headerSection.data(), keyStart, keyLen);
+        trimRange(headerSection.data(), valStart, valLen);
 
-        if (headerKey == "content-length") {
-            if (hasNonEmptyValue(headers, headerKey)) {
-                errorCode = HTTP_BAD_REQUEST;
-                return Logger::error("Multiple Content-Length headers not allowed");
-            }
-            headers[headerKey] = headerVal;
+        ArenaString headerKey = arenaString(headerSection.data() + keyStart, keyLen);
+        for (size_t i = 0; i < headerKey.size(); ++i)
+            headerKey[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(headerKey[i])));
+
+        ArenaMapString::iterator it = headers.find(headerKey);
+        if (it == headers.end()) {
+            headers.insert(std::make_pair(headerKey, arenaString(headerSection.data() + valStart, valLen)));
+        } else if (it->second.empty()) {
+            it->second.assign(headerSection.data() + valStart, valLen);
+        } else if (headerKey == "content-length") {
+            errorCode = HTTP_BAD_REQUEST;
+            return Logger::error("Multiple Content-Length headers not allowed");
         } else {
             // RFC 7230: Multiple headers with same name should append with comma
-            if (!hasNonEmptyValue(headers, headerKey))
-                headers[headerKey] = headerVal;
-            else
-                headers[headerKey] += "," + headerVal;
+            it->second += ',';
+            it->second.append(headerSection.data() + valStart, valLen);
         }
         pos = lineEnd + lineEndLen;
     }
@@ -193,14 +327,14 @@ bool HttpRequest::parseHeaders(const String& headerSection) {
     }
 
     // ! Parse cookies if present
-    String cookieHeader = getValue(headers, String(HEADER_COOKIE), String());
-    if (!cookieHeader.empty())
-        parseCookies(cookieHeader);
+    const ArenaString* cookieHeader = findHeader(HEADER_COOKIE);
+    if (cookieHeader && !cookieHeader->empty())
+        parseCookies(cookieHeader->data(), cookieHeader->size());
 
     // ! Extract Content-Type
-    String ct = getValue(headers, String("content-type"), String());
-    if (!ct.empty())
-        contentType = ct;
+    const ArenaString* ct = findHeader("content-type");
+    if (ct && !ct->empty())
+        contentType.assign(ct->data(), ct->size());
 
     // ! Validate and extract Content-Length
     if (!validateContentLength()) {
@@ -208,14 +342,29 @@ bool HttpRequest::parseHeaders(const String& headerSection) {
     }
 
     // ! Extract host and port
-    String portStr;
-    String hostHeader = getValue(headers, String(HEADER_HOST), String());
-    if (!hostHeader.empty()) {
-        if (!splitByChar(hostHeader, host, portStr, COLON)) {
-            host = hostHeader;
-        } else if (!stringToType<int>(portStr, port) || port < 1 || port > 65535) {
-            errorCode = HTTP_BAD_REQUEST;
-            return Logger::error("Invalid port number in Host header");
+    const ArenaString* hostHeader = findHeader(HEADER_HOST);
+    if (hostHeader && !hostHeader->empty()) {
+        // an IPv6 literal is bracketed: the port colon comes after ']'
+        size_t hostEnd  = ((*hostHeader)[0] == '[') ? hostHeader->find(']') : 0;
+        size_t colonPos = hostEnd == ArenaString::npos ? ArenaString::npos : hostHeader->find(COLON, hostEnd);
+        if (colonPos == ArenaString::npos) {
+            host.assign(hostHeader->data(), hostHeader->size());
+        } else {
+            host.assign(hostHeader->data(), colonPos);
+            size_t portLen = hostHeader->size() - colonPos - 1;
+            port           = 0;
+            for (size_t i = colonPos + 1; i < hostHeader->size() && port <= 65535; ++i) {
+                char c = (*hostHeader)[i];
+                if (!std::isdigit(static_cast<unsigned char>(c))) {
+                    port = 0;
+                    break;
+                }
+                port = port * 10 + (c - '0');
+            }
+            if (portLen == 0 || port < 1 || port > 65535) {
+                errorCode = HTTP_BAD_REQUEST;
+                return Logger::error("Invalid port number in Host header");
+            }
         }
     }
     return true;
@@ -226,7 +375,8 @@ bool HttpRequest::parseBody(const String& bodySection) {
     // ! If method typically has a body (POST, PUT, PATCH)
     bool methodExpectsBody = (method == METHOD_POST || method == METHOD_PUT || method == METHOD_PATCH);
 
-    if (hasNonEmptyValue(headers, String("content-length"))) {
+    const ArenaString* cl = findHeader("content-length");
+    if (cl && !cl->empty()) {
         // ! Content-Length is present, validate body size matches
         if (body.size() != contentLength) {
             errorCode = HTTP_BAD_REQUEST;
@@ -253,8 +403,8 @@ bool HttpRequest::parseBody(const String& bodySection) {
 bool HttpRequest::validateHostHeader() {
     // ! HTTP/1.1 requires Host header
     if (httpVersion == HTTP_VERSION_1_1) {
-        MapString::const_iterator it = headers.find(HEADER_HOST);
-        if (it == headers.end() || it->second.empty()) {
+        const ArenaString* hostHeader = findHeader(HEADER_HOST);
+        if (!hostHeader || hostHeader->empty()) {
             return false;
         }
     }
@@ -262,35 +412,47 @@ bool HttpRequest::validateHostHeader() {
 }
 
 bool HttpRequest::validateContentLength() {
-    MapString::const_iterator it = headers.find("content-length");
-    if (it == headers.end() || it->second.empty()) {
+    const ArenaString* clValue = findHeader("content-length");
+    if (!clValue || clValue->empty()) {
         contentLength = 0;
         return true;
     }
-    const String& clValue = it->second;
-    for (size_t i = 0; i < clValue.length(); ++i) {
-        if (!std::isdigit(clValue[i])) {
-            errorCode = HTTP_BAD_REQUEST;
+    contentLength = 0;
+    for (size_t i = 0; i < clValue->length(); ++i) {
+        char c = (*clValue)[i];
+        if (!std::isdigit(static_cast<unsigned char>(c)) || contentLength > (SIZE_MAX - (c - '0')) / 10) {
+            contentLength = 0;
+            errorCode     = HTTP_BAD_REQUEST;
             return false;
         }
-    }
-    std::stringstream ss(clValue);
-    ss >> contentLength;
-    if (ss.fail()) {
-        errorCode = HTTP_BAD_REQUEST;
-        return false;
+        contentLength = contentLength * 10 + (c - '0');
     }
     return true;
 }
 // ? example Cookie: "key1=value1; key2=value2; key3=value3" & "session=42; theme=dark; lang=en"
 void HttpRequest::parseCookies(const String& cookieHeader) {
-    VectorString cookiePairs;
-    splitByString(cookieHeader, cookiePairs, ";");
-    for (size_t i = 0; i < cookiePairs.size(); ++i) {
-        String key, value;
-        if (splitByChar(trimSpaces(cookiePairs[i]), key, value, EQUALS)) {
-            cookies[trimSpaces(key)] = trimSpaces(value);
+    parseCookies(cookieHeader.data(), cookieHeader.size());
+}
+
+// Scans the header value where it lies; only the keys and values land in the arena
+void HttpRequest::parseCookies(const char* data, size_t len) {
+    size_t start = 0;
+    while (start <= len) {
+        const char* semicolon = static_cast<const char*>(std::memchr(data + start, SEMICOLON, len - start));
+        size_t      end       = semicolon ? static_cast<size_t>(semicolon - data) : len;
+        size_t      pairStart = start, pairLen = end - start;
+        trimRange(data, pairStart, pairLen);
+        const char* eq = static_cast<const char*>(std::memchr(data + pairStart, EQUALS, pairLen));
+        if (eq) {
+            size_t keyStart = pairStart, keyLen = static_cast<size_t>(eq - data) - pairStart;
+            size_t valStart = keyStart + keyLen + 1, valLen = pairStart + pairLen - valStart;
+            trimRange(data, keyStart, keyLen);
+            trimRange(data, valStart, valLen);
+            ArenaString key = arenaString(data + keyStart, keyLen);
+            cookies.erase(key);
+            cookies.insert(std::make_pair(key, arenaString(data + valStart, valLen)));
         }
+        start = end + 1;
     }
 }
 // Getters
@@ -300,23 +462,64 @@ const String& HttpRequest::getMethod() const {
 const String& HttpRequest::getUri() const {
     return uri;
 }
+const String& HttpRequest::getTarget() const {
+    return target;
+}
 const String& HttpRequest::getHttpVersion() const {
     return httpVersion;
 }
 String HttpRequest::getHeader(const String& key) const {
-    String                    lowerKey = toLowerWords(key);
-    MapString::const_iterator it       = headers.find(lowerKey);
-    if (it != headers.end()) {
-        return it->second;
-    }
+    const ArenaString* value = findHeader(key.data(), key.size());
+    if (value)
+        return String(value->data(), value->size());
     return "";
 }
-const MapString& HttpRequest::getHeaders() const {
+// Same as !getHeader(key).empty(), without copying the value
+bool HttpRequest::hasHeader(const char* lowerKey) const {
+    const ArenaString* value = findHeader(lowerKey);
+    return value && !value->empty();
+}
+
+// The whole value is the given token, in any case
+bool HttpRequest::headerEquals(const char* lowerKey, const char* value) const {
+    const ArenaString* found = findHeader(lowerKey);
+    if (!found)
+        return false;
+    size_t len = std::strlen(value);
+    return found->size() == len && strncasecmp(found->data(), value, len) == 0;
+}
+
+// Transfer-Encoding names chunked, in any case. Checked on the value in the
+// arena, without the copy getHeader() would make.
+bool HttpRequest::isChunked() const {
+    const ArenaString* te = findHeader("transfer-encoding");
+    if (!te)
+        return false;
+    for (size_t i = 0; i + 7 <= te->size(); ++i) {
+        if (strncasecmp(te->data() + i, "chunked", 7) == 0)
+            return true;
+    }
+    return false;
+}
+
+const ArenaMapString& HttpRequest::getHeaders() const {
     return headers;
 }
 const String& HttpRequest::getBody() const {
     return body;
 }
+size_t HttpRequest::getBodyReceived() const {
+    return bodyReceived;
+}
+void HttpRequest::addBodyReceived(size_t len) {
+    bodyReceived += len;
+}
+void HttpRequest::appendBody(const String& data) {
+    body += data;
+}
+ChunkedDecoder& HttpRequest::getChunkedDecoder() {
+    return bodyDecoder;
+}
 size_t HttpRequest::getContentLength() const {
     return contentLength;
 }
@@ -343,13 +546,13 @@ bool HttpRequest::hasBody() const {
     return !body.empty();
 }
 String HttpRequest::getCookie(const String& key) const {
-    const MapString::const_iterator it = cookies.find(key);
+    const ArenaMapString::const_iterator it = cookies.find(arenaString(key.data(), key.size()));
     if (it == cookies.end()) {
         return "";
     }
-    return it->second;
+    return String(it->second.data(), it->second.size());
 }
-const MapString& HttpRequest::getCookies() const {
+const ArenaMapString& HttpRequest::getCookies() const {
     return cookies;
 }
 int HttpRequest::getErrorCode() const {
@@ -358,4 +561,8 @@ int HttpRequest::getErrorCode() const {
 
 const String& HttpRequest::getQueryString() const {
     return queryString;
+}
+
+Arena& HttpRequest::getArena() const {
+    return arena;
 }
\ No newline at end of file
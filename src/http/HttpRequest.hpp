@@ -4,23 +4,35 @@
 #include <iostream>
 #include <map>
 #include <sstream>
+#include "../utils/Arena.hpp"
 #include "../utils/Utils.hpp"
+#include "ChunkedDecoder.hpp"
 
 class HttpRequest {
    private:
-    String    method;        // GET, POST, DELETE
-    String    uri;           // /path/to/resource
-    String    httpVersion;   // HTTP/1.1
-    String    queryString;   // ?key=value
-    String    fragment;      // #section
-    MapString headers;       // Header key-value pairs
-    String    body;          // Request body
-    String    contentType;   // e.g., text/html Mime type
-    size_t    contentLength; // e.g., 348
-    String    host;          // Host from Host header
-    int       port;          // Port from Host header
-    MapString cookies;       // Cookies from Cookie header
-    int       errorCode;     // HTTP error code (0 if no error)
+    mutable Arena  arena;         // Per-request scratch memory, reset by clear()
+    String         method;        // GET, POST, DELETE
+    String         uri;           // /path/to/resource
+    String         target;        // /path?query as sent, still percent-encoded
+    String         httpVersion;   // HTTP/1.1
+    String         queryString;   // ?key=value
+    String         fragment;      // #section
+    ArenaMapString headers;       // Header key-value pairs (arena backed)
+    String         body;          // Request body
+    String         contentType;   // e.g., text/html Mime type
+    size_t         contentLength; // e.g., 348
+    String         host;          // Host from Host header
+    int            port;          // Port from Host header
+    ArenaMapString cookies;       // Cookies from Cookie header (arena backed)
+    int            errorCode;     // HTTP error code (0 if no error)
+    size_t         bodyReceived;  // body bytes streamed straight to a handler
+    ChunkedDecoder bodyDecoder;   // state of a chunked body being streamed
+
+    ArenaString        arenaString(const char* data, size_t len) const;
+    const ArenaString* findHeader(const char* key) const;
+    const ArenaString* findHeader(const char* key, size_t len) const;
+    void               copyFrom(const HttpRequest& other);
+    void               parseCookies(const char* data, size_t len);
 
    public:
     HttpRequest();
@@ -35,23 +47,32 @@ class HttpRequest {
     void parseCookies(const String& cookieHeader);
 
     // Getters
-    const String&    getMethod() const;
-    const String&    getUri() const;
-    const String&    getHttpVersion() const;
-    String           getHeader(const String& key) const;
-    const MapString& getHeaders() const;
-    const String&    getBody() const;
-    size_t           getContentLength() const;
-    const String&    getContentType() const;
-    const String&    getHost() const;
-    int              getPort() const;
-    String           getCookie(const String& key) const;
-    const MapString& getCookies() const;
-    int              getErrorCode() const;
-    const String&    getQueryString() const;
+    const String&         getMethod() const;
+    const String&         getUri() const;
+    const String&         getTarget() const;
+    const String&         getHttpVersion() const;
+    String                getHeader(const String& key) const;
+    bool                  hasHeader(const char* lowerKey) const;
+    bool                  headerEquals(const char* lowerKey, const char* value) const;
+    bool                  isChunked() const;
+    const ArenaMapString& getHeaders() const;
+    const String&         getBody() const;
+    size_t                getBodyReceived() const;
+    ChunkedDecoder&       getChunkedDecoder();
+    size_t                getContentLength() const;
+    const String&         getContentType() const;
+    const String&         getHost() const;
+    int                   getPort() const;
+    String                getCookie(const String& key) const;
+    const ArenaMapString& getCookies() const;
+    int                   getErrorCode() const;
+    const String&         getQueryString() const;
+    Arena&                getArena() const;
 
     // Setters
     void setPort(int serverPort);
+    void addBodyReceived(size_t len);
+    void appendBody(const String& data);
 
     // Validators
     bool isComplete() const;
@@ -26,8 +26,25 @@ void HttpResponse::setStatus(int code, const String& msg) {
     statusCode    = code;
     statusMessage = msg;
 }
+// Case-insensitive, since CGI scripts spell header names as they like
+// Index of the header, or headers.size()
+size_t HttpResponse::findHeader(const String& key) const {
+    size_t i = 0;
+    while (i < headers.size() && !equalsIgnoreCase(headers[i].first, key))
+        ++i;
+    return i;
+}
+
+// Replaces a header of the same name
 void HttpResponse::addHeader(const String& key, const String& value) {
-    headers[key] = value;
+    size_t i = findHeader(key);
+    if (i < headers.size()) {
+        headers[i].second = value;
+        return;
+    }
+    if (headers.empty())
+        headers.reserve(RESPONSE_HEADERS_RESERVE);
+    headers.push_back(std::make_pair(key, value));
 }
 
 void HttpResponse::addSetCookie(const String& cookie) {
@@ -51,6 +68,11 @@ void HttpResponse::setBody(const String& _body) {
     body = _body;
 }
 
+// Takes the caller's buffer instead of copying it; the old body ends up there
+void HttpResponse::swapBody(String& _body) {
+    body.swap(_body);
+}
+
 void HttpResponse::setHttpVersion(const String& version) {
     httpVersion = version;
 }
@@ -59,20 +81,62 @@ const String& HttpResponse::getBody() const {
     return body;
 }
 
+bool HttpResponse::hasHeader(const String& key) const {
+    return findHeader(key) < headers.size();
+}
+
+String HttpResponse::getHeader(const String& key) const {
+    size_t i = findHeader(key);
+    return i < headers.size() ? headers[i].second : "";
+}
+
+void HttpResponse::removeHeader(const String& key) {
+    size_t i = findHeader(key);
+    if (i < headers.size())
+        headers.erase(headers.begin() + i);
+}
+
+bool HttpResponse::hasSetCookie() const {
+    return !setCookies.empty();
+}
+
 String HttpResponse::toString() {
+    String ss = headersToString();
+    ss += body;
+    return ss;
+}
+
+// Status line and headers up to the blank line, for responses whose body is sent separately
+String HttpResponse::headersToString() {
     String ss;
-    ss += httpVersion + " " + typeToString<int>(statusCode) + " " + statusMessage + "\r\n";
-    if (headers.find(HEADER_DATE) == headers.end())
-        addHeader(HEADER_DATE, formatDateTime());
-    if (headers.find(HEADER_SERVER) == headers.end())
-        addHeader(HEADER_SERVER, "Webserv/1.0");
-    for (MapString::const_iterator it = headers.begin(); it != headers.end(); ++it)
-        ss += it->first + ": " + it->second + "\r\n";
-    for (size_t i = 0; i < setCookies.size(); ++i)
-        ss += String(HEADER_SET_COOKIE) + ": " + setCookies[i] + "\r\n";
+    ss.reserve(256 + body.size());
+    // Appended piece by piece: operator+ would build a temporary for each
+    ss += httpVersion;
+    ss += ' ';
+    ss += typeToString<int>(statusCode);
+    ss += ' ';
+    ss += statusMessage;
+    ss += "\r\n";
+    for (VectorStringPair::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+        ss += it->first;
+        ss += ": ";
+        ss += it->second;
+        ss += "\r\n";
+    }
+    // written straight out: the date comes from the per-second cache
+    if (!hasHeader(HEADER_DATE)) {
+        ss += HEADER_DATE ": ";
+        ss += httpDate();
+        ss += "\r\n";
+    }
+    if (!hasHeader(HEADER_SERVER))
+        ss += HEADER_SERVER ": Webserv/1.0\r\n";
+    for (size_t i = 0; i < setCookies.size(); ++i) {
+        ss += HEADER_SET_COOKIE ": ";
+        ss += setCookies[i];
+        ss += "\r\n";
+    }
 
     ss += "\r\n";
-    ss += body;
-    Logger::debug("response Sent (" + typeToString<int>(statusCode) + "): " + statusMessage);
     return ss;
 }
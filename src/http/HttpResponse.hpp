@@ -17,18 +17,26 @@ class HttpResponse {
     void   addSetCookie(const String& cookie);
     void   setResponseHeaders(const String& contentType, size_t contentLength);
     void   setBody(const String&);
+    void   swapBody(String&);
     void   setHttpVersion(const String& version);
     const String& getBody() const;
+    bool   hasHeader(const String& key) const;
+    String getHeader(const String& key) const;
+    void   removeHeader(const String& key);
+    bool   hasSetCookie() const;
     String toString();
+    String headersToString();
     int    getStatusCode() const;
 
     const String& getStatusMessage() const;
 
    private:
+    size_t findHeader(const String& key) const;
+
     int          statusCode;
     String       statusMessage;
     String       httpVersion;
-    MapString    headers;
+    VectorStringPair headers; // few enough that a scan beats map nodes
     VectorString setCookies;
     String       body;
 };
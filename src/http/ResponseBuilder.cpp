@@ -11,7 +11,7 @@ ResponseBuilder& ResponseBuilder::operator=(const ResponseBuilder& other) {
 }
 ResponseBuilder::~ResponseBuilder() {}
 
-HttpResponse ResponseBuilder::build(const RouteResult& resultRouter, CgiProcess* cgi, const VectorInt& openFds) {
+HttpResponse ResponseBuilder::build(const RouteResult& resultRouter, CgiProcess* cgi, const VectorInt& openFds, FastCgiRequest* fcgi, ProxyRequest* proxy) {
     HttpResponse response;
 
     // Handle redirect
@@ -36,14 +36,18 @@ HttpResponse ResponseBuilder::build(const RouteResult& resultRouter, CgiProcess*
             if (handleDirectory(response, resultRouter))
                 return response;
             break;
-        case UPLOAD:
-            if (handleUpload(response, resultRouter))
-                return response;
-            break;
         case CGI:
             if (cgi && handleCgi(response, resultRouter, cgi, openFds))
                 return response;
             break;
+        case FASTCGI:
+            if (fcgi && handleFastCgi(response, resultRouter, fcgi))
+                return response;
+            break;
+        case PROXY:
+            if (proxy && handleProxy(response, resultRouter, proxy))
+                return response;
+            break;
         case STATIC:
             if (handleStatic(response, resultRouter))
                 return response;
@@ -52,7 +56,7 @@ HttpResponse ResponseBuilder::build(const RouteResult& resultRouter, CgiProcess*
             if (handleDelete(response, resultRouter))
                 return response;
             break;
-        default:
+        default: // UPLOAD is answered by ServerManager once the body is on disk
             break;
     }
 
@@ -93,41 +97,6 @@ bool ResponseBuilder::handleDirectory(HttpResponse& response, const RouteResult&
     return dirHandler.handle(resultRouter, response);
 }
 
-bool ResponseBuilder::handleUpload(HttpResponse& response, const RouteResult& resultRouter) const {
-    const LocationConfig* loc = resultRouter.getLocation();
-    if (!loc || !resultRouter.getIsUploadRequest())
-        return false;
-
-    UploaderHandler uploader;
-
-    String filename;
-    String fileContent;
-
-    // Check if this is a multipart/form-data upload
-    String contentType = resultRouter.getRequest().getContentType();
-    if (contentType.find("multipart/form-data") != String::npos) {
-        // Extract boundary from Content-Type
-        String boundary = extractBoundaryFromContentType(contentType);
-
-        // Parse multipart body to extract filename and content
-        if (boundary.empty() || !parseMultipartFormData(resultRouter.getRequest().getBody(), boundary, filename, fileContent)) {
-            // Fallback to timestamp-based filename
-            filename    = "upload_" + typeToString<time_t>(getCurrentTime()) + ".dat";
-            fileContent = resultRouter.getRequest().getBody();
-        }
-    } else {
-        // Not multipart, try to extract from Content-Disposition header or generate default
-        filename = extractFilenameFromHeader(resultRouter.getRequest().getHeader(HEADER_CONTENT_DISPOSITION));
-        if (filename.empty()) {
-            // Generate timestamp-based filename
-            filename = "upload_" + typeToString<time_t>(getCurrentTime()) + ".dat";
-        }
-        fileContent = resultRouter.getRequest().getBody();
-    }
-
-    return uploader.handle(loc->getUploadDir(), filename, fileContent, response);
-}
-
 void ResponseBuilder::handleError(HttpResponse& response, const RouteResult& resultRouter) {
     ErrorPageHandler handler;
     handler.handle(response, resultRouter, mimeTypes);
@@ -150,6 +119,20 @@ bool ResponseBuilder::handleCgi(HttpResponse& response, const RouteResult& resul
     return handler.handle(resultRouter, response, openFds);
 }
 
+bool ResponseBuilder::handleFastCgi(HttpResponse& response, const RouteResult& resultRouter, FastCgiRequest* fcgi) const {
+    if (!fcgi)
+        return false;
+    FastCgiHandler handler(*fcgi);
+    return handler.handle(resultRouter, response);
+}
+
+bool ResponseBuilder::handleProxy(HttpResponse& response, const RouteResult& resultRouter, ProxyRequest* proxy) const {
+    if (!proxy)
+        return false;
+    ProxyHandler handler(*proxy);
+    return handler.handle(resultRouter, response);
+}
+
 HttpResponse ResponseBuilder::buildCgiResponse(CgiProcess& cgi) {
     HttpResponse response;
     if (CgiHandler::parseOutput(cgi.getOutput(), response))
@@ -159,3 +142,14 @@ HttpResponse ResponseBuilder::buildCgiResponse(CgiProcess& cgi) {
     cgi.reset();
     return response;
 }
+
+// FCGI_STDOUT carries a CGI response, so it is parsed the same way as a forked script's output
+HttpResponse ResponseBuilder::buildFastCgiResponse(FastCgiRequest& fcgi) {
+    HttpResponse response;
+    if (CgiHandler::parseOutput(fcgi.getOutput(), response))
+        response.addHeader(HEADER_CONTENT_LENGTH, typeToString<size_t>(response.getBody().size()));
+    else
+        response = buildError(HTTP_BAD_GATEWAY, "Bad Gateway");
+    fcgi.reset();
+    return response;
+}
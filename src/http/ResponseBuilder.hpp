@@ -8,6 +8,8 @@
 #include "../handlers/DeleteHandler.hpp"
 #include "../handlers/DirectoryListingHandler.hpp"
 #include "../handlers/ErrorPageHandler.hpp"
+#include "../handlers/FastCgiHandler.hpp"
+#include "../handlers/ProxyHandler.hpp"
 #include "../handlers/StaticFileHandler.hpp"
 #include "../handlers/UploaderHandler.hpp"
 #include "../utils/Utils.hpp"
@@ -22,9 +24,10 @@ class ResponseBuilder {
     ResponseBuilder& operator=(const ResponseBuilder& other);
     ~ResponseBuilder();
 
-    HttpResponse build(const RouteResult& resultRouter, CgiProcess* cgi = NULL, const VectorInt& openFds = VectorInt());
+    HttpResponse build(const RouteResult& resultRouter, CgiProcess* cgi = NULL, const VectorInt& openFds = VectorInt(), FastCgiRequest* fcgi = NULL, ProxyRequest* proxy = NULL);
     HttpResponse buildError(int code, const std::string& msg);
     HttpResponse buildCgiResponse(CgiProcess& cgi);
+    HttpResponse buildFastCgiResponse(FastCgiRequest& fcgi);
 
    private:
     MimeTypes mimeTypes;
@@ -32,8 +35,9 @@ class ResponseBuilder {
     bool handleStatic(HttpResponse& response, const RouteResult& resultRouter) const;
     bool handleDelete(HttpResponse& response, const RouteResult& resultRouter) const;
     bool handleDirectory(HttpResponse& response, const RouteResult& resultRouter) const;
-    bool handleUpload(HttpResponse& response, const RouteResult& resultRouter) const;
     bool handleCgi(HttpResponse& response, const RouteResult& resultRouter, CgiProcess* cgi, const VectorInt& openFds) const;
+    bool handleFastCgi(HttpResponse& response, const RouteResult& resultRouter, FastCgiRequest* fcgi) const;
+    bool handleProxy(HttpResponse& response, const RouteResult& resultRouter, ProxyRequest* proxy) const;
     void handleError(HttpResponse& response, const RouteResult& resultRouter);
 };
 
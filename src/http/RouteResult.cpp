@@ -12,7 +12,7 @@ RouteResult::RouteResult()
       location(NULL),
       isCgiRequest(false),
       isUploadRequest(false),
-      request(),
+      request(NULL),
       handlerType(NOT_FOUND) {}
 
 RouteResult::RouteResult(const RouteResult& other)
@@ -108,7 +108,7 @@ void RouteResult::setUploadRequest(bool isUpload) {
 }
 
 void RouteResult::setRequest(const HttpRequest& req) {
-    request = req;
+    request = &req;
 }
 
 void RouteResult::setHandlerType(HandlerType type) {
@@ -171,7 +171,10 @@ bool RouteResult::getIsUploadRequest() const {
 }
 
 const HttpRequest& RouteResult::getRequest() const {
-    return request;
+    static const HttpRequest emptyRequest;
+    if (!request)
+        return emptyRequest;
+    return *request;
 }
 
 HandlerType RouteResult::getHandlerType() const {
@@ -57,7 +57,7 @@ class RouteResult {
     const LocationConfig* location;
     bool                  isCgiRequest;
     bool                  isUploadRequest;
-    HttpRequest           request;
+    const HttpRequest*    request; // owned by the Client, outlives the route
     HandlerType           handlerType;
     String                remoteAddress;
 };
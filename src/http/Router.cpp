@@ -1,13 +1,15 @@
 #include "Router.hpp"
 
 // Constructors / Destructor
-Router::Router() : _servers(NULL), _request() {}
-Router::Router(const VectorServerConfig& servers, const HttpRequest& request) : _servers(&servers), _request(request) {}
-Router::Router(const Router& other) : _servers(other._servers), _request(other._request) {}
+Router::Router() : _servers(NULL), _request(NULL) {}
+Router::Router(const VectorServerConfig& servers, const HttpRequest& request)
+    : _servers(&servers), _request(&request), _uri(normalizePath(request.getUri())) {}
+Router::Router(const Router& other) : _servers(other._servers), _request(other._request), _uri(other._uri) {}
 Router& Router::operator=(const Router& other) {
     if (this != &other) {
         _servers = other._servers;
         _request = other._request;
+        _uri     = other._uri;
     }
     return *this;
 }
@@ -19,10 +21,8 @@ void Router::resolveCgiScriptAndPathInfo(const LocationConfig* loc, String& scri
     if (!loc || !loc->hasCgi())
         return;
 
-    const String root    = loc->getRoot();
-    const String locPath = normalizePath(loc->getPath());
-    const String uri     = normalizePath(_request.getUri());
-    const String rest    = getUriRemainder(uri, locPath);
+    const String& root = loc->getRoot();
+    const String  rest = getUriRemainder(_uri, loc->getNormalizedPath());
 
     String directFile = joinPaths(root, rest);
     if (fileExists(directFile) && getFileType(directFile) == SINGLEFILE && isCgiRequest(directFile, *loc)) {
@@ -63,7 +63,7 @@ void Router::resolveCgiScriptAndPathInfo(const LocationConfig* loc, String& scri
 // Main request processing
 RouteResult Router::processRequest() {
     RouteResult result;
-    result.setRequest(_request);
+    result.setRequest(*_request);
 
     // 1. Find server
     const ServerConfig* srv = findServer();
@@ -83,14 +83,29 @@ RouteResult Router::processRequest() {
         return result.setRedirect(loc->getRedirectValue(), loc->getRedirectCode());
 
     // 4. Method check
-    String methodToCheck = _request.getMethod();
+    const String& methodToCheck = _request->getMethod();
     // this comment only for tester work 
     // if (methodToCheck == "HEAD")
     //     methodToCheck = "GET";
     if (!isKeyInVector(methodToCheck, loc->getAllowedMethods()))
         return result.setCodeAndMessage(HTTP_METHOD_NOT_ALLOWED, getHttpStatusMessage(HTTP_METHOD_NOT_ALLOWED));
 
-    // 5. CGI handling
+    // 5. FastCGI: the whole location is served by the upstream application
+    if (loc->hasFastcgi()) {
+        result.setPathRootUri(resolveFilesystemPath(loc));
+        result.setHandlerType(FASTCGI);
+        result.setStatusCode(HTTP_OK);
+        return result;
+    }
+
+    // 6. Proxy: the whole location is forwarded to the upstream HTTP server
+    if (loc->hasProxy()) {
+        result.setHandlerType(PROXY);
+        result.setStatusCode(HTTP_OK);
+        return result;
+    }
+
+    // 7. CGI handling
     if (loc->hasCgi()) {
         String scriptPath, pathInfo;
         resolveCgiScriptAndPathInfo(loc, scriptPath, pathInfo);
@@ -105,15 +120,15 @@ RouteResult Router::processRequest() {
         }
     }
 
-    // 6. Upload handling (POST/PUT to a location with upload_dir)
-    if (!loc->getUploadDir().empty() && (_request.getMethod() == "POST" || _request.getMethod() == "PUT")) {
+    // 8. Upload handling (POST/PUT to a location with upload_dir)
+    if (!loc->getUploadDir().empty() && (_request->getMethod() == "POST" || _request->getMethod() == "PUT")) {
         result.setUploadRequest(true);
         result.setHandlerType(UPLOAD);
         result.setStatusCode(HTTP_OK);
         return result;
     }
 
-    // 7. Resolve filesystem path for static/directory
+    // 9. Resolve filesystem path for static/directory
     String fsPath = resolveFilesystemPath(loc);
     if (!fileExists(fsPath))
         return result.setCodeAndMessage(HTTP_NOT_FOUND, getHttpStatusMessage(HTTP_NOT_FOUND));
@@ -156,8 +171,8 @@ RouteResult Router::processRequest() {
         return result.setCodeAndMessage(HTTP_NOT_FOUND, getHttpStatusMessage(HTTP_NOT_FOUND));
     result.setPathRootUri(fsPath);
 
-    // 8. Determine handler type based on method and file type
-    String method = _request.getMethod();
+    // 10. Determine handler type based on method and file type
+    const String& method = _request->getMethod();
     if (method == "DELETE") {
         result.setHandlerType(DELETE_FILE);
     } else if (method == "GET" || method == "HEAD") {
@@ -166,24 +181,34 @@ RouteResult Router::processRequest() {
         result.setHandlerType(NOT_FOUND);
     }
 
-    // 9. Compute remaining path
+    // 11. Compute remaining path
     String remaining;
-    if (_request.getUri().length() > result.getMatchedPath().length())
-        remaining = _request.getUri().substr(result.getMatchedPath().length());
+    if (_request->getUri().length() > result.getMatchedPath().length())
+        remaining = _request->getUri().substr(result.getMatchedPath().length());
     result.setRemainingPath(remaining);
     result.setStatusCode(HTTP_OK);
     return result;
 }
 
+// Whether processRequest() stats any path: not for a location that redirects
+// or is served by an upstream
+bool Router::needsFilesystem() const {
+    const ServerConfig* srv = findServer();
+    if (!srv)
+        return false;
+    const LocationConfig* loc = bestMatchLocation(srv->getLocations());
+    return loc && !loc->getIsRedirect() && !loc->hasFastcgi() && !loc->hasProxy();
+}
+
 // Server lookup
 const ServerConfig* Router::findServer() const {
     if (!_servers)
         return NULL;
-    int    port = _request.getPort();
-    String host = _request.getHost();
+    int           port = _request->getPort();
+    const String& host = _request->getHost();
 
     for (size_t i = 0; i < _servers->size(); ++i) {
-        if ((*_servers)[i].hasPort(port) && (*_servers)[i].hasServerName(host))
+        if (((*_servers)[i].hasPort(port) || (*_servers)[i].hasUnixListen()) && (*_servers)[i].hasServerName(host))
             return &(*_servers)[i];
     }
     return getDefaultServer(port);
@@ -193,20 +218,19 @@ const ServerConfig* Router::getDefaultServer(int port) const {
     if (!_servers)
         return NULL;
     for (size_t i = 0; i < _servers->size(); ++i)
-        if ((*_servers)[i].hasPort(port))
+        if ((*_servers)[i].hasPort(port) || (*_servers)[i].hasUnixListen())
             return &(*_servers)[i];
     return NULL;
 }
 
 // Best matching location
 const LocationConfig* Router::bestMatchLocation(const VectorLocationConfig& locations) const {
-    String                uri     = normalizePath(_request.getUri());
     const LocationConfig* best    = NULL;
     size_t                bestLen = 0;
 
     for (size_t i = 0; i < locations.size(); ++i) {
-        String path = normalizePath(locations[i].getPath());
-        if (pathStartsWith(uri, path) && path.length() > bestLen) {
+        const String& path = locations[i].getNormalizedPath();
+        if (pathStartsWith(_uri, path) && path.length() > bestLen) {
             best    = &locations[i];
             bestLen = path.length();
         }
@@ -219,11 +243,8 @@ String Router::resolveFilesystemPath(const LocationConfig* loc) const {
     if (!loc)
         return "";
 
-    String root    = loc->getRoot();                   // ./www
-    String locPath = normalizePath(loc->getPath());    // path for location like /uploads
-    String uri     = normalizePath(_request.getUri()); // actual request URI like /uploads/file.txt
-    String rest    = getUriRemainder(uri, locPath);    // the part of URI after location path
-    return joinPaths(root, rest);
+    // the part of the URI after the location path, like /file.txt of /uploads/file.txt
+    return joinPaths(loc->getRoot(), getUriRemainder(_uri, loc->getNormalizedPath()));
 }
 
 // Check CGI request
@@ -231,9 +252,11 @@ bool Router::isCgiRequest(const String& path, const LocationConfig& loc) const {
     if (!loc.hasCgi())
         return false;
 
-    String name, ext;
-    if (!splitByChar(path, name, ext, '.', true))
+    size_t dot = path.rfind('.');
+    if (dot == String::npos)
         return false;
-
-    return !loc.getCgiInterpreter("." + toLowerWords(ext)).empty();
+    String ext = path.substr(dot); // ".py", lowercased in place
+    for (size_t i = 1; i < ext.size(); ++i)
+        ext[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(ext[i])));
+    return !loc.getCgiInterpreter(ext).empty();
 }
@@ -19,6 +19,7 @@ class Router {
     ~Router();
 
     RouteResult processRequest();
+    bool        needsFilesystem() const;
 
    private:
     const ServerConfig*   findServer() const;
@@ -28,7 +29,8 @@ class Router {
     bool                  isCgiRequest(const String& path, const LocationConfig& loc) const;
     void                  resolveCgiScriptAndPathInfo(const LocationConfig* loc, String& scriptPath, String& pathInfo) const;
     const VectorServerConfig* _servers; // pointer to params from config (no copy)
-    HttpRequest               _request; // param from http request
+    const HttpRequest*        _request; // the client's request (no copy)
+    String                    _uri;     // request URI through normalizePath(), once per request
 };
 
 #endif
\ No newline at end of file
@@ -37,7 +37,7 @@ int main(int ac, char** av) {
             return 1;
         }
 
-        ServerManager serverManager(configs);
+        ServerManager serverManager(configs, parser.getHttpConfig());
         setupSignals();
         if (!serverManager.initialize()) {
             Logger::error("Failed to initialize server manager");
@@ -0,0 +1,135 @@
+#include "AioPool.hpp"
+#include <signal.h>
+#include <cerrno>
+#include <ctime>
+
+AioTask::AioTask(int ownerFd) : _ownerFd(ownerFd) {}
+
+AioTask::~AioTask() {}
+
+int AioTask::getOwnerFd() const {
+    return _ownerFd;
+}
+
+AioPool::AioPool() : _threads(), _queue(), _done(), _eventFd(INVALID_FD), _stopping(false) {
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_ready, NULL);
+}
+
+AioPool::~AioPool() {
+    stop();
+    pthread_cond_destroy(&_ready);
+    pthread_mutex_destroy(&_mutex);
+}
+
+// Threads start with every signal blocked, so SIGCHLD, SIGINT and SIGTERM are
+// still delivered to the loop thread and cut its poll() short
+bool AioPool::start(int threads) {
+    _eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_eventFd == INVALID_FD)
+        return Logger::error("aio eventfd failed");
+
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    for (int i = 0; i < threads; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, work, this) != 0)
+            break;
+        _threads.push_back(thread);
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (_threads.empty())
+        return Logger::error("aio threads could not be started");
+    return Logger::info("aio threads started: " + typeToString<size_t>(_threads.size()));
+}
+
+// A thread stuck in a read from a dead mount is given AIO_EXIT_WAIT seconds
+// and then left behind; the process is about to exit anyway
+void AioPool::stop() {
+    if (_eventFd == INVALID_FD)
+        return;
+    pthread_mutex_lock(&_mutex);
+    _stopping = true;
+    pthread_cond_broadcast(&_ready);
+    pthread_mutex_unlock(&_mutex);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += AIO_EXIT_WAIT;
+    for (size_t i = 0; i < _threads.size(); ++i) {
+        if (pthread_timedjoin_np(_threads[i], NULL, &deadline) != 0)
+            pthread_detach(_threads[i]);
+    }
+    _threads.clear();
+
+    pthread_mutex_lock(&_mutex);
+    for (size_t i = 0; i < _queue.size(); ++i)
+        delete _queue[i];
+    for (size_t i = 0; i < _done.size(); ++i)
+        delete _done[i];
+    _queue.clear();
+    _done.clear();
+    pthread_mutex_unlock(&_mutex);
+    close(_eventFd);
+    _eventFd = INVALID_FD;
+}
+
+bool AioPool::isEnabled() const {
+    return _eventFd != INVALID_FD;
+}
+
+int AioPool::getFd() const {
+    return _eventFd;
+}
+
+void AioPool::post(AioTask* task) {
+    pthread_mutex_lock(&_mutex);
+    _queue.push_back(task);
+    pthread_cond_signal(&_ready);
+    pthread_mutex_unlock(&_mutex);
+}
+
+// The counter is reset when the done queue runs empty, so a completion that
+// lands after the last pop bumps it again and the next poll() round sees it
+AioTask* AioPool::nextDone() {
+    AioTask* task = NULL;
+    pthread_mutex_lock(&_mutex);
+    if (_done.empty()) {
+        uint64_t count;
+        ssize_t  n = read(_eventFd, &count, sizeof(count));
+        (void)n;
+    } else {
+        task = _done.front();
+        _done.pop_front();
+    }
+    pthread_mutex_unlock(&_mutex);
+    return task;
+}
+
+void* AioPool::work(void* pool) {
+    static_cast<AioPool*>(pool)->serve();
+    return NULL;
+}
+
+void AioPool::serve() {
+    pthread_mutex_lock(&_mutex);
+    while (true) {
+        while (_queue.empty() && !_stopping)
+            pthread_cond_wait(&_ready, &_mutex);
+        if (_stopping)
+            break;
+        AioTask* task = _queue.front();
+        _queue.pop_front();
+        pthread_mutex_unlock(&_mutex);
+
+        task->run();
+
+        pthread_mutex_lock(&_mutex);
+        _done.push_back(task);
+        uint64_t one = 1;
+        ssize_t  n   = write(_eventFd, &one, sizeof(one));
+        (void)n;
+    }
+    pthread_mutex_unlock(&_mutex);
+}
@@ -0,0 +1,64 @@
+#ifndef AIO_POOL_HPP
+#define AIO_POOL_HPP
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <deque>
+#include <vector>
+#include "../utils/Logger.hpp"
+#include "../utils/Utils.hpp"
+
+// Blocking filesystem work handed off the event loop. run() is called on a
+// pool thread and must only touch the task's own data; the loop picks the
+// task up again from AioPool::nextDone() and tells tasks apart by kind.
+class AioTask {
+   public:
+    AioTask(int ownerFd);
+    virtual ~AioTask();
+
+    virtual void    run()           = 0;
+    virtual AioKind getKind() const = 0;
+    int             getOwnerFd() const;
+
+   private:
+    int _ownerFd; // client the result is for
+
+    AioTask(const AioTask&);
+    AioTask& operator=(const AioTask&);
+};
+
+// aio threads=N: N threads take tasks from a shared queue. A finished task
+// moves to the done queue and the eventfd is bumped, so poll() wakes the loop
+// the same way as for any other fd. The pool owns a task from post() until
+// nextDone() hands it back.
+class AioPool {
+   public:
+    AioPool();
+    ~AioPool();
+
+    bool     start(int threads);
+    void     stop();
+    bool     isEnabled() const;
+    int      getFd() const;
+    void     post(AioTask* task);
+    AioTask* nextDone();
+
+   private:
+    std::vector<pthread_t> _threads;
+    std::deque<AioTask*>   _queue; // waiting for a thread
+    std::deque<AioTask*>   _done;  // finished, not yet taken by the loop
+    pthread_mutex_t        _mutex;
+    pthread_cond_t         _ready;
+    int                    _eventFd;
+    bool                   _stopping;
+
+    static void* work(void* pool);
+    void         serve();
+
+    AioPool(const AioPool&);
+    AioPool& operator=(const AioPool&);
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "CgiCache.hpp"
+#include <algorithm>
+
+CgiCache::CgiCache() : _size(0) {}
+
+CgiCache::~CgiCache() {}
+
+// A request body could change the output, so only bodiless GETs qualify
+bool CgiCache::isCacheable(const RouteResult& res, bool hasBody) {
+    const LocationConfig* loc = res.getLocation();
+    return loc && loc->hasCgiCache() && !hasBody && res.getRequest().getMethod() == METHOD_GET;
+}
+
+String CgiCache::makeKey(const RouteResult& res) {
+    const HttpRequest&  req  = res.getRequest();
+    const VectorString& vary = res.getLocation()->getCgiCacheVary();
+    String              key  = res.getPathRootUri() + "?" + req.getQueryString();
+    for (size_t i = 0; i < vary.size(); ++i)
+        key += "\n" + vary[i] + ": " + req.getHeader(vary[i]);
+    return key;
+}
+
+bool CgiCache::lookup(const String& key, HttpResponse& out) {
+    EntryMap::iterator it = _entries.find(key);
+    if (it == _entries.end())
+        return false;
+    time_t now = getCurrentTime();
+    if (now >= it->second.expires) {
+        remove(it);
+        return false;
+    }
+    out = it->second.response;
+    out.addHeader("Age", typeToString<long>(static_cast<long>(now - it->second.stored)));
+    out.addHeader(HEADER_CACHE_STATUS, "HIT");
+    _lru.splice(_lru.begin(), _lru, it->second.lru);
+    return true;
+}
+
+// Only a plain 200 is kept: not one that sets a cookie or that the script
+// marked as not to be reused
+void CgiCache::store(const String& key, const String& output, int valid) {
+    HttpResponse response;
+    if (!CgiHandler::parseOutput(output, response) || response.getStatusCode() != HTTP_OK || response.hasSetCookie())
+        return;
+    String cacheControl = toLowerWords(response.getHeader("Cache-Control"));
+    if (cacheControl.find("no-store") != String::npos || cacheControl.find("private") != String::npos ||
+        cacheControl.find("no-cache") != String::npos)
+        return;
+    response.removeHeader(HEADER_TRANSFER_ENCODING);
+    response.removeHeader(HEADER_CONNECTION);
+    response.addHeader(HEADER_CONTENT_LENGTH, typeToString<size_t>(response.getBody().size()));
+
+    EntryMap::iterator old = _entries.find(key);
+    if (old != _entries.end())
+        remove(old);
+    Entry& entry   = _entries[key];
+    entry.response = response;
+    entry.size     = response.getBody().size();
+    entry.stored   = getCurrentTime();
+    entry.expires  = entry.stored + valid;
+    entry.lru      = _lru.insert(_lru.begin(), key);
+    _size += entry.size;
+
+    while ((_size > CGI_CACHE_MAX_SIZE || _entries.size() > CGI_CACHE_MAX_ENTRIES) && !_lru.empty())
+        remove(_entries.find(_lru.back()));
+}
+
+void CgiCache::clear() {
+    _entries.clear();
+    _lru.clear();
+    _locks.clear();
+    _size = 0;
+}
+
+// false: the script already runs for this key, and clientFd now waits for it
+bool CgiCache::lock(const String& key, int clientFd) {
+    LockMap::iterator it = _locks.find(key);
+    if (it == _locks.end()) {
+        _locks[key];
+        return true;
+    }
+    it->second.push_back(clientFd);
+    return false;
+}
+
+void CgiCache::unlock(const String& key, VectorInt& waiters) {
+    LockMap::iterator it = _locks.find(key);
+    if (it == _locks.end())
+        return;
+    waiters.swap(it->second);
+    _locks.erase(it);
+}
+
+void CgiCache::stopWaiting(const String& key, int clientFd) {
+    LockMap::iterator it = _locks.find(key);
+    if (it != _locks.end())
+        it->second.erase(std::remove(it->second.begin(), it->second.end(), clientFd), it->second.end());
+}
+
+void CgiCache::remove(EntryMap::iterator it) {
+    _size -= it->second.size;
+    _lru.erase(it->second.lru);
+    _entries.erase(it);
+}
@@ -0,0 +1,57 @@
+#ifndef CGI_CACHE_HPP
+#define CGI_CACHE_HPP
+
+#include <ctime>
+#include <list>
+#include <map>
+#include "../handlers/CgiHandler.hpp"
+#include "../http/HttpResponse.hpp"
+#include "../http/RouteResult.hpp"
+#include "../utils/Utils.hpp"
+
+// cgi_cache_valid: complete 200 responses of GET CGI requests, kept in
+// memory so a repeated request is answered without running the script. An
+// entry is found by script path, query string and the request's values of the
+// location's cgi_cache_vary headers. Past CGI_CACHE_MAX_ENTRIES entries or
+// CGI_CACHE_MAX_SIZE bytes, the least recently used go.
+//
+// A miss takes the key's lock and runs the script; identical requests that
+// find it taken wait, by client fd, until its output is stored.
+class CgiCache {
+   public:
+    CgiCache();
+    ~CgiCache();
+
+    bool lookup(const String& key, HttpResponse& out);
+    void store(const String& key, const String& output, int valid);
+    void clear();
+    bool lock(const String& key, int clientFd);
+    void unlock(const String& key, VectorInt& waiters);
+    void stopWaiting(const String& key, int clientFd);
+
+    static bool   isCacheable(const RouteResult& res, bool hasBody);
+    static String makeKey(const RouteResult& res);
+
+   private:
+    struct Entry {
+        HttpResponse                response; // Content-Length set, body included
+        size_t                      size;
+        time_t                      stored;
+        time_t                      expires;
+        std::list<String>::iterator lru;
+    };
+    typedef std::map<String, Entry>     EntryMap;
+    typedef std::map<String, VectorInt> LockMap;
+
+    EntryMap          _entries;
+    LockMap           _locks; // keys being run, and the clients waiting for them
+    std::list<String> _lru;  // keys, most recently used first
+    size_t            _size; // bytes of all cached bodies
+
+    void remove(EntryMap::iterator it);
+
+    CgiCache(const CgiCache&);
+    CgiCache& operator=(const CgiCache&);
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "CgiQueue.hpp"
+
+CgiQueue::Gate::Gate() : running(0), max(0), queueSize(0), timeout(0), waiting() {}
+
+CgiQueue::CgiQueue() : _gates(), _locations(), _running(), _waiting() {}
+
+CgiQueue::~CgiQueue() {}
+
+void CgiQueue::addLocation(const LocationConfig* location, const String& key) {
+    if (!location->hasCgiLimit())
+        return;
+    Gate& gate           = _gates[key];
+    gate.max             = location->getCgiMaxConcurrency();
+    gate.queueSize       = location->getCgiQueueSize();
+    gate.timeout         = location->getCgiQueueTimeout();
+    _locations[location] = &gate;
+}
+
+bool CgiQueue::isLimited(const LocationConfig* location) const {
+    return find(location) != NULL;
+}
+
+// Takes a slot for the client when one is free
+bool CgiQueue::acquire(const LocationConfig* location, int clientFd) {
+    Gate* gate = find(location);
+    if (!gate || gate->running >= gate->max)
+        return false;
+    ++gate->running;
+    _running[clientFd] = gate;
+    return true;
+}
+
+// Returns false when the queue is full
+bool CgiQueue::enqueue(const LocationConfig* location, int clientFd) {
+    Gate* gate = find(location);
+    if (!gate || gate->waiting.size() >= gate->queueSize)
+        return false;
+    Waiter waiter = {clientFd, getCurrentTime()};
+    gate->waiting.push_back(waiter);
+    _waiting[clientFd] = gate;
+    return true;
+}
+
+// Gives back the client's slot, or its place in a queue. Safe to call for a
+// client that holds neither.
+void CgiQueue::release(int clientFd) {
+    ClientMap::iterator it = _running.find(clientFd);
+    if (it != _running.end()) {
+        --it->second->running;
+        _running.erase(it);
+        return;
+    }
+    it = _waiting.find(clientFd);
+    if (it == _waiting.end())
+        return;
+    std::deque<Waiter>& waiting = it->second->waiting;
+    for (size_t i = 0; i < waiting.size(); ++i) {
+        if (waiting[i].fd == clientFd) {
+            waiting.erase(waiting.begin() + i);
+            break;
+        }
+    }
+    _waiting.erase(it);
+}
+
+// The first waiting client of a gate with a free slot; the slot is already
+// taken on its behalf. INVALID_FD when there is none.
+int CgiQueue::nextReady() {
+    if (_waiting.empty())
+        return INVALID_FD;
+    for (GateMap::iterator it = _gates.begin(); it != _gates.end(); ++it) {
+        Gate& gate = it->second;
+        if (gate.waiting.empty() || gate.running >= gate.max)
+            continue;
+        int fd = gate.waiting.front().fd;
+        gate.waiting.pop_front();
+        _waiting.erase(fd);
+        ++gate.running;
+        _running[fd] = &gate;
+        return fd;
+    }
+    return INVALID_FD;
+}
+
+// Queues are in arrival order, so only their heads can have timed out
+int CgiQueue::nextExpired() {
+    if (_waiting.empty())
+        return INVALID_FD;
+    time_t now = getCurrentTime();
+    for (GateMap::iterator it = _gates.begin(); it != _gates.end(); ++it) {
+        Gate& gate = it->second;
+        if (gate.waiting.empty() || getDifferentTime(gate.waiting.front().since, now) < gate.timeout)
+            continue;
+        int fd = gate.waiting.front().fd;
+        gate.waiting.pop_front();
+        _waiting.erase(fd);
+        return fd;
+    }
+    return INVALID_FD;
+}
+
+CgiQueue::Gate* CgiQueue::find(const LocationConfig* location) const {
+    LocationMap::const_iterator it = _locations.find(location);
+    return it == _locations.end() ? NULL : it->second;
+}
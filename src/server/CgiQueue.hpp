@@ -0,0 +1,55 @@
+#ifndef CGI_QUEUE_HPP
+#define CGI_QUEUE_HPP
+
+#include <deque>
+#include <map>
+#include "../config/LocationConfig.hpp"
+#include "../utils/Utils.hpp"
+
+// cgi_max_concurrency: at most N CGI requests of a location run at once. The
+// ones over the limit wait in arrival order, up to cgi_queue_size of them and
+// for at most cgi_queue_timeout seconds. Each listener routes through its own
+// copy of the server blocks, so locations register under a key and copies of
+// the same location share one gate.
+class CgiQueue {
+   public:
+    CgiQueue();
+    ~CgiQueue();
+
+    void addLocation(const LocationConfig* location, const String& key);
+    bool isLimited(const LocationConfig* location) const;
+    bool acquire(const LocationConfig* location, int clientFd);
+    bool enqueue(const LocationConfig* location, int clientFd);
+    void release(int clientFd);
+    int  nextReady();
+    int  nextExpired();
+
+   private:
+    struct Waiter {
+        int    fd;
+        time_t since;
+    };
+    struct Gate {
+        size_t             running;
+        size_t             max;
+        size_t             queueSize;
+        int                timeout;
+        std::deque<Waiter> waiting;
+        Gate();
+    };
+    typedef std::map<String, Gate>                 GateMap;
+    typedef std::map<const LocationConfig*, Gate*> LocationMap;
+    typedef std::map<int, Gate*>                   ClientMap;
+
+    GateMap     _gates;
+    LocationMap _locations;
+    ClientMap   _running; // client fd -> gate it holds a slot of
+    ClientMap   _waiting; // client fd -> gate it waits in
+
+    Gate* find(const LocationConfig* location) const;
+
+    CgiQueue(const CgiQueue&);
+    CgiQueue& operator=(const CgiQueue&);
+};
+
+#endif
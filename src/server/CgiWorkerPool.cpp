@@ -0,0 +1,199 @@
+#include "CgiWorkerPool.hpp"
+
+extern char** environ;
+
+CgiWorkerPool::Worker::Worker() : pid(-1), writeFd(INVALID_FD), readFd(INVALID_FD), requests(0), lastUsed(0), busy(false) {}
+
+CgiWorkerPool::CgiWorkerPool() : _pools(), _exiting(), _lastMaintain(0) {}
+
+CgiWorkerPool::~CgiWorkerPool() {
+    clear();
+}
+
+void CgiWorkerPool::prespawn(const String& interpreter, const CgiWorkerConfig& config) {
+    Pool& pool = getPool(interpreter, config);
+    while (pool.workers.size() < pool.config.getMin() && spawn(pool))
+        ;
+}
+
+// Returns -1 when every worker is busy and the pool is at max, or spawning
+// failed; the caller then runs the script as a regular forked CGI.
+pid_t CgiWorkerPool::acquire(const String& interpreter, const CgiWorkerConfig& config, int& writeFd, int& readFd) {
+    Pool&   pool   = getPool(interpreter, config);
+    Worker* worker = NULL;
+    while (!worker) {
+        // The most recently used idle worker goes first, so the others can age out
+        size_t index = pool.workers.size();
+        for (size_t i = 0; i < pool.workers.size(); ++i) {
+            if (!pool.workers[i].busy && (index == pool.workers.size() || pool.workers[i].lastUsed >= pool.workers[index].lastUsed))
+                index = i;
+        }
+        if (index == pool.workers.size())
+            break;
+        if (!reapIfExited(pool.workers[index]))
+            worker = &pool.workers[index];
+        else
+            pool.workers.erase(pool.workers.begin() + index);
+    }
+    if (!worker) {
+        if (pool.workers.size() >= pool.config.getMax() || !spawn(pool))
+            return -1;
+        worker = &pool.workers.back();
+    }
+    worker->busy = true;
+    writeFd      = worker->writeFd;
+    readFd       = worker->readFd;
+    return worker->pid;
+}
+
+// A worker that did not finish its response cleanly is out of sync with the
+// framing and is never reused.
+void CgiWorkerPool::release(pid_t pid, bool reusable) {
+    for (PoolMap::iterator it = _pools.begin(); it != _pools.end(); ++it) {
+        std::vector<Worker>& workers = it->second.workers;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            if (workers[i].pid != pid)
+                continue;
+            workers[i].busy     = false;
+            workers[i].lastUsed = getCurrentTime();
+            if (!reusable || ++workers[i].requests >= it->second.config.getMaxRequests()) {
+                stop(workers[i]);
+                workers.erase(workers.begin() + i);
+            }
+            return;
+        }
+    }
+}
+
+void CgiWorkerPool::retire(pid_t pid) {
+    release(pid, false);
+}
+
+// Runs at most once a second from the event loop
+void CgiWorkerPool::maintain() {
+    time_t now = getCurrentTime();
+    if (getDifferentTime(_lastMaintain, now) < 1)
+        return;
+    _lastMaintain = now;
+
+    for (size_t i = 0; i < _exiting.size();) {
+        if (waitpid(_exiting[i], NULL, WNOHANG) != 0)
+            _exiting.erase(_exiting.begin() + i);
+        else
+            ++i;
+    }
+    for (PoolMap::iterator it = _pools.begin(); it != _pools.end(); ++it) {
+        Pool&                pool    = it->second;
+        std::vector<Worker>& workers = pool.workers;
+        for (size_t i = 0; i < workers.size();) {
+            Worker& w       = workers[i];
+            bool    dropped = false;
+            if (!w.busy) {
+                dropped = reapIfExited(w);
+                if (!dropped && workers.size() > pool.config.getMin() && getDifferentTime(w.lastUsed, now) > pool.config.getIdleTimeout()) {
+                    stop(w);
+                    dropped = true;
+                }
+            }
+            if (dropped)
+                workers.erase(workers.begin() + i);
+            else
+                ++i;
+        }
+        while (workers.size() < pool.config.getMin() && spawn(pool))
+            ;
+    }
+}
+
+void CgiWorkerPool::clear() {
+    for (PoolMap::iterator it = _pools.begin(); it != _pools.end(); ++it) {
+        std::vector<Worker>& workers = it->second.workers;
+        for (size_t i = 0; i < workers.size(); ++i)
+            stop(workers[i]);
+    }
+    _pools.clear();
+    for (size_t i = 0; i < _exiting.size(); ++i) {
+        kill(_exiting[i], SIGKILL);
+        waitpid(_exiting[i], NULL, 0);
+    }
+    _exiting.clear();
+}
+
+size_t CgiWorkerPool::getWorkerCount() const {
+    size_t count = 0;
+    for (PoolMap::const_iterator it = _pools.begin(); it != _pools.end(); ++it)
+        count += it->second.workers.size();
+    return count;
+}
+
+CgiWorkerPool::Pool& CgiWorkerPool::getPool(const String& interpreter, const CgiWorkerConfig& config) {
+    String            key = interpreter + " " + config.getScript();
+    PoolMap::iterator it  = _pools.find(key);
+    if (it == _pools.end()) {
+        it                     = _pools.insert(std::make_pair(key, Pool())).first;
+        it->second.interpreter = interpreter;
+        it->second.config      = config;
+    }
+    return it->second;
+}
+
+// Parent ends are close-on-exec so CGIs and other workers never hold them;
+// the dup2 file actions give the worker its own stdin/stdout copies.
+bool CgiWorkerPool::spawn(Pool& pool) {
+    int toWorker[2];
+    int fromWorker[2];
+    if (pipe2(toWorker, O_CLOEXEC) == -1)
+        return Logger::error("CGI worker pipe failed");
+    if (pipe2(fromWorker, O_CLOEXEC) == -1) {
+        close(toWorker[0]);
+        close(toWorker[1]);
+        return Logger::error("CGI worker pipe failed");
+    }
+    VectorString argv;
+    argv.push_back(pool.interpreter);
+    argv.push_back(pool.config.getScript());
+    VectorString env;
+    for (char** var = environ; *var; ++var)
+        env.push_back(*var);
+
+    pid_t pid = CgiHandler::spawn(argv, env, toWorker[0], fromWorker[1], "");
+    if (pid < 0) {
+        close(toWorker[0]);
+        close(toWorker[1]);
+        close(fromWorker[0]);
+        close(fromWorker[1]);
+        return Logger::error("CGI worker spawn failed: " + pool.interpreter + " " + pool.config.getScript());
+    }
+    close(toWorker[0]);
+    close(fromWorker[1]);
+    setNonBlocking(toWorker[1]);
+    setNonBlocking(fromWorker[0]);
+
+    Worker worker;
+    worker.pid      = pid;
+    worker.writeFd  = toWorker[1];
+    worker.readFd   = fromWorker[0];
+    worker.lastUsed = getCurrentTime();
+    pool.workers.push_back(worker);
+    return true;
+}
+
+// An idle worker that died (crashed script, killed by hand) is dropped here
+// rather than handed a request it can never answer.
+bool CgiWorkerPool::reapIfExited(Worker& worker) {
+    if (waitpid(worker.pid, NULL, WNOHANG) == 0)
+        return false;
+    Logger::error("CGI worker " + typeToString<int>(worker.pid) + " exited");
+    close(worker.writeFd);
+    close(worker.readFd);
+    return true;
+}
+
+// Closing stdin is enough for a well-behaved worker; SIGTERM covers one stuck
+// in a script. The pid is reaped later by maintain().
+void CgiWorkerPool::stop(Worker& worker) {
+    close(worker.writeFd);
+    close(worker.readFd);
+    kill(worker.pid, SIGTERM);
+    _exiting.push_back(worker.pid);
+}
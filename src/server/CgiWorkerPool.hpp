@@ -0,0 +1,60 @@
+#ifndef CGI_WORKER_POOL_HPP
+#define CGI_WORKER_POOL_HPP
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <map>
+#include <vector>
+#include "../config/CgiWorkerConfig.hpp"
+#include "../handlers/CgiHandler.hpp"
+#include "../utils/Utils.hpp"
+
+// Pre-spawned interpreter processes for cgi_worker, keyed by the command line
+// (interpreter + worker script). acquire() hands out an idle worker or spawns
+// one below max; release() takes it back or retires it once it has served
+// max requests. maintain() reaps dead and idle workers and refills to min.
+class CgiWorkerPool {
+   public:
+    CgiWorkerPool();
+    ~CgiWorkerPool();
+
+    void   prespawn(const String& interpreter, const CgiWorkerConfig& config);
+    pid_t  acquire(const String& interpreter, const CgiWorkerConfig& config, int& writeFd, int& readFd);
+    void   release(pid_t pid, bool reusable);
+    void   retire(pid_t pid);
+    void   maintain();
+    void   clear();
+    size_t getWorkerCount() const;
+
+   private:
+    struct Worker {
+        pid_t  pid;
+        int    writeFd; // worker stdin
+        int    readFd;  // worker stdout
+        size_t requests;
+        time_t lastUsed;
+        bool   busy;
+        Worker();
+    };
+    struct Pool {
+        String              interpreter;
+        CgiWorkerConfig     config; // first location to use the command sets the limits
+        std::vector<Worker> workers;
+    };
+    typedef std::map<String, Pool> PoolMap;
+
+    PoolMap            _pools;
+    std::vector<pid_t> _exiting; // retired, waiting to be reaped
+    time_t             _lastMaintain;
+
+    Pool& getPool(const String& interpreter, const CgiWorkerConfig& config);
+    bool  spawn(Pool& pool);
+    bool  reapIfExited(Worker& worker);
+    void  stop(Worker& worker);
+
+    CgiWorkerPool(const CgiWorkerPool&);
+    CgiWorkerPool& operator=(const CgiWorkerPool&);
+};
+
+#endif
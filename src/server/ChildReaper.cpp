@@ -0,0 +1,127 @@
+#include "ChildReaper.hpp"
+
+int ChildReaper::_writeFd = INVALID_FD;
+
+ChildReaper::ChildReaper() : _children(), _exits(), _readFd(INVALID_FD), _reaped(0), _failed(0), _released(0) {}
+
+ChildReaper::~ChildReaper() {
+    if (_readFd == INVALID_FD)
+        return;
+    signal(SIGCHLD, SIG_DFL);
+    for (ChildMap::iterator it = _children.begin(); it != _children.end(); ++it) {
+        if (it->second.released)
+            kill(it->first, SIGKILL);
+    }
+    reap();
+    close(_readFd);
+    close(_writeFd);
+    _readFd  = INVALID_FD;
+    _writeFd = INVALID_FD;
+}
+
+// Both ends are non-blocking: a full pipe already means a wakeup is pending,
+// so the handler can drop its byte. SA_RESTART keeps other blocking calls
+// from failing with EINTR; poll() still returns early.
+bool ChildReaper::initialize() {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) == -1)
+        return Logger::error("SIGCHLD pipe failed");
+    _readFd  = fds[0];
+    _writeFd = fds[1];
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handleSignal;
+    action.sa_flags   = SA_RESTART | SA_NOCLDSTOP;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGCHLD, &action, NULL) == -1)
+        return Logger::error("SIGCHLD handler failed");
+    return true;
+}
+
+int ChildReaper::getFd() const {
+    return _readFd;
+}
+
+void ChildReaper::watch(pid_t pid, int ownerFd) {
+    Child child = {ownerFd, 0};
+    _children[pid] = child;
+}
+
+// The client is gone or timed out. Its pipes are closed, which is all a
+// script that is only flushing or exiting needs.
+void ChildReaper::release(pid_t pid) {
+    ChildMap::iterator it = _children.find(pid);
+    if (it == _children.end() || it->second.released)
+        return;
+    it->second.ownerFd  = INVALID_FD;
+    it->second.released = getCurrentTime();
+    ++_released;
+}
+
+void ChildReaper::killReleased() {
+    if (_released == 0)
+        return;
+    time_t now = getCurrentTime();
+    for (ChildMap::iterator it = _children.begin(); it != _children.end(); ++it) {
+        if (it->second.released && getDifferentTime(it->second.released, now) > CGI_EXIT_WAIT)
+            kill(it->first, SIGKILL);
+    }
+}
+
+// Drains the wakeup bytes first, so a SIGCHLD that arrives during the scan
+// leaves one behind and the next poll round scans again.
+void ChildReaper::reap() {
+    char buffer[64];
+    while (read(_readFd, buffer, sizeof(buffer)) > 0)
+        ;
+    for (ChildMap::iterator it = _children.begin(); it != _children.end();) {
+        int   status = 0;
+        pid_t ret    = waitpid(it->first, &status, WNOHANG);
+        if (ret == 0) {
+            ++it;
+            continue;
+        }
+        ++_reaped;
+        if (WIFSIGNALED(status)) {
+            ++_failed;
+            Logger::error("CGI " + typeToString<int>(it->first) + " killed by signal " + typeToString<int>(WTERMSIG(status)));
+        } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+            ++_failed;
+            Logger::error("CGI " + typeToString<int>(it->first) + " exited with status " + typeToString<int>(WEXITSTATUS(status)));
+        }
+        if (it->second.released) {
+            --_released;
+        } else {
+            Exit exit = {it->first, it->second.ownerFd, status};
+            _exits.push_back(exit);
+        }
+        _children.erase(it++);
+    }
+}
+
+bool ChildReaper::nextExit(pid_t& pid, int& ownerFd, int& status) {
+    if (_exits.empty())
+        return false;
+    pid     = _exits.front().pid;
+    ownerFd = _exits.front().ownerFd;
+    status  = _exits.front().status;
+    _exits.erase(_exits.begin());
+    return true;
+}
+
+size_t ChildReaper::getReapedCount() const {
+    return _reaped;
+}
+
+size_t ChildReaper::getFailedCount() const {
+    return _failed;
+}
+
+void ChildReaper::handleSignal(int signum) {
+    (void)signum;
+    if (_writeFd != INVALID_FD) {
+        ssize_t n = write(_writeFd, "", 1);
+        (void)n;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef CHILD_REAPER_HPP
+#define CHILD_REAPER_HPP
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <map>
+#include <vector>
+#include "../utils/Logger.hpp"
+#include "../utils/Utils.hpp"
+
+// SIGCHLD through a self-pipe: the handler only writes a byte, the event loop
+// polls the read end and reaps the watched CGI children with WNOHANG. A child
+// is never waited on, and its exit status is queued for the client that
+// spawned it. Only a child whose client gave up on it is killed, and only if
+// it is still running CGI_EXIT_WAIT seconds later. cgi_worker processes are
+// left to CgiWorkerPool.
+class ChildReaper {
+   public:
+    ChildReaper();
+    ~ChildReaper();
+
+    bool   initialize();
+    int    getFd() const;
+    void   watch(pid_t pid, int ownerFd);
+    void   release(pid_t pid);
+    void   killReleased();
+    void   reap();
+    bool   nextExit(pid_t& pid, int& ownerFd, int& status);
+    size_t getReapedCount() const;
+    size_t getFailedCount() const;
+
+   private:
+    struct Child {
+        int    ownerFd;
+        time_t released; // 0 while a client waits for it
+    };
+    struct Exit {
+        pid_t pid;
+        int   ownerFd;
+        int   status;
+    };
+    typedef std::map<pid_t, Child> ChildMap;
+
+    ChildMap          _children; // running pid -> owner
+    std::vector<Exit> _exits;    // reaped, not yet handed to the owner
+    int               _readFd;
+    size_t            _reaped;
+    size_t            _failed;   // non-zero exit or killed by a signal
+    size_t            _released; // children in _children nobody waits for
+
+    static int  _writeFd;
+    static void handleSignal(int signum);
+
+    ChildReaper(const ChildReaper&);
+    ChildReaper& operator=(const ChildReaper&);
+};
+
+#endif
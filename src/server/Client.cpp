@@ -1,6 +1,8 @@
 #include "Client.hpp"
 
-Client::Client() : client_fd(-1), lastActivity(0), _keepAlive(false), _headersParsed(false) {}
+Client::Client() : client_fd(-1), lastActivity(0), _keepAlive(false), _corked(false), _streaming(false), _headersParsed(false), _cgiQueued(false), _cgiCacheLock(CACHE_LOCK_NONE), _aioTask(NULL) {
+    std::memset(&remoteAddr, 0, sizeof(remoteAddr));
+}
 
 Client::Client(const Client& other)
     : client_fd(other.client_fd),
@@ -8,9 +10,20 @@ Client::Client(const Client& other)
       storeSendData(other.storeSendData),
       lastActivity(other.lastActivity),
       _cgi(other._cgi),
+      _fcgi(other._fcgi),
+      _proxy(other._proxy),
+      _multipart(other._multipart),
+      _rawUpload(other._rawUpload),
       _keepAlive(other._keepAlive),
+      _corked(other._corked),
+      _streaming(other._streaming),
+      remoteAddr(other.remoteAddr),
       remoteAddress(other.remoteAddress),
       _headersParsed(other._headersParsed),
+      _cgiQueued(other._cgiQueued),
+      _cgiCacheLock(other._cgiCacheLock),
+      _cgiCacheKey(other._cgiCacheKey),
+      _aioTask(other._aioTask),
       _request(other._request) {}
 
 Client& Client::operator=(const Client& other) {
@@ -20,16 +33,28 @@ Client& Client::operator=(const Client& other) {
         storeSendData    = other.storeSendData;
         lastActivity     = other.lastActivity;
         _cgi             = other._cgi;
+        _fcgi            = other._fcgi;
+        _proxy           = other._proxy;
+        _multipart       = other._multipart;
+        _rawUpload       = other._rawUpload;
         _keepAlive       = other._keepAlive;
+        _corked          = other._corked;
+        _streaming       = other._streaming;
+        remoteAddr       = other.remoteAddr;
         remoteAddress    = other.remoteAddress;
         _headersParsed   = other._headersParsed;
+        _cgiQueued       = other._cgiQueued;
+        _cgiCacheLock    = other._cgiCacheLock;
+        _cgiCacheKey     = other._cgiCacheKey;
+        _aioTask         = other._aioTask;
         _request         = other._request;
     }
     return *this;
 }
 
-Client::Client(int fd) : client_fd(fd), _keepAlive(false), _headersParsed(false) {
+Client::Client(int fd) : client_fd(fd), _keepAlive(false), _corked(false), _streaming(false), _headersParsed(false), _cgiQueued(false), _cgiCacheLock(CACHE_LOCK_NONE), _aioTask(NULL) {
     lastActivity = getCurrentTime();
+    std::memset(&remoteAddr, 0, sizeof(remoteAddr));
 }
 
 Client::~Client() {
@@ -41,11 +66,45 @@ Client::~Client() {
     storeSendData.clear();
 }
 
+// Recycle this object for a new connection (see ClientPool). Buffers keep their
+// capacity unless a large upload or response inflated them.
+void Client::reset(int fd) {
+    closeConnection();
+    if (_cgi.isActive())
+        _cgi.cleanup();
+    if (storeReceiveData.capacity() > CLIENT_BUFFER_KEEP)
+        String().swap(storeReceiveData);
+    if (storeSendData.capacity() > CLIENT_BUFFER_KEEP)
+        String().swap(storeSendData);
+    storeReceiveData.clear();
+    storeSendData.clear();
+    client_fd      = fd;
+    lastActivity   = getCurrentTime();
+    _cgi           = CgiProcess();
+    _fcgi.reset();
+    _proxy.reset();
+    _multipart.abort();
+    _rawUpload.abort();
+    _keepAlive     = false;
+    _corked        = false;
+    _streaming     = false;
+    _headersParsed = false;
+    _cgiQueued     = false;
+    _cgiCacheLock  = CACHE_LOCK_NONE;
+    _cgiCacheKey.clear();
+    _aioTask       = NULL;
+    std::memset(&remoteAddr, 0, sizeof(remoteAddr));
+    remoteAddress.clear();
+    _request.clear();
+}
+
+// Reads at most CLIENT_READ_BATCH bytes per wakeup: poll reports the rest,
+// and a body that is not being consumed stays in the socket.
 ssize_t Client::receiveData() {
     char    tmp[BUFFER_SIZE];
     ssize_t total = 0;
-    ssize_t n;
-    while ((n = read(client_fd, tmp, BUFFER_SIZE)) > 0) {
+    ssize_t n     = -1;
+    while (total < CLIENT_READ_BATCH && (n = read(client_fd, tmp, BUFFER_SIZE)) > 0) {
         storeReceiveData.append(tmp, n);
         total += n;
     }
@@ -64,15 +123,42 @@ ssize_t Client::sendData() {
         storeSendData.erase(0, sent);
         updateTime(lastActivity);
     }
+    // A short write of a complete response means the rest goes out over later
+    // POLLOUTs: cork so the kernel only emits full segments, and uncork once
+    // drained to flush the tail. Streamed output is never held back, since
+    // the next chunk may be a while coming.
+    if (!storeSendData.empty() && !_streaming && !_corked)
+        setCork(true);
+    else if ((storeSendData.empty() || _streaming) && _corked)
+        setCork(false);
     return sent;
 }
 
-void Client::setSendData(const String& data) {
-    storeSendData = data;
+void Client::setCork(bool on) {
+    int opt = on ? 1 : 0;
+    setsockopt(client_fd, IPPROTO_TCP, TCP_CORK, &opt, sizeof(opt));
+    _corked = on;
+}
+
+// A whole response, headers and body, that can be corked. It goes behind
+// whatever an earlier pipelined response still has unsent.
+void Client::queueResponse(const String& data) {
+    if (storeSendData.empty())
+        storeSendData = data;
+    else
+        storeSendData += data;
+    _streaming = false;
+}
+
+// Part of a response produced piece by piece (CGI, FastCGI, proxy)
+void Client::appendSendData(const String& data) {
+    storeSendData += data;
+    _streaming = true;
 }
 
-void Client::setRemoteAddress(const String& address) {
-    remoteAddress = address;
+void Client::setRemoteAddress(const struct sockaddr_storage& addr) {
+    remoteAddr = addr;
+    remoteAddress.clear();
 }
 
 void Client::clearStoreReceiveData() {
@@ -113,8 +199,23 @@ CgiProcess& Client::getCgi() {
 const CgiProcess& Client::getCgi() const {
     return _cgi;
 }
+FastCgiRequest& Client::getFastCgi() {
+    return _fcgi;
+}
+ProxyRequest& Client::getProxy() {
+    return _proxy;
+}
+MultipartUpload& Client::getMultipart() {
+    return _multipart;
+}
+RawUpload& Client::getRawUpload() {
+    return _rawUpload;
+}
 
-String Client::getRemoteAddress() const {
+// Only CGI and logging need the peer as text (REMOTE_ADDR), so it is formatted on demand
+const String& Client::getRemoteAddress() const {
+    if (remoteAddress.empty())
+        remoteAddress = sockaddrToString(remoteAddr);
     return remoteAddress;
 }
 
@@ -126,6 +227,35 @@ void Client::setHeadersParsed(bool parsed) {
     _headersParsed = parsed;
 }
 
+bool Client::isCgiQueued() const {
+    return _cgiQueued;
+}
+
+void Client::setCgiQueued(bool queued) {
+    _cgiQueued = queued;
+}
+
+CacheLock Client::getCgiCacheLock() const {
+    return _cgiCacheLock;
+}
+
+const String& Client::getCgiCacheKey() const {
+    return _cgiCacheKey;
+}
+
+void Client::setCgiCacheLock(CacheLock lock, const String& key) {
+    _cgiCacheLock = lock;
+    _cgiCacheKey  = key;
+}
+
+AioTask* Client::getAioTask() const {
+    return _aioTask;
+}
+
+void Client::setAioTask(AioTask* task) {
+    _aioTask = task;
+}
+
 HttpRequest& Client::getRequest() {
     return _request;
 }
@@ -1,24 +1,46 @@
 #ifndef CLIENT_HPP
 #define CLIENT_HPP
 
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <cstring>
 #include <ctime>
 #include <iostream>
 #include "../handlers/CgiProcess.hpp"
+#include "../handlers/FastCgiRequest.hpp"
+#include "../handlers/MultipartUpload.hpp"
+#include "../handlers/ProxyRequest.hpp"
+#include "../handlers/RawUpload.hpp"
 #include "../http/HttpRequest.hpp"
 #include "../utils/Utils.hpp"
+
+class AioTask;
+
 class Client {
    private:
-    int         client_fd;
-    String      storeReceiveData;
-    String      storeSendData;
-    time_t      lastActivity;
-    CgiProcess  _cgi;
-    bool        _keepAlive;
-    String      remoteAddress;
-    bool        _headersParsed;
-    HttpRequest _request;
+    int            client_fd;
+    String         storeReceiveData;
+    String         storeSendData;
+    time_t         lastActivity;
+    CgiProcess     _cgi;
+    FastCgiRequest _fcgi;
+    ProxyRequest   _proxy;
+    MultipartUpload _multipart;
+    RawUpload      _rawUpload;
+    bool           _keepAlive;
+    bool           _corked;    // TCP_CORK held while a response spans several writes
+    bool           _streaming; // send buffer last filled by appendSendData(): not corked
+    sockaddr_storage remoteAddr;
+    mutable String   remoteAddress; // formatted from remoteAddr on first use
+    bool           _headersParsed;
+    bool           _cgiQueued; // waiting for a cgi_max_concurrency slot
+    CacheLock      _cgiCacheLock; // cgi_cache_valid miss run for others, or waited for
+    String         _cgiCacheKey;
+    AioTask*       _aioTask;   // response being built on an aio thread
+    HttpRequest    _request;
 
    public:
     Client(const Client&);
@@ -27,10 +49,12 @@ class Client {
     Client();
     ~Client();
 
+    void          reset(int fd);
     ssize_t       receiveData();
     ssize_t       sendData();
-    void          setSendData(const String& data);
-    void          setRemoteAddress(const String& address);
+    void          queueResponse(const String& data);
+    void          appendSendData(const String& data);
+    void          setRemoteAddress(const struct sockaddr_storage& addr);
     void          clearStoreReceiveData();
     bool          isTimedOut(int timeout) const;
     void          closeConnection();
@@ -38,16 +62,30 @@ class Client {
     const String& getStoreReceiveData() const;
     const String& getStoreSendData() const;
     int           getFd() const;
-    String        getRemoteAddress() const;
+    const String& getRemoteAddress() const;
     bool          isHeadersParsed() const;
     void          setHeadersParsed(bool parsed);
+    bool          isCgiQueued() const;
+    void          setCgiQueued(bool queued);
+    CacheLock     getCgiCacheLock() const;
+    const String& getCgiCacheKey() const;
+    void          setCgiCacheLock(CacheLock lock, const String& key);
+    AioTask*      getAioTask() const;
+    void          setAioTask(AioTask* task);
     HttpRequest&  getRequest();
 
     CgiProcess&       getCgi();
     const CgiProcess& getCgi() const;
+    FastCgiRequest&   getFastCgi();
+    ProxyRequest&     getProxy();
+    MultipartUpload&  getMultipart();
+    RawUpload&        getRawUpload();
     void              setKeepAlive(bool keepAlive);
     bool              isKeepAlive() const;
     void              refreshActivity();
+
+   private:
+    void setCork(bool on);
 };
 
 #endif
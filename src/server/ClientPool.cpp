@@ -0,0 +1,50 @@
+#include "ClientPool.hpp"
+
+ClientPool::ClientPool() : _all(), _free() {
+    grow(CLIENT_POOL_PREALLOC);
+}
+
+ClientPool::ClientPool(size_t prealloc) : _all(), _free() {
+    grow(prealloc);
+}
+
+ClientPool::~ClientPool() {
+    for (size_t i = 0; i < _all.size(); ++i)
+        delete _all[i];
+    _all.clear();
+    _free.clear();
+}
+
+void ClientPool::grow(size_t count) {
+    _all.reserve(_all.size() + count);
+    _free.reserve(_all.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        Client* client = new Client();
+        _all.push_back(client);
+        _free.push_back(client);
+    }
+}
+
+Client* ClientPool::acquire(int fd) {
+    if (_free.empty())
+        grow(_all.empty() ? 1 : _all.size());
+    Client* client = _free.back();
+    _free.pop_back();
+    client->reset(fd);
+    return client;
+}
+
+void ClientPool::release(Client* client) {
+    if (!client)
+        return;
+    client->reset(INVALID_FD);
+    _free.push_back(client);
+}
+
+size_t ClientPool::getFreeCount() const {
+    return _free.size();
+}
+
+size_t ClientPool::getTotalCount() const {
+    return _all.size();
+}
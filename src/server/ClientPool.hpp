@@ -0,0 +1,32 @@
+#ifndef CLIENT_POOL_HPP
+#define CLIENT_POOL_HPP
+
+#include <vector>
+#include "../utils/Constants.hpp"
+#include "Client.hpp"
+
+// Free list of preconstructed clients. acquire() hands out a recycled Client
+// (buffers keep their capacity), release() puts it back, so accept/close
+// churn does not go through new/delete.
+class ClientPool {
+   public:
+    ClientPool();
+    ClientPool(size_t prealloc);
+    ~ClientPool();
+
+    Client* acquire(int fd);
+    void    release(Client* client);
+    size_t  getFreeCount() const;
+    size_t  getTotalCount() const;
+
+   private:
+    std::vector<Client*> _all;
+    std::vector<Client*> _free;
+
+    ClientPool(const ClientPool&);
+    ClientPool& operator=(const ClientPool&);
+
+    void grow(size_t count);
+};
+
+#endif
@@ -0,0 +1,255 @@
+#include "ConnectionTable.hpp"
+
+ConnectionTable::Slot::Slot()
+    : kind(FD_NONE),
+      client(NULL),
+      server(NULL),
+      ownerFd(INVALID_FD),
+      clientIndex(0),
+      idle(false),
+      idlePrev(INVALID_FD),
+      idleNext(INVALID_FD),
+      hasRoute(false),
+      route() {}
+
+ConnectionTable::ConnectionTable() : _slots(), _clientFds(), _idleHead(INVALID_FD), _idleTail(INVALID_FD) {
+    _slots.reserve(MAX_CONNECTIONS);
+    _clientFds.reserve(MAX_CONNECTIONS);
+}
+
+ConnectionTable::ConnectionTable(const ConnectionTable& other)
+    : _slots(other._slots), _clientFds(other._clientFds), _idleHead(other._idleHead), _idleTail(other._idleTail) {}
+
+ConnectionTable& ConnectionTable::operator=(const ConnectionTable& other) {
+    if (this != &other) {
+        _slots     = other._slots;
+        _clientFds = other._clientFds;
+        _idleHead  = other._idleHead;
+        _idleTail  = other._idleTail;
+    }
+    return *this;
+}
+
+ConnectionTable::~ConnectionTable() {}
+
+ConnectionTable::Slot* ConnectionTable::slotAt(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= _slots.size())
+        return NULL;
+    return &_slots[fd];
+}
+
+const ConnectionTable::Slot* ConnectionTable::slotAt(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= _slots.size())
+        return NULL;
+    return &_slots[fd];
+}
+
+ConnectionTable::Slot& ConnectionTable::ensureSlot(int fd) {
+    if (static_cast<size_t>(fd) >= _slots.size())
+        _slots.resize(fd + 1);
+    return _slots[fd];
+}
+
+void ConnectionTable::setListener(int fd, Server* server) {
+    if (fd < 0)
+        return;
+    Slot& slot  = ensureSlot(fd);
+    slot.kind   = FD_LISTENER;
+    slot.server = server;
+}
+
+void ConnectionTable::setClient(int fd, Client* client, Server* server) {
+    if (fd < 0)
+        return;
+    Slot& slot = ensureSlot(fd);
+    if (slot.kind != FD_CLIENT) {
+        slot.clientIndex = _clientFds.size();
+        _clientFds.push_back(fd);
+    }
+    slot.kind     = FD_CLIENT;
+    slot.client   = client;
+    slot.server   = server;
+    slot.hasRoute = false;
+}
+
+void ConnectionTable::setCgiPipe(int pipeFd, int clientFd) {
+    if (pipeFd < 0)
+        return;
+    Slot& slot   = ensureSlot(pipeFd);
+    slot.kind    = FD_CGI_PIPE;
+    slot.ownerFd = clientFd;
+}
+
+// An upstream connection with clientFd -1 is parked in the keep-alive pool
+void ConnectionTable::setUpstream(int fd, int clientFd) {
+    if (fd < 0)
+        return;
+    Slot& slot   = ensureSlot(fd);
+    slot.kind    = FD_FASTCGI;
+    slot.ownerFd = clientFd;
+}
+
+void ConnectionTable::setProxy(int fd, int clientFd) {
+    if (fd < 0)
+        return;
+    Slot& slot   = ensureSlot(fd);
+    slot.kind    = FD_PROXY;
+    slot.ownerFd = clientFd;
+}
+
+void ConnectionTable::setHealthProbe(int fd, int group) {
+    if (fd < 0)
+        return;
+    Slot& slot   = ensureSlot(fd);
+    slot.kind    = FD_HEALTH_PROBE;
+    slot.ownerFd = group;
+}
+
+void ConnectionTable::setSignal(int fd) {
+    if (fd < 0)
+        return;
+    ensureSlot(fd).kind = FD_SIGNAL;
+}
+
+void ConnectionTable::setAio(int fd) {
+    if (fd < 0)
+        return;
+    ensureSlot(fd).kind = FD_AIO;
+}
+
+// Slots are reset in place; the route keeps its string capacity for the next
+// connection that lands on the same fd.
+void ConnectionTable::remove(int fd) {
+    Slot* slot = slotAt(fd);
+    if (!slot)
+        return;
+    if (slot->kind == FD_CLIENT) {
+        markBusy(fd);
+        // swap-remove from the dense client list
+        int movedFd                  = _clientFds.back();
+        _clientFds[slot->clientIndex] = movedFd;
+        _slots[movedFd].clientIndex  = slot->clientIndex;
+        _clientFds.pop_back();
+    }
+    slot->kind     = FD_NONE;
+    slot->client   = NULL;
+    slot->server   = NULL;
+    slot->ownerFd  = INVALID_FD;
+    slot->hasRoute = false;
+}
+
+void ConnectionTable::clear() {
+    _slots.clear();
+    _clientFds.clear();
+    _idleHead = INVALID_FD;
+    _idleTail = INVALID_FD;
+}
+
+void ConnectionTable::setRoute(int fd, const RouteResult& route) {
+    Slot* slot = slotAt(fd);
+    if (!slot || slot->kind != FD_CLIENT)
+        return;
+    slot->route    = route;
+    slot->hasRoute = true;
+}
+
+void ConnectionTable::clearRoute(int fd) {
+    Slot* slot = slotAt(fd);
+    if (slot)
+        slot->hasRoute = false;
+}
+
+const RouteResult& ConnectionTable::getRoute(int fd) const {
+    static const RouteResult emptyRoute;
+    const Slot*              slot = slotAt(fd);
+    if (!slot || !slot->hasRoute)
+        return emptyRoute;
+    return slot->route;
+}
+
+FdKind ConnectionTable::getKind(int fd) const {
+    const Slot* slot = slotAt(fd);
+    return slot ? slot->kind : FD_NONE;
+}
+
+Client* ConnectionTable::getClient(int fd) const {
+    const Slot* slot = slotAt(fd);
+    if (!slot || slot->kind != FD_CLIENT)
+        return NULL;
+    return slot->client;
+}
+
+Server* ConnectionTable::getServer(int fd) const {
+    const Slot* slot = slotAt(fd);
+    if (!slot || (slot->kind != FD_LISTENER && slot->kind != FD_CLIENT))
+        return NULL;
+    return slot->server;
+}
+
+Client* ConnectionTable::getPipeOwner(int pipeFd) const {
+    const Slot* slot = slotAt(pipeFd);
+    if (!slot || slot->kind != FD_CGI_PIPE)
+        return NULL;
+    return getClient(slot->ownerFd);
+}
+
+Client* ConnectionTable::getUpstreamOwner(int fd) const {
+    const Slot* slot = slotAt(fd);
+    if (!slot || (slot->kind != FD_FASTCGI && slot->kind != FD_PROXY))
+        return NULL;
+    return getClient(slot->ownerFd);
+}
+
+int ConnectionTable::getProbeGroup(int fd) const {
+    const Slot* slot = slotAt(fd);
+    if (!slot || slot->kind != FD_HEALTH_PROBE)
+        return -1;
+    return slot->ownerFd;
+}
+
+const VectorInt& ConnectionTable::getClientFds() const {
+    return _clientFds;
+}
+
+size_t ConnectionTable::getClientCount() const {
+    return _clientFds.size();
+}
+
+// Appends to the tail: the head is always the client that went idle first,
+// which is the one to drop when a new connection needs its place.
+void ConnectionTable::markIdle(int fd) {
+    Slot* slot = slotAt(fd);
+    if (!slot || slot->kind != FD_CLIENT)
+        return;
+    if (slot->idle)
+        markBusy(fd);
+    slot->idle     = true;
+    slot->idlePrev = _idleTail;
+    slot->idleNext = INVALID_FD;
+    if (_idleTail != INVALID_FD)
+        _slots[_idleTail].idleNext = fd;
+    else
+        _idleHead = fd;
+    _idleTail = fd;
+}
+
+void ConnectionTable::markBusy(int fd) {
+    Slot* slot = slotAt(fd);
+    if (!slot || !slot->idle)
+        return;
+    if (slot->idlePrev != INVALID_FD)
+        _slots[slot->idlePrev].idleNext = slot->idleNext;
+    else
+        _idleHead = slot->idleNext;
+    if (slot->idleNext != INVALID_FD)
+        _slots[slot->idleNext].idlePrev = slot->idlePrev;
+    else
+        _idleTail = slot->idlePrev;
+    slot->idle     = false;
+    slot->idlePrev = INVALID_FD;
+    slot->idleNext = INVALID_FD;
+}
+
+int ConnectionTable::getOldestIdle() const {
+    return _idleHead;
+}
@@ -0,0 +1,77 @@
+#ifndef CONNECTION_TABLE_HPP
+#define CONNECTION_TABLE_HPP
+
+#include <vector>
+#include "../http/RouteResult.hpp"
+#include "../utils/Constants.hpp"
+#include "../utils/Enums.hpp"
+#include "../utils/Types.hpp"
+
+// Flat table indexed by file descriptor. The kernel hands out the lowest free
+// fd, so the table stays dense and every event is dispatched with one index
+// instead of a walk through several std::map.
+class ConnectionTable {
+   public:
+    ConnectionTable();
+    ConnectionTable(const ConnectionTable& other);
+    ConnectionTable& operator=(const ConnectionTable& other);
+    ~ConnectionTable();
+
+    void setListener(int fd, Server* server);
+    void setClient(int fd, Client* client, Server* server);
+    void setCgiPipe(int pipeFd, int clientFd);
+    void setUpstream(int fd, int clientFd);
+    void setProxy(int fd, int clientFd);
+    void setHealthProbe(int fd, int group);
+    void setSignal(int fd);
+    void setAio(int fd);
+    void remove(int fd);
+    void clear();
+
+    // The reference from getRoute() is only good until the next set*() call,
+    // which may grow the table
+    void               setRoute(int fd, const RouteResult& route);
+    void               clearRoute(int fd);
+    const RouteResult& getRoute(int fd) const;
+
+    FdKind           getKind(int fd) const;
+    Client*          getClient(int fd) const;
+    Server*          getServer(int fd) const;
+    Client*          getPipeOwner(int pipeFd) const;
+    Client*          getUpstreamOwner(int fd) const;
+    int              getProbeGroup(int fd) const;
+    const VectorInt& getClientFds() const;
+    size_t           getClientCount() const;
+
+    // Idle keep-alive clients, least recently used first
+    void markIdle(int fd);
+    void markBusy(int fd);
+    int  getOldestIdle() const;
+
+   private:
+    struct Slot {
+        FdKind      kind;
+        Client*     client;      // FD_CLIENT
+        Server*     server;      // FD_LISTENER, or the listener of a FD_CLIENT
+        int         ownerFd;     // FD_CGI_PIPE / FD_FASTCGI / FD_PROXY: client the fd works for (-1: idle upstream)
+                                 // FD_HEALTH_PROBE: index of the upstream group probed
+        size_t      clientIndex; // position in _clientFds
+        bool        idle;        // linked in the idle list
+        int         idlePrev;
+        int         idleNext;
+        bool        hasRoute;
+        RouteResult route;
+        Slot();
+    };
+
+    std::vector<Slot> _slots;
+    VectorInt         _clientFds; // dense list of client fds, for timeouts and shutdown
+    int               _idleHead;  // oldest idle client
+    int               _idleTail;  // most recently idled client
+
+    Slot*       slotAt(int fd);
+    const Slot* slotAt(int fd) const;
+    Slot&       ensureSlot(int fd);
+};
+
+#endif
@@ -17,13 +17,18 @@ PollManager::~PollManager() {
     _fdIndex.clear();
 }
 
+int PollManager::indexOf(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= _fdIndex.size())
+        return -1;
+    return _fdIndex[fd];
+}
+
 void PollManager::addFd(int fd, int events) {
     if (fd < 0)
         return;
 
-    std::map<int, size_t>::iterator it = _fdIndex.find(fd);
-    if (it != _fdIndex.end()) {
-        size_t idx       = it->second;
+    int idx = indexOf(fd);
+    if (idx >= 0) {
         fds[idx].events  = events;
         fds[idx].revents = 0;
         return;
@@ -33,7 +38,9 @@ void PollManager::addFd(int fd, int events) {
     pfd.fd      = fd;
     pfd.events  = events;
     pfd.revents = 0;
-    _fdIndex[fd] = fds.size();
+    if (static_cast<size_t>(fd) >= _fdIndex.size())
+        _fdIndex.resize(fd + 1, -1);
+    _fdIndex[fd] = static_cast<int>(fds.size());
     fds.push_back(pfd);
 }
 
@@ -41,29 +48,25 @@ void PollManager::removeFd(size_t index) {
     if (index >= fds.size())
         return;
 
-    int removedFd = fds[index].fd;
-    _fdIndex.erase(removedFd);
+    int removedFd       = fds[index].fd;
+    _fdIndex[removedFd] = -1;
     if (index < fds.size() - 1) {
-        fds[index] = fds.back();
-        _fdIndex[fds[index].fd] = index;
+        fds[index]              = fds.back();
+        _fdIndex[fds[index].fd] = static_cast<int>(index);
     }
     fds.pop_back();
 }
 
 void PollManager::removeFdByValue(int fd) {
-    std::map<int, size_t>::iterator it = _fdIndex.find(fd);
-    if (it != _fdIndex.end())
-        removeFd(it->second);
+    int idx = indexOf(fd);
+    if (idx >= 0)
+        removeFd(idx);
 }
 
 int PollManager::pollConnections(int timeout) {
     if (fds.empty())
         return 0;
-
-    for (size_t i = 0; i < fds.size(); i++) {
-        fds[i].revents = 0;
-    }
-
+    // poll() rewrites every revents itself, no need to clear them first
     return poll(&fds[0], fds.size(), timeout);
 }
 
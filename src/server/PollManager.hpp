@@ -10,7 +10,9 @@
 class PollManager {
    private:
     std::vector<struct pollfd> fds;
-    std::map<int, size_t>     _fdIndex;
+    VectorInt                  _fdIndex; // fd -> position in fds, -1 when not polled
+
+    int  indexOf(int fd) const;
 
    public:
     PollManager(const PollManager&);
@@ -0,0 +1,269 @@
+#include "ProxyCache.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+ProxyCache::ProxyCache() : _maxSize(0), _size(0), _serial(0) {}
+
+ProxyCache::~ProxyCache() {
+    clear();
+}
+
+// Bodies left by an earlier run have no index entry anymore, so they go
+bool ProxyCache::init(const String& dir, size_t maxSize) {
+    if (!ensureDirectoryExists(dir))
+        return Logger::error("Cannot create proxy_cache_path " + dir + ": " + std::strerror(errno));
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+        return Logger::error("Cannot open proxy_cache_path " + dir + ": " + std::strerror(errno));
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        String name = entry->d_name;
+        if (name.compare(0, std::strlen(PROXY_CACHE_FILE_PREFIX), PROXY_CACHE_FILE_PREFIX) == 0)
+            unlink(joinPaths(dir, name).c_str());
+    }
+    closedir(d);
+    _dir     = dir;
+    _maxSize = maxSize;
+    return true;
+}
+
+// Waiters are dropped too: nothing will be fetched for them anymore
+void ProxyCache::clear() {
+    while (!_entries.empty())
+        remove(_entries.begin());
+    _locks.clear();
+}
+
+bool ProxyCache::isEnabled() const {
+    return !_dir.empty();
+}
+
+// A response to a request with credentials may be meant for that user only
+bool ProxyCache::isCacheable(const HttpRequest& req) {
+    return (req.getMethod() == METHOD_GET || req.getMethod() == METHOD_HEAD) && req.getHeader("authorization").empty();
+}
+
+// HEAD is answered from the GET entry
+String ProxyCache::makeKey(const HttpRequest& req) {
+    return String(METHOD_GET) + " " + toLowerWords(req.getHeader(HEADER_HOST)) + " " + req.getTarget();
+}
+
+// ─── Lookup ──────────────────────────────────────────────────────────────────
+
+// An expired entry sends the request on to the upstream. A GET becomes the
+// one refreshing it, and until that finishes, requests within the
+// stale-while-revalidate window are answered with the old copy.
+CacheStatus ProxyCache::lookup(const String& key, const HttpRequest& req, HttpResponse& out) {
+    EntryMap::iterator it = _entries.find(variantKey(key, req));
+    if (it == _entries.end())
+        return CACHE_MISS;
+    Entry&      entry  = it->second;
+    time_t      now    = getCurrentTime();
+    CacheStatus status = CACHE_HIT;
+    if (now >= entry.expires) {
+        if (!entry.updating || now >= entry.staleUntil) {
+            if (req.getMethod() == METHOD_GET)
+                entry.updating = true;
+            return CACHE_EXPIRED;
+        }
+        status = CACHE_STALE;
+    }
+    String body;
+    if (req.getMethod() != METHOD_HEAD && (!readFileContent(entry.file, body) || body.size() != entry.size)) {
+        Logger::error("Cached body lost: " + entry.file);
+        remove(it);
+        return CACHE_MISS;
+    }
+    out = entry.head;
+    out.addHeader(HEADER_CONTENT_LENGTH, typeToString<size_t>(entry.size));
+    out.addHeader("Age", typeToString<long>(static_cast<long>(now - entry.stored)));
+    out.addHeader(HEADER_CACHE_STATUS, status == CACHE_HIT ? "HIT" : "STALE");
+    out.setBody(body);
+    _lru.splice(_lru.begin(), _lru, entry.lru);
+    return status;
+}
+
+void ProxyCache::cancelUpdate(const String& key, const HttpRequest& req) {
+    EntryMap::iterator it = _entries.find(variantKey(key, req));
+    if (it != _entries.end())
+        it->second.updating = false;
+}
+
+// ─── Cache lock ──────────────────────────────────────────────────────────────
+
+// The lock covers the base key, so variants of one URL share it. false: the
+// key is being fetched already, and clientFd now waits for it.
+bool ProxyCache::lock(const String& key, int clientFd) {
+    LockMap::iterator it = _locks.find(key);
+    if (it == _locks.end()) {
+        _locks[key];
+        return true;
+    }
+    it->second.push_back(clientFd);
+    return false;
+}
+
+void ProxyCache::unlock(const String& key, VectorInt& waiters) {
+    LockMap::iterator it = _locks.find(key);
+    if (it == _locks.end())
+        return;
+    waiters.swap(it->second);
+    _locks.erase(it);
+}
+
+void ProxyCache::stopWaiting(const String& key, int clientFd) {
+    LockMap::iterator it = _locks.find(key);
+    if (it != _locks.end())
+        it->second.erase(std::remove(it->second.begin(), it->second.end(), clientFd), it->second.end());
+}
+
+// ─── Store ───────────────────────────────────────────────────────────────────
+
+// Seconds the response stays fresh, 0 when it must not be stored:
+// s-maxage, then max-age, then Expires against Date, then proxy_cache_valid
+long ProxyCache::freshness(const HttpResponse& head, int defaultValid, long& staleWhileRevalidate) {
+    long         maxAge = -1, sharedMaxAge = -1;
+    VectorString directives;
+    splitByString(toLowerWords(head.getHeader("Cache-Control")), directives, ",");
+    for (size_t i = 0; i < directives.size(); ++i) {
+        String name = trimSpaces(directives[i]), value;
+        if (splitByChar(name, name, value, EQUALS))
+            value = trimQuotes(trimSpaces(value));
+        if (name == "no-store" || name == "private" || name == "no-cache")
+            return 0;
+        if (name == "max-age" && !stringToType<long>(value, maxAge))
+            return 0;
+        if (name == "s-maxage" && !stringToType<long>(value, sharedMaxAge))
+            return 0;
+        if (name == "stale-while-revalidate" && !stringToType<long>(value, staleWhileRevalidate))
+            staleWhileRevalidate = 0;
+    }
+    if (sharedMaxAge >= 0)
+        return sharedMaxAge;
+    if (maxAge >= 0)
+        return maxAge;
+    if (head.hasHeader("Expires")) {
+        time_t expires = parseHttpDate(head.getHeader("Expires"));
+        time_t date    = parseHttpDate(head.getHeader(HEADER_DATE));
+        if (date == -1)
+            date = getCurrentTime();
+        return expires == -1 ? 0 : static_cast<long>(expires - date);
+    }
+    return head.getStatusCode() == HTTP_OK ? defaultValid : 0;
+}
+
+// Replaces whatever the key held: a refreshed response that cannot be stored
+// leaves no stale copy behind either
+void ProxyCache::store(const String& key, const HttpRequest& req, const HttpResponse& head, const String& body, int defaultValid) {
+    EntryMap::iterator old = _entries.find(variantKey(key, req));
+    if (old != _entries.end())
+        remove(old);
+
+    int status = head.getStatusCode();
+    if (status != HTTP_OK && status != HTTP_MOVED_PERMANENTLY && status != HTTP_NOT_FOUND)
+        return;
+    if (head.hasSetCookie() || body.size() > PROXY_CACHE_ENTRY_MAX || body.size() > _maxSize)
+        return;
+    long staleWhileRevalidate = 0;
+    long fresh                = freshness(head, defaultValid, staleWhileRevalidate);
+    if (fresh <= 0)
+        return;
+
+    VectorString names, vary;
+    if (head.hasHeader("Vary"))
+        splitByString(toLowerWords(head.getHeader("Vary")), vary, ",");
+    for (size_t i = 0; i < vary.size(); ++i) {
+        String name = trimSpaces(vary[i]);
+        if (name == "*")
+            return;
+        if (!name.empty())
+            names.push_back(name);
+    }
+    // The upstream changed what the response varies on: older variants go
+    VariantsMap::iterator variants = _variants.find(key);
+    if (variants != _variants.end() && variants->second.names != names) {
+        for (EntryMap::iterator it = _entries.begin(); it != _entries.end();) {
+            EntryMap::iterator next = it;
+            ++next;
+            if (it->second.base == key)
+                remove(it);
+            it = next;
+        }
+    }
+    if (!names.empty()) {
+        Variants& v = _variants[key];
+        if (v.names != names) {
+            v.names   = names;
+            v.entries = 0;
+        }
+    }
+
+    String file = joinPaths(_dir, PROXY_CACHE_FILE_PREFIX + typeToString<unsigned long>(_serial++));
+    if (!writeBody(file, body)) {
+        Logger::error("Cannot write cache file " + file + ": " + std::strerror(errno));
+        unlink(file.c_str());
+        if (!names.empty() && _variants[key].entries == 0)
+            _variants.erase(key);
+        return;
+    }
+    String full  = variantKey(key, req);
+    Entry& entry = _entries[full];
+    entry.base   = key;
+    entry.head   = head;
+    entry.head.removeHeader(HEADER_CONNECTION);
+    entry.head.removeHeader(HEADER_TRANSFER_ENCODING);
+    entry.head.removeHeader(HEADER_CONTENT_LENGTH);
+    entry.head.removeHeader(HEADER_CACHE_STATUS);
+    entry.file       = file;
+    entry.size       = body.size();
+    entry.stored     = getCurrentTime();
+    entry.expires    = entry.stored + fresh;
+    entry.staleUntil = entry.expires + staleWhileRevalidate;
+    entry.updating   = false;
+    entry.lru        = _lru.insert(_lru.begin(), full);
+    _size += entry.size;
+    if (!names.empty())
+        ++_variants[key].entries;
+
+    while (_size > _maxSize && !_lru.empty())
+        remove(_entries.find(_lru.back()));
+}
+
+// ─── Internals ───────────────────────────────────────────────────────────────
+
+String ProxyCache::variantKey(const String& key, const HttpRequest& req) const {
+    VariantsMap::const_iterator it = _variants.find(key);
+    if (it == _variants.end())
+        return key;
+    String full = key;
+    for (size_t i = 0; i < it->second.names.size(); ++i)
+        full += "\n" + it->second.names[i] + ": " + req.getHeader(it->second.names[i]);
+    return full;
+}
+
+void ProxyCache::remove(EntryMap::iterator it) {
+    Entry& entry = it->second;
+    unlink(entry.file.c_str());
+    _size -= entry.size;
+    _lru.erase(entry.lru);
+    VariantsMap::iterator variants = _variants.find(entry.base);
+    if (variants != _variants.end() && it->first != entry.base && --variants->second.entries == 0)
+        _variants.erase(variants);
+    _entries.erase(it);
+}
+
+bool ProxyCache::writeBody(const String& file, const String& body) const {
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return false;
+    size_t total = 0;
+    while (total < body.size()) {
+        ssize_t n = write(fd, body.data() + total, body.size() - total);
+        if (n <= 0)
+            break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    return total == body.size();
+}
@@ -0,0 +1,81 @@
+#ifndef PROXY_CACHE_HPP
+#define PROXY_CACHE_HPP
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ctime>
+#include <list>
+#include <map>
+#include "../http/HttpRequest.hpp"
+#include "../http/HttpResponse.hpp"
+#include "../utils/Enums.hpp"
+#include "../utils/Logger.hpp"
+#include "../utils/Utils.hpp"
+
+// proxy_cache responses: bodies in files under proxy_cache_path, the index in
+// memory. An entry is found by "GET host target", plus the request's values
+// of the headers the response named in Vary. Once the bodies outgrow
+// max_size, the least recently used entries are dropped. After an entry
+// expires, the first request goes to the upstream to refresh it; during
+// stale-while-revalidate the others are served the old copy meanwhile.
+// With proxy_cache_lock, a GET that has to go to the upstream takes the key's
+// lock; the GETs that find it taken wait, by client fd, until it is released.
+class ProxyCache {
+   public:
+    ProxyCache();
+    ~ProxyCache();
+
+    bool        init(const String& dir, size_t maxSize);
+    void        clear();
+    bool        isEnabled() const;
+    CacheStatus lookup(const String& key, const HttpRequest& req, HttpResponse& out);
+    void        store(const String& key, const HttpRequest& req, const HttpResponse& head, const String& body, int defaultValid);
+    void        cancelUpdate(const String& key, const HttpRequest& req);
+    bool        lock(const String& key, int clientFd);
+    void        unlock(const String& key, VectorInt& waiters);
+    void        stopWaiting(const String& key, int clientFd);
+
+    static bool   isCacheable(const HttpRequest& req);
+    static String makeKey(const HttpRequest& req);
+
+   private:
+    struct Entry {
+        String                      base;       // key without the Vary part
+        HttpResponse                head;       // status and end-to-end headers
+        String                      file;       // body
+        size_t                      size;
+        time_t                      stored;
+        time_t                      expires;
+        time_t                      staleUntil; // stale-while-revalidate end
+        bool                        updating;   // a request is refreshing it
+        std::list<String>::iterator lru;
+    };
+    struct Variants {
+        VectorString names; // lowercase Vary header names
+        size_t       entries;
+    };
+    typedef std::map<String, Entry>     EntryMap;
+    typedef std::map<String, Variants>  VariantsMap;
+    typedef std::map<String, VectorInt> LockMap;
+
+    String            _dir;
+    size_t            _maxSize;
+    size_t            _size;     // bytes of all stored bodies
+    unsigned long     _serial;   // next body file name
+    EntryMap          _entries;  // full key -> entry
+    VariantsMap       _variants; // base key -> Vary names, for responses that had one
+    std::list<String> _lru;      // full keys, most recently used first
+    LockMap           _locks;    // base key -> clients waiting for its fetch
+
+    String variantKey(const String& key, const HttpRequest& req) const;
+    void   remove(EntryMap::iterator it);
+    bool   writeBody(const String& file, const String& body) const;
+
+    static long freshness(const HttpResponse& head, int defaultValid, long& staleWhileRevalidate);
+
+    ProxyCache(const ProxyCache&);
+    ProxyCache& operator=(const ProxyCache&);
+};
+
+#endif
@@ -0,0 +1,24 @@
+#include "ResponseTask.hpp"
+
+ResponseTask::ResponseTask(int ownerFd, ResponseBuilder& builder, const RouteResult& route, const HttpRequest& request, ssize_t bodyLen)
+    : AioTask(ownerFd), _builder(builder), _request(request), _route(route), _response(), _bodyLen(bodyLen) {
+    _route.setRequest(_request);
+}
+
+ResponseTask::~ResponseTask() {}
+
+void ResponseTask::run() {
+    _response = _builder.build(_route);
+}
+
+AioKind ResponseTask::getKind() const {
+    return AIO_RESPONSE;
+}
+
+HttpResponse& ResponseTask::getResponse() {
+    return _response;
+}
+
+ssize_t ResponseTask::getBodyLen() const {
+    return _bodyLen;
+}
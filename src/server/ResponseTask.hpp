@@ -0,0 +1,34 @@
+#ifndef RESPONSE_TASK_HPP
+#define RESPONSE_TASK_HPP
+
+#include "../http/HttpRequest.hpp"
+#include "../http/HttpResponse.hpp"
+#include "../http/ResponseBuilder.hpp"
+#include "../http/RouteResult.hpp"
+#include "AioPool.hpp"
+
+// A static file, directory listing, DELETE or error page built on an aio
+// thread. The request is copied, since the route only points at the
+// Client's, and the Client can be recycled while the task runs.
+class ResponseTask : public AioTask {
+   public:
+    ResponseTask(int ownerFd, ResponseBuilder& builder, const RouteResult& route, const HttpRequest& request, ssize_t bodyLen);
+    ~ResponseTask();
+
+    void          run();
+    AioKind       getKind() const;
+    HttpResponse& getResponse();
+    ssize_t       getBodyLen() const;
+
+   private:
+    ResponseBuilder& _builder;
+    HttpRequest      _request;
+    RouteResult      _route;
+    HttpResponse     _response;
+    ssize_t          _bodyLen; // request body bytes to drop once the response is queued
+
+    ResponseTask(const ResponseTask&);
+    ResponseTask& operator=(const ResponseTask&);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "RouteTask.hpp"
+
+RouteTask::RouteTask(int ownerFd, ResponseBuilder& builder, const VectorServerConfig& servers, const HttpRequest& request)
+    : AioTask(ownerFd), _builder(builder), _servers(servers), _request(request), _route(), _response(), _answered(false) {}
+
+RouteTask::~RouteTask() {}
+
+void RouteTask::run() {
+    Router router(_servers, _request);
+    _route = router.processRequest();
+    if (!canAnswer())
+        return;
+    _response = _builder.build(_route);
+    _answered = true;
+}
+
+AioKind RouteTask::getKind() const {
+    return AIO_ROUTE;
+}
+
+// Points at the task's copy of the request until the loop sets it back
+RouteResult& RouteTask::getRoute() {
+    return _route;
+}
+
+HttpResponse& RouteTask::getResponse() {
+    return _response;
+}
+
+bool RouteTask::isAnswered() const {
+    return _answered;
+}
+
+// What ServerManager::respond() would build once an empty body was read;
+// errors and redirects are left to the loop, which closes or answers them
+bool RouteTask::canAnswer() const {
+    HandlerType type = _route.getHandlerType();
+    if (_route.getStatusCode() >= 400 || _route.getIsRedirect())
+        return false;
+    if (_request.hasHeader("content-length") || _request.isChunked())
+        return false;
+    return type == STATIC || type == DIRECTORY_LISTING || type == DELETE_FILE;
+}
@@ -0,0 +1,40 @@
+#ifndef ROUTE_TASK_HPP
+#define ROUTE_TASK_HPP
+
+#include "../http/HttpRequest.hpp"
+#include "../http/HttpResponse.hpp"
+#include "../http/ResponseBuilder.hpp"
+#include "../http/RouteResult.hpp"
+#include "../http/Router.hpp"
+#include "AioPool.hpp"
+
+// Routing stats the paths it tries (CGI script, index files), so with aio
+// threads it runs on one. A request without a body for a static file,
+// listing or DELETE is answered in the same run; any other route goes back
+// to the loop. The request is copied, as for ResponseTask.
+class RouteTask : public AioTask {
+   public:
+    RouteTask(int ownerFd, ResponseBuilder& builder, const VectorServerConfig& servers, const HttpRequest& request);
+    ~RouteTask();
+
+    void          run();
+    AioKind       getKind() const;
+    RouteResult&  getRoute();
+    HttpResponse& getResponse();
+    bool          isAnswered() const;
+
+   private:
+    ResponseBuilder&          _builder;
+    const VectorServerConfig& _servers; // the listener's, alive as long as the pool
+    HttpRequest               _request;
+    RouteResult               _route;
+    HttpResponse              _response;
+    bool                      _answered;
+
+    bool canAnswer() const;
+
+    RouteTask(const RouteTask&);
+    RouteTask& operator=(const RouteTask&);
+};
+
+#endif
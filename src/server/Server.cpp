@@ -1,50 +1,108 @@
 #include "Server.hpp"
 
-Server::Server(ServerConfig cfg, size_t listenIdx) : server_fd(-1), running(false), config(cfg), listenIndex(listenIdx) {}
+Server::Server(ServerConfig cfg, size_t listenIdx) : server_fd(-1), running(false), config(cfg), listenIndex(listenIdx), bindAddrLen(0) {
+    std::memset(&bindAddr, 0, sizeof(bindAddr));
+}
 
-Server::Server() : server_fd(-1), running(false), config(ServerConfig()), listenIndex(0) {}
+Server::Server() : server_fd(-1), running(false), config(ServerConfig()), listenIndex(0), bindAddrLen(0) {
+    std::memset(&bindAddr, 0, sizeof(bindAddr));
+}
 
 Server::~Server() {
     stop();
 }
+// Resolve the listen address first: its family (AF_INET or AF_INET6) decides the socket's.
 bool Server::createSocket() {
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    const ListenAddress& addr = config.getListenAddresses()[listenIndex];
+    if (addr.isUnix())
+        return createUnixSocket(addr);
+    struct addrinfo hints, *res;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family     = AF_UNSPEC;
+    hints.ai_socktype   = SOCK_STREAM;
+    hints.ai_flags      = AI_PASSIVE;
+    String iface        = config.getInterface(listenIndex);
+    String portString   = typeToString<int>(config.getPort(listenIndex));
+    if (getaddrinfo(iface.c_str(), portString.c_str(), &hints, &res) != 0)
+        return Logger::error("getaddrinfo failed");
+    std::memcpy(&bindAddr, res->ai_addr, res->ai_addrlen);
+    bindAddrLen = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    server_fd = socket(bindAddr.ss_family, SOCK_STREAM, 0);
     if (server_fd < 0) {
         return Logger::error("Failed to create socket");
     }
     return true;
 }
+// Path length was checked by the config parser.
+bool Server::createUnixSocket(const ListenAddress& addr) {
+    struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&bindAddr);
+    un->sun_family         = AF_UNIX;
+    std::memcpy(un->sun_path, addr.getInterface().c_str(), addr.getInterface().size() + 1);
+    bindAddrLen = sizeof(struct sockaddr_un);
+
+    server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0)
+        return Logger::error("Failed to create unix socket");
+    return true;
+}
+
 bool Server::configureSocket() {
     int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        return Logger::error("Failed to set SO_REUSEADDR");
+    // a unix socket is "reused" by unlinking the stale file in bindSocket()
+    if (bindAddr.ss_family != AF_UNIX) {
+        if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+            return Logger::error("Failed to set SO_REUSEADDR");
+        }
+        if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            return Logger::error("Failed to set SO_REUSEPORT");
+        }
+    }
+
+    // listen options: applied before bind/listen so accepted sockets inherit them
+    const ListenAddress& addr = config.getListenAddresses()[listenIndex];
+    int                  rcvBuf = addr.getRcvBuf();
+    int                  sndBuf = addr.getSndBuf();
+    if (rcvBuf > 0 && setsockopt(server_fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf)) < 0)
+        return Logger::error("Failed to set SO_RCVBUF");
+    if (sndBuf > 0 && setsockopt(server_fd, SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf)) < 0)
+        return Logger::error("Failed to set SO_SNDBUF");
+    if (addr.isSoKeepalive() && setsockopt(server_fd, SOL_SOCKET, SO_KEEPALIVE, &opt, sizeof(opt)) < 0)
+        return Logger::error("Failed to set SO_KEEPALIVE");
+    if (bindAddr.ss_family == AF_INET6) {
+        // set explicitly so [::] is dual-stack regardless of net.ipv6.bindv6only
+        int v6only = addr.isIpv6Only() ? 1 : 0;
+        if (setsockopt(server_fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only)) < 0)
+            return Logger::error("Failed to set IPV6_V6ONLY");
     }
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
-        return Logger::error("Failed to set SO_REUSEPORT");
+    if (addr.isDeferred()) {
+        // wake the listener only once the request bytes have arrived
+        int timeout = DEFER_ACCEPT_TIMEOUT;
+        if (setsockopt(server_fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &timeout, sizeof(timeout)) < 0)
+            return Logger::error("Failed to set TCP_DEFER_ACCEPT");
     }
     return true;
 }
 bool Server::bindSocket() {
-    struct addrinfo hints, *res;
-    std::memset(&hints, 0, sizeof(hints));
-    hints.ai_family        = AF_INET;
-    hints.ai_socktype      = SOCK_STREAM;
-    hints.ai_flags         = AI_PASSIVE;
-    String      iface      = config.getInterface(listenIndex);
-    int         portNum    = config.getPort(listenIndex);
-    const char* interface  = iface.c_str();
-    String      portString = typeToString<int>(portNum);
-    const char* portStr    = portString.c_str();
-    if (getaddrinfo(interface, portStr, &hints, &res) != 0)
-        return Logger::error("getaddrinfo failed");
-    int bindResult = bind(server_fd, res->ai_addr, res->ai_addrlen);
-    freeaddrinfo(res);
-    if (bindResult < 0)
-        return Logger::error("Failed to bind socket to " + iface + ":" + typeToString<int>(portNum));
-    return Logger::info("Socket bound to http://" + iface + ":" + typeToString<int>(portNum));
+    const ListenAddress& addr          = config.getListenAddresses()[listenIndex];
+    String               listenAddress = addr.getListenAddress();
+    if (addr.isUnix() && S_ISSOCK(getFileStat(addr.getInterface()).st_mode))
+        unlink(addr.getInterface().c_str()); // left behind by a previous run
+    if (bind(server_fd, reinterpret_cast<sockaddr*>(&bindAddr), bindAddrLen) < 0)
+        return Logger::error("Failed to bind socket to " + listenAddress);
+    if (addr.isUnix() && addr.getMode() >= 0 && chmod(addr.getInterface().c_str(), addr.getMode()) < 0)
+        return Logger::error("Failed to set mode on " + listenAddress);
+    return Logger::info("Socket bound to http://" + listenAddress);
 }
 bool Server::startListening() {
-    if (listen(server_fd, SOMAXCONN) < 0)
+    const ListenAddress& addr    = config.getListenAddresses()[listenIndex];
+    int                  backlog = addr.getBacklog() > 0 ? addr.getBacklog() : SOMAXCONN;
+    int                  qlen    = addr.getFastOpen();
+    // fastopen=0 is accepted and simply leaves TFO off
+    if (qlen > 0 && setsockopt(server_fd, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)) < 0)
+        return Logger::error("Failed to set TCP_FASTOPEN");
+    if (listen(server_fd, backlog) < 0)
         return Logger::error("Failed to listen on socket");
     return Logger::info("Server is listening on socket");
 }
@@ -71,31 +129,28 @@ void Server::stop() {
     if (server_fd != -1) {
         close(server_fd);
         server_fd = -1;
+        if (bindAddr.ss_family == AF_UNIX)
+            unlink(reinterpret_cast<struct sockaddr_un*>(&bindAddr)->sun_path);
     }
     running = false;
 }
 
-int Server::acceptConnection(String& remoteAddress) {
+// accept4 hands back the socket already non-blocking and close-on-exec.
+// A negative return is also how a drained backlog looks, so it is not logged.
+// Responses are queued whole, so Nagle only delays the tail of each one.
+int Server::acceptConnection(struct sockaddr_storage& remoteAddr) {
     if (!running || server_fd == -1) {
         Logger::error("Cannot accept connection: server not running");
         return -1;
     }
 
-    sockaddr_in addr;
-    socklen_t   addr_len  = sizeof(addr);
-    int         client_fd = accept(server_fd, (sockaddr*)&addr, &addr_len);
-    if (client_fd < 0) {
-        Logger::error("Failed to accept new connection");
-        return -1;
-    }
-    if (!setNonBlocking(client_fd)) {
-        close(client_fd);
-        Logger::error("Failed to set non-blocking mode for client socket");
-        return -1;
+    socklen_t addr_len = sizeof(remoteAddr);
+    int       fd       = accept4(server_fd, (sockaddr*)&remoteAddr, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd >= 0 && bindAddr.ss_family != AF_UNIX) {
+        int opt = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
     }
-    unsigned char* ip = (unsigned char*)&addr.sin_addr.s_addr;
-    remoteAddress     = typeToString<int>(ip[0]) + "." + typeToString<int>(ip[1]) + "." + typeToString<int>(ip[2]) + "." + typeToString<int>(ip[3]);
-    return client_fd;
+    return fd;
 }
 
 int Server::getFd() const {
@@ -4,7 +4,9 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
@@ -18,8 +20,12 @@ class Server {
     bool         running;
     ServerConfig config;
     size_t       listenIndex;
+    // resolved by createSocket(), which picks the family from the address
+    struct sockaddr_storage bindAddr;
+    socklen_t               bindAddrLen;
 
     bool createSocket();
+    bool createUnixSocket(const ListenAddress& addr);
     bool configureSocket();
     bool bindSocket();
     bool startListening();
@@ -34,7 +40,7 @@ class Server {
 
     bool init();
     void stop();
-    int  acceptConnection(String& remoteAddress);
+    int  acceptConnection(struct sockaddr_storage& remoteAddr);
 
     // getters
     int          getFd() const;
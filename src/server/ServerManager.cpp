@@ -1,10 +1,10 @@
 #include "ServerManager.hpp"
 
 ServerManager::ServerManager()
-    : pollManager(), servers(), serverConfigs(), clients(), clientToServer(), serverToConfigs(), mimeTypes(), sessionManager() {}
+    : pollManager(), servers(), serverConfigs(), httpConfig(), connections(), clientPool(), serverToConfigs(), mimeTypes(), sessionManager(), fastcgiPool(FASTCGI_KEEPALIVE), proxyPool(PROXY_KEEPALIVE), proxyCache(), upstreamGroups(), cgiWorkers(), childReaper(), cgiQueue(), aioPool(), listenersPaused(false), overloaded(false) {}
 
-ServerManager::ServerManager(const VectorServerConfig& _configs)
-    : pollManager(), servers(), serverConfigs(_configs), clients(), clientToServer(), serverToConfigs(), mimeTypes(), sessionManager() {}
+ServerManager::ServerManager(const VectorServerConfig& _configs, const HttpConfig& _httpConfig)
+    : pollManager(), servers(), serverConfigs(_configs), httpConfig(_httpConfig), connections(), clientPool(), serverToConfigs(), mimeTypes(), sessionManager(), fastcgiPool(FASTCGI_KEEPALIVE), proxyPool(PROXY_KEEPALIVE), proxyCache(), upstreamGroups(), cgiWorkers(), childReaper(), cgiQueue(), aioPool(), listenersPaused(false), overloaded(false) {}
 
 ServerManager::~ServerManager() {
     shutdown();
@@ -15,6 +15,33 @@ bool ServerManager::initialize() {
         return Logger::error("No server configurations provided");
     if (!initializeServers(serverConfigs) || servers.empty())
         return Logger::error("Failed to initialize servers");
+    if (!childReaper.initialize())
+        return Logger::error("Failed to install the SIGCHLD handler");
+    pollManager.addFd(childReaper.getFd(), POLLIN);
+    connections.setSignal(childReaper.getFd());
+    if (httpConfig.getAioThreads() > 0) {
+        if (!aioPool.start(httpConfig.getAioThreads()))
+            return Logger::error("Failed to start the aio thread pool");
+        pollManager.addFd(aioPool.getFd(), POLLIN);
+        connections.setAio(aioPool.getFd());
+    }
+    prespawnCgiWorkers();
+    registerCgiLimits();
+    const VectorUpstreamConfig& upstreams = httpConfig.getUpstreams();
+    for (size_t i = 0; i < upstreams.size(); ++i)
+        upstreamGroups.push_back(UpstreamGroup(upstreams[i]));
+    const String& cachePath = httpConfig.getProxyCachePath();
+    if (!cachePath.empty() && !proxyCache.init(cachePath, httpConfig.getProxyCacheMaxSize()))
+        return Logger::error("Failed to set up the proxy cache");
+    if (httpConfig.getOverloadRetryAfter() >= 0) {
+        // Built once: while overloaded we answer without parsing or allocating
+        String body      = "503 Service Unavailable\n";
+        overloadResponse = "HTTP/1.1 503 Service Unavailable\r\n";
+        overloadResponse += "Retry-After: " + typeToString<int>(httpConfig.getOverloadRetryAfter()) + "\r\n";
+        overloadResponse += "Content-Type: text/plain\r\n";
+        overloadResponse += "Content-Length: " + typeToString<size_t>(body.size()) + "\r\n";
+        overloadResponse += "Connection: close\r\n\r\n" + body;
+    }
     g_running = 1;
     return Logger::info("[INFO]: ServerManager initialized");
 }
@@ -24,7 +51,7 @@ ListenerToConfigsMap ServerManager::mapListenersToConfigs(const VectorServerConf
     for (size_t i = 0; i < serversConfigs.size(); i++) {
         const VectorListenAddress& addresses = serversConfigs[i].getListenAddresses();
         for (size_t j = 0; j < addresses.size(); j++) {
-            String key = addresses[j].getInterface() + ":" + typeToString<int>(addresses[j].getPort());
+            String key = addresses[j].getListenAddress();
             result[key].push_back(serversConfigs[i]);
         }
     }
@@ -52,16 +79,25 @@ Server* ServerManager::initializeServer(const ServerConfig& serverConfig, size_t
 Server* ServerManager::createServerForListener(const String& listenerKey, const VectorServerConfig& serversConfigsForListener, PollManager& pollMgr) {
     if (serversConfigsForListener.empty())
         return NULL;
-    const ServerConfig&        firstConfig = serversConfigsForListener[0];
-    const VectorListenAddress& addresses   = firstConfig.getListenAddresses();
-    size_t                     listenIndex = 0;
-    for (size_t i = 0; i < addresses.size(); i++) {
-        if (addresses[i].getListenAddress() == listenerKey) {
-            listenIndex = i;
+    // the socket takes its options from the one listen directive that has
+    // any (the config allows no more), else from the first server block
+    size_t configIndex = 0;
+    size_t listenIndex = 0;
+    bool   withOptions = false;
+    for (size_t i = 0; i < serversConfigsForListener.size() && !withOptions; i++) {
+        const VectorListenAddress& addresses = serversConfigsForListener[i].getListenAddresses();
+        for (size_t j = 0; j < addresses.size(); j++) {
+            if (addresses[j].getListenAddress() != listenerKey)
+                continue;
+            withOptions = addresses[j].hasOptions();
+            if (i == 0 || withOptions) {
+                configIndex = i;
+                listenIndex = j;
+            }
             break;
         }
     }
-    Server* server = initializeServer(firstConfig, listenIndex);
+    Server* server = initializeServer(serversConfigsForListener[configIndex], listenIndex);
     if (!server)
         return NULL;
     pollMgr.addFd(server->getFd(), POLLIN);
@@ -75,6 +111,7 @@ bool ServerManager::initializeServers(const VectorServerConfig& serversConfigs)
         if (!server)
             continue;
         servers.push_back(server);
+        connections.setListener(server->getFd(), server);
         serverToConfigs[server->getFd()] = it->second;
     }
     return !servers.empty();
@@ -83,14 +120,14 @@ bool ServerManager::initializeServers(const VectorServerConfig& serversConfigs)
 bool ServerManager::run() {
     if (!g_running)
         return false;
-    time_t lastSessionCleanup = getCurrentTime();
     while (g_running) {
         int eventCount = pollManager.pollConnections(10);
         checkTimeouts(CLIENT_TIMEOUT);
-        if (getDifferentTime(lastSessionCleanup, getCurrentTime()) > SESSION_CLEANUP_INTERVAL) {
-            sessionManager.cleanupExpiredSessions(SESSION_TIMEOUT);
-            lastSessionCleanup = getCurrentTime();
-        }
+        cgiWorkers.maintain();
+        childReaper.killReleased();
+        serveCgiQueue();
+        runHealthProbes();
+        sessionManager.cleanupExpiredSessions(SESSION_TIMEOUT);
         if (eventCount <= 0)
             continue;
 
@@ -107,7 +144,40 @@ bool ServerManager::run() {
                 continue;
 
             try {
-                if (isCgiPipe(fd)) {
+                if (connections.getKind(fd) == FD_FASTCGI) {
+                    handleFastCgiEvent(fd, hasIn, hasOut, hasHup || hasErr);
+                    eventCount--;
+                    if (i < pollManager.size() && pollManager.getFd(i) != fd)
+                        --i;
+                    continue;
+                }
+                if (connections.getKind(fd) == FD_PROXY) {
+                    handleProxyEvent(fd, hasIn, hasOut, hasHup || hasErr);
+                    eventCount--;
+                    if (i < pollManager.size() && pollManager.getFd(i) != fd)
+                        --i;
+                    continue;
+                }
+                if (connections.getKind(fd) == FD_HEALTH_PROBE) {
+                    handleHealthProbe(fd, hasIn, hasOut, hasHup || hasErr);
+                    eventCount--;
+                    if (i < pollManager.size() && pollManager.getFd(i) != fd)
+                        --i;
+                    continue;
+                }
+                if (connections.getKind(fd) == FD_SIGNAL) {
+                    handleChildExits();
+                    eventCount--;
+                    continue;
+                }
+                if (connections.getKind(fd) == FD_AIO) {
+                    handleAioCompletions();
+                    eventCount--;
+                    if (i < pollManager.size() && pollManager.getFd(i) != fd)
+                        --i;
+                    continue;
+                }
+                if (connections.getKind(fd) == FD_CGI_PIPE) {
                     if (hasOut)
                         handleCgiWrite(fd);
                     if (hasIn || hasHup || hasErr)
@@ -118,28 +188,25 @@ bool ServerManager::run() {
                     continue;
                 }
                 if (hasIn) {
-                    if (isServerSocket(fd)) {
-                        Server* server = findServerByFd(fd);
-                        if (server)
-                            acceptNewConnection(server);
-                    } else if (clients.count(fd)) {
+                    if (connections.getKind(fd) == FD_LISTENER)
+                        acceptNewConnection(connections.getServer(fd));
+                    else if (connections.getKind(fd) == FD_CLIENT)
                         handleClientRead(fd);
-                    }
                     eventCount--;
                 }
                 if (hasOut) {
-                    if (clients.count(fd))
+                    if (connections.getKind(fd) == FD_CLIENT)
                         handleClientWrite(fd);
                     eventCount--;
                 }
                 if ((hasErr || hasHup) && !hasIn && !hasOut) {
-                    if (clients.count(fd))
+                    if (connections.getKind(fd) == FD_CLIENT)
                         closeClientConnection(fd);
                     eventCount--;
                 }
             } catch (const std::exception& e) {
                 Logger::error("Exception on fd " + typeToString(fd) + ": " + e.what());
-                if (!isServerSocket(fd) && !isCgiPipe(fd) && clients.count(fd))
+                if (connections.getKind(fd) == FD_CLIENT)
                     closeClientConnection(fd);
             }
             if (i < pollManager.size() && pollManager.getFd(i) != fd)
@@ -149,33 +216,93 @@ bool ServerManager::run() {
     return true;
 }
 
+// Drain up to accept_batch pending connections per wakeup instead of one per
+// poll() round, so a connect burst does not sit in the listen backlog.
 bool ServerManager::acceptNewConnection(Server* server) {
-    if (clients.size() >= MAX_CONNECTIONS) {
-        Logger::error("Max connections reached (" + typeToString(MAX_CONNECTIONS) + "), rejecting new connection");
-        String remoteAddress;
-        int    tmpFd = server->acceptConnection(remoteAddress);
-        if (tmpFd >= 0)
-            close(tmpFd);
-        return false;
+    int              batch    = httpConfig.getAcceptBatch();
+    int              accepted = 0;
+    sockaddr_storage remoteAddr;
+    for (; accepted < batch; ++accepted) {
+        if (!makeRoomForConnection()) {
+            if (!overloaded) {
+                overloaded = true;
+                Logger::error("Max connections reached (" + typeToString(httpConfig.getMaxConnections()) + "), shedding new connections");
+            }
+            if (httpConfig.getOverloadRetryAfter() >= 0)
+                rejectOverloaded(server);
+            else
+                pauseListeners();
+            break;
+        }
+        int clientFd = server->acceptConnection(remoteAddr);
+        if (clientFd < 0)
+            break;
+        Client* client = clientPool.acquire(clientFd);
+        client->setRemoteAddress(remoteAddr);
+        connections.setClient(clientFd, client, server);
+        pollManager.addFd(clientFd, POLLIN);
     }
-    String remoteAddress;
-    int    clientFd = server->acceptConnection(remoteAddress);
-    if (clientFd < 0)
+    return accepted > 0;
+}
+
+// At the limit, an idle keep-alive connection is worth less than a new one:
+// close the least recently used idle client to make room.
+bool ServerManager::makeRoomForConnection() {
+    if (connections.getClientCount() < httpConfig.getMaxConnections())
+        return true;
+    int idleFd = connections.getOldestIdle();
+    if (idleFd == INVALID_FD)
         return false;
-    Client* client = new Client(clientFd);
-    client->setRemoteAddress(remoteAddress);
-    clients[clientFd]        = client;
-    clientToServer[clientFd] = server;
-    pollManager.addFd(clientFd, POLLIN);
+    closeClientConnection(idleFd);
     return true;
 }
 
+// Answer the rest of this batch with the prebuilt 503. The write is
+// best-effort: a fresh socket always has room for a few hundred bytes.
+void ServerManager::rejectOverloaded(Server* server) {
+    sockaddr_storage remoteAddr;
+    for (int i = 0; i < httpConfig.getAcceptBatch(); ++i) {
+        int fd = server->acceptConnection(remoteAddr);
+        if (fd < 0)
+            break;
+        send(fd, overloadResponse.data(), overloadResponse.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(fd);
+    }
+}
+
+// Stop polling the listeners while full: pending connections wait in the
+// kernel backlog instead of costing an accept/close round trip each.
+void ServerManager::pauseListeners() {
+    if (listenersPaused)
+        return;
+    for (size_t i = 0; i < servers.size(); i++)
+        pollManager.addFd(servers[i]->getFd(), 0);
+    listenersPaused = true;
+}
+
+void ServerManager::resumeListeners() {
+    if (!listenersPaused)
+        return;
+    for (size_t i = 0; i < servers.size(); i++)
+        pollManager.addFd(servers[i]->getFd(), POLLIN);
+    listenersPaused = false;
+}
+
 void ServerManager::handleClientRead(int clientFd) {
-    Client* client = getValue(clients, clientFd, (Client*)NULL);
+    Client* client = connections.getClient(clientFd);
     if (!client) {
         closeClientConnection(clientFd);
         return;
     }
+    connections.markBusy(clientFd);
+    if (canSpliceBody(client)) {
+        spliceCgiBody(client);
+        return;
+    }
+    if (canSpliceUpload(client)) {
+        spliceUpload(client);
+        return;
+    }
     ssize_t received = client->receiveData();
     if (received == 0) {
         closeClientConnection(clientFd);
@@ -184,42 +311,120 @@ void ServerManager::handleClientRead(int clientFd) {
     if (received < 0) {
         return;
     }
-    Server* server = getValue(clientToServer, clientFd, (Server*)NULL);
+    Server* server = connections.getServer(clientFd);
     if (server)
         processRequest(client, server);
 }
 
 void ServerManager::handleClientWrite(int clientFd) {
-    Client* client = getValue(clients, clientFd, (Client*)NULL);
+    Client* client = connections.getClient(clientFd);
     if (!client || client->sendData() < 0) {
         closeClientConnection(clientFd);
         return;
     }
+    // output spliced to the socket waits until nothing is queued ahead of it
+    CgiProcess& cgi    = client->getCgi();
+    size_t      resume = canSpliceOutput(client) ? 1 : CGI_STREAM_BUFFER / 2;
+    if (cgi.isReadPaused() && client->getStoreSendData().size() < resume) {
+        cgi.setReadPaused(false);
+        cgi.resetStartTime();
+        pollManager.addFd(cgi.getReadFd(), POLLIN);
+    }
+    ProxyRequest& proxy = client->getProxy();
+    if (proxy.isReadPaused() && client->getStoreSendData().size() < PROXY_STREAM_BUFFER / 2) {
+        proxy.setReadPaused(false);
+        proxy.resetStartTime();
+        pollManager.addFd(proxy.getFd(), POLLIN);
+    }
     if (client->getStoreSendData().empty()) {
-        if (client->isKeepAlive())
+        if (cgi.isActive() || proxy.isActive()) {
+            // still streaming: the next CGI or upstream output re-arms POLLOUT
+            pollManager.addFd(clientFd, clientEvents(client));
+        } else if (client->isKeepAlive()) {
             pollManager.addFd(clientFd, POLLIN);
-        else
+            if (!client->isHeadersParsed() && client->getStoreReceiveData().empty())
+                connections.markIdle(clientFd);
+            // An idle client can be evicted, so there is room again
+            resumeListeners();
+        } else {
             closeClientConnection(clientFd);
+        }
     }
 }
 
+// Clients answered here are only looked at for pipelined requests after the
+// walk, since processing them can close connections and reorder the list
 void ServerManager::checkTimeouts(int timeout) {
     std::vector<int> toClose;
-    for (MapIntClientPtr::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->second->getCgi().isActive()) {
-            if (getDifferentTime(it->second->getCgi().getStartTime(), getCurrentTime()) > CGI_TIMEOUT) {
-                cleanupClientCgi(it->second);
-                it->second->setSendData(responseBuilder.buildError(HTTP_GATEWAY_TIMEOUT, "CGI Timeout").toString());
-                it->second->setHeadersParsed(false);
-                it->second->getRequest().clear();
-                pollManager.addFd(it->first, POLLIN | POLLOUT);
+    std::vector<int> toResume;
+    const VectorInt& clientFds = connections.getClientFds();
+    for (size_t i = 0; i < clientFds.size(); ++i) {
+        Client* client = connections.getClient(clientFds[i]);
+        if (client->getCgi().isOutputDone()) {
+            // all output is in but the script lingers: answer, and leave it running
+            if (getDifferentTime(client->getCgi().getStartTime(), getCurrentTime()) > CGI_EXIT_WAIT) {
+                completeCgiResponse(client, true);
+                toResume.push_back(clientFds[i]);
+            }
+        } else if (client->getCgi().isActive()) {
+            if (getDifferentTime(client->getCgi().getStartTime(), getCurrentTime()) > CGI_TIMEOUT) {
+                // part of the response is already out, so there is no room for a 504
+                if (client->getCgi().isHeadersSent()) {
+                    toClose.push_back(clientFds[i]);
+                    continue;
+                }
+                // the rest of an unread body must not be taken for a request
+                if (!client->getCgi().isBodyComplete()) {
+                    client->setKeepAlive(false);
+                    client->clearStoreReceiveData();
+                }
+                cleanupClientCgi(client);
+                client->queueResponse(responseBuilder.buildError(HTTP_GATEWAY_TIMEOUT, "CGI Timeout").toString());
+                client->setHeadersParsed(false);
+                client->getRequest().clear();
+                pollManager.addFd(clientFds[i], POLLIN | POLLOUT);
+                toResume.push_back(clientFds[i]);
             }
-        } else if (it->second->isTimedOut(timeout)) {
-            toClose.push_back(it->first);
+        } else if (client->getFastCgi().isActive()) {
+            if (getDifferentTime(client->getFastCgi().getStartTime(), getCurrentTime()) > CGI_TIMEOUT) {
+                cleanupClientFastCgi(client);
+                HttpResponse response = responseBuilder.buildError(HTTP_GATEWAY_TIMEOUT, "FastCGI Timeout");
+                sendUpstreamResponse(client, response);
+                toResume.push_back(clientFds[i]);
+            }
+        } else if (client->getCgiCacheLock() == CACHE_LOCK_WAITING) {
+            if (client->isTimedOut(CGI_CACHE_LOCK_TIMEOUT)) {
+                resumeCgiCacheWaiter(client, true);
+                toResume.push_back(clientFds[i]);
+            }
+        } else if (client->getProxy().getCacheLock() == CACHE_LOCK_WAITING) {
+            if (getDifferentTime(client->getProxy().getStartTime(), getCurrentTime()) > PROXY_CACHE_LOCK_TIMEOUT) {
+                resumeCacheWaiter(client, true);
+                toResume.push_back(clientFds[i]);
+            }
+        } else if (client->getProxy().isActive()) {
+            if (getDifferentTime(client->getProxy().getStartTime(), getCurrentTime()) > PROXY_TIMEOUT) {
+                if (client->getProxy().isHeadersSent()) {
+                    toClose.push_back(clientFds[i]);
+                    continue;
+                }
+                releaseProxyServer(client, true);
+                cleanupClientProxy(client);
+                HttpResponse response = responseBuilder.buildError(HTTP_GATEWAY_TIMEOUT, "Gateway Timeout");
+                sendUpstreamResponse(client, response);
+                toResume.push_back(clientFds[i]);
+            }
+        } else if (client->isTimedOut(timeout)) {
+            toClose.push_back(clientFds[i]);
         }
     }
     for (size_t i = 0; i < toClose.size(); i++)
         closeClientConnection(toClose[i]);
+    for (size_t i = 0; i < toResume.size(); i++) {
+        Client* client = connections.getClient(toResume[i]);
+        if (client)
+            processPipelined(client);
+    }
 }
 
 void ServerManager::sendErrorResponse(Client* client, int statusCode, const String& message, bool closeConnection, size_t bytesToRemove) {
@@ -228,7 +433,7 @@ void ServerManager::sendErrorResponse(Client* client, int statusCode, const Stri
         response.addHeader("Connection", "close");
         client->setKeepAlive(false);
     }
-    client->setSendData(response.toString());
+    client->queueResponse(response.toString());
     if (bytesToRemove > 0)
         client->removeReceivedData(bytesToRemove);
     else
@@ -240,17 +445,33 @@ void ServerManager::sendErrorResponse(Client* client, int statusCode, const Stri
 
 void ServerManager::processRequest(Client* client, Server* server) {
     while (true) {
+        // pipelined bytes wait in the receive buffer until the upstream or
+        // the aio thread answers
+        if (client->getFastCgi().isActive() || client->getProxy().isActive() || client->getAioTask())
+            break;
         if (!client->isHeadersParsed()) {
+            // the connection closes once the queued response is out: what is
+            // still arriving is the rest of a rejected body, not a request
+            if (!client->isKeepAlive() && !client->getStoreSendData().empty())
+                break;
             if (!parseAndRouteHeaders(client, server))
                 return;
-            if (!client->isHeadersParsed())
-                break;
+            // leading CRLFs were skipped, the request came from the CGI cache,
+            // or its upload file is being opened on an aio thread
+            continue;
         }
 
         if (client->isHeadersParsed()) {
+            // the body stays unread until a CGI slot frees up; nothing is read
+            // while another request runs the script for this one's cache key
+            if (client->isCgiQueued() || client->getCgiCacheLock() == CACHE_LOCK_WAITING)
+                break;
             if (client->getCgi().isActive()) {
                 handleCgiBodyStreaming(client);
                 break;
+            } else if (client->getMultipart().isActive() || client->getRawUpload().isActive()) {
+                if (handleUploadBody(client))
+                    continue;
             } else {
                 if (handleRegularBody(client))
                     continue;
@@ -269,20 +490,83 @@ ssize_t ServerManager::getMaxBodySize(const RouteResult& res) const {
     return maxBody;
 }
 
-void ServerManager::finalizeResponse(Client* client, const HttpResponse& response, ssize_t bodyLen) {
-    HttpResponse resp = response;
+// With aio threads the response is built off the loop. The client is left out
+// of poll() meanwhile, except for hangups, so nothing else of it is read.
+void ServerManager::respond(Client* client, const RouteResult& res, ssize_t bodyLen) {
+    if (!aioPool.isEnabled() || res.getIsRedirect()) {
+        HttpResponse response = responseBuilder.build(res, &client->getCgi(), VectorInt());
+        finalizeResponse(client, response, bodyLen);
+        return;
+    }
+    ResponseTask* task = new ResponseTask(client->getFd(), responseBuilder, res, client->getRequest(), bodyLen);
+    client->setAioTask(task);
+    aioPool.post(task);
+    pollManager.addFd(client->getFd(), 0);
+}
+
+// A task whose client closed, or whose fd went to a new connection, is
+// dropped: only the client that posted it still points at it
+void ServerManager::handleAioCompletions() {
+    while (AioTask* done = aioPool.nextDone()) {
+        Client* client = connections.getClient(done->getOwnerFd());
+        if (client && client->getAioTask() == done) {
+            client->setAioTask(NULL);
+            if (done->getKind() == AIO_ROUTE) {
+                finishRouteTask(client, *static_cast<RouteTask*>(done));
+            } else if (done->getKind() == AIO_UPLOAD) {
+                finishUploadTask(client, *static_cast<UploadTask*>(done));
+            } else {
+                ResponseTask* task = static_cast<ResponseTask*>(done);
+                finalizeResponse(client, task->getResponse(), task->getBodyLen());
+                processPipelined(client);
+            }
+        }
+        delete done;
+    }
+}
+
+// The rest of parseAndRouteHeaders(), unless the response was built with the
+// route. The route points at the task's copy of the request until set back.
+void ServerManager::finishRouteTask(Client* client, RouteTask& task) {
+    if (task.isAnswered()) {
+        finalizeResponse(client, task.getResponse(), 0);
+        processPipelined(client);
+        return;
+    }
+    RouteResult& res = task.getRoute();
+    res.setRequest(client->getRequest());
+    pollManager.addFd(client->getFd(), clientEvents(client));
+    if (applyRoute(client, res))
+        processRequest(client, connections.getServer(client->getFd()));
+}
+
+void ServerManager::finishUploadTask(Client* client, UploadTask& task) {
+    task.giveBack(client->getRawUpload(), client->getMultipart());
+    pollManager.addFd(client->getFd(), clientEvents(client));
+    uploadWritten(client, task.getStatus(), task.isLast(), task.getSaved());
+    processPipelined(client);
+}
+
+// processRequest() stops at a request answered off the read path (aio thread,
+// CGI, FastCGI, upstream), so what was pipelined behind it waits in the
+// receive buffer until its response is queued
+void ServerManager::processPipelined(Client* client) {
+    Server* server = connections.getServer(client->getFd());
+    if (server && !client->getStoreReceiveData().empty())
+        processRequest(client, server);
+}
+
+void ServerManager::finalizeResponse(Client* client, HttpResponse& response, ssize_t bodyLen) {
     if (!client->isKeepAlive())
-        resp.addHeader("Connection", "close");
+        response.addHeader("Connection", "close");
     else
-        resp.addHeader("Connection", "keep-alive");
-    client->setSendData(resp.toString());
+        response.addHeader("Connection", "keep-alive");
+    client->queueResponse(response.toString());
     if (bodyLen > 0)
         client->removeReceivedData(bodyLen);
-    else
-        client->clearStoreReceiveData();
     client->setHeadersParsed(false);
     client->getRequest().clear();
-    clientRoutes.erase(client->getFd());
+    connections.clearRoute(client->getFd());
     pollManager.addFd(client->getFd(), POLLIN | POLLOUT);
 }
 
@@ -314,50 +598,58 @@ bool ServerManager::parseAndRouteHeaders(Client* client, Server* server) {
     }
     client->getRequest().setPort(server->getPort());
 
-    bool   keepAlive = (client->getRequest().getHttpVersion() == HTTP_VERSION_1_1);
-    String conn      = toLowerWords(client->getRequest().getHeader("connection"));
-    if (conn == "close")
+    bool keepAlive = (client->getRequest().getHttpVersion() == HTTP_VERSION_1_1);
+    if (client->getRequest().headerEquals("connection", "close"))
         keepAlive = false;
-    else if (conn == "keep-alive")
+    else if (client->getRequest().headerEquals("connection", "keep-alive"))
         keepAlive = true;
     client->setKeepAlive(keepAlive);
 
     client->setHeadersParsed(true);
     client->removeReceivedData(headerEnd + headerEndLen);
 
-    Router      router(serverToConfigs[server->getFd()], client->getRequest());
+    // routing stats files: with aio threads that is done on one
+    Router router(serverToConfigs[server->getFd()], client->getRequest());
+    if (aioPool.isEnabled() && router.needsFilesystem()) {
+        RouteTask* task = new RouteTask(client->getFd(), responseBuilder, serverToConfigs[server->getFd()], client->getRequest());
+        client->setAioTask(task);
+        aioPool.post(task);
+        pollManager.addFd(client->getFd(), 0);
+        return false;
+    }
     RouteResult res = router.processRequest();
-    res.setRemoteAddress(client->getRemoteAddress());
-    clientRoutes[client->getFd()] = res;
+    return applyRoute(client, res);
+}
+
+bool ServerManager::applyRoute(Client* client, RouteResult& res) {
+    if (res.getHandlerType() == CGI || res.getHandlerType() == FASTCGI || res.getHandlerType() == PROXY)
+        res.setRemoteAddress(client->getRemoteAddress());
+    connections.setRoute(client->getFd(), res);
 
     if (res.getStatusCode() >= 400) {
         sendErrorResponse(client, res.getStatusCode(),
                           res.getErrorMessage().empty() ? getHttpStatusMessage(res.getStatusCode()) : res.getErrorMessage(), true, 0);
-        clientRoutes.erase(client->getFd());
+        connections.clearRoute(client->getFd());
         return false;
     }
 
-    bool hasContentLength = !client->getRequest().getHeader("content-length").empty();
-    bool isChunked        = (toLowerWords(client->getRequest().getHeader("transfer-encoding")).find("chunked") != String::npos);
+    bool hasContentLength = client->getRequest().hasHeader("content-length");
+    bool isChunked        = client->getRequest().isChunked();
 
     if (!validateRequestBody(client, res, hasContentLength, isChunked))
         return false;
 
-    if (res.getHandlerType() == CGI) {
-        ssize_t cl = client->getRequest().getContentLength();
-        if (cl <= 0 && !isChunked)
-            client->getCgi().setWriteDone(true);
-        responseBuilder.build(res, &client->getCgi(), VectorInt());
-        if (client->getCgi().isActive())
-            registerCgiPipes(client);
-    }
+    if (res.getHandlerType() == CGI && !admitCgi(client, res, client->getRequest().getContentLength() > 0 || isChunked))
+        return false;
+    if (res.getHandlerType() == UPLOAD && !beginUpload(client, res))
+        return false;
     return true;
 }
 
 bool ServerManager::validateRequestBody(Client* client, const RouteResult& res, bool hasContentLength, bool isChunked) {
     if (hasContentLength && isChunked) {
         sendErrorResponse(client, HTTP_BAD_REQUEST, getHttpStatusMessage(HTTP_BAD_REQUEST), true, 0);
-        clientRoutes.erase(client->getFd());
+        connections.clearRoute(client->getFd());
         return false;
     }
 
@@ -366,13 +658,13 @@ bool ServerManager::validateRequestBody(Client* client, const RouteResult& res,
 
     if ((method == "GET" || method == "DELETE" || method == "TRACE") && (hasContentLength || isChunked)) {
         sendErrorResponse(client, HTTP_BAD_REQUEST, getHttpStatusMessage(HTTP_BAD_REQUEST), true, 0);
-        clientRoutes.erase(client->getFd());
+        connections.clearRoute(client->getFd());
         return false;
     }
 
     if ((method == "POST" || method == "PUT" || method == "PATCH") && !hasContentLength && !isChunked) {
         sendErrorResponse(client, HTTP_LENGTH_REQUIRED, getHttpStatusMessage(HTTP_LENGTH_REQUIRED), true, 0);
-        clientRoutes.erase(client->getFd());
+        connections.clearRoute(client->getFd());
         return false;
     }
 
@@ -380,151 +672,698 @@ bool ServerManager::validateRequestBody(Client* client, const RouteResult& res,
         size_t cl = client->getRequest().getContentLength();
         if (maxBody >= 0 && (ssize_t)cl > maxBody) {
             sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
-            clientRoutes.erase(client->getFd());
+            connections.clearRoute(client->getFd());
             return false;
         }
     }
 
     if (maxBody >= 0 && client->getStoreReceiveData().size() > (size_t)maxBody) {
         sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
-        clientRoutes.erase(client->getFd());
+        connections.clearRoute(client->getFd());
         return false;
     }
     return true;
 }
 
-void ServerManager::handleCgiBodyStreaming(Client* client) {
-    bool        isChunked = (toLowerWords(client->getRequest().getHeader("transfer-encoding")).find("chunked") != String::npos);
-    RouteResult boundRes  = getValue(clientRoutes, client->getFd(), RouteResult());
-    ssize_t     maxBody   = getMaxBodySize(boundRes);
+// Moves body bytes from the receive buffer to the CGI's stdin as they arrive,
+// decoding a chunked body on the fly; the request keeps no copy. Once
+// CGI_STREAM_BUFFER bytes wait for the pipe the rest stays in the receive
+// buffer and the socket is no longer polled, until handleCgiWrite drains it.
+// Returns false when the body was rejected.
+bool ServerManager::handleCgiBodyStreaming(Client* client) {
+    CgiProcess&   cgi     = client->getCgi();
+    HttpRequest&  req     = client->getRequest();
+    const String& input   = client->getStoreReceiveData();
+    bool          done    = false;
+    size_t        room    = 0;
+    size_t        consumed;
+    if (cgi.isBodyComplete())
+        return true;
+    if (cgi.getPendingWrite() < CGI_STREAM_BUFFER)
+        room = CGI_STREAM_BUFFER - cgi.getPendingWrite();
 
-    if (isChunked) {
-        if (maxBody >= 0 && client->getStoreReceiveData().size() > (size_t)maxBody) {
-            sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
-            clientRoutes.erase(client->getFd());
-            return;
-        }
-        String decoded;
-        if (decodeChunkedBody(client->getStoreReceiveData(), decoded)) {
-            if (maxBody >= 0 && decoded.size() > (size_t)maxBody) {
-                sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
-                clientRoutes.erase(client->getFd());
-                return;
-            }
-            client->getCgi().appendBuffer(decoded);
-            client->getCgi().setWriteDone(true);
-            client->clearStoreReceiveData();
-            pollManager.addFd(client->getCgi().getWriteFd(), POLLOUT);
-        }
+    if (req.isChunked()) {
+        ChunkedDecoder& decoder = req.getChunkedDecoder();
+        ssize_t         maxBody = getMaxBodySize(connections.getRoute(client->getFd()));
+        String          part;
+        ChunkedStatus   status  = decoder.decode(input, part, consumed, room);
+        if (status == CHUNKED_INVALID)
+            return rejectCgiBody(client, HTTP_BAD_REQUEST);
+        if (maxBody >= 0 && decoder.getDecodedSize() > (size_t)maxBody)
+            return rejectCgiBody(client, HTTP_PAYLOAD_TOO_LARGE);
+        cgi.appendBuffer(part);
+        done = (status == CHUNKED_COMPLETE);
     } else {
-        size_t cl              = client->getRequest().getContentLength();
-        size_t currentBodySize = client->getRequest().getBody().size();
-        if (cl < currentBodySize) {
-            sendErrorResponse(client, HTTP_BAD_REQUEST, getHttpStatusMessage(HTTP_BAD_REQUEST), true, 0);
-            clientRoutes.erase(client->getFd());
-            return;
-        }
-        size_t toWrite = std::min(client->getStoreReceiveData().size(), cl - currentBodySize);
-        if (toWrite > 0) {
-            String part = client->getStoreReceiveData().substr(0, toWrite);
-            if (maxBody >= 0 && (ssize_t)(currentBodySize + part.size()) > maxBody) {
-                sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
-                clientRoutes.erase(client->getFd());
-                return;
-            }
-            client->getCgi().appendBuffer(part);
-            client->getRequest().parseBody(client->getRequest().getBody() + part);
-            client->removeReceivedData(toWrite);
-            if (client->getCgi().getWriteFd() != -1)
-                pollManager.addFd(client->getCgi().getWriteFd(), POLLOUT);
+        size_t left = req.getContentLength() - req.getBodyReceived();
+        consumed    = std::min(std::min(input.size(), left), room);
+        if (consumed > 0)
+            cgi.appendBuffer(input.substr(0, consumed));
+        req.addBodyReceived(consumed);
+        done = (consumed == left);
+    }
+    client->removeReceivedData(consumed);
+    if (done)
+        cgi.setWriteDone(true);
+    if (cgi.getWriteFd() != INVALID_FD && (cgi.getPendingWrite() > 0 || done))
+        pollManager.addFd(cgi.getWriteFd(), POLLOUT);
+    pollManager.addFd(client->getFd(), clientEvents(client));
+    return true;
+}
+
+// The CGI is stopped and the connection closed after the error, since the
+// rest of the body is never read. A response already under way is cut off.
+bool ServerManager::rejectCgiBody(Client* client, int statusCode) {
+    bool streaming = client->getCgi().isHeadersSent();
+    cleanupClientCgi(client);
+    if (streaming) {
+        closeClientConnection(client->getFd());
+        return false;
+    }
+    sendErrorResponse(client, statusCode, getHttpStatusMessage(statusCode), true, 0);
+    connections.clearRoute(client->getFd());
+    return false;
+}
+
+// POLLIN is left out while a CGI's stdin buffer is full, so the rest of the
+// body waits in the socket instead of in memory. POLLOUT is kept while CGI
+// output waits for room in the socket.
+int ServerManager::clientEvents(Client* client) const {
+    int events = (client->getStoreSendData().empty() && !client->getCgi().isReadPaused()) ? 0 : POLLOUT;
+    if (!client->getCgi().isWriteBufferFull())
+        events |= POLLIN;
+    return events;
+}
+
+// A Content-Length body goes from the socket straight into a forked CGI's
+// stdin once no part of it is left in userspace buffers
+bool ServerManager::canSpliceBody(Client* client) {
+    CgiProcess& cgi = client->getCgi();
+    if (!client->isHeadersParsed() || !cgi.isActive() || !cgi.canSplice() || cgi.isBodyComplete())
+        return false;
+    if (cgi.getWriteFd() == INVALID_FD || cgi.getPendingWrite() > 0 || !client->getStoreReceiveData().empty())
+        return false;
+    return !client->getRequest().isChunked();
+}
+
+// Called on POLLIN, so a failed splice means the pipe is full: the socket
+// waits until handleCgiWrite sees room again
+void ServerManager::spliceCgiBody(Client* client) {
+    CgiProcess&  cgi  = client->getCgi();
+    HttpRequest& req  = client->getRequest();
+    size_t       left = req.getContentLength() - req.getBodyReceived();
+    ssize_t      n    = cgi.spliceBody(client->getFd(), left);
+    if (n == 0) {
+        closeClientConnection(client->getFd());
+        return;
+    }
+    if (n > 0) {
+        client->refreshActivity();
+        req.addBodyReceived(n);
+        if ((size_t)n == left) {
+            cgi.setWriteDone(true);
+            pollManager.addFd(cgi.getWriteFd(), POLLOUT);
         }
-        if (client->getRequest().getBody().size() >= cl)
-            client->getCgi().setWriteDone(true);
+    } else if (cgi.isWriteBufferFull()) {
+        pollManager.addFd(cgi.getWriteFd(), POLLOUT);
     }
+    pollManager.addFd(client->getFd(), clientEvents(client));
 }
 
 bool ServerManager::handleRegularBody(Client* client) {
-    bool    isChunked = (toLowerWords(client->getRequest().getHeader("transfer-encoding")).find("chunked") != String::npos);
+    bool    isChunked = client->getRequest().isChunked();
     ssize_t cl        = client->getRequest().getContentLength();
 
     if (!isChunked && client->getStoreReceiveData().size() >= (size_t)cl) {
         if (cl > 0)
             client->getRequest().parseBody(client->getStoreReceiveData().substr(0, cl));
-        RouteResult res = getValue(clientRoutes, client->getFd(), RouteResult());
+        // A copy: starting a CGI, FastCGI or proxy request registers new fds,
+        // which may grow the connection table the stored route lives in
+        RouteResult res = connections.getRoute(client->getFd());
 
         if (res.getHandlerType() == CGI) {
-            bool isChunked2 = (toLowerWords(client->getRequest().getHeader("transfer-encoding")).find("chunked") != String::npos);
-            if (cl <= 0 && !isChunked2)
-                client->getCgi().setWriteDone(true);
-            responseBuilder.build(res, &client->getCgi(), VectorInt());
-            if (client->getCgi().isActive()) {
-                registerCgiPipes(client);
+            if (startCgi(client, res, cl > 0))
                 return true;
-            }
+        } else if (res.getHandlerType() == FASTCGI) {
+            return startFastCgi(client, res, cl);
+        } else if (res.getHandlerType() == PROXY) {
+            return startProxy(client, res, cl);
         } else {
-            HttpResponse response = responseBuilder.build(res, &client->getCgi(), VectorInt());
-            finalizeResponse(client, response, cl);
+            respond(client, res, cl);
             return true;
         }
     } else if (isChunked) {
-        String decoded;
-        if (decodeChunkedBody(client->getStoreReceiveData(), decoded)) {
-            RouteResult res     = getValue(clientRoutes, client->getFd(), RouteResult());
-            ssize_t     maxBody = getMaxBodySize(res);
-
-            if (maxBody >= 0 && decoded.size() > (size_t)maxBody) {
-                sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
-                clientRoutes.erase(client->getFd());
-                return false;
-            }
+        // decoded as it arrives, like a streamed body, so a request pipelined
+        // behind the last chunk stays in the receive buffer
+        HttpRequest&    req     = client->getRequest();
+        ChunkedDecoder& decoder = req.getChunkedDecoder();
+        const String&   input   = client->getStoreReceiveData();
+        String          part;
+        size_t          consumed;
+        ChunkedStatus   status  = decoder.decode(input, part, consumed, input.size());
+        RouteResult     res     = connections.getRoute(client->getFd()); // copied, as above
+        ssize_t         maxBody = getMaxBodySize(res);
 
-            client->getRequest().parseBody(decoded);
+        if (status == CHUNKED_INVALID) {
+            sendErrorResponse(client, HTTP_BAD_REQUEST, getHttpStatusMessage(HTTP_BAD_REQUEST), true, 0);
+            connections.clearRoute(client->getFd());
+            return false;
+        }
+        if (maxBody >= 0 && decoder.getDecodedSize() > (size_t)maxBody) {
+            sendErrorResponse(client, HTTP_PAYLOAD_TOO_LARGE, getHttpStatusMessage(HTTP_PAYLOAD_TOO_LARGE), true, 0);
+            connections.clearRoute(client->getFd());
+            return false;
+        }
+        req.appendBody(part);
+        client->removeReceivedData(consumed);
+        if (status != CHUNKED_COMPLETE)
+            return false;
 
-            if (res.getHandlerType() == CGI) {
-                client->getCgi().appendBuffer(decoded);
+        if (res.getHandlerType() == CGI) {
+            if (startCgi(client, res, true)) {
+                client->getCgi().appendBuffer(req.getBody());
                 client->getCgi().setWriteDone(true);
-                responseBuilder.build(res, &client->getCgi(), VectorInt());
-                if (client->getCgi().isActive()) {
-                    registerCgiPipes(client);
-                    return true;
-                }
-            } else {
-                HttpResponse response = responseBuilder.build(res, &client->getCgi(), VectorInt());
-                finalizeResponse(client, response, 0);
                 return true;
             }
+        } else if (res.getHandlerType() == FASTCGI) {
+            return startFastCgi(client, res, 0);
+        } else if (res.getHandlerType() == PROXY) {
+            return startProxy(client, res, 0);
+        } else {
+            respond(client, res, 0);
+            return true;
         }
     }
     return false;
 }
 
+// Upload bodies go to disk as they arrive instead of being buffered for
+// ResponseBuilder: a multipart body with a boundary through MultipartUpload,
+// anything else as one file through RawUpload
+bool ServerManager::beginUpload(Client* client, const RouteResult& res) {
+    HttpRequest&          req         = client->getRequest();
+    const LocationConfig* loc         = res.getLocation();
+    String                contentType = req.getContentType();
+    String                boundary;
+    if (contentType.find("multipart/form-data") != String::npos)
+        boundary = extractBoundaryFromContentType(contentType);
+    if (!boundary.empty()) {
+        client->getMultipart().begin(loc->getUploadDir(), boundary);
+        return true;
+    }
+
+    String filename;
+    if (contentType.find("multipart/form-data") == String::npos)
+        filename = sanitizeFilename(extractFilenameFromHeader(req.getHeader(HEADER_CONTENT_DISPOSITION)));
+    if (filename.empty() || filename == "." || filename == "..")
+        filename = "upload_" + typeToString<time_t>(getCurrentTime()) + ".dat";
+    bool   isChunked = req.isChunked();
+    size_t length    = isChunked ? 0 : req.getContentLength();
+    // the file is created before any of the body is taken; false once rejected
+    client->getRawUpload().begin(loc->getUploadDir(), filename, length, loc->getUploadIo());
+    writeUpload(client, "", 0, 0, false);
+    return client->getAioTask() || client->getRawUpload().isActive();
+}
+
+// Hands body bytes to the upload as soon as they are read, decoding a chunked
+// body on the fly, so neither the receive buffer nor the request holds the
+// body. Returns true once the response is queued.
+bool ServerManager::handleUploadBody(Client* client) {
+    HttpRequest&  req   = client->getRequest();
+    const String& input = client->getStoreReceiveData();
+    const char*   data  = input.data();
+    size_t        length;
+    size_t        consumed;
+    bool          done;
+    String        part;
+
+    if (req.isChunked()) {
+        ChunkedDecoder& decoder = req.getChunkedDecoder();
+        ssize_t         maxBody = getMaxBodySize(connections.getRoute(client->getFd()));
+        ChunkedStatus   chunked = decoder.decode(input, part, consumed, input.size());
+        if (chunked == CHUNKED_INVALID)
+            return rejectUpload(client, HTTP_BAD_REQUEST);
+        if (maxBody >= 0 && decoder.getDecodedSize() > (size_t)maxBody)
+            return rejectUpload(client, HTTP_PAYLOAD_TOO_LARGE);
+        data   = part.data();
+        length = part.size();
+        done   = (chunked == CHUNKED_COMPLETE);
+    } else {
+        size_t left = req.getContentLength() - req.getBodyReceived();
+        consumed    = std::min(input.size(), left);
+        length      = consumed;
+        req.addBodyReceived(consumed);
+        done = (consumed == left);
+    }
+    // a rejected upload has cleared the receive buffer already
+    bool answered = (length > 0 || done) && writeUpload(client, data, length, 0, done);
+    client->removeReceivedData(consumed);
+    return answered;
+}
+
+// A Content-Length body for an upload_io splice location goes from the socket
+// to the file once no part of it is left in the receive buffer
+bool ServerManager::canSpliceUpload(Client* client) {
+    if (!client->isHeadersParsed() || !client->getRawUpload().canSplice() || !client->getStoreReceiveData().empty())
+        return false;
+    return !client->getRequest().isChunked();
+}
+
+// Filling the pipe only moves socket pages; the pipe is drained into the
+// file along with the rest of the upload's disk work
+void ServerManager::spliceUpload(Client* client) {
+    HttpRequest& req   = client->getRequest();
+    size_t       left  = req.getContentLength() - req.getBodyReceived();
+    ssize_t      moved = client->getRawUpload().fillPipe(client->getFd(), left);
+    if (moved == 0) {
+        closeClientConnection(client->getFd());
+        return;
+    }
+    if (moved < 0)
+        return; // nothing to read yet, or splice was refused and the next read copies
+    client->refreshActivity();
+    req.addBodyReceived(moved);
+    writeUpload(client, "", 0, moved, (size_t)moved == left);
+}
+
+// With aio threads the piece goes to one, and the client is left out of
+// poll() until it is written, so pieces reach the file in order. Returns true
+// once the response is queued.
+bool ServerManager::writeUpload(Client* client, const char* data, size_t len, size_t spliced, bool last) {
+    if (aioPool.isEnabled()) {
+        UploadTask* task = new UploadTask(client->getFd(), client->getRawUpload(), client->getMultipart(), data, len, spliced, last);
+        client->setAioTask(task);
+        aioPool.post(task);
+        pollManager.addFd(client->getFd(), 0);
+        return false;
+    }
+    VectorString    saved;
+    MultipartStatus status = UploadTask::write(client->getRawUpload(), client->getMultipart(), data, len, spliced, last, saved);
+    return uploadWritten(client, status, last, saved);
+}
+
+bool ServerManager::uploadWritten(Client* client, MultipartStatus status, bool last, const VectorString& saved) {
+    if (status == MULTIPART_FAILED)
+        return rejectUpload(client, uploadFailureStatus(client));
+    if (status == MULTIPART_INVALID || (last && status != MULTIPART_COMPLETE))
+        return rejectUpload(client, HTTP_BAD_REQUEST);
+    if (!last)
+        return false;
+
+    HttpResponse    response;
+    UploaderHandler uploader;
+    if (!uploader.respond(saved, response))
+        return rejectUpload(client, HTTP_BAD_REQUEST); // multipart body without a file part
+    finalizeResponse(client, response, 0);
+    return true;
+}
+
+// The file being written is removed; the connection is closed since the rest
+// of the body is never read
+bool ServerManager::rejectUpload(Client* client, int statusCode) {
+    client->getMultipart().abort();
+    client->getRawUpload().abort();
+    sendErrorResponse(client, statusCode, getHttpStatusMessage(statusCode), true, 0);
+    connections.clearRoute(client->getFd());
+    return false;
+}
+
+int ServerManager::uploadFailureStatus(Client* client) const {
+    return client->getRawUpload().isOutOfSpace() ? HTTP_INSUFFICIENT_STORAGE : HTTP_INTERNAL_SERVER_ERROR;
+}
+
 void ServerManager::closeClientConnection(int clientFd) {
-    Client* c = getValue(clients, clientFd, (Client*)NULL);
+    Client* c = connections.getClient(clientFd);
     if (c) {
+        cgiQueue.release(clientFd);
+        releaseCgiCacheLock(c);
+        c->getMultipart().abort();
+        c->getRawUpload().abort();
         if (c->getCgi().isActive())
             cleanupClientCgi(c);
+        if (c->getFastCgi().isActive())
+            cleanupClientFastCgi(c);
+        if (c->getProxy().isActive())
+            cleanupClientProxy(c);
         c->closeConnection();
-        delete c;
+        clientPool.release(c);
     }
     pollManager.removeFdByValue(clientFd);
-    clients.erase(clientFd);
-    clientToServer.erase(clientFd);
+    connections.remove(clientFd);
+    if (overloaded && connections.getClientCount() < httpConfig.getMaxConnections()) {
+        overloaded = false;
+        Logger::info("Connections below max_connections, accepting again");
+        resumeListeners();
+    }
 }
 
 bool ServerManager::isCgiPipe(int fd) const {
-    return cgiPipeToClient.count(fd);
+    return connections.getKind(fd) == FD_CGI_PIPE;
+}
+
+// Stops polling a CGI pipe, FastCGI or proxy connection, or health probe,
+// and forgets it in the connection table. Closing it is up to the owner.
+void ServerManager::removeWatchedFd(int fd) {
+    pollManager.removeFdByValue(fd);
+    connections.remove(fd);
+}
+
+// A cgi_cache_valid hit is answered without a slot. On a miss the first
+// request takes the key's lock and runs the script; identical ones wait for
+// its output, polled for nothing, and are answered from the cache. Like a
+// started or queued request, both return true.
+bool ServerManager::admitCgi(Client* client, const RouteResult& res, bool hasBody) {
+    if (CgiCache::isCacheable(res, hasBody)) {
+        String       key = CgiCache::makeKey(res);
+        HttpResponse cached;
+        if (cgiCache.lookup(key, cached)) {
+            sendUpstreamResponse(client, cached);
+            return true;
+        }
+        if (!cgiCache.lock(key, client->getFd())) {
+            client->setCgiCacheLock(CACHE_LOCK_WAITING, key);
+            client->refreshActivity();
+            pollManager.addFd(client->getFd(), 0);
+            return true;
+        }
+        client->setCgiCacheLock(CACHE_LOCK_HELD, key);
+    }
+    if (runCgi(client, res, hasBody))
+        return true;
+    releaseCgiCacheLock(client);
+    return false;
+}
+
+// Past cgi_max_concurrency the request waits in the location's queue, its
+// body left unread in the socket. A full queue is answered with 503 right
+// away, as is a request that waited longer than cgi_queue_timeout.
+bool ServerManager::runCgi(Client* client, const RouteResult& res, bool hasBody) {
+    const LocationConfig* loc = res.getLocation();
+    if (!cgiQueue.isLimited(loc))
+        return startCgi(client, res, hasBody);
+    if (cgiQueue.acquire(loc, client->getFd())) {
+        if (startCgi(client, res, hasBody))
+            return true;
+        cgiQueue.release(client->getFd());
+        return false;
+    }
+    if (!cgiQueue.enqueue(loc, client->getFd())) {
+        sendErrorResponse(client, HTTP_SERVICE_UNAVAILABLE, "CGI Queue Full", true, 0);
+        connections.clearRoute(client->getFd());
+        return false;
+    }
+    client->setCgiQueued(true);
+    pollManager.addFd(client->getFd(), 0);
+    return true;
+}
+
+// Waiters are answered from the cache when the script's output was stored.
+// Otherwise (not cacheable, failed, cut short) they all run it at once rather
+// than taking the lock in turn, as proxy_cache_lock waiters do.
+void ServerManager::releaseCgiCacheLock(Client* client) {
+    CacheLock lock = client->getCgiCacheLock();
+    String    key  = client->getCgiCacheKey();
+    client->setCgiCacheLock(CACHE_LOCK_NONE, "");
+    if (lock == CACHE_LOCK_WAITING)
+        cgiCache.stopWaiting(key, client->getFd());
+    if (lock != CACHE_LOCK_HELD)
+        return;
+    VectorInt waiters;
+    cgiCache.unlock(key, waiters);
+    for (size_t i = 0; i < waiters.size(); ++i) {
+        Client* waiter = connections.getClient(waiters[i]);
+        if (waiter && waiter->getCgiCacheLock() == CACHE_LOCK_WAITING) {
+            resumeCgiCacheWaiter(waiter, false);
+            processPipelined(waiter);
+        }
+    }
+}
+
+// A waiter past CGI_CACHE_LOCK_TIMEOUT stops waiting and runs the script itself
+void ServerManager::resumeCgiCacheWaiter(Client* client, bool timedOut) {
+    int          fd  = client->getFd();
+    String       key = client->getCgiCacheKey();
+    HttpResponse cached;
+    if (timedOut)
+        cgiCache.stopWaiting(key, fd);
+    client->setCgiCacheLock(CACHE_LOCK_NONE, "");
+    if (!timedOut && cgiCache.lookup(key, cached)) {
+        sendUpstreamResponse(client, cached);
+        return;
+    }
+    RouteResult res = connections.getRoute(fd); // copied: startCgi() may grow the table
+    if (runCgi(client, res, false) && !client->isCgiQueued())
+        pollManager.addFd(fd, clientEvents(client));
+}
+
+void ServerManager::registerCgiLimits() {
+    for (std::map<int, VectorServerConfig>::iterator it = serverToConfigs.begin(); it != serverToConfigs.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); ++i) {
+            const ServerConfig&         srv = it->second[i];
+            const VectorLocationConfig& locs = srv.getLocations();
+            // a server block is copied for each of its listeners: name it by all of them
+            String key = srv.getServerName();
+            for (size_t j = 0; j < srv.getListenAddresses().size(); ++j)
+                key += " " + srv.getListenAddresses()[j].getListenAddress();
+            for (size_t j = 0; j < locs.size(); ++j)
+                cgiQueue.addLocation(&locs[j], key + " " + locs[j].getPath());
+        }
+    }
+}
+
+// Runs once per event loop round: drops requests that waited too long, then
+// starts the ones whose turn came now that slots were released
+void ServerManager::serveCgiQueue() {
+    int fd;
+    while ((fd = cgiQueue.nextExpired()) != INVALID_FD) {
+        Client* client = connections.getClient(fd);
+        client->setCgiQueued(false);
+        sendErrorResponse(client, HTTP_SERVICE_UNAVAILABLE, "CGI Queue Timeout", true, 0);
+        connections.clearRoute(fd);
+        releaseCgiCacheLock(client);
+    }
+    while ((fd = cgiQueue.nextReady()) != INVALID_FD) {
+        Client*     client    = connections.getClient(fd);
+        RouteResult res       = connections.getRoute(fd); // copied: startCgi() may grow the table
+        bool        isChunked = client->getRequest().isChunked();
+        client->setCgiQueued(false);
+        if (!startCgi(client, res, client->getRequest().getContentLength() > 0 || isChunked)) {
+            cgiQueue.release(fd);
+            releaseCgiCacheLock(client);
+            continue;
+        }
+        pollManager.addFd(fd, clientEvents(client));
+        processRequest(client, connections.getServer(fd));
+    }
+}
+
+// Hands the request to a pre-spawned worker when the location has a
+// cgi_worker for the script's extension, otherwise spawns a new CGI process.
+// When neither starts, the error is queued and the connection closed, since
+// the request body has not been read.
+bool ServerManager::startCgi(Client* client, const RouteResult& res, bool hasBody) {
+    CgiProcess& cgi = client->getCgi();
+    if (!startCgiWorker(client, res)) {
+        HttpResponse response = responseBuilder.build(res, &cgi, VectorInt());
+        if (!cgi.isActive()) {
+            sendErrorResponse(client, response.getStatusCode(), response.getStatusMessage(), true, 0);
+            connections.clearRoute(client->getFd());
+            return false;
+        }
+    }
+    if (!hasBody)
+        cgi.setWriteDone(true);
+    if (CgiCache::isCacheable(res, hasBody))
+        cgi.startCaching(CgiCache::makeKey(res), res.getLocation()->getCgiCacheValid());
+    registerCgiPipes(client);
+    return true;
+}
+
+bool ServerManager::startCgiWorker(Client* client, const RouteResult& res) {
+    const LocationConfig* loc = res.getLocation();
+    if (!loc)
+        return false;
+    String                 extension = extractFileExtension(res.getPathRootUri());
+    const CgiWorkerConfig* config    = loc->getCgiWorker(extension);
+    if (!config)
+        return false;
+    int   writeFd, readFd;
+    pid_t pid = cgiWorkers.acquire(loc->getCgiInterpreter(extension), *config, writeFd, readFd);
+    if (pid < 0)
+        return false;
+    client->getCgi().initWorker(pid, writeFd, readFd, CgiHandler::buildEnv(res));
+    return true;
+}
+
+void ServerManager::prespawnCgiWorkers() {
+    for (size_t i = 0; i < serverConfigs.size(); ++i) {
+        const VectorLocationConfig& locs = serverConfigs[i].getLocations();
+        for (size_t j = 0; j < locs.size(); ++j) {
+            const MapCgiWorkerConfig& workers = locs[j].getCgiWorkers();
+            for (MapCgiWorkerConfig::const_iterator it = workers.begin(); it != workers.end(); ++it)
+                cgiWorkers.prespawn(locs[j].getCgiInterpreter(it->first), it->second);
+        }
+    }
+}
+
+// The worker's pipes stay open for its next request; they only leave the poll set
+void ServerManager::finishCgiWorker(Client* client) {
+    CgiProcess& cgi = client->getCgi();
+    removeWatchedFd(cgi.getWriteFd());
+    removeWatchedFd(cgi.getReadFd());
+    cgiWorkers.release(cgi.getPid(), cgi.isResponseDone() && cgi.isWriteDone());
+    completeCgiResponse(client, cgi.isResponseDone());
+}
+
+// Queues the response head as soon as the script's header block is complete,
+// then forwards body bytes as they arrive. Reading the pipe stops while the
+// client is CGI_STREAM_BUFFER behind and resumes from handleClientWrite.
+void ServerManager::streamCgiOutput(Client* client) {
+    CgiProcess& cgi = client->getCgi();
+    if (!cgi.isHeadersSent()) {
+        if (!sendCgiHeaders(client))
+            return;
+    } else {
+        appendCgiBody(client, cgi.takeOutput());
+    }
+    if (!cgi.isReadPaused() && client->getStoreSendData().size() >= CGI_STREAM_BUFFER) {
+        pollManager.removeFdByValue(cgi.getReadFd());
+        cgi.setReadPaused(true);
+    }
+    pollManager.addFd(client->getFd(), clientEvents(client));
 }
 
-void ServerManager::removeCgiPipe(int pipeFd) {
-    pollManager.removeFdByValue(pipeFd);
-    cgiPipeToClient.erase(pipeFd);
+// Without a Content-Length from the script the body is sent chunked, or
+// delimited by closing the connection for an HTTP/1.0 client.
+bool ServerManager::sendCgiHeaders(Client* client) {
+    CgiProcess&  cgi = client->getCgi();
+    HttpResponse response;
+    size_t       bodyStart;
+    if (!CgiHandler::parseHeaders(cgi.getOutput(), response, bodyStart)) {
+        if (cgi.getOutput().size() < CGI_STREAM_BUFFER)
+            return false;
+        cleanupClientCgi(client);
+        sendErrorResponse(client, HTTP_INTERNAL_SERVER_ERROR, "CGI Error", true, 0);
+        connections.clearRoute(client->getFd());
+        return false;
+    }
+    int  status  = response.getStatusCode();
+    bool hasBody = status != HTTP_NO_CONTENT && status != HTTP_NOT_MODIFIED;
+    bool chunked = false;
+    if (hasBody && !response.hasHeader(HEADER_CONTENT_LENGTH)) {
+        if (client->getRequest().getHttpVersion() == HTTP_VERSION_1_1) {
+            response.addHeader(HEADER_TRANSFER_ENCODING, "chunked");
+            chunked = true;
+        } else {
+            client->setKeepAlive(false);
+        }
+    }
+    if (!client->isKeepAlive())
+        response.addHeader(HEADER_CONNECTION, "close");
+    if (cgi.isCaching())
+        response.addHeader(HEADER_CACHE_STATUS, "MISS");
+    client->appendSendData(response.headersToString());
+    cgi.startStream(chunked);
+    String output = cgi.takeOutput();
+    if (hasBody)
+        appendCgiBody(client, output.substr(bodyStart));
+    return true;
+}
+
+// Identity-coded output needs no framing, so once the head and the body bytes
+// read along with it are out, the rest can bypass userspace, unless it is
+// being kept for cgi_cache_valid
+bool ServerManager::canSpliceOutput(Client* client) {
+    CgiProcess& cgi = client->getCgi();
+    return cgi.isActive() && cgi.isHeadersSent() && !cgi.isChunked() && cgi.canSplice() && cgi.getOutput().empty() &&
+           !cgi.isCaching();
+}
+
+// Called on POLLIN of stdout; returns false at EOF. A failed splice means the
+// socket is full, so stdout leaves the poll set until handleClientWrite.
+bool ServerManager::spliceCgiOutput(Client* client) {
+    CgiProcess& cgi = client->getCgi();
+    ssize_t     n   = 0;
+    if (client->getStoreSendData().empty()) {
+        n = cgi.spliceOutput(client->getFd());
+        if (n == 0)
+            return false;
+        if (n > 0)
+            client->refreshActivity();
+    }
+    if (n <= 0 && cgi.canSplice()) {
+        pollManager.removeFdByValue(cgi.getReadFd());
+        cgi.setReadPaused(true);
+    }
+    pollManager.addFd(client->getFd(), clientEvents(client));
+    return true;
 }
 
+void ServerManager::appendCgiBody(Client* client, const String& data) {
+    appendStreamed(client, data, client->getCgi().isChunked());
+}
+
+void ServerManager::appendStreamed(Client* client, const String& data, bool chunked) {
+    if (data.empty())
+        return;
+    if (!chunked) {
+        client->appendSendData(data);
+        return;
+    }
+    std::ostringstream size;
+    size << std::hex << data.size();
+    client->appendSendData(size.str() + CRLF + data + CRLF);
+}
+
+// Output that ended before its header block was sent goes out as a single
+// response with a Content-Length. A streamed response only needs its last
+// chunk; one cut short is ended by closing the connection instead. So is one
+// that finished before reading its whole request body. Complete output is
+// offered to the cgi_cache_valid cache, which keeps it if it is a plain 200,
+// before the requests waiting for it are let go.
+void ServerManager::completeCgiResponse(Client* client, bool complete) {
+    CgiProcess& cgi = client->getCgi();
+    if (!cgi.isBodyComplete()) {
+        client->setKeepAlive(false);
+        client->clearStoreReceiveData();
+    }
+    cgiQueue.release(client->getFd());
+    if (cgi.isCrashed())
+        complete = false;
+    if (!cgi.isHeadersSent() && !complete) {
+        client->queueResponse(responseBuilder.buildError(HTTP_INTERNAL_SERVER_ERROR, "CGI Error").toString());
+        cgi.reset();
+    } else if (!cgi.isHeadersSent()) {
+        bool caching = cgi.isCaching();
+        if (caching)
+            cgiCache.store(cgi.getCacheKey(), cgi.getOutput(), cgi.getCacheValid());
+        HttpResponse response = responseBuilder.buildCgiResponse(cgi);
+        if (caching)
+            response.addHeader(HEADER_CACHE_STATUS, "MISS");
+        client->queueResponse(response.toString());
+    } else {
+        appendCgiBody(client, cgi.takeOutput());
+        if (complete && cgi.isBodyComplete() && cgi.isCaching())
+            cgiCache.store(cgi.getCacheKey(), cgi.takeCacheOutput(), cgi.getCacheValid());
+        if (!complete)
+            client->setKeepAlive(false);
+        else if (cgi.isChunked())
+            client->appendSendData(String("0") + DOUBLE_CRLF);
+        cgi.reset();
+    }
+    client->setHeadersParsed(false);
+    client->getRequest().clear();
+    connections.clearRoute(client->getFd());
+    pollManager.addFd(client->getFd(), POLLIN | POLLOUT);
+    releaseCgiCacheLock(client);
+}
+
+// The stdin pipe is only polled for POLLOUT while something waits to be written
 void ServerManager::registerCgiPipes(Client* client) {
     CgiProcess& cgi = client->getCgi();
     if (!cgi.isWriteDone()) {
-        pollManager.addFd(cgi.getWriteFd(), POLLOUT);
-        cgiPipeToClient[cgi.getWriteFd()] = client->getFd();
+        if (cgi.getPendingWrite() > 0)
+            pollManager.addFd(cgi.getWriteFd(), POLLOUT);
+        connections.setCgiPipe(cgi.getWriteFd(), client->getFd());
     } else {
         if (cgi.getWriteFd() != -1) {
             close(cgi.getWriteFd());
@@ -532,70 +1371,577 @@ void ServerManager::registerCgiPipes(Client* client) {
         }
     }
     pollManager.addFd(cgi.getReadFd(), POLLIN);
-    cgiPipeToClient[cgi.getReadFd()] = client->getFd();
+    connections.setCgiPipe(cgi.getReadFd(), client->getFd());
+    if (!cgi.isWorker())
+        childReaper.watch(cgi.getPid(), client->getFd());
 }
 
 void ServerManager::handleCgiWrite(int pipeFd) {
-    Client* client = getValue(clients, getValue(cgiPipeToClient, pipeFd, -1), (Client*)NULL);
-    if (!client || client->getCgi().writeBody(pipeFd)) {
-        removeCgiPipe(pipeFd);
-        if (client && client->getCgi().getWriteFd() != -1) {
+    Client* client = connections.getPipeOwner(pipeFd);
+    if (!client) {
+        removeWatchedFd(pipeFd);
+        return;
+    }
+    CgiProcess& cgi     = client->getCgi();
+    bool        wasFull = cgi.isWriteBufferFull();
+    cgi.setPipeFull(false);
+    if (cgi.writeBody(pipeFd)) {
+        removeWatchedFd(pipeFd);
+        if (cgi.getWriteFd() != -1 && !cgi.isWorker()) {
+            close(cgi.getWriteFd());
+            cgi.setWriteFd(-1);
+        }
+    } else if (cgi.getPendingWrite() == 0) {
+        // caught up with the client: wait for more of the body
+        pollManager.removeFdByValue(pipeFd);
+    }
+    // room again: take what was already received, then resume reading the socket
+    if (wasFull && !cgi.isWriteBufferFull())
+        handleCgiBodyStreaming(client);
+}
+
+void ServerManager::handleCgiRead(int pipeFd) {
+    Client* client = connections.getPipeOwner(pipeFd);
+    if (client && canSpliceOutput(client)) {
+        if (spliceCgiOutput(client))
+            return;
+    } else if (client && client->getCgi().handleRead()) {
+        streamCgiOutput(client);
+        return;
+    }
+    removeWatchedFd(pipeFd);
+    if (client && client->getCgi().isWorker()) {
+        finishCgiWorker(client);
+    } else if (client) {
+        if (client->getCgi().getWriteFd() != -1) {
+            removeWatchedFd(client->getCgi().getWriteFd());
             close(client->getCgi().getWriteFd());
             client->getCgi().setWriteFd(-1);
         }
+        if (client->getCgi().getReadFd() != -1) {
+            close(client->getCgi().getReadFd());
+            client->getCgi().setReadFd(-1);
+        }
+        // the script may still be flushing or exiting: wait for its status
+        client->getCgi().setOutputDone();
+        if (client->getCgi().hasExited())
+            completeCgiResponse(client, true);
     }
+    if (client && !client->getCgi().isActive())
+        processPipelined(client);
 }
 
-void ServerManager::handleCgiRead(int pipeFd) {
-    Client* client = getValue(clients, getValue(cgiPipeToClient, pipeFd, -1), (Client*)NULL);
-    if (!client || !client->getCgi().handleRead()) {
-        removeCgiPipe(pipeFd);
-        if (client) {
-            if (client->getCgi().getWriteFd() != -1) {
-                removeCgiPipe(client->getCgi().getWriteFd());
-                close(client->getCgi().getWriteFd());
-                client->getCgi().setWriteFd(-1);
-            }
-            if (client->getCgi().getReadFd() != -1) {
-                close(client->getCgi().getReadFd());
-                client->getCgi().setReadFd(-1);
-            }
-            client->setSendData(responseBuilder.buildCgiResponse(client->getCgi()).toString());
-            client->setHeadersParsed(false);
-            client->getRequest().clear();
-            clientRoutes.erase(client->getFd());
-            client->getCgi().finish();
-            pollManager.addFd(client->getFd(), POLLIN | POLLOUT);
+void ServerManager::handleChildExits() {
+    childReaper.reap();
+    pid_t pid;
+    int   ownerFd;
+    int   status;
+    while (childReaper.nextExit(pid, ownerFd, status)) {
+        // the owner may have gone, or already answered and moved on
+        Client* client = connections.getClient(ownerFd);
+        if (!client || !client->getCgi().isActive() || client->getCgi().getPid() != pid)
+            continue;
+        client->getCgi().setExitStatus(status);
+        if (client->getCgi().isOutputDone()) {
+            completeCgiResponse(client, true);
+            processPipelined(client);
         }
     }
 }
 
 void ServerManager::cleanupClientCgi(Client* client) {
     if (client->getCgi().getWriteFd() != -1)
-        removeCgiPipe(client->getCgi().getWriteFd());
+        removeWatchedFd(client->getCgi().getWriteFd());
     if (client->getCgi().getReadFd() != -1)
-        removeCgiPipe(client->getCgi().getReadFd());
+        removeWatchedFd(client->getCgi().getReadFd());
+    if (client->getCgi().isWorker()) {
+        // mid-request the worker's framing is unknown: retire it rather than reuse it
+        cgiWorkers.retire(client->getCgi().getPid());
+        client->getCgi().reset();
+        releaseCgiCacheLock(client);
+        return;
+    }
+    childReaper.release(client->getCgi().getPid());
     client->getCgi().cleanup();
+    cgiQueue.release(client->getFd());
+    releaseCgiCacheLock(client);
 }
 
-Server* ServerManager::findServerByFd(int serverFd) const {
-    for (size_t i = 0; i < servers.size(); i++)
-        if (servers[i]->getFd() == serverFd)
-            return servers[i];
+// ─── FastCGI ─────────────────────────────────────────────────────────────────
+
+// The body is complete: encode the request, consume it from the receive
+// buffer and hand it to an upstream connection. Returns true when a response
+// was queued right away (encoding or connecting failed).
+bool ServerManager::startFastCgi(Client* client, const RouteResult& res, ssize_t bodyLen) {
+    HttpResponse response = responseBuilder.build(res, NULL, VectorInt(), &client->getFastCgi());
+    if (!client->getFastCgi().isActive()) {
+        finalizeResponse(client, response, bodyLen);
+        return true;
+    }
+    if (bodyLen > 0)
+        client->removeReceivedData(bodyLen);
+    if (attachFastCgi(client))
+        return false;
+    client->getFastCgi().reset();
+    response = responseBuilder.buildError(HTTP_BAD_GATEWAY, "Bad Gateway");
+    sendUpstreamResponse(client, response);
+    return true;
+}
+
+bool ServerManager::attachFastCgi(Client* client) {
+    FastCgiRequest& fcgi = client->getFastCgi();
+    bool            reused, connecting;
+    int             fd = fastcgiPool.acquire(fcgi.getUpstream(), reused, connecting);
+    if (fd < 0)
+        return false;
+    fcgi.attach(fd, reused, connecting);
+    connections.setUpstream(fd, client->getFd());
+    pollManager.addFd(fd, POLLOUT);
+    return true;
+}
+
+void ServerManager::handleFastCgiEvent(int fd, bool readable, bool writable, bool failed) {
+    Client* client = connections.getUpstreamOwner(fd);
+    if (!client) {
+        // An idle pooled connection only becomes readable when the app closes it
+        fastcgiPool.remove(fd);
+        removeWatchedFd(fd);
+        close(fd);
+        return;
+    }
+    FastCgiRequest& fcgi   = client->getFastCgi();
+    FastCgiStatus   status = FCGI_PENDING;
+    if (writable) {
+        status = fcgi.handleWrite();
+        if (status == FCGI_COMPLETE) {
+            pollManager.addFd(fd, POLLIN);
+            status = FCGI_PENDING;
+        }
+    }
+    if (status == FCGI_PENDING && (readable || failed))
+        status = fcgi.handleRead();
+    if (status == FCGI_PENDING && failed && !readable)
+        status = FCGI_FAILED;
+
+    if (status == FCGI_COMPLETE)
+        finishFastCgi(client);
+    else if (status == FCGI_FAILED)
+        failFastCgi(client);
+    if (status != FCGI_PENDING)
+        processPipelined(client);
+}
+
+// Park the connection for the next request when the app kept it open
+void ServerManager::finishFastCgi(Client* client) {
+    FastCgiRequest& fcgi = client->getFastCgi();
+    int             fd   = fcgi.getFd();
+    if (fcgi.canKeepConnection() && fastcgiPool.release(fcgi.getUpstream(), fd)) {
+        connections.setUpstream(fd, INVALID_FD);
+        pollManager.addFd(fd, POLLIN);
+    } else {
+        removeWatchedFd(fd);
+        close(fd);
+    }
+    fcgi.detach();
+    HttpResponse response = responseBuilder.buildFastCgiResponse(fcgi);
+    sendUpstreamResponse(client, response);
+}
+
+// A pooled connection the app already closed fails before any reply: the
+// request has not been processed, so it is replayed on another connection.
+void ServerManager::failFastCgi(Client* client) {
+    FastCgiRequest& fcgi      = client->getFastCgi();
+    bool            retryable = fcgi.isReused() && !fcgi.hasResponseData();
+    removeWatchedFd(fcgi.getFd());
+    close(fcgi.getFd());
+    fcgi.detach();
+    if (retryable && attachFastCgi(client))
+        return;
+    Logger::error("FastCGI upstream " + fcgi.getUpstream() + " failed");
+    fcgi.reset();
+    HttpResponse response = responseBuilder.buildError(HTTP_BAD_GATEWAY, "Bad Gateway");
+    sendUpstreamResponse(client, response);
+}
+
+// Mid-request the upstream connection is in an unknown state, so it is closed rather than pooled
+void ServerManager::cleanupClientFastCgi(Client* client) {
+    FastCgiRequest& fcgi = client->getFastCgi();
+    if (fcgi.getFd() != INVALID_FD) {
+        removeWatchedFd(fcgi.getFd());
+        close(fcgi.getFd());
+    }
+    fcgi.reset();
+}
+
+// Like finalizeResponse, except the request body was already consumed when the upstream request started
+void ServerManager::sendUpstreamResponse(Client* client, HttpResponse& response) {
+    response.addHeader("Connection", client->isKeepAlive() ? "keep-alive" : "close");
+    client->queueResponse(response.toString());
+    client->setHeadersParsed(false);
+    client->getRequest().clear();
+    connections.clearRoute(client->getFd());
+    pollManager.addFd(client->getFd(), POLLIN | POLLOUT);
+}
+
+// ─── Proxy ───────────────────────────────────────────────────────────────────
+
+// Same shape as startFastCgi: the body is complete and consumed here, and
+// true means a response was queued right away
+bool ServerManager::startProxy(Client* client, const RouteResult& res, ssize_t bodyLen) {
+    HttpResponse response = responseBuilder.build(res, NULL, VectorInt(), NULL, &client->getProxy());
+    if (!client->getProxy().isActive()) {
+        finalizeResponse(client, response, bodyLen);
+        return true;
+    }
+    if (lookupProxyCache(client, res, response)) {
+        client->getProxy().reset();
+        finalizeResponse(client, response, bodyLen);
+        return true;
+    }
+    if (bodyLen > 0)
+        client->removeReceivedData(bodyLen);
+    // a proxy_cache_lock waiter is attached once the fetch it waits for ends
+    if (client->getProxy().getCacheLock() == CACHE_LOCK_WAITING)
+        return false;
+    if (attachProxy(client, -1))
+        return false;
+    client->getProxy().reset();
+    response = responseBuilder.buildError(HTTP_BAD_GATEWAY, "Bad Gateway");
+    sendUpstreamResponse(client, response);
+    return true;
+}
+
+// A fresh copy, or a stale one while another request refreshes it, answers
+// without the upstream; otherwise the response is marked to be stored
+bool ServerManager::lookupProxyCache(Client* client, const RouteResult& res, HttpResponse& response) {
+    const LocationConfig* loc = res.getLocation();
+    const HttpRequest&    req = client->getRequest();
+    if (!proxyCache.isEnabled() || !loc || !loc->hasProxyCache() || !ProxyCache::isCacheable(req))
+        return false;
+    String      key    = ProxyCache::makeKey(req);
+    CacheStatus status = proxyCache.lookup(key, req, response);
+    if (status == CACHE_HIT || status == CACHE_STALE)
+        return true;
+    ProxyRequest& proxy = client->getProxy();
+    proxy.startCaching(key, status, loc->getProxyCacheValid(), req.getMethod() == METHOD_GET);
+    if (loc->hasProxyCacheLock() && req.getMethod() == METHOD_GET)
+        proxy.setCacheLock(proxyCache.lock(key, client->getFd()) ? CACHE_LOCK_HELD : CACHE_LOCK_WAITING);
+    return false;
+}
+
+// The waiters of a released lock are answered from the cache when the fetch
+// stored a response. Otherwise they all go to the upstream at once rather
+// than taking the lock in turn, which would queue them behind each other.
+void ServerManager::releaseCacheLock(Client* client) {
+    ProxyRequest& proxy = client->getProxy();
+    CacheLock     lock  = proxy.getCacheLock();
+    proxy.setCacheLock(CACHE_LOCK_NONE);
+    if (lock == CACHE_LOCK_WAITING)
+        proxyCache.stopWaiting(proxy.getCacheKey(), client->getFd());
+    if (lock != CACHE_LOCK_HELD)
+        return;
+    VectorInt waiters;
+    proxyCache.unlock(proxy.getCacheKey(), waiters);
+    for (size_t i = 0; i < waiters.size(); ++i) {
+        Client* waiter = connections.getClient(waiters[i]);
+        if (waiter && waiter->getProxy().getCacheLock() == CACHE_LOCK_WAITING) {
+            resumeCacheWaiter(waiter, false);
+            processPipelined(waiter);
+        }
+    }
+}
+
+// A waiter past PROXY_CACHE_LOCK_TIMEOUT stops waiting and fetches for itself
+void ServerManager::resumeCacheWaiter(Client* client, bool timedOut) {
+    ProxyRequest& proxy  = client->getProxy();
+    CacheStatus   status = proxy.getCacheStatus();
+    HttpResponse  response;
+    if (timedOut)
+        proxyCache.stopWaiting(proxy.getCacheKey(), client->getFd());
+    else
+        status = proxyCache.lookup(proxy.getCacheKey(), client->getRequest(), response);
+    proxy.setCacheLock(CACHE_LOCK_NONE);
+    if (status == CACHE_HIT || status == CACHE_STALE) {
+        proxy.reset();
+        sendUpstreamResponse(client, response);
+        return;
+    }
+    proxy.startCaching(proxy.getCacheKey(), status, proxy.getCacheValid(), true);
+    proxy.resetStartTime();
+    if (attachProxy(client, -1))
+        return;
+    proxy.reset();
+    response = responseBuilder.buildError(HTTP_BAD_GATEWAY, "Bad Gateway");
+    sendUpstreamResponse(client, response);
+}
+
+// With an upstream block, a server is picked first; one that cannot even be
+// connected to counts as failed, and the next one is tried
+bool ServerManager::attachProxy(Client* client, int exclude) {
+    ProxyRequest&  proxy = client->getProxy();
+    UpstreamGroup* group = findUpstreamGroup(proxy.getUpstream());
+    bool           reused, connecting;
+    int            fd = INVALID_FD;
+    while (fd < 0) {
+        if (group) {
+            int server = group->select(client->getRequest(), exclude);
+            if (server < 0)
+                return Logger::error("No live servers in upstream " + group->getName());
+            group->acquire(server);
+            proxy.setServer(group->getAddress(server), server);
+        }
+        fd = proxyPool.acquire(proxy.getAddress(), reused, connecting);
+        if (fd >= 0)
+            break;
+        if (!group)
+            return false;
+        exclude = proxy.getServer();
+        releaseProxyServer(client, true);
+        if (proxy.getTries() >= group->size())
+            return false;
+    }
+    proxy.attach(fd, reused, connecting);
+    connections.setProxy(fd, client->getFd());
+    pollManager.addFd(fd, POLLOUT);
+    return true;
+}
+
+// Hands the server back to its upstream block, with the outcome for passive
+// health tracking
+void ServerManager::releaseProxyServer(Client* client, bool failed) {
+    ProxyRequest&  proxy = client->getProxy();
+    UpstreamGroup* group = findUpstreamGroup(proxy.getUpstream());
+    if (group && proxy.getServer() >= 0)
+        group->release(proxy.getServer(), failed);
+    proxy.clearServer();
+}
+
+void ServerManager::handleProxyEvent(int fd, bool readable, bool writable, bool failed) {
+    Client* client = connections.getUpstreamOwner(fd);
+    if (!client) {
+        // An idle pooled connection only becomes readable when the upstream closes it
+        proxyPool.remove(fd);
+        removeWatchedFd(fd);
+        close(fd);
+        return;
+    }
+    ProxyRequest& proxy  = client->getProxy();
+    ProxyStatus   status = PROXY_PENDING;
+    if (writable) {
+        status = proxy.handleWrite();
+        if (status == PROXY_COMPLETE) {
+            pollManager.addFd(fd, POLLIN);
+            status = PROXY_PENDING;
+        }
+    }
+    if (status == PROXY_PENDING && (readable || failed))
+        status = proxy.handleRead();
+    if (status == PROXY_PENDING && failed && !readable)
+        status = PROXY_FAILED;
+
+    if (status == PROXY_COMPLETE)
+        finishProxy(client);
+    else if (status == PROXY_FAILED)
+        failProxy(client);
+    else if (proxy.isHeadersDone())
+        streamProxyResponse(client);
+    if (status != PROXY_PENDING)
+        processPipelined(client);
+}
+
+// Queues the response head as soon as the upstream's is parsed, then forwards
+// body bytes as they arrive. Reading the upstream stops while the client is
+// PROXY_STREAM_BUFFER behind and resumes from handleClientWrite.
+void ServerManager::streamProxyResponse(Client* client) {
+    ProxyRequest& proxy = client->getProxy();
+    if (!proxy.isHeadersSent())
+        sendProxyHeaders(client);
+    appendStreamed(client, proxy.takeOutput(), proxy.isChunked());
+    if (!proxy.isReadPaused() && client->getStoreSendData().size() >= PROXY_STREAM_BUFFER) {
+        pollManager.removeFdByValue(proxy.getFd());
+        proxy.setReadPaused(true);
+    }
+    pollManager.addFd(client->getFd(), clientEvents(client));
+}
+
+// A body the upstream delimits by chunks or by closing is sent chunked, or
+// delimited by closing the connection for an HTTP/1.0 client
+void ServerManager::sendProxyHeaders(Client* client) {
+    ProxyRequest& proxy    = client->getProxy();
+    HttpResponse& response = proxy.getResponse();
+    bool          chunked  = false;
+    bool          unsized  = proxy.getFraming() == PROXY_BODY_CHUNKED || proxy.getFraming() == PROXY_BODY_CLOSE;
+    if (unsized && !response.hasHeader(HEADER_CONTENT_LENGTH)) {
+        if (client->getRequest().getHttpVersion() == HTTP_VERSION_1_1) {
+            response.addHeader(HEADER_TRANSFER_ENCODING, "chunked");
+            chunked = true;
+        } else {
+            client->setKeepAlive(false);
+        }
+    }
+    if (!proxy.getCacheKey().empty())
+        response.addHeader(HEADER_CACHE_STATUS, proxy.getCacheStatus() == CACHE_EXPIRED ? "EXPIRED" : "MISS");
+    response.addHeader(HEADER_CONNECTION, client->isKeepAlive() ? "keep-alive" : "close");
+    client->appendSendData(response.headersToString());
+    proxy.startStream(chunked);
+}
+
+// Parks the upstream connection for the next request when it can carry one.
+// A response read whole before its head went out gets a Content-Length.
+void ServerManager::finishProxy(Client* client) {
+    ProxyRequest& proxy = client->getProxy();
+    int           fd    = proxy.getFd();
+    if (proxy.canKeepConnection() && proxyPool.release(proxy.getAddress(), fd)) {
+        connections.setProxy(fd, INVALID_FD);
+        pollManager.addFd(fd, POLLIN);
+    } else {
+        removeWatchedFd(fd);
+        close(fd);
+    }
+    proxy.detach();
+    releaseProxyServer(client, false);
+    String body = proxy.takeOutput();
+    if (!proxy.isHeadersSent()) {
+        if (proxy.getFraming() == PROXY_BODY_CHUNKED || proxy.getFraming() == PROXY_BODY_CLOSE)
+            proxy.getResponse().addHeader(HEADER_CONTENT_LENGTH, typeToString<size_t>(body.size()));
+        sendProxyHeaders(client);
+    }
+    if (proxy.isCaching())
+        proxyCache.store(proxy.getCacheKey(), client->getRequest(), proxy.getResponse(), proxy.takeCacheBody(), proxy.getCacheValid());
+    else if (!proxy.getCacheKey().empty())
+        proxyCache.cancelUpdate(proxy.getCacheKey(), client->getRequest());
+    releaseCacheLock(client);
+    appendStreamed(client, body, proxy.isChunked());
+    if (proxy.isChunked())
+        client->appendSendData(String("0") + DOUBLE_CRLF);
+    proxy.reset();
+    client->setHeadersParsed(false);
+    client->getRequest().clear();
+    connections.clearRoute(client->getFd());
+    pollManager.addFd(client->getFd(), POLLIN | POLLOUT);
+}
+
+// A pooled connection the upstream already closed fails before any reply, so
+// the request is replayed on another connection. In an upstream block, a
+// server that never answered counts as failed and the next one gets the
+// request, unless it may have had side effects there (a POST that reached
+// it). A response cut short after its head went out can only be ended by
+// closing the client connection.
+void ServerManager::failProxy(Client* client) {
+    ProxyRequest&  proxy   = client->getProxy();
+    UpstreamGroup* group   = findUpstreamGroup(proxy.getUpstream());
+    bool           stale   = proxy.isReused() && !proxy.hasResponseData();
+    bool           reached = !proxy.isConnecting() && client->getRequest().getMethod() == METHOD_POST;
+    bool           next    = group && !proxy.hasResponseData() && !reached && proxy.getTries() < group->size();
+    int            server  = proxy.getServer();
+    removeWatchedFd(proxy.getFd());
+    close(proxy.getFd());
+    proxy.detach();
+    releaseProxyServer(client, !stale);
+    if ((stale && attachProxy(client, -1)) || (!stale && next && attachProxy(client, server)))
+        return;
+    Logger::error("Proxy upstream " + proxy.getAddress() + " failed");
+    if (!proxy.getCacheKey().empty())
+        proxyCache.cancelUpdate(proxy.getCacheKey(), client->getRequest());
+    releaseCacheLock(client);
+    if (proxy.isHeadersSent()) {
+        appendStreamed(client, proxy.takeOutput(), proxy.isChunked());
+        proxy.reset();
+        client->setKeepAlive(false);
+        client->setHeadersParsed(false);
+        client->getRequest().clear();
+        connections.clearRoute(client->getFd());
+        pollManager.addFd(client->getFd(), POLLIN | POLLOUT);
+        return;
+    }
+    proxy.reset();
+    HttpResponse response = responseBuilder.buildError(HTTP_BAD_GATEWAY, "Bad Gateway");
+    sendUpstreamResponse(client, response);
+}
+
+// Mid-request the upstream connection is in an unknown state, so it is closed rather than pooled
+void ServerManager::cleanupClientProxy(Client* client) {
+    ProxyRequest& proxy = client->getProxy();
+    releaseProxyServer(client, false);
+    if (!proxy.getCacheKey().empty())
+        proxyCache.cancelUpdate(proxy.getCacheKey(), client->getRequest());
+    releaseCacheLock(client);
+    if (proxy.getFd() != INVALID_FD) {
+        removeWatchedFd(proxy.getFd());
+        close(proxy.getFd());
+    }
+    proxy.reset();
+}
+
+// ─── Upstream blocks ─────────────────────────────────────────────────────────
+
+// Upstream block names cannot hold a ':', so a host:port never matches one
+UpstreamGroup* ServerManager::findUpstreamGroup(const String& name) {
+    for (size_t i = 0; i < upstreamGroups.size(); ++i) {
+        if (upstreamGroups[i].getName() == name)
+            return &upstreamGroups[i];
+    }
     return NULL;
 }
 
+void ServerManager::runHealthProbes() {
+    for (size_t i = 0; i < upstreamGroups.size(); ++i) {
+        VectorInt started, expired;
+        upstreamGroups[i].runProbes(started, expired);
+        for (size_t j = 0; j < expired.size(); ++j) {
+            removeWatchedFd(expired[j]);
+            close(expired[j]);
+        }
+        for (size_t j = 0; j < started.size(); ++j) {
+            connections.setHealthProbe(started[j], static_cast<int>(i));
+            pollManager.addFd(started[j], POLLOUT);
+        }
+    }
+}
+
+void ServerManager::handleHealthProbe(int fd, bool readable, bool writable, bool failed) {
+    int group = connections.getProbeGroup(fd);
+    if (group >= 0 && !upstreamGroups[group].handleProbe(fd, readable, writable, failed)) {
+        pollManager.addFd(fd, upstreamGroups[group].getProbeEvents(fd));
+        return;
+    }
+    removeWatchedFd(fd);
+    close(fd);
+}
+
 bool ServerManager::isServerSocket(int fd) const {
-    return findServerByFd(fd) != NULL;
+    return connections.getKind(fd) == FD_LISTENER;
 }
 
 void ServerManager::shutdown() {
-    for (MapIntClientPtr::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->second->getCgi().isActive())
-            cleanupClientCgi(it->second);
-        delete it->second;
+    aioPool.stop();
+    // first, so a cache lock released below sends no waiter to the upstream
+    proxyCache.clear();
+    cgiCache.clear();
+    const VectorInt& clientFds = connections.getClientFds();
+    for (size_t i = 0; i < clientFds.size(); ++i) {
+        Client* client = connections.getClient(clientFds[i]);
+        if (client->getCgi().isActive())
+            cleanupClientCgi(client);
+        if (client->getFastCgi().isActive())
+            cleanupClientFastCgi(client);
+        if (client->getProxy().isActive())
+            cleanupClientProxy(client);
+        clientPool.release(client);
+    }
+    fastcgiPool.clear();
+    proxyPool.clear();
+    for (size_t i = 0; i < upstreamGroups.size(); ++i) {
+        VectorInt probes;
+        upstreamGroups[i].closeProbes(probes);
+        for (size_t j = 0; j < probes.size(); ++j)
+            close(probes[j]);
     }
-    clients.clear();
+    cgiWorkers.clear();
+    if (childReaper.getReapedCount() > 0)
+        Logger::info("CGI processes reaped: " + typeToString<size_t>(childReaper.getReapedCount()) + ", failed: " +
+                     typeToString<size_t>(childReaper.getFailedCount()));
+    connections.clear();
     for (size_t i = 0; i < servers.size(); i++)
         delete servers[i];
     servers.clear();
@@ -605,5 +1951,5 @@ size_t ServerManager::getServerCount() const {
     return servers.size();
 }
 size_t ServerManager::getClientCount() const {
-    return clients.size();
+    return connections.getClientCount();
 }
@@ -6,7 +6,9 @@
 #include <unistd.h>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <vector>
+#include "../config/HttpConfig.hpp"
 #include "../config/MimeTypes.hpp"
 #include "../config/ServerConfig.hpp"
 #include "../http/HttpRequest.hpp"
@@ -16,16 +18,29 @@
 #include "../utils/Logger.hpp"
 #include "../utils/SessionManager.hpp"
 #include "../utils/Utils.hpp"
+#include "AioPool.hpp"
+#include "CgiCache.hpp"
+#include "CgiQueue.hpp"
+#include "CgiWorkerPool.hpp"
+#include "ChildReaper.hpp"
 #include "Client.hpp"
+#include "ClientPool.hpp"
+#include "ConnectionTable.hpp"
 #include "PollManager.hpp"
+#include "ProxyCache.hpp"
+#include "ResponseTask.hpp"
+#include "RouteTask.hpp"
 #include "Server.hpp"
+#include "UploadTask.hpp"
+#include "UpstreamGroup.hpp"
+#include "UpstreamPool.hpp"
 
 extern volatile sig_atomic_t g_running;
 
 class ServerManager {
    public:
     ServerManager();
-    ServerManager(const VectorServerConfig& configs);
+    ServerManager(const VectorServerConfig& configs, const HttpConfig& httpConfig = HttpConfig());
     ~ServerManager();
 
     bool   initialize();
@@ -36,44 +51,119 @@ class ServerManager {
 
    private:
     ServerManager(const ServerManager&);
-    ServerManager&             operator=(const ServerManager&);
-    PollManager                pollManager;
-    std::vector<Server*>       servers;
-    const VectorServerConfig   serverConfigs;
-    MapIntClientPtr            clients;
-    MapIntServerPtr            clientToServer;
-    MapIntVectorServerConfig   serverToConfigs;
-    MimeTypes                  mimeTypes;
-    ResponseBuilder            responseBuilder;
-    SessionManager             sessionManager;
-    MapInt                     cgiPipeToClient;
-    std::map<int, RouteResult> clientRoutes;
+    ServerManager&           operator=(const ServerManager&);
+    PollManager              pollManager;
+    std::vector<Server*>     servers;
+    const VectorServerConfig serverConfigs;
+    const HttpConfig         httpConfig;
+    ConnectionTable          connections; // fd -> listener / client / CGI pipe
+    ClientPool               clientPool;
+    MapIntVectorServerConfig serverToConfigs;
+    MimeTypes                mimeTypes;
+    ResponseBuilder          responseBuilder;
+    SessionManager           sessionManager;
+    UpstreamPool             fastcgiPool; // keep-alive connections for fastcgi_pass
+    UpstreamPool             proxyPool;   // keep-alive connections for proxy_pass
+    ProxyCache               proxyCache;  // proxy_cache responses, under proxy_cache_path
+    VectorUpstreamGroup      upstreamGroups; // upstream blocks, in httpConfig order
+    CgiWorkerPool            cgiWorkers;  // pre-spawned interpreters for cgi_worker
+    ChildReaper              childReaper; // SIGCHLD self-pipe, reaps forked CGIs
+    CgiQueue                 cgiQueue;    // cgi_max_concurrency slots and waiting requests
+    CgiCache                 cgiCache;    // cgi_cache_valid responses, in memory
+    AioPool                  aioPool;     // aio threads for file handlers
+    bool                     listenersPaused;
+    bool                     overloaded;
+    String                   overloadResponse; // prebuilt 503 for overload_response 503
 
     // Internal helpers
     bool    initializeServers(const VectorServerConfig& serversConfigs);
     bool    acceptNewConnection(Server* server);
+    bool    makeRoomForConnection();
+    void    rejectOverloaded(Server* server);
+    void    pauseListeners();
+    void    resumeListeners();
     void    handleClientRead(int clientFd);
     void    handleClientWrite(int clientFd);
     void    checkTimeouts(int timeout);
     void    closeClientConnection(int clientFd);
-    Server* findServerByFd(int serverFd) const;
     bool    isServerSocket(int fd) const;
     bool    isCgiPipe(int fd) const;
+    void    removeWatchedFd(int fd);
     void    processRequest(Client* client, Server* server);
     bool    parseAndRouteHeaders(Client* client, Server* server);
+    bool    applyRoute(Client* client, RouteResult& res);
     bool    validateRequestBody(Client* client, const RouteResult& res, bool hasContentLength, bool isChunked);
-    void    handleCgiBodyStreaming(Client* client);
+    bool    handleCgiBodyStreaming(Client* client);
+    bool    rejectCgiBody(Client* client, int statusCode);
+    int     clientEvents(Client* client) const;
+    bool    canSpliceBody(Client* client);
+    void    spliceCgiBody(Client* client);
     bool    handleRegularBody(Client* client);
-    void    finalizeResponse(Client* client, const HttpResponse& response, ssize_t bodyLen);
+    bool    beginUpload(Client* client, const RouteResult& res);
+    bool    handleUploadBody(Client* client);
+    bool    canSpliceUpload(Client* client);
+    void    spliceUpload(Client* client);
+    bool    writeUpload(Client* client, const char* data, size_t len, size_t spliced, bool last);
+    bool    uploadWritten(Client* client, MultipartStatus status, bool last, const VectorString& saved);
+    bool    rejectUpload(Client* client, int statusCode);
+    int     uploadFailureStatus(Client* client) const;
+    void    respond(Client* client, const RouteResult& res, ssize_t bodyLen);
+    void    handleAioCompletions();
+    void    finishRouteTask(Client* client, RouteTask& task);
+    void    finishUploadTask(Client* client, UploadTask& task);
+    void    processPipelined(Client* client);
+    void    finalizeResponse(Client* client, HttpResponse& response, ssize_t bodyLen);
     ssize_t getMaxBodySize(const RouteResult& res) const;
     Server* initializeServer(const ServerConfig& serverConfig, size_t listenIndex);
     void    sendErrorResponse(Client* client, int statusCode, const String& message, bool closeConnection, size_t bytesToRemove);
     // CGI pipe helpers
+    bool admitCgi(Client* client, const RouteResult& res, bool hasBody);
+    bool runCgi(Client* client, const RouteResult& res, bool hasBody);
+    void releaseCgiCacheLock(Client* client);
+    void resumeCgiCacheWaiter(Client* client, bool timedOut);
+    bool startCgi(Client* client, const RouteResult& res, bool hasBody);
+    void registerCgiLimits();
+    void serveCgiQueue();
+    bool startCgiWorker(Client* client, const RouteResult& res);
+    void prespawnCgiWorkers();
+    void finishCgiWorker(Client* client);
+    void streamCgiOutput(Client* client);
+    bool sendCgiHeaders(Client* client);
+    void appendCgiBody(Client* client, const String& data);
+    void appendStreamed(Client* client, const String& data, bool chunked);
+    bool canSpliceOutput(Client* client);
+    bool spliceCgiOutput(Client* client);
+    void completeCgiResponse(Client* client, bool complete);
     void registerCgiPipes(Client* client);
     void handleCgiRead(int pipeFd);
     void handleCgiWrite(int pipeFd);
+    void handleChildExits();
     void cleanupClientCgi(Client* client);
-    void removeCgiPipe(int pipeFd);
+    // FastCGI helpers
+    bool startFastCgi(Client* client, const RouteResult& res, ssize_t bodyLen);
+    bool attachFastCgi(Client* client);
+    void handleFastCgiEvent(int fd, bool readable, bool writable, bool failed);
+    void finishFastCgi(Client* client);
+    void failFastCgi(Client* client);
+    void cleanupClientFastCgi(Client* client);
+    void sendUpstreamResponse(Client* client, HttpResponse& response);
+    // Proxy helpers
+    bool startProxy(Client* client, const RouteResult& res, ssize_t bodyLen);
+    bool attachProxy(Client* client, int exclude);
+    bool lookupProxyCache(Client* client, const RouteResult& res, HttpResponse& response);
+    void releaseCacheLock(Client* client);
+    void resumeCacheWaiter(Client* client, bool timedOut);
+    void releaseProxyServer(Client* client, bool failed);
+    void handleProxyEvent(int fd, bool readable, bool writable, bool failed);
+    void streamProxyResponse(Client* client);
+    void sendProxyHeaders(Client* client);
+    void finishProxy(Client* client);
+    void failProxy(Client* client);
+    void cleanupClientProxy(Client* client);
+    // Upstream block helpers
+    UpstreamGroup* findUpstreamGroup(const String& name);
+    void           runHealthProbes();
+    void           handleHealthProbe(int fd, bool readable, bool writable, bool failed);
 
     Server*              createServerForListener(const String& listenerKey, const VectorServerConfig& configs, PollManager& pollMgr);
     ListenerToConfigsMap getListerToConfigs();
@@ -0,0 +1,70 @@
+#include "UploadTask.hpp"
+
+UploadTask::UploadTask(int ownerFd, RawUpload& raw, MultipartUpload& multipart, const char* data, size_t len, size_t spliced, bool last)
+    : AioTask(ownerFd),
+      _raw(raw),
+      _multipart(multipart),
+      _data(data, len),
+      _spliced(spliced),
+      _last(last),
+      _status(MULTIPART_INCOMPLETE),
+      _saved(),
+      _givenBack(false) {
+    raw       = RawUpload();
+    multipart = MultipartUpload();
+}
+
+UploadTask::~UploadTask() {
+    if (_givenBack)
+        return;
+    _raw.abort();
+    _multipart.abort();
+}
+
+void UploadTask::run() {
+    _status = write(_raw, _multipart, _data.data(), _data.size(), _spliced, _last, _saved);
+}
+
+AioKind UploadTask::getKind() const {
+    return AIO_UPLOAD;
+}
+
+void UploadTask::giveBack(RawUpload& raw, MultipartUpload& multipart) {
+    raw        = _raw;
+    multipart  = _multipart;
+    _givenBack = true;
+}
+
+MultipartStatus UploadTask::getStatus() const {
+    return _status;
+}
+
+bool UploadTask::isLast() const {
+    return _last;
+}
+
+const VectorString& UploadTask::getSaved() const {
+    return _saved;
+}
+
+// The disk work for one piece, on an aio thread or, without one, on the
+// loop. A raw upload reports MULTIPART_COMPLETE once renamed into place.
+MultipartStatus UploadTask::write(RawUpload& raw, MultipartUpload& multipart, const char* data, size_t len, size_t spliced, bool last,
+                                  VectorString& saved) {
+    if (multipart.isActive()) {
+        MultipartStatus status = multipart.feed(data, len);
+        if (last && status == MULTIPART_COMPLETE) {
+            saved = multipart.getSavedFiles();
+            multipart.reset();
+        }
+        return status;
+    }
+    if (!raw.isOpen() && !raw.open())
+        return MULTIPART_FAILED;
+    if (!raw.write(data, len) || (spliced > 0 && !raw.drainPipe(spliced)))
+        return MULTIPART_FAILED;
+    if (!last)
+        return MULTIPART_INCOMPLETE;
+    saved.push_back(raw.getFilename());
+    return raw.finish() ? MULTIPART_COMPLETE : MULTIPART_FAILED;
+}
@@ -0,0 +1,42 @@
+#ifndef UPLOAD_TASK_HPP
+#define UPLOAD_TASK_HPP
+
+#include "../handlers/MultipartUpload.hpp"
+#include "../handlers/RawUpload.hpp"
+#include "AioPool.hpp"
+
+// A piece of an upload body written on an aio thread: the raw file is opened
+// before the first piece and renamed after the last, multipart files as
+// their parts open and close. The upload is taken over from the Client and
+// the piece copied, so a connection closed meanwhile cannot close the file
+// under the thread; an upload never given back is removed with the task.
+class UploadTask : public AioTask {
+   public:
+    UploadTask(int ownerFd, RawUpload& raw, MultipartUpload& multipart, const char* data, size_t len, size_t spliced, bool last);
+    ~UploadTask();
+
+    void                run();
+    AioKind             getKind() const;
+    void                giveBack(RawUpload& raw, MultipartUpload& multipart);
+    MultipartStatus     getStatus() const;
+    bool                isLast() const;
+    const VectorString& getSaved() const;
+
+    static MultipartStatus write(RawUpload& raw, MultipartUpload& multipart, const char* data, size_t len, size_t spliced, bool last,
+                                 VectorString& saved);
+
+   private:
+    RawUpload       _raw;
+    MultipartUpload _multipart;
+    String          _data;
+    size_t          _spliced; // bytes waiting in the raw upload's pipe
+    bool            _last;
+    MultipartStatus _status;
+    VectorString    _saved; // files completed by the last piece
+    bool            _givenBack;
+
+    UploadTask(const UploadTask&);
+    UploadTask& operator=(const UploadTask&);
+};
+
+#endif
@@ -0,0 +1,340 @@
+#include "UpstreamGroup.hpp"
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+UpstreamGroup::Server::Server()
+    : address(),
+      maxFails(UPSTREAM_MAX_FAILS),
+      failTimeout(UPSTREAM_FAIL_TIMEOUT),
+      active(0),
+      fails(0),
+      failStart(0),
+      downUntil(0),
+      healthy(true),
+      probeStreak(0),
+      probeFd(INVALID_FD),
+      probeSending(false),
+      probeData(),
+      addrLen(0),
+      resolved(false) {
+    std::memset(&addr, 0, sizeof(addr));
+}
+
+UpstreamGroup::UpstreamGroup()
+    : _name(),
+      _servers(),
+      _policy(UPSTREAM_ROUND_ROBIN),
+      _hashCookie(),
+      _ring(),
+      _next(0),
+      _healthCheck(false),
+      _healthInterval(UPSTREAM_HEALTH_INTERVAL),
+      _healthRequest(),
+      _healthFails(1),
+      _healthPasses(1),
+      _nextProbe(0) {}
+
+UpstreamGroup::UpstreamGroup(const UpstreamConfig& config)
+    : _name(config.getName()),
+      _servers(),
+      _policy(config.getPolicy()),
+      _hashCookie(config.getHashCookie()),
+      _ring(),
+      _next(0),
+      _healthCheck(config.hasHealthCheck()),
+      _healthInterval(config.getHealthInterval()),
+      _healthRequest(),
+      _healthFails(config.getHealthFails()),
+      _healthPasses(config.getHealthPasses()),
+      _nextProbe(0) {
+    const UpstreamConfig::VectorServer& servers = config.getServers();
+    for (size_t i = 0; i < servers.size(); ++i) {
+        Server server;
+        server.address     = servers[i].address;
+        server.maxFails    = servers[i].maxFails;
+        server.failTimeout = servers[i].failTimeout;
+        _servers.push_back(server);
+        for (int point = 0; point < UPSTREAM_HASH_POINTS; ++point)
+            _ring.push_back(RingPoint(hashKey(server.address + "-" + typeToString<int>(point)), static_cast<int>(i)));
+    }
+    std::sort(_ring.begin(), _ring.end());
+    // HTTP/1.0 so the server closes once the status line is out
+    _healthRequest = "GET " + config.getHealthUri() + " HTTP/1.0" + CRLF;
+    _healthRequest += "host: " + _name + CRLF;
+    _healthRequest += String("connection: close") + DOUBLE_CRLF;
+}
+
+UpstreamGroup::UpstreamGroup(const UpstreamGroup& other)
+    : _name(other._name),
+      _servers(other._servers),
+      _policy(other._policy),
+      _hashCookie(other._hashCookie),
+      _ring(other._ring),
+      _next(other._next),
+      _healthCheck(other._healthCheck),
+      _healthInterval(other._healthInterval),
+      _healthRequest(other._healthRequest),
+      _healthFails(other._healthFails),
+      _healthPasses(other._healthPasses),
+      _nextProbe(other._nextProbe) {}
+
+UpstreamGroup& UpstreamGroup::operator=(const UpstreamGroup& other) {
+    if (this != &other) {
+        _name           = other._name;
+        _servers        = other._servers;
+        _policy         = other._policy;
+        _hashCookie     = other._hashCookie;
+        _ring           = other._ring;
+        _next           = other._next;
+        _healthCheck    = other._healthCheck;
+        _healthInterval = other._healthInterval;
+        _healthRequest  = other._healthRequest;
+        _healthFails    = other._healthFails;
+        _healthPasses   = other._healthPasses;
+        _nextProbe      = other._nextProbe;
+    }
+    return *this;
+}
+
+// Probe sockets are closed by the ServerManager, which also polls them
+UpstreamGroup::~UpstreamGroup() {}
+
+// ─── Balancing ───────────────────────────────────────────────────────────────
+
+// Returns -1 when every server is down. `exclude` is a server that just
+// failed this request, so a retry goes elsewhere.
+int UpstreamGroup::select(const HttpRequest& req, int exclude) {
+    time_t now = getCurrentTime();
+    if (_policy == UPSTREAM_HASH_URI)
+        return selectHashed(req.getTarget(), exclude, now);
+    if (_policy == UPSTREAM_HASH_COOKIE) {
+        String value = req.getCookie(_hashCookie);
+        // without the cookie there is nothing to stick to yet
+        if (!value.empty())
+            return selectHashed(value, exclude, now);
+    }
+    int best = -1;
+    for (size_t n = 0; n < _servers.size(); ++n) {
+        int server = static_cast<int>((_next + n) % _servers.size());
+        if (!isUp(server, exclude, now))
+            continue;
+        if (_policy != UPSTREAM_LEAST_CONN) {
+            best = server;
+            break;
+        }
+        // ties go to the first server after the cursor, so equal loads rotate
+        if (best == -1 || _servers[server].active < _servers[best].active)
+            best = server;
+    }
+    if (best != -1)
+        _next = best + 1;
+    return best;
+}
+
+// The key goes to the first ring point at or after its hash. A server that
+// is down only moves its own keys to the next point clockwise; the others
+// stay where they were.
+int UpstreamGroup::selectHashed(const String& key, int exclude, time_t now) const {
+    if (_ring.empty())
+        return -1;
+    size_t start = std::lower_bound(_ring.begin(), _ring.end(), RingPoint(hashKey(key), -1)) - _ring.begin();
+    for (size_t n = 0; n < _ring.size(); ++n) {
+        int server = _ring[(start + n) % _ring.size()].second;
+        if (isUp(server, exclude, now))
+            return server;
+    }
+    return -1;
+}
+
+bool UpstreamGroup::isUp(int server, int exclude, time_t now) const {
+    return server != exclude && _servers[server].healthy && _servers[server].downUntil <= now;
+}
+
+void UpstreamGroup::acquire(int server) {
+    ++_servers[server].active;
+}
+
+// max_fails failures within fail_timeout of the first one take the server
+// out for fail_timeout; a success starts the count over
+void UpstreamGroup::release(int server, bool failed) {
+    if (server < 0 || static_cast<size_t>(server) >= _servers.size())
+        return;
+    Server& s = _servers[server];
+    if (s.active > 0)
+        --s.active;
+    if (!failed) {
+        s.fails = 0;
+        return;
+    }
+    if (s.maxFails == 0)
+        return;
+    time_t now = getCurrentTime();
+    if (s.fails == 0 || getDifferentTime(s.failStart, now) >= s.failTimeout) {
+        s.fails     = 0;
+        s.failStart = now;
+    }
+    if (++s.fails >= s.maxFails) {
+        s.fails     = 0;
+        s.downUntil = now + s.failTimeout;
+        Logger::error("Upstream " + _name + ": " + s.address + " marked down for " + typeToString<int>(s.failTimeout) + "s");
+    }
+}
+
+const String& UpstreamGroup::getName() const {
+    return _name;
+}
+
+const String& UpstreamGroup::getAddress(int server) const {
+    return _servers[server].address;
+}
+
+size_t UpstreamGroup::size() const {
+    return _servers.size();
+}
+
+// ─── Health probes ───────────────────────────────────────────────────────────
+
+// Starts a probe per server once the interval is up. A probe still in flight
+// by then has timed out: it counts as failed, and its fd is handed back in
+// `expired` for the caller to stop polling and close.
+void UpstreamGroup::runProbes(VectorInt& started, VectorInt& expired) {
+    if (!_healthCheck)
+        return;
+    time_t now = getCurrentTime();
+    if (now < _nextProbe)
+        return;
+    _nextProbe = now + _healthInterval;
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        Server& server = _servers[i];
+        if (server.probeFd != INVALID_FD) {
+            expired.push_back(server.probeFd);
+            finishProbe(server, false);
+        }
+        startProbe(server);
+        if (server.probeFd != INVALID_FD)
+            started.push_back(server.probeFd);
+    }
+}
+
+void UpstreamGroup::startProbe(Server& server) {
+    if (!server.resolved) {
+        if (!resolveAddress(server.address, server.addr, server.addrLen)) {
+            finishProbe(server, false);
+            return;
+        }
+        server.resolved = true;
+    }
+    // running out of sockets here says nothing about the server
+    int fd = socket(server.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return;
+    // the outcome of connect() is read through SO_ERROR once writable
+    connect(fd, reinterpret_cast<sockaddr*>(&server.addr), server.addrLen);
+    server.probeFd      = fd;
+    server.probeSending = true;
+    server.probeData    = _healthRequest;
+}
+
+// True once the probe is over and its fd can be closed. A 2xx or 3xx status
+// line passes; a refused connection, an error or anything else fails.
+bool UpstreamGroup::handleProbe(int fd, bool readable, bool writable, bool failed) {
+    Server* server = findProbe(fd);
+    if (!server)
+        return true;
+    if (server->probeSending) {
+        int       err = 0;
+        socklen_t len = sizeof(err);
+        if (failed || (writable && (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0))) {
+            finishProbe(*server, false);
+            return true;
+        }
+        if (!writable)
+            return false;
+        ssize_t w = write(fd, server->probeData.data(), server->probeData.size());
+        if (w > 0)
+            server->probeData.erase(0, w);
+        if (server->probeData.empty())
+            server->probeSending = false;
+        return false;
+    }
+    if (!readable && !failed)
+        return false;
+    char    buf[BUFFER_SIZE];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n > 0)
+        server->probeData.append(buf, n);
+    size_t eol = server->probeData.find(CRLF);
+    if (eol == String::npos && n > 0 && server->probeData.size() < BUFFER_SIZE)
+        return false;
+    String line  = server->probeData.substr(0, eol);
+    size_t space = line.find(' ');
+    int    code  = 0;
+    bool   pass  = line.compare(0, 5, "HTTP/") == 0 && space != String::npos &&
+                stringToType<int>(line.substr(space + 1, 3), code) && code >= 200 && code < 400;
+    finishProbe(*server, pass);
+    return true;
+}
+
+// A passing probe also ends a passive timeout early
+void UpstreamGroup::finishProbe(Server& server, bool healthy) {
+    server.probeFd      = INVALID_FD;
+    server.probeSending = false;
+    server.probeData.clear();
+    if (healthy)
+        server.downUntil = 0;
+    if (healthy == server.healthy) {
+        server.probeStreak = 0;
+        return;
+    }
+    if (++server.probeStreak < (server.healthy ? _healthFails : _healthPasses))
+        return;
+    server.healthy     = healthy;
+    server.probeStreak = 0;
+    server.fails       = 0;
+    if (healthy)
+        Logger::info("Upstream " + _name + ": " + server.address + " passed health checks, back up");
+    else
+        Logger::error("Upstream " + _name + ": " + server.address + " failed health checks, marked down");
+}
+
+int UpstreamGroup::getProbeEvents(int fd) const {
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        if (_servers[i].probeFd == fd)
+            return _servers[i].probeSending ? POLLOUT : POLLIN;
+    }
+    return 0;
+}
+
+void UpstreamGroup::closeProbes(VectorInt& fds) {
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        if (_servers[i].probeFd != INVALID_FD)
+            fds.push_back(_servers[i].probeFd);
+        _servers[i].probeFd = INVALID_FD;
+    }
+}
+
+UpstreamGroup::Server* UpstreamGroup::findProbe(int fd) {
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        if (_servers[i].probeFd == fd)
+            return &_servers[i];
+    }
+    return NULL;
+}
+
+// FNV-1a, then the murmur3 finalizer: FNV alone clusters the ring points of
+// addresses that differ only in their last characters
+uint32_t UpstreamGroup::hashKey(const String& key) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < key.size(); ++i) {
+        h ^= static_cast<unsigned char>(key[i]);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
@@ -0,0 +1,81 @@
+#ifndef UPSTREAM_GROUP_HPP
+#define UPSTREAM_GROUP_HPP
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <ctime>
+#include <utility>
+#include <vector>
+#include "../config/UpstreamConfig.hpp"
+#include "../http/HttpRequest.hpp"
+#include "../utils/Utils.hpp"
+
+// Runtime state of one upstream block. select() picks a server by the block's
+// policy among those that are up, and release() hands it back with the
+// outcome: max_fails failures within fail_timeout take a server out for
+// fail_timeout seconds (passive tracking). With health_check, every server is
+// also probed each interval over a plain non-blocking socket the event loop
+// polls, and taken out or put back after fails/passes probes in a row.
+class UpstreamGroup {
+   public:
+    UpstreamGroup();
+    UpstreamGroup(const UpstreamConfig& config);
+    UpstreamGroup(const UpstreamGroup& other);
+    UpstreamGroup& operator=(const UpstreamGroup& other);
+    ~UpstreamGroup();
+
+    int           select(const HttpRequest& req, int exclude);
+    void          acquire(int server);
+    void          release(int server, bool failed);
+    const String& getName() const;
+    const String& getAddress(int server) const;
+    size_t        size() const;
+
+    void runProbes(VectorInt& started, VectorInt& expired);
+    bool handleProbe(int fd, bool readable, bool writable, bool failed);
+    int  getProbeEvents(int fd) const;
+    void closeProbes(VectorInt& fds);
+
+   private:
+    struct Server {
+        String                  address;
+        int                     maxFails;
+        int                     failTimeout;
+        int                     active;      // requests in flight
+        int                     fails;       // failures counted since failStart
+        time_t                  failStart;
+        time_t                  downUntil;   // passive: skipped until then
+        bool                    healthy;     // active: false while probes fail
+        int                     probeStreak; // probes in a row that disagree with healthy
+        int                     probeFd;     // -1: no probe in flight
+        bool                    probeSending;
+        String                  probeData;   // request left to write, then the reply read so far
+        struct sockaddr_storage addr;
+        socklen_t               addrLen;
+        bool                    resolved;
+        Server();
+    };
+    typedef std::pair<uint32_t, int> RingPoint; // hash, server index
+
+    String                 _name;
+    std::vector<Server>    _servers;
+    UpstreamPolicy         _policy;
+    String                 _hashCookie;
+    std::vector<RingPoint> _ring;  // consistent-hash ring, sorted by hash
+    size_t                 _next;  // round-robin cursor
+    bool                   _healthCheck;
+    int                    _healthInterval;
+    String                 _healthRequest;
+    int                    _healthFails;
+    int                    _healthPasses;
+    time_t                 _nextProbe;
+
+    bool            isUp(int server, int exclude, time_t now) const;
+    int             selectHashed(const String& key, int exclude, time_t now) const;
+    void            startProbe(Server& server);
+    void            finishProbe(Server& server, bool healthy);
+    Server*         findProbe(int fd);
+    static uint32_t hashKey(const String& key);
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "UpstreamPool.hpp"
+
+UpstreamPool::Upstream::Upstream() : addrLen(0), resolved(false), idle() {
+    std::memset(&addr, 0, sizeof(addr));
+}
+
+UpstreamPool::UpstreamPool() : _upstreams(), _maxIdle(FASTCGI_KEEPALIVE) {}
+
+UpstreamPool::UpstreamPool(size_t maxIdle) : _upstreams(), _maxIdle(maxIdle) {}
+
+UpstreamPool::~UpstreamPool() {
+    clear();
+}
+
+// Returns -1 when the address does not resolve or no socket can be created.
+// A connect() still in progress is reported through `connecting`; its result
+// is read with SO_ERROR once the socket becomes writable.
+int UpstreamPool::acquire(const String& address, bool& reused, bool& connecting) {
+    Upstream& up = _upstreams[address];
+    if (!up.idle.empty()) {
+        int fd = up.idle.back();
+        up.idle.pop_back();
+        reused     = true;
+        connecting = false;
+        return fd;
+    }
+    if (!up.resolved) {
+        if (!resolveAddress(address, up.addr, up.addrLen)) {
+            Logger::error("Cannot resolve upstream " + address);
+            return -1;
+        }
+        up.resolved = true;
+    }
+    int fd = socket(up.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    reused     = false;
+    connecting = (connect(fd, reinterpret_cast<sockaddr*>(&up.addr), up.addrLen) < 0);
+    return fd;
+}
+
+bool UpstreamPool::release(const String& address, int fd) {
+    Upstream& up = _upstreams[address];
+    if (up.idle.size() >= _maxIdle)
+        return false;
+    up.idle.push_back(fd);
+    return true;
+}
+
+// Drop an idle connection the backend closed; the caller closes the fd
+bool UpstreamPool::remove(int fd) {
+    for (UpstreamMap::iterator it = _upstreams.begin(); it != _upstreams.end(); ++it) {
+        VectorInt& idle = it->second.idle;
+        for (size_t i = 0; i < idle.size(); ++i) {
+            if (idle[i] == fd) {
+                idle.erase(idle.begin() + i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void UpstreamPool::clear() {
+    for (UpstreamMap::iterator it = _upstreams.begin(); it != _upstreams.end(); ++it) {
+        for (size_t i = 0; i < it->second.idle.size(); ++i)
+            close(it->second.idle[i]);
+        it->second.idle.clear();
+    }
+}
+
+size_t UpstreamPool::getIdleCount(const String& address) const {
+    UpstreamMap::const_iterator it = _upstreams.find(address);
+    return it == _upstreams.end() ? 0 : it->second.idle.size();
+}
@@ -0,0 +1,42 @@
+#ifndef UPSTREAM_POOL_HPP
+#define UPSTREAM_POOL_HPP
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <map>
+#include "../utils/Utils.hpp"
+
+// Keep-alive connections to backend servers, keyed by the configured address
+// (host:port or unix:/path). acquire() prefers an idle connection and only
+// opens a new non-blocking socket when none is left; release() parks a
+// connection for the next request, up to maxIdle per upstream.
+class UpstreamPool {
+   public:
+    UpstreamPool();
+    UpstreamPool(size_t maxIdle);
+    ~UpstreamPool();
+
+    int    acquire(const String& address, bool& reused, bool& connecting);
+    bool   release(const String& address, int fd);
+    bool   remove(int fd);
+    void   clear();
+    size_t getIdleCount(const String& address) const;
+
+   private:
+    struct Upstream {
+        struct sockaddr_storage addr;
+        socklen_t               addrLen;
+        bool                    resolved;
+        VectorInt               idle; // most recently released last
+        Upstream();
+    };
+    typedef std::map<String, Upstream> UpstreamMap;
+
+    UpstreamMap _upstreams;
+    size_t      _maxIdle;
+
+    UpstreamPool(const UpstreamPool&);
+    UpstreamPool& operator=(const UpstreamPool&);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "Arena.hpp"
+
+Arena::Arena(size_t blockSize) : _blocks(), _current(0), _offset(0), _blockSize(blockSize), _used(0) {}
+
+Arena::~Arena() {
+    releaseBlocks();
+}
+
+void* Arena::allocate(size_t size) {
+    const size_t align = ARENA_ALIGNMENT;
+    size                = (size + align - 1) & ~(align - 1);
+    if (size == 0)
+        size = align;
+
+    while (_current < _blocks.size() && _offset + size > _blocks[_current].size) {
+        _current++;
+        _offset = 0;
+    }
+    if (_current >= _blocks.size())
+        addBlock(size);
+
+    void* p = _blocks[_current].data + _offset;
+    _offset += size;
+    _used += size;
+    return p;
+}
+
+// Forget every allocation. If the last request needed more than one block the
+// blocks are merged into a single one sized for it, so the next request fits.
+void Arena::reset() {
+    if (_blocks.size() > 1) {
+        size_t total = 0;
+        for (size_t i = 0; i < _blocks.size(); ++i)
+            total += _blocks[i].size;
+        releaseBlocks();
+        addBlock(total);
+    }
+    _current = 0;
+    _offset  = 0;
+    _used    = 0;
+}
+
+size_t Arena::getUsed() const {
+    return _used;
+}
+
+size_t Arena::getCapacity() const {
+    size_t total = 0;
+    for (size_t i = 0; i < _blocks.size(); ++i)
+        total += _blocks[i].size;
+    return total;
+}
+
+void Arena::addBlock(size_t minSize) {
+    Block block;
+    block.size = (minSize > _blockSize) ? minSize : _blockSize;
+    block.data = static_cast<char*>(::operator new(block.size));
+    _blocks.push_back(block);
+    _current = _blocks.size() - 1;
+    _offset  = 0;
+}
+
+void Arena::releaseBlocks() {
+    for (size_t i = 0; i < _blocks.size(); ++i)
+        ::operator delete(_blocks[i].data);
+    _blocks.clear();
+    _current = 0;
+    _offset  = 0;
+}
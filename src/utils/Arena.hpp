@@ -0,0 +1,121 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include "Constants.hpp"
+
+// Bump allocator for per-request scratch memory.
+// allocate() only moves a pointer forward; deallocate() is a no-op and everything
+// is released at once by reset(). After the first few requests the arena settles
+// on a single block big enough for a whole request, so steady state needs no malloc.
+class Arena {
+   public:
+    Arena(size_t blockSize = ARENA_BLOCK_SIZE);
+    ~Arena();
+
+    void*  allocate(size_t size);
+    void   reset();
+    size_t getUsed() const;
+    size_t getCapacity() const;
+
+   private:
+    struct Block {
+        char*  data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t             _current;   // index of the block we are bumping in
+    size_t             _offset;    // first free byte inside the current block
+    size_t             _blockSize; // minimum size of a new block
+    size_t             _used;      // bytes handed out since the last reset
+
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    void addBlock(size_t minSize);
+    void releaseBlocks();
+};
+
+// STL allocator that draws from an Arena. Containers using it must not outlive
+// the next Arena::reset().
+template <typename T>
+class ArenaAllocator {
+   public:
+    typedef T              value_type;
+    typedef T*             pointer;
+    typedef const T*       const_pointer;
+    typedef T&             reference;
+    typedef const T&       const_reference;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator() throw() : _arena(NULL) {}
+    ArenaAllocator(Arena* arena) throw() : _arena(arena) {}
+    ArenaAllocator(const ArenaAllocator& other) throw() : _arena(other._arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) throw() : _arena(other.getArena()) {}
+    ~ArenaAllocator() throw() {}
+
+    pointer address(reference x) const {
+        return &x;
+    }
+    const_pointer address(const_reference x) const {
+        return &x;
+    }
+
+    pointer allocate(size_type n, const void* hint = 0) {
+        (void)hint;
+        if (!_arena)
+            return static_cast<pointer>(::operator new(n * sizeof(T)));
+        return static_cast<pointer>(_arena->allocate(n * sizeof(T)));
+    }
+    void deallocate(pointer p, size_type n) {
+        (void)n;
+        if (!_arena)
+            ::operator delete(p);
+    }
+
+    size_type max_size() const throw() {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+    void construct(pointer p, const T& value) {
+        new (static_cast<void*>(p)) T(value);
+    }
+    void destroy(pointer p) {
+        p->~T();
+    }
+
+    Arena* getArena() const throw() {
+        return _arena;
+    }
+
+   private:
+    Arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.getArena() == b.getArena();
+}
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.getArena() != b.getArena();
+}
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > ArenaString;
+typedef ArenaAllocator<std::pair<const ArenaString, ArenaString> >              ArenaPairAllocator;
+typedef std::map<ArenaString, ArenaString, std::less<ArenaString>, ArenaPairAllocator> ArenaMapString;
+
+#endif
@@ -4,9 +4,11 @@
 // ! HTTP STATUS CODES - 2xx Success
 #define HTTP_OK 200
 #define HTTP_CREATED 201
+#define HTTP_NO_CONTENT 204
 
 // ! HTTP STATUS CODES - 3xx Redirect
 #define HTTP_MOVED_PERMANENTLY 301
+#define HTTP_NOT_MODIFIED 304
 
 // ! HTTP STATUS CODES - 4xx Client Error
 #define HTTP_BAD_REQUEST 400
@@ -21,12 +23,16 @@
 // ! HTTP STATUS CODES - 5xx Server Error
 #define HTTP_INTERNAL_SERVER_ERROR 500
 #define HTTP_NOT_IMPLEMENTED 501
+#define HTTP_BAD_GATEWAY 502
+#define HTTP_SERVICE_UNAVAILABLE 503
 #define HTTP_GATEWAY_TIMEOUT 504
 #define HTTP_VERSION_NOT_SUPPORTED 505
+#define HTTP_INSUFFICIENT_STORAGE 507
 
 // ! HTTP HEADER NAMES
 #define HEADER_CONTENT_TYPE "Content-Type"
 #define HEADER_CONTENT_LENGTH "Content-Length"
+#define HEADER_TRANSFER_ENCODING "Transfer-Encoding"
 #define HEADER_CONTENT_DISPOSITION "Content-Disposition"
 #define HEADER_HOST "host"
 #define HEADER_COOKIE "cookie"
@@ -63,6 +69,9 @@
 #define MAX_URI_LENGTH 8192
 #define MAX_HEADER_SIZE 8192
 #define BUFFER_SIZE 4096
+#define ARENA_BLOCK_SIZE 8192
+#define ARENA_ALIGNMENT 16
+#define RESPONSE_HEADERS_RESERVE 8 // header slots a response reserves on its first header
 #ifndef SIZE_MAX
 #define SIZE_MAX (18446744073709551615UL)
 #endif
@@ -70,10 +79,21 @@
 // ! CONNECTION LIMITS
 #define MAX_CONNECTIONS 1024
 #define MAX_KEEPALIVE_REQUESTS 100
+#define CLIENT_POOL_PREALLOC 64
+#define ACCEPT_BATCH_DEFAULT 64
+#define ACCEPT_BATCH_MAX 4096
+#define MAX_CONNECTIONS_LIMIT 65536
+#define OVERLOAD_RETRY_AFTER 1
+#define CLIENT_BUFFER_KEEP 65536
+#define CLIENT_READ_BATCH 65536
+#define AIO_THREADS_MAX 64
 
 // ! TIMEOUTS
 #define CLIENT_TIMEOUT 160
 #define CGI_TIMEOUT 160
+#define CGI_EXIT_WAIT 2 // after EOF, before answering without the exit status
+#define AIO_EXIT_WAIT 2 // at shutdown, for an aio thread still blocked on disk
+#define DEFER_ACCEPT_TIMEOUT 5
 #define SECONDS_PER_DAY 86400
 #define SECONDS_PER_HOUR 3600
 #define SECONDS_PER_MIN 60
@@ -86,12 +106,53 @@
 // ! CGI
 #define CGI_INTERFACE "CGI/1.1"
 #define SERVER_PROTOCOL "HTTP/1.1"
+#define CGI_STREAM_BUFFER 65536 // CGI output held per client before the pipe stops being read
+#define CGI_WORKER_MIN 1
+#define CGI_WORKER_MAX 4
+#define CGI_WORKER_IDLE 60 // seconds before an idle worker above min exits
+#define CGI_WORKER_REQUESTS 1000 // requests before a worker is recycled
+#define CGI_QUEUE_SIZE 0 // requests over cgi_max_concurrency that may wait
+#define CGI_QUEUE_TIMEOUT 30 // seconds a queued CGI request waits for a slot
+#define CGI_CACHE_MAX_ENTRIES 1024 // cgi_cache_valid responses kept before the least recently used go
+#define CGI_CACHE_MAX_SIZE 33554432 // bytes of cached CGI output, all locations together
+#define CGI_CACHE_ENTRY_MAX 1048576 // larger CGI output is streamed but not cached
+#define CGI_CACHE_LOCK_TIMEOUT 5 // seconds a request waits for another to run the script for its cache key
+
+// ! UPLOADS
+#define UPLOAD_DIRECT_ALIGN 4096 // O_DIRECT buffer, offset and length alignment
+#define UPLOAD_DIRECT_BLOCK 1048576 // staged before each O_DIRECT write
+
+// ! FASTCGI
+#define FCGI_VERSION_1 1
+#define FCGI_HEADER_LEN 8
+#define FCGI_MAX_CONTENT 65535
+#define FCGI_RESPONDER 1
+#define FCGI_KEEP_CONN 1
+#define FCGI_REQUEST_ID 1 // one request per upstream connection at a time
+#define FASTCGI_KEEPALIVE 16 // idle connections kept per upstream
+
+// ! PROXY
+#define PROXY_KEEPALIVE 16 // idle connections kept per proxy_pass upstream
+#define PROXY_TIMEOUT 60 // seconds an upstream may go without sending or taking data
+#define PROXY_STREAM_BUFFER 65536 // response bytes held per client before the upstream stops being read
+#define PROXY_CACHE_MAX_SIZE 104857600 // proxy_cache_path max_size default: 100M of cached bodies
+#define PROXY_CACHE_ENTRY_MAX 8388608 // larger bodies are passed through uncached
+#define PROXY_CACHE_FILE_PREFIX "webserv-cache-"
+#define PROXY_CACHE_LOCK_TIMEOUT 5 // seconds a proxy_cache_lock waiter waits before going to the upstream itself
+#define HEADER_CACHE_STATUS "X-Cache-Status"
+
+// ! UPSTREAMS
+#define UPSTREAM_MAX_FAILS 1 // failed attempts within fail_timeout before a server is marked down
+#define UPSTREAM_FAIL_TIMEOUT 10 // seconds failures are counted over, and a down server is skipped
+#define UPSTREAM_HEALTH_INTERVAL 5 // seconds between health_check probes
+#define UPSTREAM_HASH_POINTS 160 // points per server on the consistent-hash ring
 
 // ! SESSION
 #define SESSION_COOKIE_NAME "webserv_sid"
 #define SESSION_ID_LENGTH 32
 #define SESSION_TIMEOUT 1800
-#define SESSION_CLEANUP_INTERVAL 60
+#define SESSION_TABLE_MIN_SIZE 64 // initial hash table slots, a power of two
+#define SESSION_CLEANUP_BATCH 1024 // expiry entries looked at per event loop round
 
 #define EMPTY_STRING ""
 #define DEFAULT_MIME_TYPE "application/octet-stream"
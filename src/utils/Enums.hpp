@@ -2,6 +2,28 @@
 #define ENUM_HPP
 enum Type { TOKEN_WORD, TOKEN_STRING, TOKEN_SEMICOLON, TOKEN_LBRACE, TOKEN_RBRACE, TOKEN_EOF };
 enum FileType { SINGLEFILE, DIRECTORY, UNKNOWN };
-enum HandlerType { STATIC, DIRECTORY_LISTING, CGI, UPLOAD, ERROR_PAGE, NOT_FOUND, DELETE_FILE };
+enum HandlerType { STATIC, DIRECTORY_LISTING, CGI, UPLOAD, ERROR_PAGE, NOT_FOUND, DELETE_FILE, FASTCGI, PROXY };
+enum FdKind { FD_NONE, FD_LISTENER, FD_CLIENT, FD_CGI_PIPE, FD_FASTCGI, FD_PROXY, FD_HEALTH_PROBE, FD_SIGNAL, FD_AIO };
+enum AioKind { AIO_ROUTE, AIO_RESPONSE, AIO_UPLOAD };
+enum FastCgiRecordType {
+    FCGI_BEGIN_REQUEST = 1,
+    FCGI_ABORT_REQUEST = 2,
+    FCGI_END_REQUEST   = 3,
+    FCGI_PARAMS        = 4,
+    FCGI_STDIN         = 5,
+    FCGI_STDOUT        = 6,
+    FCGI_STDERR        = 7
+};
+enum FastCgiStatus { FCGI_PENDING, FCGI_COMPLETE, FCGI_FAILED };
+enum ProxyStatus { PROXY_PENDING, PROXY_COMPLETE, PROXY_FAILED };
+enum UpstreamPolicy { UPSTREAM_ROUND_ROBIN, UPSTREAM_LEAST_CONN, UPSTREAM_HASH_URI, UPSTREAM_HASH_COOKIE };
+enum CacheStatus { CACHE_MISS, CACHE_EXPIRED, CACHE_HIT, CACHE_STALE };
+enum CacheLock { CACHE_LOCK_NONE, CACHE_LOCK_HELD, CACHE_LOCK_WAITING };
+enum ProxyFraming { PROXY_BODY_NONE, PROXY_BODY_LENGTH, PROXY_BODY_CHUNKED, PROXY_BODY_CLOSE };
+enum ChunkedState { CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER, CHUNK_DONE };
+enum ChunkedStatus { CHUNKED_INCOMPLETE, CHUNKED_COMPLETE, CHUNKED_INVALID };
+enum MultipartState { PART_PREAMBLE, PART_BOUNDARY, PART_HEADERS, PART_DATA, PART_DONE };
+enum UploadIo { UPLOAD_IO_WRITE, UPLOAD_IO_DIRECT, UPLOAD_IO_SPLICE };
+enum MultipartStatus { MULTIPART_INCOMPLETE, MULTIPART_COMPLETE, MULTIPART_INVALID, MULTIPART_FAILED };
 
 #endif
\ No newline at end of file
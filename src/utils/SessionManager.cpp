@@ -1,86 +1,113 @@
 #include "SessionManager.hpp"
+#include <cstring>
 
-SessionManager::SessionManager() {}
+SessionManager::SessionManager() : _used(0), _deleted(0) {}
 
-SessionManager::SessionManager(const SessionManager& other) : sessions(other.sessions) {}
+SessionManager::SessionManager(const SessionManager& other)
+    : _slots(other._slots),
+      _records(other._records),
+      _freeRecords(other._freeRecords),
+      _expiry(other._expiry),
+      _used(other._used),
+      _deleted(other._deleted) {}
 
 SessionManager& SessionManager::operator=(const SessionManager& other) {
-    if (this != &other)
-        sessions = other.sessions;
+    if (this != &other) {
+        _slots       = other._slots;
+        _records     = other._records;
+        _freeRecords = other._freeRecords;
+        _expiry      = other._expiry;
+        _used        = other._used;
+        _deleted     = other._deleted;
+    }
     return *this;
 }
 
 SessionManager::~SessionManager() {}
 
-bool SessionManager::isIdTaken(const String& id) const {
-    return sessions.find(id) != sessions.end();
-}
-
 String SessionManager::createSession(const String& userId) {
-    String id;
+    String     id;
+    SessionKey key;
     do {
         id = generateGUID();
-    } while (isIdTaken(id));
+        parseKey(id, key);
+    } while (findSlot(key) != -1);
 
-    sessions[id] = SessionResult(id, userId);
+    insert(key, SessionResult(id, userId));
     Logger::info("[SESSION]: Created session " + id.substr(0, 8) + "... for user " + userId);
     return id;
 }
 
 SessionResult* SessionManager::getSession(const String& sessionId) {
-    SessionMap::iterator it = sessions.find(sessionId);
-    if (it == sessions.end())
+    long slot = find(sessionId);
+    if (slot == -1)
         return NULL;
-    if (it->second.isExpired(SESSION_TIMEOUT)) {
+    SessionResult& session = _records[_slots[slot].record].session;
+    if (session.isExpired(SESSION_TIMEOUT)) {
         Logger::info("[SESSION]: Expired session " + sessionId.substr(0, 8) + "...");
-        sessions.erase(it);
+        erase(slot);
         return NULL;
     }
-    it->second.updateTime();
-    return &it->second;
+    session.updateTime();
+    return &session;
 }
 
 bool SessionManager::removeSession(const String& sessionId) {
-    SessionMap::iterator it = sessions.find(sessionId);
-    if (it == sessions.end())
+    long slot = find(sessionId);
+    if (slot == -1)
         return false;
     Logger::info("[SESSION]: Removed session " + sessionId.substr(0, 8) + "...");
-    sessions.erase(it);
+    erase(slot);
     return true;
 }
 
+// Only the entries that are due are looked at, at most SESSION_CLEANUP_BATCH
+// of them per call, so this is cheap enough to run every event loop round
 void SessionManager::cleanupExpiredSessions(int timeoutSeconds) {
-    SessionMap::iterator it = sessions.begin();
-    while (it != sessions.end()) {
-        if (it->second.isExpired(timeoutSeconds)) {
-            Logger::info("[SESSION]: Cleanup expired session " + it->first.substr(0, 8) + "...");
-            SessionMap::iterator toErase = it;
-            ++it;
-            sessions.erase(toErase);
+    time_t now     = getCurrentTime();
+    size_t expired = 0;
+    for (size_t n = 0; n < SESSION_CLEANUP_BATCH && !_expiry.empty(); ++n) {
+        ExpiryEntry entry = _expiry.front();
+        if (getDifferentTime(entry.armedAt, now) <= timeoutSeconds)
+            break;
+        _expiry.pop_front();
+        Record& record = _records[entry.record];
+        if (!record.used || record.generation != entry.generation)
+            continue;
+        if (record.session.isExpired(timeoutSeconds)) {
+            erase(record.slot);
+            ++expired;
         } else {
-            ++it;
+            arm(entry.record);
         }
     }
+    if (expired > 0)
+        Logger::info("[SESSION]: Cleanup expired " + typeToString<size_t>(expired) + " sessions");
 }
 
 bool SessionManager::isValid(const String& sessionId) const {
-    SessionMap::const_iterator it = sessions.find(sessionId);
-    if (it == sessions.end())
+    long slot = find(sessionId);
+    if (slot == -1)
         return false;
-    return !it->second.isExpired(SESSION_TIMEOUT);
+    return !_records[_slots[slot].record].session.isExpired(SESSION_TIMEOUT);
 }
 
 String SessionManager::regenerateId(const String& oldSessionId) {
-    SessionMap::iterator it = sessions.find(oldSessionId);
-    if (it == sessions.end())
+    long slot = find(oldSessionId);
+    if (slot == -1)
         return "";
 
-    String        newId = generateGUID();
-    SessionResult copy  = it->second;
-    copy.sessionId      = newId;
+    SessionResult copy = _records[_slots[slot].record].session;
+    erase(slot);
+    String     newId;
+    SessionKey key;
+    do {
+        newId = generateGUID();
+        parseKey(newId, key);
+    } while (findSlot(key) != -1);
+    copy.sessionId = newId;
     copy.updateTime();
-    sessions.erase(it);
-    sessions[newId] = copy;
+    insert(key, copy);
 
     Logger::info("[SESSION]: Regenerated " + oldSessionId.substr(0, 8) + "... -> " + newId.substr(0, 8) + "...");
     return newId;
@@ -95,5 +122,138 @@ String SessionManager::buildExpiredCookieHeader() {
 }
 
 size_t SessionManager::getSessionCount() const {
-    return sessions.size();
+    return _used;
+}
+
+// ─── Table ───────────────────────────────────────────────────────────────────
+
+// Ids are lowercase hex, as generateGUID() writes them; anything else is
+// not a session id
+bool SessionManager::parseKey(const String& id, SessionKey& key) {
+    if (id.size() != SESSION_ID_LENGTH)
+        return false;
+    for (size_t i = 0; i < SESSION_ID_LENGTH; ++i) {
+        char c = id[i];
+        int  v;
+        if (c >= '0' && c <= '9')
+            v = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            v = c - 'a' + 10;
+        else
+            return false;
+        if (i % 2 == 0)
+            key.bytes[i / 2] = static_cast<unsigned char>(v << 4);
+        else
+            key.bytes[i / 2] |= static_cast<unsigned char>(v);
+    }
+    return true;
+}
+
+// FNV-1a: the ids are random, but the ones looked up come from clients
+size_t SessionManager::hashKey(const SessionKey& key) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(key.bytes); ++i)
+        hash = (hash ^ key.bytes[i]) * 16777619u;
+    return hash;
+}
+
+long SessionManager::find(const String& sessionId) const {
+    SessionKey key;
+    if (!parseKey(sessionId, key))
+        return -1;
+    return findSlot(key);
+}
+
+// The table is never more than half full, so probing always reaches an empty slot
+long SessionManager::findSlot(const SessionKey& key) const {
+    if (_slots.empty())
+        return -1;
+    size_t mask = _slots.size() - 1;
+    for (size_t i = hashKey(key) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = _slots[i];
+        if (slot.state == SLOT_EMPTY)
+            return -1;
+        if (slot.state == SLOT_USED && std::memcmp(slot.key.bytes, key.bytes, sizeof(key.bytes)) == 0)
+            return static_cast<long>(i);
+    }
+}
+
+// Grows the table, or just clears out deleted slots, once used and deleted
+// ones would fill half of it; afterwards it is at most a quarter full
+size_t SessionManager::insert(const SessionKey& key, const SessionResult& session) {
+    if ((_used + _deleted + 1) * 2 > _slots.size()) {
+        size_t capacity = _slots.empty() ? SESSION_TABLE_MIN_SIZE : _slots.size();
+        while ((_used + 1) * 4 > capacity)
+            capacity *= 2;
+        rehash(capacity);
+    }
+
+    size_t record;
+    if (!_freeRecords.empty()) {
+        record = _freeRecords.back();
+        _freeRecords.pop_back();
+    } else {
+        record = _records.size();
+        _records.push_back(Record());
+        _records.back().generation = 0;
+    }
+    size_t mask = _slots.size() - 1;
+    size_t i    = hashKey(key) & mask;
+    while (_slots[i].state == SLOT_USED)
+        i = (i + 1) & mask;
+    if (_slots[i].state == SLOT_DELETED)
+        --_deleted;
+    _slots[i].state          = SLOT_USED;
+    _slots[i].key            = key;
+    _slots[i].record         = record;
+    _records[record].session = session;
+    _records[record].slot    = i;
+    _records[record].used    = true;
+    ++_used;
+    arm(record);
+    return i;
+}
+
+// The record's expiry entry stays queued; the new generation marks it stale
+void SessionManager::erase(size_t slot) {
+    size_t  index  = _slots[slot].record;
+    Record& record = _records[index];
+    record.session = SessionResult();
+    record.used    = false;
+    ++record.generation;
+    _freeRecords.push_back(index);
+    _slots[slot].state = SLOT_DELETED;
+    --_used;
+    ++_deleted;
+}
+
+void SessionManager::rehash(size_t capacity) {
+    std::vector<Slot> old;
+    old.swap(_slots);
+    Slot empty;
+    empty.state  = SLOT_EMPTY;
+    empty.record = 0;
+    _slots.assign(capacity, empty);
+    _deleted    = 0;
+    size_t mask = capacity - 1;
+    for (size_t j = 0; j < old.size(); ++j) {
+        if (old[j].state != SLOT_USED)
+            continue;
+        size_t i = hashKey(old[j].key) & mask;
+        while (_slots[i].state == SLOT_USED)
+            i = (i + 1) & mask;
+        _slots[i]                    = old[j];
+        _records[old[j].record].slot = i;
+    }
+}
+
+// Queued at the session's last activity: entries are mostly in time order, and
+// one re-armed behind newer ones is only reclaimed a little late, since
+// getSession() and isValid() check the time themselves
+void SessionManager::arm(size_t record) {
+    ExpiryEntry entry;
+    entry.armedAt    = _records[record].session.lastActivity;
+    entry.record     = record;
+    entry.generation = _records[record].generation;
+    _expiry.push_back(entry);
 }
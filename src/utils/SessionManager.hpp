@@ -1,11 +1,15 @@
 #ifndef SESSION_MANAGER_HPP
 #define SESSION_MANAGER_HPP
 
+#include <deque>
 #include "Utils.hpp"
 #include "SessionResult.hpp"
 
-typedef std::map<String, SessionResult> SessionMap;
-
+// Sessions live in a deque, so the pointers getSession() hands out stay
+// valid; an open-addressing table with linear probing finds them by the id's
+// raw bytes. Expiry is a FIFO of (last activity, session) entries, one per
+// session: cleanup only looks at the front, and a session that was used since
+// its entry was queued is queued again instead of dropped.
 class SessionManager
 {
    public:
@@ -26,8 +30,43 @@ class SessionManager
     size_t getSessionCount() const;
 
    private:
-    SessionMap sessions;
-    bool   isIdTaken(const String& id) const;
+    struct SessionKey {
+        unsigned char bytes[SESSION_ID_LENGTH / 2];
+    };
+    enum SlotState { SLOT_EMPTY, SLOT_USED, SLOT_DELETED };
+    struct Slot {
+        SlotState  state;
+        SessionKey key;
+        size_t     record; // index in _records
+    };
+    struct Record {
+        SessionResult session;
+        size_t        slot;       // index in _slots
+        unsigned long generation; // bumped on removal, to spot stale expiry entries
+        bool          used;
+    };
+    struct ExpiryEntry {
+        time_t        armedAt; // the session's lastActivity when queued
+        size_t        record;
+        unsigned long generation;
+    };
+
+    std::vector<Slot>       _slots;       // power of two in size
+    std::deque<Record>      _records;
+    std::vector<size_t>     _freeRecords;
+    std::deque<ExpiryEntry> _expiry;      // oldest first
+    size_t                  _used;        // SLOT_USED slots
+    size_t                  _deleted;     // SLOT_DELETED slots
+
+    static bool   parseKey(const String& id, SessionKey& key);
+    static size_t hashKey(const SessionKey& key);
+
+    long   findSlot(const SessionKey& key) const;
+    size_t insert(const SessionKey& key, const SessionResult& session);
+    void   erase(size_t slot);
+    void   rehash(size_t capacity);
+    void   arm(size_t record);
+    long   find(const String& sessionId) const;
 };
 
 #endif
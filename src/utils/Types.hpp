@@ -6,28 +6,37 @@
 #include <string>
 #include <vector>
 
+class HttpConfig;
 class ServerConfig;
 class LocationConfig;
 class ListenAddress;
+class CgiWorkerConfig;
+class UpstreamConfig;
+class UpstreamGroup;
 class Client;
 class Server;
 typedef std::string                          String;
 typedef std::vector<String>                  VectorString;
 typedef std::vector<int>                     VectorInt;
 typedef std::map<String, String>             MapString;
-typedef std::map<int, int>                   MapInt;
+typedef std::vector<std::pair<String, String> > VectorStringPair;
 typedef std::map<String, VectorString>       MapValueVector;
 typedef std::vector<ServerConfig>            VectorServerConfig;
 typedef std::map<String, VectorServerConfig> ListenerToConfigsMap;
 typedef std::vector<LocationConfig>          VectorLocationConfig;
 typedef std::vector<ListenAddress>           VectorListenAddress;
 typedef std::map<int, String>                MapIntString;
-typedef std::map<int, Client*>               MapIntClientPtr;
-typedef std::map<int, Server*>               MapIntServerPtr;
 typedef std::map<int, VectorServerConfig>    MapIntVectorServerConfig;
+typedef std::map<String, CgiWorkerConfig>    MapCgiWorkerConfig;
+typedef std::vector<UpstreamConfig>          VectorUpstreamConfig;
+typedef std::vector<UpstreamGroup>           VectorUpstreamGroup;
 
+typedef bool (HttpConfig::*HttpSetter)(const VectorString&);
+typedef std::map<String, HttpSetter> HttpDirectiveMap;
 typedef bool (ServerConfig::*ServerSetter)(const VectorString&);
 typedef std::map<String, ServerSetter> ServerDirectiveMap;
 typedef bool (LocationConfig::*LocationSetter)(const VectorString&);
 typedef std::map<String, LocationSetter> LocationDirectiveMap;
+typedef bool (UpstreamConfig::*UpstreamSetter)(const VectorString&);
+typedef std::map<String, UpstreamSetter> UpstreamDirectiveMap;
 #endif
\ No newline at end of file
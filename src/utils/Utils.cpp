@@ -16,11 +16,58 @@ time_t getDifferentTime(const time_t& start, const time_t& end) {
     return end - start;
 }
 
+// ============================================================================
+// Number Methods
+// ============================================================================
+
+static String formatUnsigned(unsigned long value, bool negative) {
+    char  buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p   = end;
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    if (negative)
+        *--p = '-';
+    return String(p, end - p);
+}
+
+template <>
+String typeToString<int>(int _value) {
+    return typeToString<long>(_value);
+}
+
+template <>
+String typeToString<unsigned int>(unsigned int _value) {
+    return formatUnsigned(_value, false);
+}
+
+template <>
+String typeToString<long>(long _value) {
+    if (_value < 0)
+        return formatUnsigned(0UL - static_cast<unsigned long>(_value), true);
+    return formatUnsigned(static_cast<unsigned long>(_value), false);
+}
+
+template <>
+String typeToString<unsigned long>(unsigned long _value) {
+    return formatUnsigned(_value, false);
+}
+
 bool isLeapYear(int year) {
     return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
 }
 
-String formatDateTime(time_t t) {
+// Every response of the same second carries the same Date header. The
+// cache is per thread, as aio threads format Last-Modified for listings; the
+// pointer is good until the thread formats another time.
+const char* httpDate(time_t t) {
+    static __thread time_t cachedTime = -1;
+    static __thread char   cachedDate[32];
+    if (t == cachedTime)
+        return cachedDate;
+
     static const int   MONTH_DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
     static const char* WEEKDAYS[]   = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
     static const char* MONTHS[]     = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
@@ -76,7 +123,42 @@ String formatDateTime(time_t t) {
     date += " " + typeToString(year);
     date += " " + hourStr + ":" + minStr + ":" + secStr;
     date += " GMT";
-    return date;
+    size_t len = date.copy(cachedDate, sizeof(cachedDate) - 1);
+    cachedDate[len] = '\0';
+    cachedTime      = t;
+    return cachedDate;
+}
+
+String formatDateTime(time_t t) {
+    return httpDate(t);
+}
+
+// IMF-fixdate only ("Sun, 06 Nov 1994 08:49:37 GMT"), the form RFC 9110
+// requires senders to use; anything else gives -1
+time_t parseHttpDate(const String& date) {
+    static const int   MONTH_DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    static const char* MONTHS[]     = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    std::istringstream in(date);
+    String             weekday, monthName, zone;
+    int                day, year, hour, minute, second;
+    char               colon1, colon2;
+    if (!(in >> weekday >> day >> monthName >> year >> hour >> colon1 >> minute >> colon2 >> second >> zone))
+        return -1;
+    if (weekday.size() != 4 || weekday[3] != ',' || colon1 != ':' || colon2 != ':' || zone != "GMT" || year < 1970)
+        return -1;
+    int month = 0;
+    while (month < 12 && monthName != MONTHS[month])
+        ++month;
+    if (month == 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        return -1;
+
+    long days = day - 1;
+    for (int y = 1970; y < year; ++y)
+        days += isLeapYear(y) ? 366 : 365;
+    for (int m = 0; m < month; ++m)
+        days += (m == 1 && isLeapYear(year)) ? 29 : MONTH_DAYS[m];
+    return days * SECONDS_PER_DAY + hour * SECONDS_PER_HOUR + minute * SECONDS_PER_MIN + second;
 }
 
 // ============================================================================
@@ -91,6 +173,16 @@ String toUpperWords(const String& str) {
     return result;
 }
 
+bool equalsIgnoreCase(const String& a, const String& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+    return true;
+}
+
 String toLowerWords(const String& str) {
     String result = str;
     for (size_t i = 0; i < result.size(); ++i) {
@@ -284,15 +376,31 @@ bool convertFileToLines(const String& file, VectorString& lines) {
     return true;
 }
 
+// Sized from fstat and read straight into the string: one allocation, no stream copies
 bool readFileContent(const String& filePath, String& content) {
     content.clear();
-    std::ifstream file(filePath.c_str(), std::ios::in | std::ios::binary);
-    if (!file.is_open())
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
         return false;
-    std::ostringstream ss;
-    ss << file.rdbuf();
-    content = ss.str();
-    file.close();
+    }
+    if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    content.resize(static_cast<size_t>(st.st_size));
+    size_t total = 0;
+    while (total < content.size()) {
+        ssize_t n = read(fd, &content[total], content.size() - total);
+        if (n <= 0)
+            break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    content.resize(total);
     return true;
 }
 
@@ -367,56 +475,38 @@ String extractDirectoryFromPath(const String& path) {
 // Path Methods
 // ============================================================================
 
+// Collapses duplicate slashes and resolves . and .. in a single pass over
+// the path, building the result in place
 String normalizePath(const String& path) {
     if (path.empty())
         return "/";
 
-    // 1. Remove duplicate slashes
-    String cleaned;
-    cleaned.reserve(path.size());
-    if (path[0] != SLASH)
-        cleaned += '/';
-
-    for (size_t i = 0; i < path.length(); ++i) {
-        if (path[i] == SLASH && i + 1 < path.length() && path[i + 1] == SLASH)
+    String result;
+    result.reserve(path.size() + 1);
+    size_t i = 0;
+    while (i < path.size()) {
+        while (i < path.size() && path[i] == SLASH)
+            ++i;
+        size_t start = i;
+        while (i < path.size() && path[i] != SLASH)
+            ++i;
+        size_t len = i - start;
+        if (len == 0 || (len == 1 && path[start] == '.'))
+            continue;
+        if (len == 2 && path[start] == '.' && path[start + 1] == '.') {
+            size_t lastSlash = result.rfind(SLASH);
+            result.erase(lastSlash == String::npos ? 0 : lastSlash);
             continue;
-        cleaned += path[i];
-    }
-
-    // 2. Resolve . and ..
-    VectorString segments;
-    size_t       start = 0;
-    // Iterate through path, splitting by slash
-    for (size_t i = 0; i <= cleaned.length(); ++i) {
-        if (i == cleaned.length() || cleaned[i] == SLASH) {
-            if (i > start) {
-                String seg = cleaned.substr(start, i - start);
-                if (seg == "..") {
-                    if (!segments.empty())
-                        segments.pop_back();
-                } else if (seg != ".") {
-                    segments.push_back(seg);
-                }
-            }
-            start = i + 1;
         }
+        result += SLASH;
+        result.append(path, start, len);
     }
-
-    // 3. Rebuild
-    if (segments.empty())
+    if (result.empty())
         return "/";
 
-    String result = "/";
-    for (size_t i = 0; i < segments.size(); ++i) {
-        result += segments[i];
-        if (i + 1 < segments.size())
-            result += SLASH;
-    }
-
     // Preserve trailing slash if originally present (and not root)
-    if (result.size() > 1 && !cleaned.empty() && cleaned[cleaned.size() - 1] == SLASH)
+    if (path[path.size() - 1] == SLASH)
         result += SLASH;
-
     return result;
 }
 
@@ -429,12 +519,13 @@ String joinPaths(const String& firstPath, const String& secondPath) {
     bool firstEndsSlash    = (firstPath[firstPath.size() - 1] == SLASH);
     bool secondStartsSlash = (secondPath[0] == SLASH);
 
-    if (firstEndsSlash && secondStartsSlash)
-        return firstPath + secondPath.substr(1);
+    String joined;
+    joined.reserve(firstPath.size() + secondPath.size() + 1);
+    joined += firstPath;
     if (!firstEndsSlash && !secondStartsSlash)
-        return firstPath + SLASH + secondPath;
-
-    return firstPath + secondPath;
+        joined += SLASH;
+    joined.append(secondPath, (firstEndsSlash && secondStartsSlash) ? 1 : 0, String::npos);
+    return joined;
 }
 
 bool pathStartsWith(const String& path, const String& prefix) {
@@ -444,15 +535,14 @@ bool pathStartsWith(const String& path, const String& prefix) {
         return false;
 
     // Exact match or prefix ends with slash or path continues with slash
-    if (prefix == "/" || path.length() == prefix.length() || path[prefix.length()] == SLASH)
+    if ((!prefix.empty() && prefix[prefix.length() - 1] == SLASH) || path.length() == prefix.length() || path[prefix.length()] == SLASH)
         return true;
 
     return false;
 }
 
-String getUriRemainder(const String& uri, const String& locPath) {
-    String normalUri = normalizePath(uri);
-    String normalLoc = normalizePath(locPath);
+// Both arguments already went through normalizePath()
+String getUriRemainder(const String& normalUri, const String& normalLoc) {
 
     if (normalLoc == "/")
         return normalUri;
@@ -489,6 +579,68 @@ bool setNonBlocking(int fd) {
     return true;
 }
 
+// Peer address as text; IPv4-mapped IPv6 peers of a dual-stack listener print as plain IPv4,
+// unix socket peers have no address and print as "unix:"
+String sockaddrToString(const struct sockaddr_storage& addr) {
+    char buffer[INET6_ADDRSTRLEN];
+    if (addr.ss_family == AF_INET) {
+        const sockaddr_in* in = reinterpret_cast<const sockaddr_in*>(&addr);
+        if (inet_ntop(AF_INET, &in->sin_addr, buffer, sizeof(buffer)))
+            return buffer;
+    } else if (addr.ss_family == AF_INET6) {
+        const sockaddr_in6* in6 = reinterpret_cast<const sockaddr_in6*>(&addr);
+        if (IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr)) {
+            if (inet_ntop(AF_INET, &in6->sin6_addr.s6_addr[12], buffer, sizeof(buffer)))
+                return buffer;
+        } else if (inet_ntop(AF_INET6, &in6->sin6_addr, buffer, sizeof(buffer)))
+            return buffer;
+    } else if (addr.ss_family == AF_UNIX)
+        return "unix:";
+    return "";
+}
+
+// host:port or [v6addr]:port; the port must be numeric
+bool splitHostPort(const String& address, String& host, String& port) {
+    if (!address.empty() && address[0] == '[') {
+        size_t close = address.find(']');
+        if (close == String::npos || close + 1 >= address.size() || address[close + 1] != COLON)
+            return false;
+        host = address.substr(1, close - 1);
+        port = address.substr(close + 2);
+    } else if (!splitByChar(address, host, port, COLON, true))
+        return false;
+    int portNum;
+    return !host.empty() && stringToType<int>(port, portNum) && portNum >= 1 && portNum <= 65535;
+}
+
+// Upstream address (host:port, [v6]:port or unix:/path) to a connectable sockaddr
+bool resolveAddress(const String& address, struct sockaddr_storage& out, socklen_t& len) {
+    std::memset(&out, 0, sizeof(out));
+    if (address.compare(0, 5, "unix:") == 0) {
+        struct sockaddr_un* un   = reinterpret_cast<struct sockaddr_un*>(&out);
+        String              path = address.substr(5);
+        if (path.empty() || path.size() >= sizeof(un->sun_path))
+            return false;
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        len = sizeof(struct sockaddr_un);
+        return true;
+    }
+    String host, port;
+    if (!splitHostPort(address, host, port))
+        return false;
+    struct addrinfo hints, *res;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
+        return false;
+    std::memcpy(&out, res->ai_addr, res->ai_addrlen);
+    len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return true;
+}
+
 size_t convertMaxBodySize(const String& clientMaxBodySize) {
     if (clientMaxBodySize.empty())
         return 0;
@@ -666,6 +818,9 @@ String getHttpStatusMessage(int code) {
         case 505:
             result = "HTTP Version Not Supported";
             break;
+        case 507:
+            result = "Insufficient Storage";
+            break;
         default:
             result = "Unknown Error";
     }
@@ -716,59 +871,6 @@ String extractBoundaryFromContentType(const String& contentType) {
     return trimSpaces(contentType.substr(start, end - start));
 }
 
-bool parseMultipartFormData(const String& body, const String& boundary, String& filename, String& fileContent) {
-    if (boundary.empty() || body.empty())
-        return false;
-
-    String startBoundary = "--" + boundary;
-    // String endBoundary   = "--" + boundary + "--"; // Not explicitly needed for first part
-
-    // 1. Find Start
-    size_t partStart = body.find(startBoundary);
-    if (partStart == String::npos)
-        return false;
-    partStart += startBoundary.length();
-
-    // Consume CRLF if present
-    if (partStart + 2 <= body.length() && body.substr(partStart, 2) == CRLF)
-        partStart += 2;
-
-    // 2. Find End of this part (next boundary)
-    size_t partEnd = body.find(startBoundary, partStart);
-    if (partEnd == String::npos)
-        return false;
-
-    // Extract the raw part
-    String part = body.substr(partStart, partEnd - partStart);
-
-    // 3. Separate Headers and Content
-    size_t headerEnd = part.find(DOUBLE_CRLF);
-    if (headerEnd == String::npos)
-        return false;
-
-    String headers = part.substr(0, headerEnd);
-    String content = part.substr(headerEnd + 4); // Skip \r\n\r\n
-
-    // 4. Remove trailing CRLF from content (part of multipart protocol)
-    if (content.length() >= 2 && content.substr(content.length() - 2) == CRLF)
-        content.resize(content.length() - 2);
-
-    // 5. Parse Headers for filename
-    filename.clear();
-    VectorString lines;
-    splitByString(headers, lines, CRLF);
-
-    for (size_t i = 0; i < lines.size(); ++i) {
-        if (toLowerWords(lines[i]).find("content-disposition") != String::npos) {
-            filename = extractFilenameFromHeader(lines[i]);
-            break;
-        }
-    }
-
-    fileContent = content;
-    return !filename.empty();
-}
-
 bool getHeaderValue(const String& headers, const String& headerName, String& outValue) {
     outValue.clear();
     if (headerName.empty() || headers.empty())
@@ -800,67 +902,6 @@ bool isChunkedTransferEncoding(const String& headers) {
     return toLowerWords(val).find("chunked") != String::npos;
 }
 
-bool decodeChunkedBody(const String& chunkedBody, String& decodedBody) {
-    decodedBody.clear();
-    size_t pos      = 0;
-    size_t totalLen = chunkedBody.size();
-
-    while (pos < totalLen) {
-        size_t lineEnd = chunkedBody.find("\r\n", pos);
-        if (lineEnd == String::npos)
-            return false;
-
-        String sizeLine = chunkedBody.substr(pos, lineEnd - pos);
-        size_t semiPos  = sizeLine.find(';');
-        if (semiPos != String::npos)
-            sizeLine = sizeLine.substr(0, semiPos);
-
-        sizeLine = trimSpaces(sizeLine);
-        if (sizeLine.empty())
-            return false;
-
-        // 2. Parse hex chunk size manually
-        unsigned long chunkSize = 0;
-        for (size_t i = 0; i < sizeLine.size(); i++) {
-            char c = sizeLine[i];
-            chunkSize *= 16;
-            if (c >= '0' && c <= '9')
-                chunkSize += c - '0';
-            else if (c >= 'a' && c <= 'f')
-                chunkSize += c - 'a' + 10;
-            else if (c >= 'A' && c <= 'F')
-                chunkSize += c - 'A' + 10;
-            else
-                return false; // invalid hex digit
-        }
-
-        pos = lineEnd + 2; // skip \r\n
-
-        // 3. Handle last chunk (0)
-        if (chunkSize == 0) {
-            // Expect a final CRLF (or optional trailer headers + CRLF)
-            if (pos + 2 <= totalLen && chunkedBody.substr(pos, 2) == "\r\n")
-                pos += 2;
-            return pos == totalLen; // ensure all input consumed
-        }
-
-        // 4. Validate chunk size fits remaining data
-        if (pos + chunkSize + 2 > totalLen)
-            return false;
-
-        // 5. Append chunk data
-        decodedBody.append(chunkedBody, pos, chunkSize);
-        pos += chunkSize;
-
-        // 6. Check trailing CRLF after chunk
-        if (chunkedBody.substr(pos, 2) != "\r\n")
-            return false;
-        pos += 2;
-    }
-
-    return false; // should never reach here without a zero chunk
-}
-
 bool extractContentLength(ssize_t& contentLength, const String& headers) {
     String val;
     if (!getHeaderValue(headers, "content-length", val) || val.empty() || !stringToType<ssize_t>(val, contentLength))
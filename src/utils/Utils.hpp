@@ -1,10 +1,16 @@
 #ifndef UTILS_HPP
 #define UTILS_HPP
 
+#include <arpa/inet.h>
 #include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iostream>
@@ -18,10 +24,13 @@
 time_t getCurrentTime();
 void   updateTime(time_t& t);
 time_t getDifferentTime(const time_t& start, const time_t& end);
+const char* httpDate(time_t t = getCurrentTime());
 String formatDateTime(time_t t = getCurrentTime());
+time_t parseHttpDate(const String& date);
 // --- String Methods ---
 String toUpperWords(const String& str);
 String toLowerWords(const String& str);
+bool equalsIgnoreCase(const String& a, const String& b);
 String trimSpaces(const String& s);
 String trimQuotes(const String& s);
 String trimSpacesComments(const String& s);
@@ -51,7 +60,7 @@ String      extractDirectoryFromPath(const String& path);
 String        normalizePath(const String& path);
 String        joinPaths(const String& firstPath, const String& secondPath);
 bool          pathStartsWith(const String& path, const String& prefix);
-String getUriRemainder(const String& uri, const String& locPath);
+String getUriRemainder(const String& normalUri, const String& normalLoc);
 
 // --- HTTP/Network Helpers ---
 bool          checkAllowedMethods(const String& m);
@@ -59,14 +68,15 @@ bool          parseKeyValue(const String& line, String& key, VectorString& value
 size_t        convertMaxBodySize(const String& maxBody);
 String formatSize(double size);
 bool          setNonBlocking(int fd);
+String        sockaddrToString(const struct sockaddr_storage& addr);
+bool          splitHostPort(const String& address, String& host, String& port);
+bool          resolveAddress(const String& address, struct sockaddr_storage& out, socklen_t& len);
 String getHttpStatusMessage(int code);
 
 // --- Header/Body Parsing ---
 String extractFilenameFromHeader(const String& contentDisposition);
 String extractBoundaryFromContentType(const String& contentType);
-bool   parseMultipartFormData(const String& body, const String& boundary, String& filename, String& fileContent);
 bool   isChunkedTransferEncoding(const String& headers);
-bool   decodeChunkedBody(const String& chunkedBody, String& decodedBody);
 bool   getHeaderValue(const String& headers, const String& headerName, String& outValue);
 bool   extractContentLength(ssize_t& contentLength, const String& headers);
 bool   requireSingleValue(const VectorString& v, const String& directive);
@@ -98,6 +108,16 @@ String typeToString(type _value) {
     ss << _value;
     return ss.str();
 }
+// Integer conversions are on the hot path (status lines, Content-Length, dates),
+// so they skip the stringstream.
+template <>
+String typeToString<int>(int _value);
+template <>
+String typeToString<unsigned int>(unsigned int _value);
+template <>
+String typeToString<long>(long _value);
+template <>
+String typeToString<unsigned long>(unsigned long _value);
 
 template <typename T>
 bool stringToType(const String& str, T& out) {
@@ -0,0 +1,225 @@
+#!/bin/bash
+
+# ============================================================
+# Aio Tester
+# Runs webserv with aio threads and checks that static files,
+# directory listings and DELETE are answered from the thread
+# pool, and that a read stuck on the filesystem does
+# not hold up other connections
+# ============================================================
+
+WEBSERV="./webserv"
+PYTHON="/usr/bin/python3"
+TEST_DIR="aio_tests"
+PORT=8094
+THREADS=4
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name actual expected
+check() {
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+    if [ "$2" = "$3" ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $1"
+        PASS_COUNT=$((PASS_COUNT + 1))
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $1"
+        echo -e "   ${RED}Expected '$3', got '$2'${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+    fi
+}
+
+threads() {
+    awk '/^Threads/ {print $2}' "/proc/$WEBSERV_PID/status"
+}
+
+# A reader blocked in open() on the FIFO stands in for a slow disk; a writer
+# opening it lets the read finish
+release_fifo() {
+    timeout 2 sh -c ": > '$TEST_DIR/www/stall.fifo'"
+}
+
+cleanup() {
+    release_fifo 2>/dev/null
+    kill "$WEBSERV_PID" 2>/dev/null
+    wait "$WEBSERV_PID" 2>/dev/null
+}
+trap cleanup EXIT
+
+print_header "Aio Tester"
+
+if [ ! -f "$WEBSERV" ]; then
+    echo -e "${RED}❌ Error: $WEBSERV not found${NC}"
+    echo -e "${YELLOW}Please compile first: make${NC}"
+    exit 1
+fi
+
+rm -rf "$TEST_DIR"
+mkdir -p "$TEST_DIR/www/files"
+CWD=$(pwd)
+echo "hello from aio" > "$TEST_DIR/www/index.html"
+head -c 3000000 /dev/urandom > "$TEST_DIR/www/files/photo.bin"
+echo "doomed" > "$TEST_DIR/www/files/doomed.txt"
+mkfifo "$TEST_DIR/www/stall.fifo"
+cat > "$TEST_DIR/aio.conf" << EOF
+http {
+    aio threads=$THREADS;
+    server {
+        listen 127.0.0.1:$PORT;
+        server_name localhost;
+        root $CWD/$TEST_DIR/www;
+        index index.html;
+        location / {
+            methods GET HEAD DELETE;
+        }
+        location /files {
+            methods GET HEAD DELETE;
+            root $CWD/$TEST_DIR/www/files;
+            autoindex on;
+        }
+        location /upload {
+            methods POST PUT;
+            client_max_body_size 10M;
+            upload_dir $CWD/$TEST_DIR/uploads;
+        }
+        location /spliced {
+            methods PUT;
+            client_max_body_size 10M;
+            upload_dir $CWD/$TEST_DIR/uploads;
+            upload_io splice;
+        }
+    }
+}
+EOF
+
+$WEBSERV "$TEST_DIR/aio.conf" > "$TEST_DIR/webserv.log" 2>&1 &
+WEBSERV_PID=$!
+sleep 1
+
+URL="http://127.0.0.1:$PORT"
+
+# ============================================================
+# HANDLERS
+# ============================================================
+
+print_subheader "Handlers"
+
+check "Pool threads started" "$(threads)" "$((THREADS + 1))"
+check "Static file returns 200" "$(curl -s "$URL/index.html")" "hello from aio"
+check "Directory resolved to its index" "$(curl -s "$URL/")" "hello from aio"
+check "Missing file returns 404" "$(curl -s -o /dev/null -w '%{http_code}' "$URL/missing.html")" "404"
+curl -s -o "$TEST_DIR/photo.out" "$URL/files/photo.bin"
+check "Large static file intact" "$(cmp -s "$TEST_DIR/photo.out" "$TEST_DIR/www/files/photo.bin" && echo same)" "same"
+check "HEAD keeps Content-Length" "$(curl -s -I "$URL/files/photo.bin" | tr -d '\r' | awk -F': ' '/^Content-Length/ {print $2}')" "3000000"
+check "Directory listing lists files" "$(curl -s "$URL/files/" | grep -c 'photo.bin')" "1"
+check "DELETE returns 200" "$(curl -s -o /dev/null -w '%{http_code}' -X DELETE "$URL/files/doomed.txt")" "200"
+check "DELETE removed the file" "$([ -e "$TEST_DIR/www/files/doomed.txt" ] && echo kept || echo gone)" "gone"
+OUT=$(curl -s -o /dev/null -o /dev/null -o /dev/null -w '%{http_code}/%{num_connects} ' "$URL/index.html" "$URL/files/" "$URL/index.html")
+check "Keep-alive connection reused across pool responses" "$OUT" "200/1 200/0 200/0 "
+
+OK=$(seq 200 | xargs -P 20 -I{} curl -s -o /dev/null -w '%{http_code}\n' "$URL/index.html" | grep -c '^200$')
+check "200 concurrent requests all answered" "$OK" "200"
+
+# ============================================================
+# UPLOADS
+# ============================================================
+
+print_subheader "Uploads"
+
+# Args: name of the saved file; says whether it matches photo.bin
+saved() {
+    cmp -s "$TEST_DIR/uploads/$1" "$TEST_DIR/www/files/photo.bin" && echo same
+}
+PHOTO="$TEST_DIR/www/files/photo.bin"
+curl -s -o /dev/null -X PUT -H 'Content-Disposition: attachment; filename="raw.bin"' --data-binary "@$PHOTO" "$URL/upload"
+check "Raw upload written intact" "$(saved raw.bin)" "same"
+curl -s -o /dev/null -X PUT -H 'Transfer-Encoding: chunked' -H 'Content-Disposition: attachment; filename="chunked.bin"' --data-binary "@$PHOTO" "$URL/upload"
+check "Chunked upload written intact" "$(saved chunked.bin)" "same"
+curl -s -o /dev/null -F "file=@$PHOTO;filename=multi.bin" "$URL/upload"
+check "Multipart upload written intact" "$(saved multi.bin)" "same"
+curl -s -o /dev/null -X PUT -H 'Content-Disposition: attachment; filename="spliced.bin"' --data-binary "@$PHOTO" "$URL/spliced"
+check "Spliced upload written intact" "$(saved spliced.bin)" "same"
+OUT=$(python3 - "$PORT" <<'EOF'
+import re, socket, sys
+s = socket.create_connection(("127.0.0.1", int(sys.argv[1])))
+s.settimeout(5)
+s.sendall(b"PUT /upload HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\n"
+          b"Content-Disposition: attachment; filename=\"small.txt\"\r\n\r\nhello"
+          b"GET /index.html HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n")
+data = b""
+try:
+    while True:
+        chunk = s.recv(65536)
+        if not chunk:
+            break
+        data += chunk
+except socket.timeout:
+    pass
+print(" ".join(m.decode() for m in re.findall(b"HTTP/1.1 [0-9]+|hello from aio", data)))
+EOF
+)
+check "Request pipelined behind an upload answered" "$OUT" "HTTP/1.1 201 HTTP/1.1 200 hello from aio"
+check "No temporary upload files left" "$(ls -A "$TEST_DIR/uploads" | grep -c '^\.upload_')" "0"
+
+# ============================================================
+# STALLED DISK
+# ============================================================
+
+print_subheader "Stalled Disk"
+
+curl -s -o /dev/null -w '%{http_code}' -m 10 "$URL/stall.fifo" > "$TEST_DIR/stalled.out" &
+CURL_PID=$!
+sleep 0.5
+check "Other clients served while a read is stuck" "$(curl -s -m 1 "$URL/index.html")" "hello from aio"
+check "Listing served while a read is stuck" "$(curl -s -m 1 -o /dev/null -w '%{http_code}' "$URL/files/")" "200"
+release_fifo
+wait "$CURL_PID"
+check "Stuck request answered once the read finishes" "$(cat "$TEST_DIR/stalled.out")" "200"
+
+curl -s -o /dev/null -m 1 "$URL/stall.fifo"
+release_fifo
+sleep 0.3
+check "Result for a closed client is dropped" "$(curl -s -m 1 "$URL/index.html")" "hello from aio"
+check "Server still running" "$(kill -0 "$WEBSERV_PID" 2>/dev/null && echo up)" "up"
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
@@ -0,0 +1,97 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "../src/config/MimeTypes.hpp"
+#include "../src/config/ServerConfig.hpp"
+#include "../src/http/HttpRequest.hpp"
+#include "../src/http/ResponseBuilder.hpp"
+#include "../src/http/Router.hpp"
+
+volatile sig_atomic_t g_running = 1;
+
+/* ----------------------------------------------------
+ * Global allocation counter (every operator new goes here)
+ * ---------------------------------------------------- */
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+    g_allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) throw(std::bad_alloc) {
+    return operator new(size);
+}
+void operator delete(void* p) throw() {
+    std::free(p);
+}
+void operator delete[](void* p) throw() {
+    std::free(p);
+}
+
+/* ----------------------------------------------------
+ * One keep-alive request: parse -> route -> build -> serialize
+ *
+ * Parsing and routing stay in the request arena; 4 allocations per request
+ * are left, all on the response side:
+ *   - the HttpResponse header list (Date and Server are written out directly)
+ *   - the resolved file path in RouteResult
+ *   - the file body read by readFileContent()
+ *   - the serialized output
+ * ---------------------------------------------------- */
+static void runRequest(HttpRequest& request, const String& headerSection, const VectorServerConfig& servers, ResponseBuilder& builder, String& out) {
+    request.parseHeaders(headerSection);
+    request.setPort(8080);
+    Router       router(servers, request);
+    RouteResult  res      = router.processRequest();
+    HttpResponse response = builder.build(res);
+    response.addHeader("Connection", "keep-alive");
+    out = response.toString();
+    request.clear();
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = (argc > 1) ? std::strtoul(argv[1], NULL, 10) : 10000;
+    String root       = (argc > 2) ? argv[2] : ".www";
+
+    ServerConfig srv;
+    srv.setListen(VectorString(1, "127.0.0.1:8080"));
+    srv.setServerName(VectorString(1, "localhost"));
+    srv.setRoot(VectorString(1, root));
+    LocationConfig loc("/");
+    loc.setAllowedMethods(VectorString(1, "GET"));
+    srv.addLocation(loc);
+    VectorServerConfig servers(1, srv);
+
+    String headerSection =
+        "GET /index.html?lang=en&page=2 HTTP/1.1\r\n"
+        "Host: localhost:8080\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Language: en-US,en;q=0.5\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Cookie: webserv_sid=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+        "Connection: keep-alive";
+
+    ResponseBuilder builder((MimeTypes()));
+    HttpRequest     request;
+    String          out;
+
+    // Warm up: let long-lived buffers reach their steady-state capacity
+    for (size_t i = 0; i < 100; ++i)
+        runRequest(request, headerSection, servers, builder, out);
+
+    size_t before = g_allocations;
+    for (size_t i = 0; i < iterations; ++i)
+        runRequest(request, headerSection, servers, builder, out);
+    size_t total = g_allocations - before;
+
+    std::cout << "requests=" << iterations << std::endl;
+    std::cout << "allocations=" << total << std::endl;
+    std::cout << "allocationsPerRequest=" << (double)total / iterations << std::endl;
+    std::cout << "responseBytes=" << out.size() << std::endl;
+    return 0;
+}
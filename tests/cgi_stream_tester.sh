@@ -0,0 +1,463 @@
+#!/bin/bash
+
+# ============================================================
+# CGI Stream Tester
+# Runs webserv with slow and large CGI scripts and checks that
+# output and request bodies are streamed as they arrive, with
+# chunked framing, backpressure on both sides and splice()
+# for bodies passed through unchanged, and that cgi_cache_valid
+# answers repeated GETs without running the script again
+# ============================================================
+
+WEBSERV="./webserv"
+PYTHON="/usr/bin/python3"
+TEST_DIR="cgi_stream_tests"
+PORT=8092
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name actual expected
+check() {
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+    if [ "$2" = "$3" ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $1"
+        PASS_COUNT=$((PASS_COUNT + 1))
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $1"
+        echo -e "   ${RED}Expected '$3', got '$2'${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+    fi
+}
+
+rss_kb() {
+    awk '/^VmRSS/ {print $2}' "/proc/$WEBSERV_PID/status"
+}
+
+# Bytes the main thread moved through read()-like calls; splice() is not
+# counted. The task view leaves out the I/O of reaped CGI children.
+read_bytes() {
+    awk '/^rchar/ {print $2}' "/proc/$WEBSERV_PID/task/$WEBSERV_PID/io"
+}
+
+# Args: HTTP version; requests 32MB, reads nothing for 3s, prints the byte count
+slow_client() {
+    $PYTHON - "$PORT" "$1" << 'EOF'
+import socket, sys, time
+s = socket.create_connection(("127.0.0.1", int(sys.argv[1])))
+s.sendall(b"GET /big.py?33554432 HTTP/%s\r\nHost: localhost\r\nConnection: close\r\n\r\n" % sys.argv[2].encode())
+time.sleep(3)
+total = 0
+while True:
+    data = s.recv(65536)
+    if not data:
+        break
+    total += len(data)
+print(total)
+EOF
+}
+
+cleanup() {
+    kill "$WEBSERV_PID" 2>/dev/null
+    wait "$WEBSERV_PID" 2>/dev/null
+}
+trap cleanup EXIT
+
+print_header "CGI Stream Tester"
+
+if [ ! -f "$WEBSERV" ]; then
+    echo -e "${RED}❌ Error: $WEBSERV not found${NC}"
+    echo -e "${YELLOW}Please compile first: make${NC}"
+    exit 1
+fi
+
+mkdir -p "$TEST_DIR/www"
+CWD=$(pwd)
+cat > "$TEST_DIR/www/slow.py" << 'EOF'
+import sys, time
+sys.stdout.write("Content-Type: text/plain\r\n\r\nfirst\n")
+sys.stdout.flush()
+time.sleep(2)
+sys.stdout.write("second\n")
+EOF
+cat > "$TEST_DIR/www/length.py" << 'EOF'
+import sys, time
+sys.stdout.write("Content-Type: text/plain\r\nContent-Length: 12\r\n\r\nfirst\n")
+sys.stdout.flush()
+time.sleep(0.5)
+sys.stdout.write("second")
+EOF
+cat > "$TEST_DIR/www/big.py" << 'EOF'
+import os, sys
+size = int(os.environ.get("QUERY_STRING") or 1048576)
+out = sys.stdout.buffer
+out.write(b"Content-Type: application/octet-stream\r\n\r\n")
+line = b"x" * 1023 + b"\n"
+for _ in range(size // 1024):
+    out.write(line)
+EOF
+cat > "$TEST_DIR/www/biglen.py" << 'EOF'
+import os, sys
+size = int(os.environ.get("QUERY_STRING") or 1048576)
+out = sys.stdout.buffer
+out.write(b"Content-Type: application/octet-stream\r\nContent-Length: %d\r\n\r\n" % size)
+line = b"x" * 1023 + b"\n"
+for _ in range(size // 1024):
+    out.write(line)
+EOF
+cat > "$TEST_DIR/www/noheader.py" << 'EOF'
+import sys
+sys.stdout.write("y" * 200000)
+EOF
+cat > "$TEST_DIR/www/count.py" << 'EOF'
+import hashlib, sys
+body = sys.stdin.buffer.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\n%d %s\n" % (len(body), hashlib.md5(body).hexdigest()))
+EOF
+cat > "$TEST_DIR/www/lazy.py" << 'EOF'
+import sys, time
+time.sleep(3)
+body = sys.stdin.buffer.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\n%d\n" % len(body))
+EOF
+cat > "$TEST_DIR/www/linger.py" << 'EOF'
+import os, sys, time
+sys.stdout.write("Content-Type: text/plain\r\n\r\ndone\n")
+sys.stdout.flush()
+os.close(1)
+time.sleep(4)
+open(os.path.join(os.path.dirname(os.path.abspath(__file__)), "linger.mark"), "w").close()
+EOF
+# Dies once the headers are out: a crash seen before that is a plain 500
+cat > "$TEST_DIR/www/crash.py" << 'EOF'
+import os, signal, sys, time
+sys.stdout.write("Content-Type: text/plain\r\n\r\npartial\n")
+sys.stdout.flush()
+time.sleep(0.5)
+os.kill(os.getpid(), signal.SIGKILL)
+EOF
+cat > "$TEST_DIR/www/exit1.py" << 'EOF'
+import sys
+sys.stdout.write("Content-Type: text/plain\r\nContent-Length: 6\r\n\r\nerror\n")
+sys.exit(1)
+EOF
+cat > "$TEST_DIR/www/hold.py" << 'EOF'
+import sys, time
+time.sleep(2)
+sys.stdout.write("Content-Type: text/plain\r\n\r\nheld\n")
+EOF
+cat > "$TEST_DIR/www/counter.py" << 'EOF'
+import os, sys, time
+path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "counter.txt")
+count = int(open(path).read()) + 1 if os.path.exists(path) else 1
+open(path, "w").write(str(count))
+query = os.environ.get("QUERY_STRING", "")
+if query == "slow":
+    time.sleep(1)
+sys.stdout.write("Content-Type: text/plain\r\n")
+if query == "nostore":
+    sys.stdout.write("Cache-Control: no-store\r\n")
+if query == "cookie":
+    sys.stdout.write("Set-Cookie: id=%d\r\n" % count)
+sys.stdout.write("\r\ncount=%d lang=%s\n" % (count, os.environ.get("HTTP_ACCEPT_LANGUAGE", "")))
+EOF
+head -c 20000000 /dev/urandom > "$TEST_DIR/upload.bin"
+UPLOAD_SUM="20000000 $(md5sum "$TEST_DIR/upload.bin" | cut -d' ' -f1)"
+cat > "$TEST_DIR/cgi_stream.conf" << EOF
+http {
+    server {
+        listen 127.0.0.1:$PORT;
+        server_name localhost;
+        root $CWD/$TEST_DIR/www;
+        client_max_body_size 100M;
+        location / {
+            methods GET POST;
+            cgi_pass .py $PYTHON;
+        }
+        location /small {
+            methods POST;
+            cgi_pass .py $PYTHON;
+            client_max_body_size 1K;
+        }
+        location /limited {
+            methods GET;
+            cgi_pass .py $PYTHON;
+            cgi_max_concurrency 1;
+            cgi_queue_size 1;
+        }
+        location /brief {
+            methods GET;
+            cgi_pass .py $PYTHON;
+            cgi_max_concurrency 1;
+            cgi_queue_size 1;
+            cgi_queue_timeout 1;
+        }
+        location /cached {
+            methods GET POST;
+            cgi_pass .py $PYTHON;
+            cgi_cache_valid 2;
+            cgi_cache_vary Accept-Language;
+            cgi_max_concurrency 1;
+            cgi_queue_size 1;
+        }
+    }
+}
+EOF
+
+$WEBSERV "$TEST_DIR/cgi_stream.conf" > "$TEST_DIR/webserv.log" 2>&1 &
+WEBSERV_PID=$!
+sleep 1
+
+BASE="http://127.0.0.1:$PORT"
+
+# ============================================================
+# STREAMING
+# ============================================================
+
+print_subheader "Streaming"
+
+TTFB=$(curl -s -o /dev/null -w '%{time_starttransfer}' "$BASE/slow.py")
+check "Headers and first bytes before the script exits" "$(awk -v t="$TTFB" 'BEGIN {print (t < 1.5) ? "yes" : "no"}')" "yes"
+
+OUT=$(curl -s -D - "$BASE/slow.py" | tr -d '\r')
+check "No Content-Length: chunked transfer coding" "$(echo "$OUT" | grep -ci '^transfer-encoding: chunked')" "1"
+check "Chunked body decoded intact" "$(echo "$OUT" | tail -2 | tr '\n' ' ')" "first second "
+
+OUT=$(curl -s -D - "$BASE/length.py" | tr -d '\r')
+check "Script Content-Length kept, no chunking" "$(echo "$OUT" | grep -ci '^transfer-encoding')" "0"
+check "Content-Length body intact" "$(echo "$OUT" | tail -2 | tr '\n' ' ')" "first second "
+
+OUT=$(curl -s -0 -D - "$BASE/slow.py" | tr -d '\r')
+check "HTTP/1.0 client: body delimited by close" "$(echo "$OUT" | grep -ci '^connection: close')" "1"
+check "HTTP/1.0 body intact" "$(echo "$OUT" | tail -2 | tr '\n' ' ')" "first second "
+
+CONNECTS=$(curl -s -o /dev/null -o /dev/null -w '%{num_connects}\n' "$BASE/slow.py" "$BASE/big.py?65536" | tr '\n' ' ')
+check "Keep-alive after a chunked response" "$CONNECTS" "1 0 "
+
+check "Output without a header block returns 500" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/noheader.py")" "500"
+
+# ============================================================
+# LARGE OUTPUT
+# ============================================================
+
+print_subheader "Large Output"
+
+SIZE=$(curl -s "$BASE/big.py?8388608" | wc -c | tr -d ' ')
+check "8MB output forwarded intact" "$SIZE" "8388608"
+
+# A client that stops reading: the script blocks on the pipe instead of
+# its output piling up in the server
+BEFORE=$(rss_kb)
+slow_client 1.1 > "$TEST_DIR/slow_client.out" &
+CLIENT_PID=$!
+sleep 2
+AFTER=$(rss_kb)
+check "Memory bounded while the client is not reading" "$([ $((AFTER - BEFORE)) -lt 8192 ] && echo yes || echo "no ($((AFTER - BEFORE)) kB)")" "yes"
+wait "$CLIENT_PID"
+check "Slow client receives the whole response" "$([ "$(cat "$TEST_DIR/slow_client.out")" -gt 33554432 ] && echo yes)" "yes"
+
+# ============================================================
+# SPLICE
+# ============================================================
+
+print_subheader "Splice"
+
+BEFORE=$(read_bytes)
+OUT=$(curl -s "$BASE/biglen.py?8388608" | md5sum | cut -d' ' -f1)
+check "Content-Length output spliced intact" "$OUT" "$($PYTHON -c "import sys; sys.stdout.write(('x' * 1023 + '\n') * 8192)" | md5sum | cut -d' ' -f1)"
+check "Output bypasses the server's buffers" "$([ $(($(read_bytes) - BEFORE)) -lt 1048576 ] && echo yes)" "yes"
+
+BEFORE=$(read_bytes)
+OUT=$(curl -s -X POST --data-binary "@$TEST_DIR/upload.bin" "$BASE/count.py")
+check "20MB Content-Length body spliced intact" "$OUT" "$UPLOAD_SUM"
+check "Request body bypasses the server's buffers" "$([ $(($(read_bytes) - BEFORE)) -lt 1048576 ] && echo yes)" "yes"
+
+check "Slow HTTP/1.0 client receives the whole spliced response" "$(slow_client 1.0 | awk '{print ($1 > 33554432) ? "yes" : "no"}')" "yes"
+
+# ============================================================
+# REQUEST BODY
+# ============================================================
+
+print_subheader "Request Body"
+
+# Args: raw request, sent byte by byte when $2 is set; prints the response
+raw_request() {
+    printf "$1" | timeout 10 $PYTHON -c "
+import socket, sys, time
+s = socket.create_connection(('127.0.0.1', $PORT))
+data = sys.stdin.buffer.read()
+if len(sys.argv) > 1:
+    for i in range(len(data)):
+        s.send(data[i:i + 1])
+        time.sleep(0.001)
+else:
+    s.sendall(data)
+sys.stdout.write(s.makefile('rb').read().decode())" $2
+}
+
+OUT=$(curl -s -X POST -H "Transfer-Encoding: chunked" --data-binary "@$TEST_DIR/upload.bin" "$BASE/count.py")
+check "20MB chunked body decoded as it arrives" "$OUT" "$UPLOAD_SUM"
+
+OUT=$(raw_request 'POST /count.py HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n3;ext=1\r\nabc\r\n2\r\nde\r\n0\r\nX-Trailer: 1\r\n\r\n' split)
+check "Chunked body split byte by byte, with extension and trailer" "$(echo "$OUT" | tr -d '\r' | grep -c "^5 $(printf abcde | md5sum | cut -d' ' -f1)$")" "1"
+
+OUT=$(raw_request 'POST /count.py HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\nabc\r\n')
+check "Invalid chunk size returns 400" "$(echo "$OUT" | head -1 | cut -d' ' -f2)" "400"
+
+STATUS=$(head -c 4096 /dev/zero | curl -s -o /dev/null -w '%{http_code}' -X POST -H "Transfer-Encoding: chunked" --data-binary @- "$BASE/small/count.py")
+check "Chunked body over client_max_body_size returns 413" "$STATUS" "413"
+
+# The script sleeps before reading stdin: the upload has to wait in the
+# client socket rather than in the server
+BEFORE=$(rss_kb)
+curl -s -X POST --data-binary "@$TEST_DIR/upload.bin" "$BASE/lazy.py" > "$TEST_DIR/lazy.out" &
+UPLOAD_PID=$!
+sleep 2
+AFTER=$(rss_kb)
+check "Memory bounded while the script is not reading" "$([ $((AFTER - BEFORE)) -lt 8192 ] && echo yes || echo "no ($((AFTER - BEFORE)) kB)")" "yes"
+wait "$UPLOAD_PID"
+check "Upload completes once the script reads" "$(cat "$TEST_DIR/lazy.out")" "20000000"
+
+# ============================================================
+# PROCESS EXIT
+# ============================================================
+
+print_subheader "Process Exit"
+
+rm -f "$TEST_DIR/www/linger.mark"
+OUT=$(curl -s -m 10 -w ' %{time_total}' "$BASE/linger.py")
+check "Script that closes stdout and lingers still gets a response" "$(echo $OUT | cut -d' ' -f1)" "done"
+check "Response does not wait for the lingering script" "$(echo $OUT | awk '{print ($2 < 3.5) ? "yes" : "no"}')" "yes"
+sleep 3
+check "Lingering script is not killed" "$([ -f "$TEST_DIR/www/linger.mark" ] && echo yes)" "yes"
+
+curl -s -o /dev/null "$BASE/crash.py"
+check "Script killed by a signal: chunked body left unterminated" "$?" "18"
+EXITED=$(grep -c 'exited with status 1' "$TEST_DIR/webserv.log")
+check "Non-zero exit status keeps the script's response" "$(curl -s "$BASE/exit1.py")" "error"
+
+KILLED=$(grep -c 'killed by signal' "$TEST_DIR/webserv.log")
+for i in 1 2 3 4 5; do curl -s -o /dev/null "$BASE/length.py" & done
+wait $(jobs -p | grep -v "^$WEBSERV_PID$") 2>/dev/null
+sleep 0.5
+check "No zombie CGI processes" "$(ps --ppid "$WEBSERV_PID" -o stat= | grep -c Z)" "0"
+check "Exit status logged" "$(grep -c 'exited with status 1' "$TEST_DIR/webserv.log")" "$((EXITED + 1))"
+check "Finished scripts are not killed when the client leaves" "$(grep -c 'killed by signal' "$TEST_DIR/webserv.log")" "$KILLED"
+
+# ============================================================
+# CONCURRENCY
+# ============================================================
+
+print_subheader "Concurrency"
+
+curl -s -o /dev/null -w '%{http_code}\n' "$BASE/limited/hold.py" > "$TEST_DIR/running.out" &
+RUNNING_PID=$!
+sleep 0.3
+curl -s -o "$TEST_DIR/queued.body" -w '%{http_code} %{time_total}\n' "$BASE/limited/hold.py" > "$TEST_DIR/queued.out" &
+QUEUED_PID=$!
+sleep 0.3
+check "Request over the full queue returns 503" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/limited/hold.py")" "503"
+wait "$RUNNING_PID" "$QUEUED_PID"
+check "Running request is served" "$(cat "$TEST_DIR/running.out")" "200"
+check "Queued request is served once the slot frees up" "$(cat "$TEST_DIR/queued.body") $(cut -d' ' -f1 "$TEST_DIR/queued.out")" "held 200"
+check "Queued request waits for the running one" "$(awk '{print ($2 > 3) ? "yes" : "no"}' "$TEST_DIR/queued.out")" "yes"
+
+curl -s -o /dev/null "$BASE/brief/hold.py" &
+RUNNING_PID=$!
+sleep 0.3
+check "Request queued past cgi_queue_timeout returns 503" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/brief/hold.py")" "503"
+wait "$RUNNING_PID"
+check "Slot is free again after the queue drains" "$(curl -s "$BASE/brief/hold.py")" "held"
+
+# ============================================================
+# CACHING
+# ============================================================
+
+print_subheader "Caching"
+
+rm -f "$TEST_DIR/www/counter.txt"
+# Args: curl arguments; prints the X-Cache-Status value and the body
+cached() {
+    local headers="$TEST_DIR/headers.$BASHPID"
+    curl -s -D "$headers" "$@" | tr -d '\n'
+    echo " $(tr -d '\r' < "$headers" | awk -F': ' 'tolower($1) == "x-cache-status" {print $2}')"
+}
+check "First GET runs the script" "$(cached "$BASE/cached/counter.py")" "count=1 lang= MISS"
+check "Repeated GET is answered from the cache" "$(cached "$BASE/cached/counter.py")" "count=1 lang= HIT"
+check "Cached response carries Age" "$(curl -s -D - -o /dev/null "$BASE/cached/counter.py" | grep -ci '^age: ')" "1"
+check "Query string is part of the key" "$(cached "$BASE/cached/counter.py?a")" "count=2 lang= MISS"
+check "cgi_cache_vary header is part of the key" "$(cached -H 'Accept-Language: fr' "$BASE/cached/counter.py")" "count=3 lang=fr MISS"
+check "Each vary value has its own entry" "$(cached -H 'Accept-Language: fr' "$BASE/cached/counter.py")" "count=3 lang=fr HIT"
+check "POST is not cached" "$(cached -d x "$BASE/cached/counter.py")" "count=4 lang= "
+cached "$BASE/cached/counter.py?nostore" > /dev/null
+check "Cache-Control: no-store is not kept" "$(cached "$BASE/cached/counter.py?nostore")" "count=6 lang= MISS"
+cached "$BASE/cached/counter.py?cookie" > /dev/null
+check "Response setting a cookie is not kept" "$(cached "$BASE/cached/counter.py?cookie")" "count=8 lang= MISS"
+sleep 2.2
+check "Expired entry runs the script again" "$(cached "$BASE/cached/counter.py")" "count=9 lang= MISS"
+
+curl -s -o /dev/null "$BASE/cached/slow.py"
+OUT=$(curl -s -D "$TEST_DIR/headers" -w ' %{time_total}' "$BASE/cached/slow.py" | tr -d '\n')
+check "Streamed output is cached once complete" "$(echo "$OUT" | cut -d' ' -f1) $(grep -i '^x-cache-status:' "$TEST_DIR/headers" | tr -d '\r' | cut -d' ' -f2)" "firstsecond HIT"
+check "Streamed response replayed with a Content-Length" "$(grep -ci '^content-length: 13' "$TEST_DIR/headers")" "1"
+
+curl -s -o /dev/null "$BASE/cached/hold.py"
+curl -s -o /dev/null "$BASE/cached/hold.py?busy" &
+RUNNING_PID=$!
+sleep 0.3
+OUT=$(curl -s -w ' %{time_total}' "$BASE/cached/hold.py")
+check "Cache hit skips the full CGI queue" "$(echo "$OUT" | tr -d '\n' | awk '{print $1, ($2 < 1) ? "fast" : "slow"}')" "held fast"
+wait "$RUNNING_PID"
+
+# Five identical misses at once: one runs the script, the others wait for its
+# output rather than taking the single slot and queue place in turn
+rm -f "$TEST_DIR/www/counter.txt" "$TEST_DIR"/lock.*
+LOCK_PIDS=""
+for i in 1 2 3 4 5; do
+    cached "$BASE/cached/counter.py?slow" > "$TEST_DIR/lock.$i" &
+    LOCK_PIDS="$LOCK_PIDS $!"
+done
+wait $LOCK_PIDS
+check "Concurrent identical misses run the script once" "$(cat "$TEST_DIR/www/counter.txt")" "1"
+check "Waiting requests are answered from the cache" "$(cat "$TEST_DIR"/lock.* | sort | uniq -c | awk '{print $1, $2, $4}' | tr '\n' ' ')" "4 count=1 HIT 1 count=1 MISS "
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
@@ -0,0 +1,171 @@
+#!/bin/bash
+
+# ============================================================
+# CGI Worker Tester
+# Runs webserv with cgi_worker and checks that requests are
+# served by the pre-spawned pool, recycled and refilled
+# ============================================================
+
+WEBSERV="./webserv"
+WORKER="$(pwd)/www/workers/cgi_worker.py"
+PYTHON="/usr/bin/python3"
+TEST_DIR="cgi_worker_tests"
+PORT=8091
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name actual expected
+check() {
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+    if [ "$2" = "$3" ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $1"
+        PASS_COUNT=$((PASS_COUNT + 1))
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $1"
+        echo -e "   ${RED}Expected '$3', got '$2'${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+    fi
+}
+
+# Pids of the running worker processes
+worker_pids() {
+    ps -eo pid,args | awk -v w="$WORKER" '$3 == w {print $1}'
+}
+
+cleanup() {
+    kill "$WEBSERV_PID" 2>/dev/null
+    wait "$WEBSERV_PID" 2>/dev/null
+}
+trap cleanup EXIT
+
+print_header "CGI Worker Tester"
+
+if [ ! -f "$WEBSERV" ]; then
+    echo -e "${RED}❌ Error: $WEBSERV not found${NC}"
+    echo -e "${YELLOW}Please compile first: make${NC}"
+    exit 1
+fi
+
+mkdir -p "$TEST_DIR/www"
+CWD=$(pwd)
+cat > "$TEST_DIR/www/pid.py" << 'EOF'
+import os, sys
+body = sys.stdin.read()
+sys.stdout.write("Content-Type: text/plain\r\n\r\n")
+print("pid=%d" % os.getpid())
+print("query=%s" % os.environ.get("QUERY_STRING", ""))
+print("body=%d" % len(body))
+EOF
+cat > "$TEST_DIR/www/slow.py" << 'EOF'
+import os, sys, time
+time.sleep(1)
+sys.stdout.write("Content-Type: text/plain\r\n\r\npid=%d\n" % os.getpid())
+EOF
+cat > "$TEST_DIR/www/fail.py" << 'EOF'
+raise RuntimeError("broken script")
+EOF
+cat > "$TEST_DIR/cgi_worker.conf" << EOF
+http {
+    server {
+        listen 127.0.0.1:$PORT;
+        server_name localhost;
+        root $CWD/$TEST_DIR/www;
+        location / {
+            methods GET POST;
+            cgi_pass .py $PYTHON;
+            cgi_worker .py $WORKER min=2 max=3 idle=2 requests=5;
+        }
+    }
+}
+EOF
+
+$WEBSERV "$TEST_DIR/cgi_worker.conf" > "$TEST_DIR/webserv.log" 2>&1 &
+WEBSERV_PID=$!
+sleep 1
+
+BASE="http://127.0.0.1:$PORT"
+
+# ============================================================
+# POOL
+# ============================================================
+
+print_subheader "Pool"
+
+check "min workers started up front" "$(worker_pids | wc -l)" "2"
+
+OUT=$(curl -s "$BASE/pid.py?x=1")
+check "Query string reaches the script" "$(echo "$OUT" | grep '^query=')" "query=x=1"
+check "Script runs inside a worker" "$(worker_pids | grep -cx "$(echo "$OUT" | grep '^pid=' | cut -d= -f2)")" "1"
+
+OUT=$(curl -s -X POST --data-binary "@$WORKER" "$BASE/pid.py")
+check "POST body forwarded" "$(echo "$OUT" | grep '^body=')" "body=$(wc -c < "$WORKER" | tr -d ' ')"
+
+OUT=$(curl -s -X POST -H "Transfer-Encoding: chunked" --data-binary "@$WORKER" "$BASE/pid.py")
+check "Chunked POST body forwarded" "$(echo "$OUT" | grep '^body=')" "body=$(wc -c < "$WORKER" | tr -d ' ')"
+
+check "Script exception returns 500" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/fail.py")" "500"
+check "Worker survives a failing script" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/pid.py")" "200"
+
+# ============================================================
+# RECYCLING
+# ============================================================
+
+print_subheader "Recycling"
+
+PIDS=$(for i in 1 2 3 4 5 6; do curl -s "$BASE/pid.py" | grep '^pid='; done | sort -u | wc -l)
+check "Worker recycled after max requests" "$([ "$PIDS" -ge 2 ] && echo yes)" "yes"
+
+for i in 1 2 3 4 5; do curl -s -o /dev/null "$BASE/slow.py" & done
+wait $(jobs -p | grep -v "^$WEBSERV_PID$") 2>/dev/null
+sleep 0.5
+check "Pool grows up to max under load" "$(worker_pids | wc -l)" "3"
+sleep 4
+check "Idle workers above min exit" "$(worker_pids | wc -l)" "2"
+
+kill -9 $(worker_pids) 2>/dev/null
+sleep 0.2
+check "Request after workers were killed" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/pid.py")" "200"
+sleep 1.5
+check "Pool refilled to min" "$(worker_pids | wc -l)" "2"
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
@@ -20,6 +20,31 @@ void printLocation(const LocationConfig& loc, const ssize_t& resolvedBody) {
     std::cout << "    autoindex  : " << (loc.getAutoIndex() ? "on" : "off") << "\n";
     std::cout << "    return     : " << (loc.getIsRedirect() ? (loc.getRedirectValue() + " " + typeToString<int>(loc.getRedirectCode())) : "none")
               << "\n";
+    const MapCgiWorkerConfig& workers = loc.getCgiWorkers();
+    for (MapCgiWorkerConfig::const_iterator it = workers.begin(); it != workers.end(); ++it)
+        std::cout << "    cgi_worker : " << it->first << " " << it->second.getScript() << " min=" << it->second.getMin() << " max=" << it->second.getMax()
+                  << " idle=" << it->second.getIdleTimeout() << " requests=" << it->second.getMaxRequests() << "\n";
+    if (!loc.getUploadDir().empty()) {
+        const char* io[] = {"write", "direct", "splice"};
+        std::cout << "    upload     : " << loc.getUploadDir() << " io=" << io[loc.getUploadIo()] << "\n";
+    }
+    if (loc.hasFastcgi())
+        std::cout << "    fastcgi    : " << loc.getFastcgiPass() << "\n";
+    if (loc.hasProxy() && !loc.getProxyUpstream().empty())
+        std::cout << "    proxy      : upstream " << loc.getProxyUpstream() << loc.getProxyUri() << "\n";
+    else if (loc.hasProxy())
+        std::cout << "    proxy      : " << loc.getProxyPass() << loc.getProxyUri() << "\n";
+    if (loc.hasProxyCache())
+        std::cout << "    proxy_cache: valid=" << loc.getProxyCacheValid() << (loc.hasProxyCacheLock() ? " lock" : "") << "\n";
+    if (loc.hasCgiCache()) {
+        std::cout << "    cgi_cache  : valid=" << loc.getCgiCacheValid();
+        for (size_t i = 0; i < loc.getCgiCacheVary().size(); ++i)
+            std::cout << " " << loc.getCgiCacheVary()[i];
+        std::cout << "\n";
+    }
+    if (loc.hasCgiLimit())
+        std::cout << "    cgi_limit  : max=" << loc.getCgiMaxConcurrency() << " queue=" << loc.getCgiQueueSize()
+                  << " timeout=" << loc.getCgiQueueTimeout() << "\n";
     for (size_t i = 0; i < loc.getAllowedMethods().size(); i++) {
         std::cout << "    method     : " << loc.getAllowedMethods()[i] << "\n";
     }
@@ -29,6 +54,22 @@ void printLocation(const LocationConfig& loc, const ssize_t& resolvedBody) {
         std::cout << "    client_max : " << resolvedBody << " (fallback)\n";
 }
 
+/* ----------------------------------------------------
+ * Print upstream
+ * ---------------------------------------------------- */
+void printUpstream(const UpstreamConfig& up) {
+    const char* policies[] = {"round-robin", "least_conn", "hash $request_uri", "hash $cookie_"};
+    printLine();
+    std::cout << "Upstream " << up.getName() << "\n";
+    std::cout << "  policy       : " << policies[up.getPolicy()] << up.getHashCookie() << "\n";
+    const UpstreamConfig::VectorServer& servers = up.getServers();
+    for (size_t i = 0; i < servers.size(); i++)
+        std::cout << "  server       : " << servers[i].address << " max_fails=" << servers[i].maxFails << " fail_timeout=" << servers[i].failTimeout << "\n";
+    if (up.hasHealthCheck())
+        std::cout << "  health_check : interval=" << up.getHealthInterval() << " uri=" << up.getHealthUri() << " fails=" << up.getHealthFails()
+                  << " passes=" << up.getHealthPasses() << "\n";
+}
+
 /* ----------------------------------------------------
  * Print server
  * ---------------------------------------------------- */
@@ -36,6 +77,19 @@ void printServer(const ServerConfig& srv, const ConfigParser& http) {
     printLine();
     std::cout << "Server\n";
     std::cout << "  listen       : " << srv.getPort() << "\n";
+    const ListenAddress& addr = srv.getListenAddresses()[0];
+    if (addr.getBacklog() != -1)
+        std::cout << "    backlog    : " << addr.getBacklog() << "\n";
+    if (addr.isDeferred())
+        std::cout << "    deferred   : on\n";
+    if (addr.getFastOpen() != -1)
+        std::cout << "    fastopen   : " << addr.getFastOpen() << "\n";
+    if (addr.getRcvBuf() != -1)
+        std::cout << "    rcvbuf     : " << addr.getRcvBuf() << "\n";
+    if (addr.getSndBuf() != -1)
+        std::cout << "    sndbuf     : " << addr.getSndBuf() << "\n";
+    if (addr.isSoKeepalive())
+        std::cout << "    keepalive  : on\n";
     std::cout << "  server_name  : " << srv.getServerName() << "\n";
     std::cout << "  root         : " << srv.getRoot() << "\n";
 
@@ -81,6 +135,16 @@ int main(int ac, char** av) {
     printLine();
     std::cout << "HTTP\n";
     std::cout << "  client_max_body_size : " << parser.getHttpClientMaxBody() << "\n";
+    std::cout << "  accept_batch         : " << parser.getHttpConfig().getAcceptBatch() << "\n";
+    std::cout << "  max_connections      : " << parser.getHttpConfig().getMaxConnections() << "\n";
+    std::cout << "  aio threads          : " << parser.getHttpConfig().getAioThreads() << "\n";
+    if (!parser.getHttpConfig().getProxyCachePath().empty())
+        std::cout << "  proxy_cache_path     : " << parser.getHttpConfig().getProxyCachePath()
+                  << " max_size=" << parser.getHttpConfig().getProxyCacheMaxSize() << "\n";
+
+    const VectorUpstreamConfig& upstreams = parser.getHttpConfig().getUpstreams();
+    for (size_t i = 0; i < upstreams.size(); i++)
+        printUpstream(upstreams[i]);
 
     /* ------------------------------------------------
      * Servers
@@ -1131,7 +1131,7 @@ http {
 }
 EOF
 
-    # 78. IPv6 localhost (should fail - not supported)
+    # 78. IPv6 localhost
     cat > "$TEST_DIR/78_ipv6.conf" << 'EOF'
 http {
     server {
@@ -1341,6 +1341,707 @@ http {
         }
     }
 }
+EOF
+
+    # 96. accept_batch in http block
+    cat > "$TEST_DIR/96_accept_batch.conf" << 'EOF'
+http {
+    accept_batch 128;
+    server {
+        listen localhost:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 97. accept_batch out of range
+    cat > "$TEST_DIR/97_accept_batch_zero.conf" << 'EOF'
+http {
+    accept_batch 0;
+    server {
+        listen localhost:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 98. Duplicate accept_batch
+    cat > "$TEST_DIR/98_dup_accept_batch.conf" << 'EOF'
+http {
+    accept_batch 16;
+    accept_batch 32;
+    server {
+        listen localhost:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 99. max_connections and overload_response 503
+    cat > "$TEST_DIR/99_max_connections.conf" << 'EOF'
+http {
+    max_connections 2048;
+    overload_response 503 5;
+    server {
+        listen localhost:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 100. max_connections not a number
+    cat > "$TEST_DIR/100_max_connections_nan.conf" << 'EOF'
+http {
+    max_connections many;
+    server {
+        listen localhost:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 101. Invalid overload_response mode
+    cat > "$TEST_DIR/101_overload_invalid.conf" << 'EOF'
+http {
+    overload_response drop;
+    server {
+        listen localhost:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 102. listen with socket options
+    cat > "$TEST_DIR/102_listen_options.conf" << 'EOF'
+server {
+    listen localhost:8080 backlog=511 deferred fastopen=16 rcvbuf=64k sndbuf=128k so_keepalive;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 103. listen with an invalid backlog
+    cat > "$TEST_DIR/103_listen_bad_backlog.conf" << 'EOF'
+server {
+    listen localhost:8080 backlog=0;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 104. listen with an unknown option
+    cat > "$TEST_DIR/104_listen_unknown_option.conf" << 'EOF'
+server {
+    listen localhost:8080 reuseport=on;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 105. Dual-stack and IPv6-only listeners side by side
+    cat > "$TEST_DIR/105_ipv6_dual_stack.conf" << 'EOF'
+server {
+    listen [::]:8080;
+    listen [::1]:8081 ipv6only=on;
+    listen 127.0.0.1:8081;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 106. Malformed IPv6 address
+    cat > "$TEST_DIR/106_ipv6_invalid.conf" << 'EOF'
+server {
+    listen [::g]:8080;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 107. ipv6only on an IPv4 listener
+    cat > "$TEST_DIR/107_ipv6only_on_ipv4.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080 ipv6only=on;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 108. Unix socket listener with permissions
+    cat > "$TEST_DIR/108_listen_unix.conf" << 'EOF'
+server {
+    listen unix:/run/webserv.sock mode=0660 backlog=256;
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 109. Invalid unix socket mode
+    cat > "$TEST_DIR/109_listen_unix_bad_mode.conf" << 'EOF'
+server {
+    listen unix:/run/webserv.sock mode=0999;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 110. TCP-only option on a unix socket
+    cat > "$TEST_DIR/110_listen_unix_deferred.conf" << 'EOF'
+server {
+    listen unix:/run/webserv.sock deferred;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 110b. Two server blocks giving options for one address
+    cat > "$TEST_DIR/110b_listen_options_conflict.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080 backlog=511;
+    server_name a.com;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+server {
+    listen 127.0.0.1:8080 rcvbuf=64k;
+    server_name b.com;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 110c. Options in one server block, the address bare in another
+    cat > "$TEST_DIR/110c_listen_options_shared.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    server_name a.com;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+server {
+    listen 127.0.0.1:8080 backlog=511 deferred;
+    server_name b.com;
+    root /var/www;
+    location / {
+        index index.html;
+    }
+}
+EOF
+
+    # 111. fastcgi_pass over TCP and unix socket
+    cat > "$TEST_DIR/111_fastcgi_pass.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /app {
+        fastcgi_pass 127.0.0.1:9000;
+    }
+    location /php {
+        fastcgi_pass unix:/run/php-fpm.sock;
+    }
+}
+EOF
+
+    # 112. fastcgi_pass without a port
+    cat > "$TEST_DIR/112_fastcgi_pass_no_port.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /app {
+        fastcgi_pass 127.0.0.1;
+    }
+}
+EOF
+
+    # 113. Duplicate fastcgi_pass
+    cat > "$TEST_DIR/113_fastcgi_pass_duplicate.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /app {
+        fastcgi_pass 127.0.0.1:9000;
+        fastcgi_pass 127.0.0.1:9001;
+    }
+}
+EOF
+
+    # 114. Persistent CGI workers
+    cat > "$TEST_DIR/114_cgi_worker.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_worker .py /var/www/workers/cgi_worker.py min=2 max=8 idle=30 requests=500;
+    }
+}
+EOF
+
+    # 115. cgi_worker without matching cgi_pass
+    cat > "$TEST_DIR/115_cgi_worker_no_cgi_pass.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .php /usr/bin/php-cgi;
+        cgi_worker .py /var/www/workers/cgi_worker.py;
+    }
+}
+EOF
+
+    # 116. cgi_worker min above max
+    cat > "$TEST_DIR/116_cgi_worker_min_max.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_worker .py /var/www/workers/cgi_worker.py min=4 max=2;
+    }
+}
+EOF
+
+    # 117. cgi_worker unknown option
+    cat > "$TEST_DIR/117_cgi_worker_unknown_option.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_worker .py /var/www/workers/cgi_worker.py threads=4;
+    }
+}
+EOF
+
+    # 118. CGI concurrency limit with a queue
+    cat > "$TEST_DIR/118_cgi_concurrency.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_max_concurrency 4;
+        cgi_queue_size 16;
+        cgi_queue_timeout 10;
+    }
+}
+EOF
+
+    # 119. cgi_queue_size without cgi_max_concurrency
+    cat > "$TEST_DIR/119_cgi_queue_without_limit.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_queue_size 16;
+    }
+}
+EOF
+
+    # 120. cgi_max_concurrency of zero
+    cat > "$TEST_DIR/120_cgi_concurrency_zero.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_max_concurrency 0;
+    }
+}
+EOF
+
+    # 121. upload_io modes
+    cat > "$TEST_DIR/121_upload_io.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /upload {
+        methods POST PUT;
+        upload_dir /var/www/uploads;
+        upload_io direct;
+    }
+    location /bulk {
+        methods PUT;
+        upload_dir /var/www/bulk;
+        upload_io splice;
+    }
+}
+EOF
+
+    # 122. upload_io without upload_dir
+    cat > "$TEST_DIR/122_upload_io_without_dir.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /upload {
+        upload_io splice;
+    }
+}
+EOF
+
+    # 123. Unknown upload_io mode
+    cat > "$TEST_DIR/123_upload_io_invalid.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /upload {
+        upload_dir /var/www/uploads;
+        upload_io mmap;
+    }
+}
+EOF
+
+    # 124. aio thread pool
+    cat > "$TEST_DIR/124_aio_threads.conf" << 'EOF'
+http {
+    aio threads=8;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 125. aio without a thread count
+    cat > "$TEST_DIR/125_aio_invalid.conf" << 'EOF'
+http {
+    aio threads=0;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 126. Duplicate aio
+    cat > "$TEST_DIR/126_dup_aio.conf" << 'EOF'
+http {
+    aio off;
+    aio threads=4;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location / {
+            index index.html;
+        }
+    }
+}
+EOF
+
+    # 129. proxy_pass with and without a URI, default port
+    cat > "$TEST_DIR/129_proxy_pass.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /api/ {
+        proxy_pass http://127.0.0.1:3000/;
+    }
+    location /app {
+        proxy_pass http://localhost;
+    }
+}
+EOF
+
+    # 130. proxy_pass to an https upstream
+    cat > "$TEST_DIR/130_proxy_pass_https.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        proxy_pass https://127.0.0.1:3000;
+    }
+}
+EOF
+
+    # 131. proxy_pass and fastcgi_pass in one location
+    cat > "$TEST_DIR/131_proxy_pass_fastcgi.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        fastcgi_pass 127.0.0.1:9000;
+        proxy_pass http://127.0.0.1:3000;
+    }
+}
+EOF
+
+    # 132. upstream blocks with every policy and health_check
+    cat > "$TEST_DIR/132_upstream.conf" << 'EOF'
+http {
+    upstream app {
+        server 127.0.0.1:3001 max_fails=3 fail_timeout=30;
+        server 127.0.0.1:3002;
+        server localhost;
+        health_check interval=2 uri=/health fails=2 passes=1;
+    }
+    upstream least {
+        least_conn;
+        server 127.0.0.1:3001;
+    }
+    upstream sticky {
+        hash $cookie_session;
+        server 127.0.0.1:3001;
+        server 127.0.0.1:3002;
+    }
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location /app/ {
+            proxy_pass http://app/;
+        }
+        location /sticky {
+            proxy_pass http://sticky;
+        }
+    }
+}
+upstream byuri {
+    hash $request_uri;
+    server 127.0.0.1:3003;
+}
+EOF
+
+    # 133. upstream block without servers
+    cat > "$TEST_DIR/133_upstream_empty.conf" << 'EOF'
+upstream app {
+    least_conn;
+}
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        proxy_pass http://app;
+    }
+}
+EOF
+
+    # 134. two balancing methods in one upstream block
+    cat > "$TEST_DIR/134_upstream_two_policies.conf" << 'EOF'
+upstream app {
+    least_conn;
+    hash $request_uri;
+    server 127.0.0.1:3001;
+}
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        proxy_pass http://app;
+    }
+}
+EOF
+
+    # 135. hash on an unsupported key
+    cat > "$TEST_DIR/135_upstream_hash_key.conf" << 'EOF'
+upstream app {
+    hash $remote_addr;
+    server 127.0.0.1:3001;
+}
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        proxy_pass http://app;
+    }
+}
+EOF
+
+    # 136. two upstream blocks with one name
+    cat > "$TEST_DIR/136_upstream_duplicate.conf" << 'EOF'
+upstream app {
+    server 127.0.0.1:3001;
+}
+upstream app {
+    server 127.0.0.1:3002;
+}
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        proxy_pass http://app;
+    }
+}
+EOF
+
+    # 137. health_check with a zero interval
+    cat > "$TEST_DIR/137_upstream_health_interval.conf" << 'EOF'
+upstream app {
+    server 127.0.0.1:3001;
+    health_check interval=0;
+}
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        proxy_pass http://app;
+    }
+}
+EOF
+
+    # 138. proxy_cache with a cache path and a default validity
+    cat > "$TEST_DIR/138_proxy_cache.conf" << 'EOF'
+http {
+    proxy_cache_path /tmp/webserv-cache max_size=10m;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location /api {
+            proxy_pass http://127.0.0.1:3000;
+            proxy_cache on;
+            proxy_cache_valid 30;
+            proxy_cache_lock on;
+        }
+    }
+}
+EOF
+
+    # 139. proxy_cache without proxy_cache_path
+    cat > "$TEST_DIR/139_proxy_cache_no_path.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /api {
+        proxy_pass http://127.0.0.1:3000;
+        proxy_cache on;
+    }
+}
+EOF
+
+    # 140. proxy_cache on a location that does not proxy
+    cat > "$TEST_DIR/140_proxy_cache_no_proxy.conf" << 'EOF'
+http {
+    proxy_cache_path /tmp/webserv-cache;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location / {
+            proxy_cache on;
+        }
+    }
+}
+EOF
+
+    # 141. proxy_cache_path with a bad max_size
+    cat > "$TEST_DIR/141_proxy_cache_path_size.conf" << 'EOF'
+http {
+    proxy_cache_path /tmp/webserv-cache max_size=lots;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+    }
+}
+EOF
+
+    # 142. proxy_cache_lock without proxy_cache
+    cat > "$TEST_DIR/142_proxy_cache_lock.conf" << 'EOF'
+http {
+    proxy_cache_path /tmp/webserv-cache;
+    server {
+        listen 127.0.0.1:8080;
+        root /var/www;
+        location /api {
+            proxy_pass http://127.0.0.1:3000;
+            proxy_cache_lock on;
+        }
+    }
+}
+EOF
+
+    # 143. CGI microcache keyed on a request header
+    cat > "$TEST_DIR/143_cgi_cache.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_cache_valid 5;
+        cgi_cache_vary Accept-Language Cookie;
+    }
+}
+EOF
+
+    # 144. cgi_cache_valid on a location without CGI
+    cat > "$TEST_DIR/144_cgi_cache_no_cgi.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location / {
+        cgi_cache_valid 5;
+    }
+}
+EOF
+
+    # 145. cgi_cache_vary without cgi_cache_valid
+    cat > "$TEST_DIR/145_cgi_cache_vary.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_cache_vary Cookie;
+    }
+}
+EOF
+
+    # 146. cgi_cache_valid of zero seconds
+    cat > "$TEST_DIR/146_cgi_cache_zero.conf" << 'EOF'
+server {
+    listen 127.0.0.1:8080;
+    root /var/www;
+    location /cgi-bin {
+        cgi_pass .py /usr/bin/python3;
+        cgi_cache_valid 0;
+    }
+}
 EOF
 
     echo -e "${GREEN}Generated $(ls -1 "$TEST_DIR"/*.conf 2>/dev/null | wc -l) test configuration files${NC}"
@@ -1462,8 +2163,8 @@ run_tests() {
     # Port 65536 should fail
     test_failure "Port 65536 (over max)" "$TEST_DIR/68_port_over_max.conf" "invalid port"
     
-    # IPv6 format likely not supported
-    test_failure "IPv6 address format" "$TEST_DIR/78_ipv6.conf" ""
+    # IPv6 listen addresses are bracketed
+    test_success "IPv6 address format" "$TEST_DIR/78_ipv6.conf"
     
     # Semicolon breaks parsing
     test_failure "Semicolon in value" "$TEST_DIR/80_semicolon_value.conf" ""
@@ -1495,6 +2196,97 @@ run_tests() {
     
     # Multiple values for root - should now FAIL
     test_failure "Multiple values for root" "$TEST_DIR/84_multi_value_root.conf" "[ERROR]: root takes exactly one value"
+
+    # ----------------------------------------------------------
+    # HTTP BLOCK DIRECTIVES
+    # ----------------------------------------------------------
+    print_subheader "HTTP Block Directives"
+    test_success "accept_batch in http block" "$TEST_DIR/96_accept_batch.conf"
+    test_failure "accept_batch zero" "$TEST_DIR/97_accept_batch_zero.conf" "invalid accept_batch"
+    test_failure "Duplicate accept_batch" "$TEST_DIR/98_dup_accept_batch.conf" "duplicate accept_batch"
+    test_success "max_connections with overload_response 503" "$TEST_DIR/99_max_connections.conf"
+    test_failure "max_connections not a number" "$TEST_DIR/100_max_connections_nan.conf" "invalid max_connections"
+    test_failure "Invalid overload_response mode" "$TEST_DIR/101_overload_invalid.conf" "invalid overload_response"
+
+    # ----------------------------------------------------------
+    # LISTEN OPTIONS
+    # ----------------------------------------------------------
+    print_subheader "Listen Options"
+    test_success "listen with socket options" "$TEST_DIR/102_listen_options.conf"
+    test_failure "listen backlog zero" "$TEST_DIR/103_listen_bad_backlog.conf" "invalid listen backlog"
+    test_failure "listen unknown option" "$TEST_DIR/104_listen_unknown_option.conf" "unknown listen option"
+    test_success "Dual-stack and IPv6-only listeners" "$TEST_DIR/105_ipv6_dual_stack.conf"
+    test_failure "Malformed IPv6 address" "$TEST_DIR/106_ipv6_invalid.conf" "invalid IPv6 address"
+    test_failure "ipv6only on IPv4 listener" "$TEST_DIR/107_ipv6only_on_ipv4.conf" "invalid listen ipv6only"
+    test_success "Unix socket listener" "$TEST_DIR/108_listen_unix.conf"
+    test_failure "Unix socket bad mode" "$TEST_DIR/109_listen_unix_bad_mode.conf" "invalid listen mode"
+    test_failure "deferred on unix socket" "$TEST_DIR/110_listen_unix_deferred.conf" "not supported on unix sockets"
+    test_failure "Conflicting listen options across servers" "$TEST_DIR/110b_listen_options_conflict.conf" "duplicate listen options"
+    test_success "listen options given once for a shared address" "$TEST_DIR/110c_listen_options_shared.conf"
+
+    # ----------------------------------------------------------
+    # FASTCGI
+    # ----------------------------------------------------------
+    print_subheader "FastCGI"
+    test_success "fastcgi_pass TCP and unix upstreams" "$TEST_DIR/111_fastcgi_pass.conf"
+    test_failure "fastcgi_pass without port" "$TEST_DIR/112_fastcgi_pass_no_port.conf" "invalid fastcgi_pass address"
+    test_failure "Duplicate fastcgi_pass" "$TEST_DIR/113_fastcgi_pass_duplicate.conf" "duplicate fastcgi_pass directive"
+
+    # ----------------------------------------------------------
+    # CGI WORKERS
+    # ----------------------------------------------------------
+    print_subheader "CGI Workers"
+    test_success "cgi_worker with pool options" "$TEST_DIR/114_cgi_worker.conf"
+    test_failure "cgi_worker without cgi_pass" "$TEST_DIR/115_cgi_worker_no_cgi_pass.conf" "cgi_worker without cgi_pass"
+    test_failure "cgi_worker min above max" "$TEST_DIR/116_cgi_worker_min_max.conf" "cgi_worker min exceeds max"
+    test_failure "cgi_worker unknown option" "$TEST_DIR/117_cgi_worker_unknown_option.conf" "unknown cgi_worker option"
+
+    # ----------------------------------------------------------
+    # CGI CONCURRENCY
+    # ----------------------------------------------------------
+    print_subheader "CGI Concurrency"
+    test_success "cgi_max_concurrency with queue" "$TEST_DIR/118_cgi_concurrency.conf"
+    test_failure "cgi_queue_size without limit" "$TEST_DIR/119_cgi_queue_without_limit.conf" "without cgi_max_concurrency"
+    test_failure "cgi_max_concurrency of zero" "$TEST_DIR/120_cgi_concurrency_zero.conf" "invalid cgi_max_concurrency"
+
+    # ----------------------------------------------------------
+    # UPLOADS
+    # ----------------------------------------------------------
+    print_subheader "Uploads"
+    test_success "upload_io direct and splice" "$TEST_DIR/121_upload_io.conf"
+    test_failure "upload_io without upload_dir" "$TEST_DIR/122_upload_io_without_dir.conf" "without upload_dir"
+    test_failure "Unknown upload_io mode" "$TEST_DIR/123_upload_io_invalid.conf" "invalid upload_io"
+
+    # ----------------------------------------------------------
+    # AIO
+    # ----------------------------------------------------------
+    print_subheader "Aio"
+    test_success "aio threads=8" "$TEST_DIR/124_aio_threads.conf"
+    test_failure "aio threads=0" "$TEST_DIR/125_aio_invalid.conf" "invalid aio"
+    test_failure "Duplicate aio" "$TEST_DIR/126_dup_aio.conf" "duplicate aio"
+
+    # ----------------------------------------------------------
+    # PROXY
+    # ----------------------------------------------------------
+    print_subheader "Proxy"
+    test_success "proxy_pass with and without a URI" "$TEST_DIR/129_proxy_pass.conf"
+    test_failure "proxy_pass to https" "$TEST_DIR/130_proxy_pass_https.conf" "must start with http://"
+    test_failure "proxy_pass beside fastcgi_pass" "$TEST_DIR/131_proxy_pass_fastcgi.conf" "cannot share a location"
+    test_success "Upstream blocks with every policy" "$TEST_DIR/132_upstream.conf"
+    test_failure "Upstream without servers" "$TEST_DIR/133_upstream_empty.conf" "has no servers"
+    test_failure "Upstream with two balancing methods" "$TEST_DIR/134_upstream_two_policies.conf" "duplicate balancing method"
+    test_failure "Upstream hash on an unknown key" "$TEST_DIR/135_upstream_hash_key.conf" "invalid hash key"
+    test_failure "Duplicate upstream name" "$TEST_DIR/136_upstream_duplicate.conf" "duplicate upstream"
+    test_failure "health_check interval of zero" "$TEST_DIR/137_upstream_health_interval.conf" "invalid health_check interval"
+    test_success "proxy_cache with proxy_cache_valid" "$TEST_DIR/138_proxy_cache.conf"
+    test_failure "proxy_cache without proxy_cache_path" "$TEST_DIR/139_proxy_cache_no_path.conf" "without proxy_cache_path"
+    test_failure "proxy_cache without proxy_pass" "$TEST_DIR/140_proxy_cache_no_proxy.conf" "without proxy_pass"
+    test_failure "proxy_cache_path with a bad max_size" "$TEST_DIR/141_proxy_cache_path_size.conf" "invalid proxy_cache_path max_size"
+    test_failure "proxy_cache_lock without proxy_cache" "$TEST_DIR/142_proxy_cache_lock.conf" "without proxy_cache in location"
+    test_success "cgi_cache_valid with cgi_cache_vary" "$TEST_DIR/143_cgi_cache.conf"
+    test_failure "cgi_cache_valid without cgi_pass" "$TEST_DIR/144_cgi_cache_no_cgi.conf" "cgi_cache_valid without cgi_pass"
+    test_failure "cgi_cache_vary without cgi_cache_valid" "$TEST_DIR/145_cgi_cache_vary.conf" "cgi_cache_vary without cgi_cache_valid"
+    test_failure "cgi_cache_valid of zero" "$TEST_DIR/146_cgi_cache_zero.conf" "cgi_cache_valid"
 }
 
 # ============================================================
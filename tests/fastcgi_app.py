@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+# Minimal FastCGI responder used by fastcgi_tester.sh.
+# usage: fastcgi_app.py <host:port | unix:/path>
+# Echoes the request as text/plain and reports which upstream connection served
+# it, so the tester can check that webserv reuses its keep-alive connections.
+import os
+import socket
+import socketserver
+import struct
+import sys
+import threading
+
+BEGIN_REQUEST, ABORT_REQUEST, END_REQUEST, PARAMS, STDIN, STDOUT = 1, 2, 3, 4, 5, 6
+KEEP_CONN = 1
+
+counter_lock = threading.Lock()
+connection_count = [0]
+
+
+def read_exact(sock, n):
+    data = b""
+    while len(data) < n:
+        chunk = sock.recv(n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def read_record(sock):
+    header = read_exact(sock, 8)
+    if header is None:
+        return None
+    _, rtype, req_id, length, padding, _ = struct.unpack("!BBHHBB", header)
+    content = read_exact(sock, length + padding)
+    if content is None:
+        return None
+    return rtype, req_id, content[:length]
+
+
+def write_record(sock, rtype, req_id, content):
+    for i in range(0, max(len(content), 1), 65535):
+        part = content[i:i + 65535]
+        padding = (8 - len(part) % 8) % 8
+        sock.sendall(struct.pack("!BBHHBB", 1, rtype, req_id, len(part), padding, 0) + part + b"\0" * padding)
+
+
+def parse_params(data):
+    params, pos = {}, 0
+    while pos < len(data):
+        lengths = []
+        for _ in range(2):
+            if data[pos] & 0x80:
+                lengths.append(struct.unpack("!I", data[pos:pos + 4])[0] & 0x7FFFFFFF)
+                pos += 4
+            else:
+                lengths.append(data[pos])
+                pos += 1
+        name = data[pos:pos + lengths[0]].decode("latin-1")
+        pos += lengths[0]
+        params[name] = data[pos:pos + lengths[1]].decode("latin-1")
+        pos += lengths[1]
+    return params
+
+
+class Handler(socketserver.BaseRequestHandler):
+    def handle(self):
+        with counter_lock:
+            connection_count[0] += 1
+            conn_id = connection_count[0]
+        served = 0
+        while True:
+            params_data, body, keep, req_id = b"", b"", False, 0
+            while True:
+                record = read_record(self.request)
+                if record is None:
+                    return
+                rtype, req_id, content = record
+                if rtype == BEGIN_REQUEST:
+                    keep = bool(content[2] & KEEP_CONN)
+                elif rtype == PARAMS:
+                    params_data += content
+                elif rtype == STDIN:
+                    if not content:
+                        break
+                    body += content
+            params = parse_params(params_data)
+            served += 1
+            uri = params.get("REQUEST_URI", "")
+            if uri.startswith("/app/missing"):
+                out = "Status: 404 Not Found\r\nContent-Type: text/plain\r\n\r\nnot here\n"
+            else:
+                out = "Content-Type: text/plain\r\nX-Fcgi-Conn: %d\r\n\r\n" % conn_id
+                out += "method=%s\n" % params.get("REQUEST_METHOD", "")
+                out += "uri=%s\n" % uri
+                out += "query=%s\n" % params.get("QUERY_STRING", "")
+                out += "script=%s\n" % params.get("SCRIPT_FILENAME", "")
+                out += "remote=%s\n" % params.get("REMOTE_ADDR", "")
+                out += "body=%d\n" % len(body)
+                out += "conn=%d served=%d\n" % (conn_id, served)
+                if uri.startswith("/app/big"):
+                    out += "x" * 200000 + "\n"
+            write_record(self.request, STDOUT, req_id, out.encode("latin-1"))
+            write_record(self.request, STDOUT, req_id, b"")
+            write_record(self.request, END_REQUEST, req_id, struct.pack("!IB3x", 0, 0))
+            if not keep:
+                return
+
+
+class TCPServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+class UnixServer(socketserver.ThreadingUnixStreamServer):
+    daemon_threads = True
+
+
+def main():
+    address = sys.argv[1] if len(sys.argv) > 1 else "127.0.0.1:9901"
+    if address.startswith("unix:"):
+        path = address[5:]
+        if os.path.exists(path):
+            os.unlink(path)
+        server = UnixServer(path, Handler)
+    else:
+        host, port = address.rsplit(":", 1)
+        server = TCPServer((host, int(port)), Handler)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,182 @@
+#!/bin/bash
+
+# ============================================================
+# FastCGI Tester
+# Runs webserv against tests/fastcgi_app.py and checks
+# fastcgi_pass responses and upstream connection reuse
+# ============================================================
+
+WEBSERV="./webserv"
+APP="tests/fastcgi_app.py"
+TEST_DIR="fastcgi_tests"
+PORT=8090
+UPSTREAM="127.0.0.1:9901"
+UNIX_UPSTREAM="unix:/tmp/webserv_fastcgi_test.sock"
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name actual expected
+check() {
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+    if [ "$2" = "$3" ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $1"
+        PASS_COUNT=$((PASS_COUNT + 1))
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $1"
+        echo -e "   ${RED}Expected '$3', got '$2'${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+    fi
+}
+
+start_app() {
+    python3 "$APP" "$1" &
+    APP_PID=$!
+    sleep 0.5
+}
+
+stop_app() {
+    kill "$APP_PID" 2>/dev/null
+    wait "$APP_PID" 2>/dev/null
+}
+
+cleanup() {
+    stop_app
+    kill "$WEBSERV_PID" 2>/dev/null
+    wait "$WEBSERV_PID" 2>/dev/null
+}
+trap cleanup EXIT
+
+print_header "FastCGI Tester"
+
+if [ ! -f "$WEBSERV" ]; then
+    echo -e "${RED}❌ Error: $WEBSERV not found${NC}"
+    echo -e "${YELLOW}Please compile first: make${NC}"
+    exit 1
+fi
+
+mkdir -p "$TEST_DIR/www"
+CWD=$(pwd)
+cat > "$TEST_DIR/fastcgi.conf" << EOF
+http {
+    server {
+        listen 127.0.0.1:$PORT;
+        server_name localhost;
+        root $CWD/$TEST_DIR/www;
+        location / {
+            methods GET;
+            index index.html;
+        }
+        location /app {
+            methods GET POST;
+            fastcgi_pass $UPSTREAM;
+        }
+        location /sock {
+            methods GET;
+            fastcgi_pass $UNIX_UPSTREAM;
+        }
+        location /down {
+            methods GET;
+            fastcgi_pass 127.0.0.1:9;
+        }
+    }
+}
+EOF
+
+start_app "$UPSTREAM"
+$WEBSERV "$TEST_DIR/fastcgi.conf" > "$TEST_DIR/webserv.log" 2>&1 &
+WEBSERV_PID=$!
+sleep 0.5
+
+BASE="http://127.0.0.1:$PORT"
+
+# ============================================================
+# RESPONSES
+# ============================================================
+
+print_subheader "Responses"
+
+OUT=$(curl -s "$BASE/app/hello?x=1")
+check "GET method" "$(echo "$OUT" | grep '^method=')" "method=GET"
+check "GET query string" "$(echo "$OUT" | grep '^query=')" "query=x=1"
+check "SCRIPT_FILENAME under root" "$(echo "$OUT" | grep '^script=')" "script=$CWD/$TEST_DIR/www/hello"
+check "REMOTE_ADDR" "$(echo "$OUT" | grep '^remote=')" "remote=127.0.0.1"
+
+OUT=$(curl -s -X POST --data-binary "@$APP" "$BASE/app/post")
+check "POST body forwarded" "$(echo "$OUT" | grep '^body=')" "body=$(wc -c < "$APP" | tr -d ' ')"
+
+OUT=$(curl -s -X POST -H "Transfer-Encoding: chunked" --data-binary "@$APP" "$BASE/app/chunked")
+check "Chunked POST body forwarded" "$(echo "$OUT" | grep '^body=')" "body=$(wc -c < "$APP" | tr -d ' ')"
+
+check "Status header from app" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/app/missing")" "404"
+check "Large response (multiple records)" "$(curl -s "$BASE/app/big" | tail -n 1 | wc -c | tr -d ' ')" "200001"
+
+# ============================================================
+# CONNECTION REUSE
+# ============================================================
+
+print_subheader "Connection Reuse"
+
+CONNS=$(for i in 1 2 3 4 5; do curl -s "$BASE/app/seq$i" | grep '^conn='; done | cut -d' ' -f1 | sort -u | wc -l)
+check "Sequential requests share one upstream connection" "$CONNS" "1"
+
+stop_app
+start_app "$UPSTREAM"
+check "Request after app restart (stale pooled connection)" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/app/restart")" "200"
+
+# ============================================================
+# UNIX SOCKET AND FAILURES
+# ============================================================
+
+print_subheader "Unix Socket and Failures"
+
+python3 "$APP" "$UNIX_UPSTREAM" &
+UNIX_APP_PID=$!
+sleep 0.5
+check "fastcgi_pass over unix socket" "$(curl -s "$BASE/sock/x" | grep '^method=')" "method=GET"
+kill "$UNIX_APP_PID" 2>/dev/null
+wait "$UNIX_APP_PID" 2>/dev/null
+
+check "Upstream down returns 502" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/down/x")" "502"
+check "Server still serving after upstream failure" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/app/after")" "200"
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
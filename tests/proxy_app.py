@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+# Minimal HTTP/1.1 upstream used by proxy_tester.sh.
+# usage: proxy_app.py <host:port>
+# Echoes the request as text/plain and reports which upstream server and
+# connection served it, so the tester can check load balancing and that webserv
+# reuses its keep-alive connections. The last path segment picks other kinds of
+# response: chunked, close-delimited, slow, big, missing, cookies. health answers
+# 200, or 503 between a sick and a well request. fresh, short, swr, vary, nostore
+# and plain carry caching headers and count how often each URL was asked for;
+# lazy and lazynostore are as slow to answer as a regenerated page.
+import socketserver
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler
+
+counter_lock = threading.Lock()
+connection_count = [0]
+sick = [False]
+hits = {}
+
+CACHING = {
+    "fresh": "max-age=60",
+    "short": "max-age=1",
+    "swr": "max-age=1, stale-while-revalidate=30",
+    "vary": "max-age=60",
+    "nostore": "no-store",
+    "plain": None,
+    "lazy": "max-age=60",
+    "lazynostore": "no-store",
+}
+
+BIG = bytes(range(256)) * 12000
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def setup(self):
+        BaseHTTPRequestHandler.setup(self)
+        with counter_lock:
+            connection_count[0] += 1
+            self.conn_id = connection_count[0]
+        self.served = 0
+
+    def log_message(self, *args):
+        pass
+
+    def send_body(self, body, content_type="text/plain"):
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if self.command != "HEAD":
+            self.wfile.write(body)
+
+    def handle_any(self):
+        self.served += 1
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length) if length else b""
+        name = self.path.split("?")[0].rsplit("/", 1)[-1]
+
+        if name == "chunked":
+            self.send_response(200)
+            self.send_header("Content-Type", "text/plain")
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            for i in range(50):
+                part = ("line %d\n" % i).encode()
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(part), part))
+            self.wfile.write(b"0\r\n\r\n")
+        elif name == "close":
+            self.send_response(200)
+            self.send_header("Content-Type", "text/plain")
+            self.send_header("Connection", "close")
+            self.end_headers()
+            self.wfile.write(b"until close\n" * 1000)
+            self.close_connection = True
+        elif name == "slow":
+            self.send_response(200)
+            self.send_header("Content-Type", "text/plain")
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            self.wfile.write(b"6\r\nfirst\n\r\n")
+            self.wfile.flush()
+            time.sleep(1.5)
+            self.wfile.write(b"5\r\nlast\n\r\n0\r\n\r\n")
+        elif name == "big":
+            self.send_response(200)
+            self.send_body(BIG, "application/octet-stream")
+        elif name == "missing":
+            self.send_response(404)
+            self.send_body(b"not here\n")
+        elif name == "health":
+            self.send_response(503 if sick[0] else 200)
+            self.send_body(b"sick\n" if sick[0] else b"ok\n")
+        elif name in ("sick", "well"):
+            sick[0] = (name == "sick")
+            self.send_response(200)
+            self.send_body(name.encode() + b"\n")
+        elif name in CACHING:
+            with counter_lock:
+                hits[self.path] = hits.get(self.path, 0) + 1
+                count = hits[self.path]
+            # a refresh of swr is slow, so stale copies get served meanwhile
+            if name == "swr" and count > 1:
+                time.sleep(1.5)
+            if name.startswith("lazy"):
+                time.sleep(1)
+            self.send_response(200)
+            if CACHING[name]:
+                self.send_header("Cache-Control", CACHING[name])
+            if name == "vary":
+                self.send_header("Vary", "Accept-Language")
+            lang = self.headers.get("Accept-Language", "")
+            self.send_body(("lang=%s count=%d\n" % (lang, count)).encode())
+        elif name == "cookies":
+            self.send_response(200)
+            self.send_header("Set-Cookie", "a=1")
+            self.send_header("Set-Cookie", "b=2")
+            self.send_body(b"cookies\n")
+        else:
+            out = "method=%s\n" % self.command
+            out += "path=%s\n" % self.path
+            out += "host=%s\n" % self.headers.get("Host", "")
+            out += "forwarded=%s\n" % self.headers.get("X-Forwarded-For", "")
+            out += "connection=%s\n" % self.headers.get("Connection", "")
+            out += "body=%d\n" % len(body)
+            out += "server=%d\n" % self.server.server_address[1]
+            out += "conn=%d served=%d\n" % (self.conn_id, self.served)
+            self.send_response(200)
+            self.send_header("X-Upstream-Conn", str(self.conn_id))
+            self.send_body(out.encode("latin-1"))
+
+    do_GET = do_POST = do_PUT = do_DELETE = do_HEAD = handle_any
+
+
+class TCPServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+def main():
+    address = sys.argv[1] if len(sys.argv) > 1 else "127.0.0.1:9902"
+    host, port = address.rsplit(":", 1)
+    TCPServer((host, int(port)), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,420 @@
+#!/bin/bash
+
+# ============================================================
+# Proxy Tester
+# Runs webserv against tests/proxy_app.py and checks
+# proxy_pass responses, streaming, upstream connection reuse,
+# upstream blocks (balancing, passive and active health) and
+# proxy_cache
+# ============================================================
+
+WEBSERV="./webserv"
+APP="tests/proxy_app.py"
+TEST_DIR="proxy_tests"
+PORT=8096
+UPSTREAM="127.0.0.1:9902"
+BACKENDS="9911 9912 9913"
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name actual expected
+check() {
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+    if [ "$2" = "$3" ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $1"
+        PASS_COUNT=$((PASS_COUNT + 1))
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $1"
+        echo -e "   ${RED}Expected '$3', got '$2'${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+    fi
+}
+
+start_app() {
+    python3 "$APP" "$1" &
+    APP_PID=$!
+    sleep 0.5
+}
+
+stop_app() {
+    kill "$APP_PID" 2>/dev/null
+    wait "$APP_PID" 2>/dev/null
+}
+
+# Args: port; the upstream block servers, one process each
+start_backend() {
+    python3 "$APP" "127.0.0.1:$1" &
+    BACKEND_PIDS[$1]=$!
+}
+
+stop_backend() {
+    kill "${BACKEND_PIDS[$1]}" 2>/dev/null
+    wait "${BACKEND_PIDS[$1]}" 2>/dev/null
+}
+
+cleanup() {
+    stop_app
+    for port in $BACKENDS; do stop_backend "$port"; done
+    kill "$WEBSERV_PID" 2>/dev/null
+    wait "$WEBSERV_PID" 2>/dev/null
+}
+trap cleanup EXIT
+
+# Args: count url [curl args]; prints the distinct servers that answered, in order of first use
+servers_used() {
+    local count="$1" url="$2"
+    shift 2
+    for i in $(seq "$count"); do echo_line server "$@" "$url"; done | awk '!seen[$0]++' | tr '\n' ' '
+}
+
+# Args: curl args; prints the X-Cache-Status and the body, on one line
+cached() {
+    local headers="$TEST_DIR/headers.$BASHPID"
+    curl -s -D "$headers" "$@" | tr -d '\n'
+    echo " $(tr -d '\r' < "$headers" | awk -F': ' 'tolower($1) == "x-cache-status" {print $2}')"
+}
+
+# Args: curl args; prints the given line of the echoed request
+echo_line() {
+    local key="$1"
+    shift
+    curl -s "$@" | grep "^$key=" | cut -d= -f2-
+}
+
+print_header "Proxy Tester"
+
+if [ ! -f "$WEBSERV" ]; then
+    echo -e "${RED}❌ Error: $WEBSERV not found${NC}"
+    echo -e "${YELLOW}Please compile first: make${NC}"
+    exit 1
+fi
+
+rm -rf "$TEST_DIR"
+mkdir -p "$TEST_DIR/www"
+CWD=$(pwd)
+echo "local page" > "$TEST_DIR/www/index.html"
+python3 -c 'import sys; sys.stdout.buffer.write(bytes(range(256)) * 12000)' > "$TEST_DIR/big.expected"
+head -c 300000 /dev/urandom > "$TEST_DIR/post.bin"
+cat > "$TEST_DIR/proxy.conf" << EOF
+http {
+    proxy_cache_path $CWD/$TEST_DIR/cache max_size=4m;
+    upstream rr {
+        server 127.0.0.1:9911;
+        server 127.0.0.1:9912;
+        server 127.0.0.1:9913;
+    }
+    upstream lc {
+        least_conn;
+        server 127.0.0.1:9911;
+        server 127.0.0.1:9912;
+    }
+    upstream byuri {
+        hash \$request_uri;
+        server 127.0.0.1:9911;
+        server 127.0.0.1:9912;
+        server 127.0.0.1:9913;
+    }
+    upstream bycookie {
+        hash \$cookie_sid;
+        server 127.0.0.1:9911;
+        server 127.0.0.1:9912;
+        server 127.0.0.1:9913;
+    }
+    upstream dead {
+        server 127.0.0.1:9914 fail_timeout=60;
+        server 127.0.0.1:9911;
+    }
+    upstream gone {
+        server 127.0.0.1:9914;
+        server 127.0.0.1:9915;
+    }
+    upstream checked {
+        server 127.0.0.1:9911;
+        server 127.0.0.1:9912;
+        health_check interval=1 uri=/health;
+    }
+    server {
+        listen 127.0.0.1:$PORT;
+        server_name localhost;
+        root $CWD/$TEST_DIR/www;
+        client_max_body_size 1M;
+        location / {
+            methods GET;
+            index index.html;
+        }
+        location /api/ {
+            methods GET POST HEAD;
+            proxy_pass http://$UPSTREAM/;
+        }
+        location /raw {
+            methods GET POST;
+            proxy_pass http://$UPSTREAM;
+        }
+        location /down {
+            methods GET;
+            proxy_pass http://127.0.0.1:9;
+        }
+        location /rr/ {
+            proxy_pass http://rr/;
+        }
+        location /lc/ {
+            proxy_pass http://lc/;
+        }
+        location /uri/ {
+            proxy_pass http://byuri/;
+        }
+        location /cookie/ {
+            proxy_pass http://bycookie/;
+        }
+        location /dead/ {
+            proxy_pass http://dead/;
+        }
+        location /gone/ {
+            proxy_pass http://gone/;
+        }
+        location /checked/ {
+            proxy_pass http://checked/;
+        }
+        location /cache/ {
+            methods GET HEAD;
+            proxy_pass http://127.0.0.1:9911/;
+            proxy_cache on;
+            proxy_cache_valid 30;
+        }
+        location /lock/ {
+            methods GET HEAD;
+            proxy_pass http://127.0.0.1:9911/;
+            proxy_cache on;
+            proxy_cache_lock on;
+        }
+    }
+}
+EOF
+
+start_app "$UPSTREAM"
+for port in $BACKENDS; do start_backend "$port"; done
+sleep 0.5
+$WEBSERV "$TEST_DIR/proxy.conf" > "$TEST_DIR/webserv.log" 2>&1 &
+WEBSERV_PID=$!
+sleep 0.5
+
+BASE="http://127.0.0.1:$PORT"
+
+# ============================================================
+# REQUESTS
+# ============================================================
+
+print_subheader "Requests"
+
+check "Local location still served" "$(curl -s "$BASE/")" "local page"
+check "URI in proxy_pass replaces the prefix" "$(echo_line path "$BASE/api/echo?a=1")" "/echo?a=1"
+check "Without a URI the path goes as sent" "$(echo_line path "$BASE/raw/echo?q=%26x%20y")" "/raw/echo?q=%26x%20y"
+check "Host header forwarded" "$(echo_line host "$BASE/api/echo")" "127.0.0.1:$PORT"
+check "X-Forwarded-For carries the client" "$(echo_line forwarded -H 'X-Forwarded-For: 10.0.0.1' "$BASE/api/echo")" "10.0.0.1, 127.0.0.1"
+check "Client Connection header not forwarded" "$(echo_line connection -H 'Connection: keep-alive' "$BASE/api/echo")" ""
+check "POST body reaches the upstream" "$(echo_line body --data-binary "@$TEST_DIR/post.bin" "$BASE/api/echo")" "300000"
+check "Chunked request body sent with a length" "$(echo_line body -H 'Transfer-Encoding: chunked' --data-binary "@$TEST_DIR/post.bin" "$BASE/api/echo")" "300000"
+OUT=$(python3 - "$PORT" <<'EOF'
+import socket, sys
+s = socket.create_connection(("127.0.0.1", int(sys.argv[1])))
+s.settimeout(5)
+s.sendall(b"POST /api/echo HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+          b"5\r\nhello\r\n0\r\n\r\n"
+          b"GET /api/echo/next HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n")
+data = b""
+try:
+    while True:
+        chunk = s.recv(65536)
+        if not chunk:
+            break
+        data += chunk
+except socket.timeout:
+    pass
+print(" ".join(l.decode() for l in data.split(b"\n") if l.startswith((b"body=", b"path="))))
+EOF
+)
+check "Request pipelined behind a chunked body answered" "$OUT" "path=/echo body=5 path=/echo/next body=0"
+check "Upstream status passed through" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/api/missing")" "404"
+check "Every Set-Cookie kept" "$(curl -s -D - -o /dev/null "$BASE/api/cookies" | grep -ci '^set-cookie')" "2"
+check "HEAD keeps Content-Length" "$(curl -s -I "$BASE/api/big" | tr -d '\r' | awk -F': ' 'tolower($1) == "content-length" {print $2}')" "3072000"
+
+# ============================================================
+# RESPONSE BODIES
+# ============================================================
+
+print_subheader "Response Bodies"
+
+curl -s -o "$TEST_DIR/big.out" "$BASE/api/big"
+check "Large body intact" "$(cmp -s "$TEST_DIR/big.out" "$TEST_DIR/big.expected" && echo same)" "same"
+curl -s --limit-rate 2M -o "$TEST_DIR/slow.out" "$BASE/api/big"
+check "Slow reader gets the whole body" "$(cmp -s "$TEST_DIR/slow.out" "$TEST_DIR/big.expected" && echo same)" "same"
+check "Chunked upstream body reassembled" "$(curl -s "$BASE/api/chunked" | tail -1)" "line 49"
+check "Close-delimited upstream body complete" "$(curl -s "$BASE/api/close" | wc -l)" "1000"
+OUT=$(curl -s -o /dev/null -o /dev/null -w '%{http_code}/%{num_connects} ' "$BASE/api/close" "$BASE/api/chunked")
+check "Client connection kept after unsized bodies" "$OUT" "200/1 200/0 "
+check "HTTP/1.0 client gets a close-delimited body" "$(curl -s -0 "$BASE/api/chunked" | tail -1)" "line 49"
+OUT=$(curl -s -o /dev/null -w '%{time_starttransfer} %{time_total}' "$BASE/api/slow")
+check "Response streamed before the upstream finishes" "$(echo "$OUT" | awk '{print ($1 < 1.0 && $2 > 1.4) ? "streamed" : "buffered"}')" "streamed"
+
+# ============================================================
+# UPSTREAM CONNECTIONS
+# ============================================================
+
+print_subheader "Upstream Connections"
+
+FIRST=$(echo_line conn "$BASE/api/echo" | cut -d' ' -f1)
+for i in 1 2 3 4; do curl -s -o /dev/null "$BASE/api/echo"; done
+LAST=$(echo_line conn "$BASE/api/echo" | cut -d' ' -f1)
+check "Sequential requests reuse one upstream connection" "$LAST" "$FIRST"
+
+stop_app
+start_app "$UPSTREAM"
+check "Pooled connections to a restarted upstream are replaced" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/api/echo")" "200"
+OK=$(seq 100 | xargs -P 20 -I{} curl -s -o /dev/null -w '%{http_code}\n' "$BASE/api/echo" | grep -c '^200$')
+check "100 concurrent requests all answered" "$OK" "100"
+check "Unreachable upstream returns 502" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/down")" "502"
+
+stop_app
+check "Stopped upstream returns 502" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/api/echo")" "502"
+check "Server still running" "$(kill -0 "$WEBSERV_PID" 2>/dev/null && echo up)" "up"
+
+# ============================================================
+# UPSTREAM BLOCKS
+# ============================================================
+
+print_subheader "Upstream Blocks"
+
+check "Round-robin visits every server in turn" "$(servers_used 6 "$BASE/rr/echo")" "9911 9912 9913 "
+curl -s -o /dev/null "$BASE/lc/slow" &
+sleep 0.3
+check "Least-connections avoids the busy server" "$(servers_used 4 "$BASE/lc/echo" | wc -w)" "1"
+wait $!
+check "URI hash sends one URI to one server" "$(servers_used 5 "$BASE/uri/echo/a")" "$(echo_line server "$BASE/uri/echo/a") "
+SPREAD=$(for i in $(seq 30); do echo_line server "$BASE/uri/echo/$i"; done | sort -u | wc -l)
+check "URI hash spreads URIs over the servers" "$SPREAD" "3"
+check "Cookie hash keeps a session on one server" "$(servers_used 5 "$BASE/cookie/echo" -b sid=alice)" "$(echo_line server -b sid=alice "$BASE/cookie/echo") "
+SPREAD=$(for i in $(seq 30); do echo_line server -b "sid=user$i" "$BASE/cookie/echo"; done | sort -u | wc -l)
+check "Cookie hash spreads sessions over the servers" "$SPREAD" "3"
+
+for i in $(seq 30); do echo "$i $(echo_line server "$BASE/uri/echo/$i")"; done > "$TEST_DIR/ring.before"
+stop_backend 9913
+for i in $(seq 30); do echo "$i $(echo_line server "$BASE/uri/echo/$i")"; done > "$TEST_DIR/ring.after"
+check "Keys of a stopped server move, and only those" "$(grep -v ' 9913$' "$TEST_DIR/ring.before" | diff - <(grep -Fxf "$TEST_DIR/ring.before" "$TEST_DIR/ring.after") && echo same)" "same"
+check "Keys of a stopped server still answered" "$(grep -c ' 99' "$TEST_DIR/ring.after")" "30"
+start_backend 9913
+
+OK=$(for i in $(seq 6); do curl -s -o /dev/null -w '%{http_code}\n' "$BASE/dead/echo"; done | grep -c '^200$')
+check "Failed server skipped, request retried on the next" "$OK" "6"
+check "Failed server marked down once" "$(grep -c '9914 marked down' "$TEST_DIR/webserv.log")" "1"
+check "No live server returns 502" "$(curl -s -o /dev/null -w '%{http_code}' "$BASE/gone/echo")" "502"
+
+LOG_LINES=$(wc -l < "$TEST_DIR/webserv.log")
+curl -s -o /dev/null http://127.0.0.1:9912/sick
+sleep 2.5
+check "Failing health checks take a server out" "$(servers_used 6 "$BASE/checked/echo")" "9911 "
+curl -s -o /dev/null http://127.0.0.1:9912/well
+sleep 2.5
+check "Passing health checks put it back" "$(servers_used 6 "$BASE/checked/echo" | wc -w)" "2"
+check "Health check transitions logged" "$(tail -n +$((LOG_LINES + 1)) "$TEST_DIR/webserv.log" | grep -c 'health checks')" "2"
+
+# ============================================================
+# PROXY CACHE
+# ============================================================
+
+print_subheader "Proxy Cache"
+
+check "First request is a miss" "$(cached "$BASE/cache/fresh")" "lang= count=1 MISS"
+check "Second request is a hit" "$(cached "$BASE/cache/fresh")" "lang= count=1 HIT"
+check "Hit carries an Age" "$(curl -s -D - -o /dev/null "$BASE/cache/fresh" | grep -ci '^age: ')" "1"
+check "HEAD answered from the GET entry" "$(curl -s -I "$BASE/cache/fresh" | tr -d '\r' | grep -i '^x-cache-status')" "X-Cache-Status: HIT"
+check "Query string is part of the key" "$(cached "$BASE/cache/fresh?page=2")" "lang= count=1 MISS"
+check "Host is part of the key" "$(cached -H 'Host: other' "$BASE/cache/fresh")" "lang= count=2 MISS"
+cached "$BASE/cache/nostore" > /dev/null
+check "no-store responses not kept" "$(cached "$BASE/cache/nostore")" "lang= count=2 MISS"
+cached -H 'Authorization: Basic eDp5' "$BASE/cache/fresh?auth" > /dev/null
+check "Requests with credentials bypass the cache" "$(cached -H 'Authorization: Basic eDp5' "$BASE/cache/fresh?auth")" "lang= count=2 "
+cached "$BASE/cache/plain" > /dev/null
+check "proxy_cache_valid keeps a response without freshness" "$(cached "$BASE/cache/plain")" "lang= count=1 HIT"
+
+cached -H 'Accept-Language: en' "$BASE/cache/vary" > /dev/null
+check "Vary: another value is another entry" "$(cached -H 'Accept-Language: fr' "$BASE/cache/vary")" "lang=fr count=2 MISS"
+check "Vary: each value hits its own entry" "$(cached -H 'Accept-Language: en' "$BASE/cache/vary")" "lang=en count=1 HIT"
+
+cached "$BASE/cache/short" > /dev/null
+sleep 1.2
+check "Expired entry refreshed from the upstream" "$(cached "$BASE/cache/short")" "lang= count=2 EXPIRED"
+
+cached "$BASE/cache/swr" > /dev/null
+sleep 1.2
+cached "$BASE/cache/swr" > "$TEST_DIR/swr.out" &
+sleep 0.3
+OUT=$(curl -s -o /dev/null -w '%{time_total}' "$BASE/cache/swr")
+check "Stale copy served while another request refreshes" "$(cached "$BASE/cache/swr")" "lang= count=1 STALE"
+check "Stale copy served without waiting" "$(echo "$OUT" | awk '{print ($1 < 0.5) ? "fast" : "slow"}')" "fast"
+wait $!
+check "The refreshing request gets the new response" "$(cat "$TEST_DIR/swr.out")" "lang= count=2 EXPIRED"
+
+curl -s -o /dev/null "$BASE/cache/big?1"
+curl -s -o /dev/null "$BASE/cache/big?2"
+check "Least recently used entry evicted beyond max_size" "$(cached -o /dev/null "$BASE/cache/big?1")" " MISS"
+curl -s -D "$TEST_DIR/headers" -o "$TEST_DIR/cached.out" "$BASE/cache/big?1"
+check "Cached body intact" "$(cmp -s "$TEST_DIR/cached.out" "$TEST_DIR/big.expected" && grep -c 'HIT' "$TEST_DIR/headers")" "1"
+check "Bodies stored under proxy_cache_path" "$(ls "$TEST_DIR/cache" | grep -c '^webserv-cache-')" "$(ls "$TEST_DIR/cache" | wc -l)"
+
+# Args: count url; prints the distinct bodies of count concurrent requests
+concurrent() {
+    seq "$1" | xargs -P "$1" -I{} curl -s "$2" | sort -u | tr '\n' ' '
+}
+
+check "Without proxy_cache_lock every miss reaches the upstream" "$(concurrent 5 "$BASE/cache/lazy" | wc -w)" "10"
+check "With proxy_cache_lock one miss fetches for all" "$(concurrent 5 "$BASE/lock/lazy?lock")" "lang= count=1 "
+check "Waiters answered from the cache" "$(seq 5 | xargs -P 5 -I{} curl -s -D - -o /dev/null "$BASE/lock/lazy?h" | tr -d '\r' | grep -i '^x-cache-status' | sort | uniq -c | awk '{print $1 $3}' | tr '\n' ' ')" "4HIT 1MISS "
+OUT=$(seq 3 | xargs -P 3 -I{} curl -s -o /dev/null -w '%{http_code}\n' "$BASE/lock/lazynostore" | grep -c '^200$')
+check "Uncacheable response releases the waiters" "$OUT" "3"
+curl -s -o /dev/null "$BASE/lock/lazynostore?t" &
+sleep 0.2
+OUT=$(seq 3 | xargs -P 3 -I{} curl -s -o /dev/null -w '%{time_total}\n' "$BASE/lock/lazynostore?t" | sort -n | tail -1)
+wait $!
+check "Released waiters fetch at once, not in turn" "$(echo "$OUT" | awk '{print ($1 < 2.5) ? "parallel" : "serial"}')" "parallel"
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
@@ -246,6 +246,11 @@ run_test "Zero content length" \
 $'POST / HTTP/1.1\r\nHost: localhost:8080\r\nContent-Length: 0\r\n\r\n' \
 "true" "POST" "/" "localhost" "8080"
 
+# Test 19: IPv6 literal host
+run_test "IPv6 literal host" \
+$'GET / HTTP/1.1\r\nHost: [::1]:8080\r\n\r\n' \
+"true" "GET" "/" "[::1]" "8080"
+
 # ============================================================
 # SUMMARY
 # ============================================================
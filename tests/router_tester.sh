@@ -289,6 +289,23 @@ REQUEST=$'GET / HTTP/1.1\r\nHost: site2.com:8080\r\n\r\n'
 
 run_test "Select by server_name site2.com" "$CONFIG" "$REQUEST" "200" "/" "site2.com"
 
+# Test 4b: Unix socket listener matches any Host port
+CONFIG="http {
+    server {
+        listen unix:/tmp/webserv_router_test.sock;
+        server_name site1.com;
+        root $CWD/$TEST_DIR/www/site1;
+        location / {
+            methods GET;
+            index index.html;
+        }
+    }
+}"
+
+REQUEST=$'GET / HTTP/1.1\r\nHost: site1.com\r\n\r\n'
+
+run_test "Unix socket listener" "$CONFIG" "$REQUEST" "200" "/" "site1.com"
+
 # ============================================================
 # LOCATION MATCHING TESTS
 # ============================================================
@@ -0,0 +1,144 @@
+#include <csignal>
+#include <iostream>
+#include "../src/utils/SessionManager.hpp"
+volatile sig_atomic_t g_running = 1;
+
+// Creates count sessions, returning their ids in creation order
+VectorString createSessions(SessionManager& manager, size_t count, const String& userId) {
+    VectorString ids;
+    for (size_t i = 0; i < count; ++i)
+        ids.push_back(manager.createSession(userId));
+    return ids;
+}
+
+// Counts the ids that resolve to their own session
+size_t countFound(SessionManager& manager, const VectorString& ids) {
+    size_t found = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        SessionResult* session = manager.getSession(ids[i]);
+        if (session && session->sessionId == ids[i])
+            ++found;
+    }
+    return found;
+}
+
+const char* boolString(bool value) {
+    return value ? "true" : "false";
+}
+
+void testInsert(SessionManager& manager) {
+    VectorString   ids     = createSessions(manager, 3, "alice");
+    SessionResult* session = manager.getSession(ids[1]);
+
+    std::cout << "count=" << manager.getSessionCount() << std::endl;
+    std::cout << "found=" << countFound(manager, ids) << std::endl;
+    std::cout << "userId=" << (session ? session->userId : "") << std::endl;
+    std::cout << "idLength=" << ids[0].size() << std::endl;
+    std::cout << "unknownValid=" << boolString(manager.isValid(String(SESSION_ID_LENGTH, '0'))) << std::endl;
+    std::cout << "shortValid=" << boolString(manager.isValid("abc")) << std::endl;
+    std::cout << "upperValid=" << boolString(manager.isValid(String(SESSION_ID_LENGTH, 'A'))) << std::endl;
+}
+
+// The table starts at SESSION_TABLE_MIN_SIZE slots and doubles several times;
+// sessions must stay reachable by id, and at the same address
+void testRehash(SessionManager& manager) {
+    String         first   = manager.createSession("alice");
+    SessionResult* session = manager.getSession(first);
+    session->setData("theme", "dark");
+    VectorString ids = createSessions(manager, SESSION_TABLE_MIN_SIZE * 16, "bob");
+    ids.push_back(first);
+
+    std::cout << "count=" << manager.getSessionCount() << std::endl;
+    std::cout << "found=" << countFound(manager, ids) << std::endl;
+    std::cout << "data=" << manager.getSession(first)->getData("theme") << std::endl;
+    std::cout << "pointerStable=" << boolString(manager.getSession(first) == session) << std::endl;
+}
+
+// Every other session is removed, leaving deleted slots inside probe chains
+// that later lookups and inserts have to walk past and reuse
+void testErase(SessionManager& manager) {
+    VectorString ids = createSessions(manager, 1000, "alice");
+    VectorString kept;
+    size_t       removed = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i % 2 == 0 && manager.removeSession(ids[i]))
+            ++removed;
+        else if (i % 2 != 0)
+            kept.push_back(ids[i]);
+    }
+    size_t stillValid = 0;
+    for (size_t i = 0; i < ids.size(); i += 2)
+        if (manager.isValid(ids[i]))
+            ++stillValid;
+
+    std::cout << "removed=" << removed << std::endl;
+    std::cout << "removedValid=" << stillValid << std::endl;
+    std::cout << "removeAgain=" << boolString(manager.removeSession(ids[0])) << std::endl;
+    std::cout << "keptFound=" << countFound(manager, kept) << std::endl;
+
+    VectorString added = createSessions(manager, 1000, "bob");
+    std::cout << "count=" << manager.getSessionCount() << std::endl;
+    std::cout << "addedFound=" << countFound(manager, added) << std::endl;
+    std::cout << "keptFoundAfterInsert=" << countFound(manager, kept) << std::endl;
+}
+
+void testRegenerate(SessionManager& manager) {
+    String oldId = manager.createSession("alice");
+    manager.createSession("bob");
+    manager.getSession(oldId)->setData("cart", "3");
+    String         newId   = manager.regenerateId(oldId);
+    SessionResult* session = manager.getSession(newId);
+
+    std::cout << "changed=" << boolString(!newId.empty() && newId != oldId) << std::endl;
+    std::cout << "oldValid=" << boolString(manager.isValid(oldId)) << std::endl;
+    std::cout << "newValid=" << boolString(manager.isValid(newId)) << std::endl;
+    std::cout << "userId=" << (session ? session->userId : "") << std::endl;
+    std::cout << "data=" << (session ? session->getData("cart") : "") << std::endl;
+    std::cout << "count=" << manager.getSessionCount() << std::endl;
+    std::cout << "unknown=" << manager.regenerateId(String(SESSION_ID_LENGTH, '0')) << std::endl;
+}
+
+// A timeout of -1 makes every queued entry due, so each call reclaims at most
+// SESSION_CLEANUP_BATCH sessions. One session's activity is moved ahead of
+// its queued entry: it must be queued again, not dropped.
+void testExpiry(SessionManager& manager) {
+    String       active = manager.createSession("alice");
+    VectorString ids    = createSessions(manager, SESSION_CLEANUP_BATCH * 2 + 10, "bob");
+    manager.getSession(active)->lastActivity = getCurrentTime() + 3600;
+
+    manager.cleanupExpiredSessions(SESSION_TIMEOUT);
+    std::cout << "afterNothingDue=" << manager.getSessionCount() << std::endl;
+    manager.cleanupExpiredSessions(-1);
+    std::cout << "afterFirstBatch=" << manager.getSessionCount() << std::endl;
+    manager.cleanupExpiredSessions(-1);
+    std::cout << "afterSecondBatch=" << manager.getSessionCount() << std::endl;
+    manager.cleanupExpiredSessions(-1);
+    std::cout << "afterThirdBatch=" << manager.getSessionCount() << std::endl;
+    std::cout << "activeValid=" << boolString(manager.isValid(active)) << std::endl;
+    std::cout << "expiredFound=" << countFound(manager, ids) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <insert|rehash|erase|regenerate|expiry>" << std::endl;
+        return 1;
+    }
+
+    String         test = argv[1];
+    SessionManager manager;
+    if (test == "insert")
+        testInsert(manager);
+    else if (test == "rehash")
+        testRehash(manager);
+    else if (test == "erase")
+        testErase(manager);
+    else if (test == "regenerate")
+        testRegenerate(manager);
+    else if (test == "expiry")
+        testExpiry(manager);
+    else {
+        std::cout << "ERROR|Unknown test: " << test << std::endl;
+        return 1;
+    }
+    return 0;
+}
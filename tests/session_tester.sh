@@ -0,0 +1,146 @@
+#!/bin/bash
+
+# ============================================================
+# Session Tester
+# Tests SessionManager's table and expiry queue
+# ============================================================
+
+TESTER="./session_tester"
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name scenario key=value...
+run_test() {
+    local test_name="$1"
+    local scenario="$2"
+    shift 2
+
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+
+    output=$($TESTER "$scenario" 2>&1)
+
+    if echo "$output" | grep -q "^ERROR|"; then
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $test_name"
+        echo -e "   ${RED}$(echo "$output" | grep "^ERROR|" | cut -d'|' -f2)${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+        return 1
+    fi
+
+    local passed=true
+    local errors=""
+    local expected key actual
+    for expected in "$@"; do
+        key="${expected%%=*}"
+        actual=$(echo "$output" | grep "^$key=" | cut -d'=' -f2-)
+        if [ "$key=$actual" != "$expected" ]; then
+            passed=false
+            errors="${errors}   Expected $expected, got $key=$actual\n"
+        fi
+    done
+
+    if [ "$passed" = true ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $test_name"
+        PASS_COUNT=$((PASS_COUNT + 1))
+        return 0
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $test_name"
+        echo -e "${RED}${errors}${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+        return 1
+    fi
+}
+
+# ============================================================
+# Check if tester binary exists
+# ============================================================
+
+print_header "Session Tester"
+
+if [ ! -f "$TESTER" ]; then
+    echo -e "${RED}❌ Error: $TESTER not found${NC}"
+    echo -e "${YELLOW}Please compile first: make session_tester${NC}"
+    exit 1
+fi
+
+# ============================================================
+# TABLE TESTS
+# ============================================================
+
+print_subheader "Table Tests"
+
+run_test "Insert and look up" insert \
+    "count=3" "found=3" "userId=alice" "idLength=32"
+
+run_test "Malformed and unknown ids are invalid" insert \
+    "unknownValid=false" "shortValid=false" "upperValid=false"
+
+run_test "Lookup after rehash" rehash \
+    "count=1025" "found=1025" "data=dark" "pointerStable=true"
+
+run_test "Erase leaves removed ids invalid" erase \
+    "removed=500" "removedValid=0" "removeAgain=false" "keptFound=500"
+
+run_test "Insert and lookup past tombstones" erase \
+    "count=1500" "addedFound=1000" "keptFoundAfterInsert=500"
+
+run_test "Regenerate keeps the session under a new id" regenerate \
+    "changed=true" "oldValid=false" "newValid=true" "userId=alice" "data=3" "count=2" "unknown="
+
+# ============================================================
+# EXPIRY TESTS
+# ============================================================
+
+print_subheader "Expiry Tests"
+
+# 2059 sessions, SESSION_CLEANUP_BATCH (1024) entries looked at per call; the
+# first call also spends one on the session that is still active
+run_test "Nothing due, nothing reclaimed" expiry \
+    "afterNothingDue=2059"
+
+run_test "Cleanup batches across SESSION_CLEANUP_BATCH" expiry \
+    "afterFirstBatch=1036" "afterSecondBatch=12" "afterThirdBatch=1" "expiredFound=0"
+
+run_test "Active session is queued again, not dropped" expiry \
+    "activeValid=true"
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
@@ -0,0 +1,252 @@
+#!/bin/bash
+
+# ============================================================
+# Upload Tester
+# Runs webserv with upload locations and checks that multipart
+# and raw bodies are written to disk as they arrive, without
+# buffering the body in memory, for every upload_io mode
+# ============================================================
+
+WEBSERV="./webserv"
+PYTHON="/usr/bin/python3"
+TEST_DIR="upload_tests"
+PORT=8093
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PASS_COUNT=0
+FAIL_COUNT=0
+TOTAL_COUNT=0
+
+print_header() {
+    echo ""
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+    echo -e "${BLUE}  $1${NC}"
+    echo -e "${BLUE}═══════════════════════════════════════════════════════════${NC}"
+}
+
+print_subheader() {
+    echo ""
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+    echo -e "${YELLOW}  $1${NC}"
+    echo -e "${YELLOW}──────────────────────────────────────────────────────────${NC}"
+}
+
+# Args: test_name actual expected
+check() {
+    TOTAL_COUNT=$((TOTAL_COUNT + 1))
+    if [ "$2" = "$3" ]; then
+        echo -e "${GREEN}✅ PASS${NC} [$TOTAL_COUNT] $1"
+        PASS_COUNT=$((PASS_COUNT + 1))
+    else
+        echo -e "${RED}❌ FAIL${NC} [$TOTAL_COUNT] $1"
+        echo -e "   ${RED}Expected '$3', got '$2'${NC}"
+        FAIL_COUNT=$((FAIL_COUNT + 1))
+    fi
+}
+
+# Bytes the main thread moved through read()-like calls; splice() is not
+# counted
+read_bytes() {
+    awk '/^rchar/ {print $2}' "/proc/$WEBSERV_PID/task/$WEBSERV_PID/io"
+}
+
+rss_kb() {
+    awk '/^VmRSS/ {print $2}' "/proc/$WEBSERV_PID/status"
+}
+
+# Args: file; prints "same" when the upload matches its source
+same_as() {
+    cmp -s "$1" "$STORE/$(basename "$1")" && echo same
+}
+
+temp_files() {
+    ls -A "$STORE" | grep -c '^\.upload_'
+}
+
+# Args: piece size, then the multipart body on stdin; sends the request in
+# small pieces with pauses in between and prints the status line
+send_slowly() {
+    $PYTHON -c '
+import socket, sys, time
+body = sys.stdin.buffer.read()
+s = socket.create_connection(("127.0.0.1", int(sys.argv[1])))
+s.sendall(b"POST /upload HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n"
+          b"Content-Type: multipart/form-data; boundary=XyZ\r\n"
+          b"Content-Length: %d\r\n\r\n" % len(body))
+step = int(sys.argv[2])
+for i in range(0, len(body), step):
+    s.sendall(body[i:i + step])
+    time.sleep(0.002)
+print(s.makefile("rb").readline().decode().strip())
+' "$PORT" "$1"
+}
+
+cleanup() {
+    kill "$WEBSERV_PID" 2>/dev/null
+    wait "$WEBSERV_PID" 2>/dev/null
+}
+trap cleanup EXIT
+
+print_header "Upload Tester"
+
+if [ ! -f "$WEBSERV" ]; then
+    echo -e "${RED}❌ Error: $WEBSERV not found${NC}"
+    echo -e "${YELLOW}Please compile first: make${NC}"
+    exit 1
+fi
+
+rm -rf "$TEST_DIR"
+mkdir -p "$TEST_DIR/www" "$TEST_DIR/files"
+CWD=$(pwd)
+STORE="$TEST_DIR/store"
+head -c 3000000 /dev/urandom > "$TEST_DIR/files/photo.bin"
+head -c 1000 /dev/urandom > "$TEST_DIR/files/notes.txt"
+head -c 100000000 /dev/urandom > "$TEST_DIR/files/large.bin"
+# Lines that start like a delimiter, split over the pieces the server reads
+$PYTHON -c 'import sys; sys.stdout.write("a\r\n--XyZ-not-quite\r\n--Xy\r\n-" * 5000)' > "$TEST_DIR/files/tricky.txt"
+cat > "$TEST_DIR/upload.conf" << EOF
+http {
+    server {
+        listen 127.0.0.1:$PORT;
+        server_name localhost;
+        root $CWD/$TEST_DIR/www;
+        client_max_body_size 200M;
+        location /upload {
+            methods POST PUT;
+            upload_dir $CWD/$STORE;
+        }
+        location /direct {
+            methods PUT;
+            upload_dir $CWD/$STORE;
+            upload_io direct;
+        }
+        location /splice {
+            methods PUT;
+            upload_dir $CWD/$STORE;
+            upload_io splice;
+        }
+    }
+}
+EOF
+
+$WEBSERV "$TEST_DIR/upload.conf" > "$TEST_DIR/webserv.log" 2>&1 &
+WEBSERV_PID=$!
+sleep 1
+
+URL="http://127.0.0.1:$PORT/upload"
+
+# ============================================================
+# MULTIPART
+# ============================================================
+
+print_subheader "Multipart"
+
+check "File part returns 201" "$(curl -s -o /dev/null -w '%{http_code}' -F "file=@$TEST_DIR/files/photo.bin" "$URL")" "201"
+check "File part saved intact" "$(same_as "$TEST_DIR/files/photo.bin")" "same"
+
+OUT=$(curl -s -F "a=@$TEST_DIR/files/notes.txt" -F "title=hello" -F "b=@$TEST_DIR/files/tricky.txt" "$URL")
+check "Every file of the request is listed" "$OUT" "File uploaded successfully: notes.txt, tricky.txt"
+check "First file saved intact" "$(same_as "$TEST_DIR/files/notes.txt")" "same"
+check "Delimiter-like lines kept in the file" "$(same_as "$TEST_DIR/files/tricky.txt")" "same"
+check "Form fields are not saved" "$(ls "$STORE" | grep -c title)" "0"
+
+rm -f "$STORE/notes.txt"
+check "Chunked multipart body saved" "$(curl -s -o /dev/null -w '%{http_code}' -H 'Transfer-Encoding: chunked' -F "file=@$TEST_DIR/files/notes.txt" "$URL")" "201"
+check "Chunked upload intact" "$(same_as "$TEST_DIR/files/notes.txt")" "same"
+
+BODY=$(printf -- '--XyZ\r\nContent-Disposition: form-data; name="f"; filename="bytes.txt"\r\n\r\nsplit\r\n--XyZ\r\n\r\nfield\r\n--XyZ--\r\n')
+check "Body split in 3-byte pieces" "$(printf '%s' "$BODY" | send_slowly 3)" "HTTP/1.1 201 Created"
+check "Pieced-together file intact" "$(cat "$STORE/bytes.txt")" "split"
+
+# ============================================================
+# ERRORS
+# ============================================================
+
+print_subheader "Errors"
+
+BODY=$(printf -- '--XyZ\r\nContent-Disposition: form-data; name="f"; filename="cut.txt"\r\n\r\nno closing boundary')
+check "Missing closing boundary returns 400" "$(printf '%s' "$BODY" | send_slowly 4096)" "HTTP/1.1 400 Bad Request"
+check "Unfinished part is not kept" "$([ -e "$STORE/cut.txt" ] && echo kept || echo gone)" "gone"
+
+BODY=$(printf -- '--XyZ\r\nContent-Disposition: form-data; name="title"\r\n\r\nhello\r\n--XyZ--\r\n')
+check "Body without a file part returns 400" "$(printf '%s' "$BODY" | send_slowly 4096)" "HTTP/1.1 400 Bad Request"
+
+curl -s -o /dev/null -m 1 --limit-rate 2M -F "file=@$TEST_DIR/files/large.bin" "$URL"
+sleep 0.5
+check "Aborted upload leaves no temp file" "$(temp_files)" "0"
+check "Aborted upload is not saved" "$([ -e "$STORE/large.bin" ] && echo kept || echo gone)" "gone"
+
+# ============================================================
+# RAW BODIES
+# ============================================================
+
+print_subheader "Raw Bodies"
+
+rm -f "$STORE/photo.bin"
+OUT=$(curl -s -X PUT -H 'Content-Disposition: attachment; filename="photo.bin"' --data-binary "@$TEST_DIR/files/photo.bin" "$URL")
+check "Named by Content-Disposition" "$OUT" "File uploaded successfully: photo.bin"
+check "Raw body saved intact" "$(same_as "$TEST_DIR/files/photo.bin")" "same"
+check "Unnamed body gets a generated name" "$(curl -s --data-binary "@$TEST_DIR/files/notes.txt" -H 'Content-Type: application/octet-stream' "$URL" | grep -c 'upload_[0-9]*\.dat$')" "1"
+
+rm -f "$STORE/notes.txt"
+curl -s -o /dev/null -X PUT -H 'Transfer-Encoding: chunked' -H 'Content-Disposition: attachment; filename="notes.txt"' --data-binary "@$TEST_DIR/files/notes.txt" "$URL"
+check "Chunked raw body saved intact" "$(same_as "$TEST_DIR/files/notes.txt")" "same"
+
+curl -s -o /dev/null -m 2 --limit-rate 2M -X PUT -H 'Content-Disposition: attachment; filename="large.bin"' --data-binary "@$TEST_DIR/files/large.bin" "$URL" &
+CURL_PID=$!
+sleep 1
+check "File reserved at Content-Length up front" "$(stat -c %s "$STORE"/.upload_* 2>/dev/null)" "100000000"
+wait "$CURL_PID"
+sleep 0.5
+check "Aborted raw upload leaves no temp file" "$(temp_files)" "0"
+
+for MODE in direct splice; do
+    rm -f "$STORE/large.bin"
+    BEFORE=$(read_bytes)
+    STATUS=$(curl -s -o /dev/null -w '%{http_code}' -X PUT -H 'Content-Disposition: attachment; filename="large.bin"' --data-binary "@$TEST_DIR/files/large.bin" "http://127.0.0.1:$PORT/$MODE")
+    READ=$(($(read_bytes) - BEFORE))
+    check "upload_io $MODE: 100MB body saved intact" "$STATUS $(same_as "$TEST_DIR/files/large.bin")" "201 same"
+done
+check "upload_io splice: body bypasses the server's buffers" "$([ "$READ" -lt 1048576 ] && echo yes || echo "no ($READ bytes)")" "yes"
+
+# ============================================================
+# MEMORY
+# ============================================================
+
+print_subheader "Memory"
+
+BEFORE=$(rss_kb)
+check "100MB upload returns 201" "$(curl -s -o /dev/null -w '%{http_code}' -F "file=@$TEST_DIR/files/large.bin" "$URL")" "201"
+AFTER=$(rss_kb)
+check "Memory does not grow with the upload" "$([ $((AFTER - BEFORE)) -lt 8192 ] && echo yes || echo "no ($((AFTER - BEFORE)) kB)")" "yes"
+check "100MB upload intact" "$(same_as "$TEST_DIR/files/large.bin")" "same"
+
+BEFORE=$(rss_kb)
+check "100MB raw upload returns 201" "$(curl -s -o /dev/null -w '%{http_code}' --data-binary "@$TEST_DIR/files/large.bin" -H 'Content-Type: application/octet-stream' "$URL")" "201"
+AFTER=$(rss_kb)
+check "Memory does not grow with the raw upload" "$([ $((AFTER - BEFORE)) -lt 8192 ] && echo yes || echo "no ($((AFTER - BEFORE)) kB)")" "yes"
+
+# ============================================================
+# SUMMARY
+# ============================================================
+
+print_header "Test Summary"
+echo "Total Tests: $TOTAL_COUNT"
+echo -e "${GREEN}Passed: $PASS_COUNT${NC}"
+echo -e "${RED}Failed: $FAIL_COUNT${NC}"
+
+if [ $FAIL_COUNT -eq 0 ]; then
+    echo ""
+    echo -e "${GREEN}🎉 All tests passed!${NC}"
+    exit 0
+else
+    echo ""
+    echo -e "${RED}❌ Some tests failed${NC}"
+    exit 1
+fi
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# Persistent CGI worker for the cgi_worker directive:
+#     cgi_pass   .py /usr/bin/python3;
+#     cgi_worker .py ./www/workers/cgi_worker.py min=2 max=8;
+# The interpreter starts once and runs each CGI script in-process.
+# Every message is a "<length>\n<bytes>" frame. A request is an environment
+# frame (NUL-separated NAME=value), the body frames and an empty frame; the
+# response is the script output as frames followed by an empty frame.
+import io
+import os
+import runpy
+import sys
+import traceback
+
+requests_in = sys.stdin.buffer
+responses_out = sys.stdout.buffer
+
+
+def read_frame():
+    line = requests_in.readline()
+    if not line:
+        return None
+    length = int(line)
+    data = requests_in.read(length) if length else b""
+    return data if len(data) == length else None
+
+
+def write_frame(data):
+    responses_out.write(b"%d\n" % len(data))
+    responses_out.write(data)
+
+
+def run_script(env, body):
+    script = env.get("SCRIPT_FILENAME", "")
+    output = io.BytesIO()
+    cwd = os.getcwd()
+    os.environ.clear()
+    os.environ.update(env)
+    sys.argv = [script]
+    sys.stdin = io.TextIOWrapper(io.BytesIO(body), encoding="utf-8", errors="replace")
+    sys.stdout = io.TextIOWrapper(output, encoding="utf-8", write_through=True)
+    try:
+        os.chdir(os.path.dirname(script) or ".")
+        runpy.run_path(script, run_name="__main__")
+    except SystemExit:
+        pass
+    except Exception:
+        traceback.print_exc(file=sys.stderr)
+        if not output.getvalue():
+            sys.stdout.write("Status: 500 Internal Server Error\r\nContent-Type: text/plain\r\n\r\nCGI script failed\n")
+    finally:
+        sys.stdout.flush()
+        data = output.getvalue()
+        sys.stdin, sys.stdout = sys.__stdin__, sys.__stdout__
+        os.chdir(cwd)
+    return data
+
+
+def main():
+    while True:
+        env_block = read_frame()
+        if env_block is None:
+            return
+        body = []
+        while True:
+            chunk = read_frame()
+            if chunk is None:
+                return
+            if not chunk:
+                break
+            body.append(chunk)
+        env = {}
+        for item in env_block.split(b"\0"):
+            name, sep, value = item.partition(b"=")
+            if sep:
+                env[name.decode("latin-1")] = value.decode("latin-1")
+        data = run_script(env, b"".join(body))
+        if data:
+            write_frame(data)
+        write_frame(b"")
+        responses_out.flush()
+
+
+if __name__ == "__main__":
+    main()